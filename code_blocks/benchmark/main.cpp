@@ -0,0 +1,1200 @@
+/*
+ * Набор замеров производительности индикаторов и функций над массивами.
+ *
+ * Для каждого индикатора замеряется время update и test в наносекундах
+ * на одно значение после прогрева, для периодов 10, 100, 1000, 10000
+ * и типов float и double. Функции статистики, нормализации, корреляции,
+ * ДПФ и SSA замеряются на массивах тех же размеров, время - на один вызов.
+ *
+ * Время замера - медиана 9 серий не короче 5 мс (в режиме --quick
+ * 5 серий по 1 мс), поэтому единичные паузы и переключения задач
+ * не сдвигают результат.
+ *
+ * PeriodStats получает одно значение в единицу времени, время хранения
+ * равно периоду. Банки индикаторов замеряются для 64 символов,
+ * время - на один вызов update_all или test_all для всех символов.
+ *
+ * Результаты пишутся в JSON и, если задан --baseline, сравниваются
+ * с базой, программа возвращает 1, если есть замеры медленнее базы
+ * больше допуска. При сравнении время базы масштабируется по медиане
+ * отношений времен всех общих замеров, чтобы учесть другую частоту
+ * процессора. Если общих замеров мало (--filter), масштаб берется
+ * по опорной нагрузке, время которой измеряется перед каждым замером.
+ * Замеры, оказавшиеся медленнее базы,
+ * повторяются (--rechecks раз) в новом процессе benchmark и берется лучшее
+ * время: длительное замедление процессора посреди прогона и неудачное
+ * для одного процесса размещение данных в памяти не дают ложных регрессий.
+ * В базе для каждого замера хранится и разброс времени между прогонами,
+ * замедление меньше этого разброса считается шумом. На виртуальных машинах
+ * отдельные замеры в разных процессах расходятся до двух раз, поэтому
+ * допуск по умолчанию - двукратное замедление; на выделенной машине
+ * его можно уменьшить через --tolerance.
+ *
+ * База зависит от машины и компилятора, поэтому в репозитории ее нет.
+ * Ее нужно записать на своей машине до изменений:
+ *  benchmark --update-baseline --baseline base.json --runs 3
+ * и затем сравнивать с ней:
+ *  benchmark --baseline base.json
+ *
+ * Параметры:
+ *  --json <файл>       Файл результатов (benchmark.json)
+ *  --baseline <файл>   Файл базы, без него сравнение не выполняется
+ *  --tolerance <доля>  Допуск замедления (1.0)
+ *  --filter <строка>   Замерять только имена, содержащие строку
+ *  --quick             Только периоды 10 и 100, короткие замеры
+ *  --runs <число>      Число прогонов, для каждого замера берется лучший (1)
+ *  --rechecks <число>  Число повторов замеров, медленнее базы (3)
+ *  --update-baseline   Записать результаты в файл базы из --baseline
+ *  --cases <файл>      Замерять только имена из файла, по одному в строке
+ *                      (так запускаются повторные замеры)
+ *
+ * Индикаторы с тяжелым пересчетом (FreqHist, ДПФ, SSA) замеряются
+ * только для периодов, у которых замер занимает разумное время.
+ * DelayEvent, ProfileIndex и RollingVolumeProfile не обрабатывают поток цен
+ * по одному значению и здесь не замеряются.
+ * У AMA и NoLagMa замеряется только update: их test копирует историю,
+ * которая растет с каждым значением, и время test зависит от длины
+ * прогона, а не от кода индикатора.
+ */
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <memory>
+#include <random>
+#include <chrono>
+#include <limits>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include "xtechnical_indicators.hpp"
+#include "xtechnical_statistics.hpp"
+#include "indicators/xtechnical_awesome_oscillator.hpp"
+#include "indicators/xtechnical_fractals_level.hpp"
+
+using namespace xtechnical;
+
+/* результат замера */
+class Result {
+public:
+    std::string name;
+    std::string type;
+    size_t period = 0;
+    std::string op;
+    double ns = 0;
+    double spread = 0;  /**< Разброс времени между прогонами, нс */
+
+    std::string key() const {
+        return name + "|" + type + "|" + std::to_string(period) + "|" + op;
+    }
+};
+
+template<class T> struct TypeName {};
+template<> struct TypeName<float> {static const char *get() {return "float";}};
+template<> struct TypeName<double> {static const char *get() {return "double";}};
+
+/* значения бара для индикаторов с разными входами */
+template<class T>
+class Sample {
+public:
+    T open = 0, high = 0, low = 0, close = 0, volume = 0;
+    uint64_t timestamp = 0;
+};
+
+/* случайное блуждание цены, повторяется по кругу */
+template<class T>
+class Series {
+public:
+    static const size_t SIZE = 1 << 15;
+    static const size_t MASK = SIZE - 1;
+    std::vector<Sample<T>> samples;
+    std::vector<T> close;
+
+    Series() : samples(SIZE), close(SIZE) {
+        std::mt19937 gen(1);
+        std::normal_distribution<double> step(0.0, 0.0005);
+        std::uniform_real_distribution<double> spread(0.0, 0.0005);
+        std::uniform_int_distribution<int> volume(1, 100);
+        double price = 1.0;
+        uint64_t timestamp = 1600000000000ULL;
+        for (size_t i = 0; i < SIZE; ++i) {
+            Sample<T> &s = samples[i];
+            s.open = (T)price;
+            price = std::max(0.1, price + step(gen));
+            s.close = (T)price;
+            s.high = (T)(std::max((double)s.open, price) + spread(gen));
+            s.low = (T)(std::min((double)s.open, price) - spread(gen));
+            s.volume = (T)volume(gen);
+            timestamp += 250 + gen() % 1000;
+            s.timestamp = timestamp;
+            close[i] = s.close;
+        }
+    }
+};
+
+volatile double benchmark_sink = 0;
+
+/* медиана, values переупорядочивается */
+static double calc_median(std::vector<double> &values) {
+    if (values.empty()) return 0;
+    const size_t middle = values.size() / 2;
+    std::nth_element(values.begin(), values.begin() + middle, values.end());
+    const double upper = values[middle];
+    if (values.size() % 2) return upper;
+    const double lower = *std::max_element(values.begin(), values.begin() + middle);
+    return (lower + upper) / 2.0;
+}
+
+class Suite {
+public:
+    std::vector<size_t> periods = {10, 100, 1000, 10000};
+    std::string filter;
+    std::set<std::string> recheck;  /**< Имена для повторного замера, пусто - замерять все */
+    double batch_time = 0.005;  /**< Минимальное время одной серии, сек. */
+    size_t repeats = 9;         /**< Число серий, берется медиана */
+    std::vector<double> reference_samples;  /**< Времена опорной нагрузки за прогон, нс */
+    std::vector<Result> results;
+
+    bool is_selected(const std::string &name) const {
+        if (!recheck.empty()) return recheck.count(name) != 0;
+        return filter.empty() || name.find(filter) != std::string::npos;
+    }
+
+    /* время одной операции в нс, func(count) выполняет count операций */
+    template<class F>
+    double measure(F &&func) {
+        typedef std::chrono::steady_clock clock;
+        size_t count = 16;
+        double sum = 0;
+        for (;;) {
+            const auto t1 = clock::now();
+            sum += func(count);
+            const double elapsed = std::chrono::duration<double>(clock::now() - t1).count();
+            if (elapsed >= batch_time) break;
+            count *= 2;
+        }
+        std::vector<double> samples(repeats);
+        for (size_t r = 0; r < repeats; ++r) {
+            const auto t1 = clock::now();
+            sum += func(count);
+            const double elapsed = std::chrono::duration<double, std::nano>(clock::now() - t1).count();
+            samples[r] = elapsed / (double)count;
+        }
+        benchmark_sink = benchmark_sink + sum;
+        return calc_median(samples);
+    }
+
+    /* опорная нагрузка - скользящая сумма по кольцевому буферу,
+     * как у простых индикаторов. Ее время меняется вместе со скоростью
+     * процессора, медиана по всему прогону используется при сравнении с базой
+     */
+    void measure_reference() {
+        const size_t count = 32768;
+        static std::vector<double> ring(1024, 1.0);
+        double best = std::numeric_limits<double>::max();
+        double sum = 0;
+        size_t pos = 0;
+        for (size_t r = 0; r < 5; ++r) {
+            const auto t1 = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < count; ++i) {
+                const double in = (double)(i & 0xFF) * 0.001;
+                sum += in - ring[pos];
+                ring[pos] = in;
+                pos = (pos + 1) & 0x3FF;
+            }
+            const double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t1).count();
+            best = std::min(best, elapsed / (double)count);
+        }
+        benchmark_sink = benchmark_sink + sum;
+        reference_samples.push_back(best);
+    }
+
+    /* время опорной нагрузки за прогон, нс */
+    double get_reference() const {
+        std::vector<double> samples(reference_samples);
+        return calc_median(samples);
+    }
+
+    void add_result(const std::string &name, const std::string &type, const size_t period, const std::string &op, const double ns) {
+        Result result;
+        result.name = name;
+        result.type = type;
+        result.period = period;
+        result.op = op;
+        result.ns = ns;
+        results.push_back(result);
+        std::cout << std::left << std::setw(48) << name << " " << std::setw(8) << type
+            << std::right << std::setw(7) << period << " " << std::left << std::setw(7) << op
+            << std::right << std::fixed << std::setprecision(2) << std::setw(12) << ns << " ns" << std::endl;
+    }
+
+    /* замер одного экземпляра: прогрев, test, затем update
+     *
+     * test не меняет состояние, поэтому замеряется сразу после прогрева:
+     * состояние не зависит от числа значений, подобранного для серий update
+     */
+    template<class T, class I, class UPDATE, class TEST>
+    void run_instance(
+            const std::string &name,
+            const size_t period,
+            I &indicator,
+            UPDATE update,
+            TEST test,
+            const bool is_test) {
+        static const Series<T> series;
+        const Sample<T> *samples = series.samples.data();
+        size_t pos = 0;
+        double sum = 0;
+        const size_t warm_up = 3 * period + 100;
+        measure_reference();
+        for (size_t i = 0; i < warm_up; ++i) {
+            sum += (double)update(indicator, samples[pos++ & Series<T>::MASK]);
+        }
+        benchmark_sink = benchmark_sink + sum;
+        double ns_test = 0;
+        if (is_test) {
+            ns_test = measure([&](const size_t count) {
+                double s = 0;
+                for (size_t i = 0; i < count; ++i) {
+                    s += (double)test(indicator, samples[pos++ & Series<T>::MASK]);
+                }
+                return s;
+            });
+        }
+        const double ns_update = measure([&](const size_t count) {
+            double s = 0;
+            for (size_t i = 0; i < count; ++i) {
+                s += (double)update(indicator, samples[pos++ & Series<T>::MASK]);
+            }
+            return s;
+        });
+        add_result(name, TypeName<T>::get(), period, "update", ns_update);
+        if (is_test) add_result(name, TypeName<T>::get(), period, "test", ns_test);
+    }
+
+    /** \brief Индикатор с периодом
+     * \param name          Имя
+     * \param make          make(period) возвращает new INDICATOR
+     * \param update        update(indicator, sample) возвращает значение
+     * \param test          test(indicator, sample) возвращает значение
+     * \param max_period    Наибольший замеряемый период
+     */
+    template<class T, class MAKE, class UPDATE, class TEST>
+    void add(
+            const std::string &name,
+            MAKE make,
+            UPDATE update,
+            TEST test,
+            const size_t max_period = std::numeric_limits<size_t>::max()) {
+        if (!is_selected(name)) return;
+        for (const size_t period : periods) {
+            if (period > max_period) continue;
+            std::unique_ptr<typename std::remove_pointer<decltype(make(period))>::type> indicator(make(period));
+            run_instance<T>(name, period, *indicator, update, test, true);
+        }
+    }
+
+    /** \brief Индикатор с периодом, у которого замеряется только update
+     *
+     * Для формирователей баров без метода test и для индикаторов,
+     * у которых время test зависит от длины истории.
+     */
+    template<class T, class MAKE, class UPDATE>
+    void add_update(
+            const std::string &name,
+            MAKE make,
+            UPDATE update,
+            const size_t max_period = std::numeric_limits<size_t>::max()) {
+        if (!is_selected(name)) return;
+        for (const size_t period : periods) {
+            if (period > max_period) continue;
+            std::unique_ptr<typename std::remove_pointer<decltype(make(period))>::type> indicator(make(period));
+            run_instance<T>(name, period, *indicator, update, update, false);
+        }
+    }
+
+    /** \brief Индикатор без периода, в результатах период 0
+     */
+    template<class T, class I, class UPDATE, class TEST>
+    void add_once(const std::string &name, UPDATE update, TEST test, const bool is_test = true) {
+        if (!is_selected(name)) return;
+        std::unique_ptr<I> indicator(new I());
+        run_instance<T>(name, 0, *indicator, update, test, is_test);
+    }
+
+    /** \brief Функция над массивом
+     * \param name      Имя
+     * \param func      func(input, size) возвращает значение, input - вектор значений размера size
+     * \param max_size  Наибольший замеряемый размер
+     */
+    template<class T, class F>
+    void add_array(
+            const std::string &name,
+            F func,
+            const size_t max_size = std::numeric_limits<size_t>::max()) {
+        if (!is_selected(name)) return;
+        static const Series<T> series;
+        for (const size_t size : periods) {
+            if (size > max_size) continue;
+            measure_reference();
+            const std::vector<T> input(series.close.begin(), series.close.begin() + size);
+            const double ns = measure([&](const size_t count) {
+                double s = 0;
+                for (size_t i = 0; i < count; ++i) s += (double)func(input, size);
+                return s;
+            });
+            add_result(name, TypeName<T>::get(), size, "call", ns);
+        }
+    }
+};
+
+/* индикаторы с одним входом и методами update(in), test(in), get() */
+template<class I, class T>
+struct Price {
+    T operator()(I &i, const Sample<T> &s) const {i.update(s.close); return i.get();}
+};
+
+template<class I, class T>
+struct PriceTest {
+    T operator()(I &i, const Sample<T> &s) const {i.test(s.close); return i.get();}
+};
+
+template<class I, class T>
+struct PriceOut {
+    T operator()(I &i, const Sample<T> &s) const {T out = 0; i.update(s.close, out); return out;}
+};
+
+template<class I, class T>
+struct PriceOutTest {
+    T operator()(I &i, const Sample<T> &s) const {T out = 0; i.test(s.close, out); return out;}
+};
+
+template<class I, class T>
+struct HighLowClose {
+    T operator()(I &i, const Sample<T> &s) const {i.update(s.high, s.low, s.close); return i.get();}
+};
+
+template<class I, class T>
+struct HighLowCloseTest {
+    T operator()(I &i, const Sample<T> &s) const {i.test(s.high, s.low, s.close); return i.get();}
+};
+
+template<class I, class T>
+struct HighLow {
+    T operator()(I &i, const Sample<T> &s) const {i.update(s.high, s.low); return i.get();}
+};
+
+template<class I, class T>
+struct HighLowTest {
+    T operator()(I &i, const Sample<T> &s) const {i.test(s.high, s.low); return i.get();}
+};
+
+template<class I, class T>
+struct MinMaxUpdate {
+    T operator()(I &i, const Sample<T> &s) const {i.update(s.close); return i.get_max() - i.get_min();}
+};
+
+template<class I, class T>
+struct MinMaxTest {
+    T operator()(I &i, const Sample<T> &s) const {i.test(s.close); return i.get_max() - i.get_min();}
+};
+
+template<class I, class T>
+struct BandsUpdate {
+    T operator()(I &i, const Sample<T> &s) const {i.update(s.close); return i.get_tl();}
+};
+
+template<class I, class T>
+struct BandsTest {
+    T operator()(I &i, const Sample<T> &s) const {T tl, ml, bl; i.test(s.close, tl, ml, bl); return tl;}
+};
+
+/* формирователи баров по цене и времени */
+template<class I, class T>
+struct Tick {
+    T operator()(I &i, const Sample<T> &s) const {i.update(s.close, s.timestamp / 1000); return 0;}
+};
+
+template<class I, class T>
+struct TickVolume {
+    T operator()(I &i, const Sample<T> &s) const {return (T)i.update(s.close, s.timestamp, (uint64_t)s.volume);}
+};
+
+/* информационные бары вместе со своим кольцом баров */
+template<class SHAPER>
+class InfoBarShaper {
+public:
+    InfoBarRing ring;
+    SHAPER shaper;
+
+    InfoBarShaper(const size_t p) : ring(1024), shaper(p, 0.00001, ring) {};
+
+    template<class T>
+    inline size_t update(const T price, const uint64_t timestamp, const uint64_t volume) {
+        return shaper.update(price, timestamp, volume);
+    }
+};
+
+/* статистика за период со своим временем: одно значение в единицу времени */
+template<class T>
+class PeriodStatsV1Stream {
+public:
+    PeriodStatsV1<T> stats;
+    uint64_t time = 0;
+
+    PeriodStatsV1Stream(const size_t p) : stats(p) {};
+};
+
+template<class I, class T>
+struct PeriodStatsV1Update {
+    T operator()(I &i, const Sample<T> &s) const {
+        i.stats.add((int)(s.close * 1000), ++i.time);
+        return i.stats.get_max_value() + i.stats.get_max_weight() + i.stats.get_center_mass();
+    }
+};
+
+class PeriodStatsV2Stream {
+public:
+    PeriodStatsV2 stats;
+    PeriodStatsV2::Stats out;
+    uint64_t time = 0;
+
+    PeriodStatsV2Stream(const size_t p) : stats(p) {};
+};
+
+/* банк индикаторов и цены символов, символ j берет ряд со сдвигом */
+template<class BANK, class T>
+class BankStream {
+public:
+    static const size_t SYMBOLS = 64;
+    static const size_t ROWS = 1024;
+    BANK bank;
+    std::vector<T> high, low, close;    /**< Цены [строка][символ] */
+    size_t row = 0;
+
+    BankStream(const size_t p) :
+            bank(SYMBOLS, p), high(SYMBOLS * ROWS), low(SYMBOLS * ROWS), close(SYMBOLS * ROWS) {
+        static const Series<T> series;
+        for (size_t r = 0; r < ROWS; ++r) {
+            for (size_t j = 0; j < SYMBOLS; ++j) {
+                const Sample<T> &s = series.samples[(r + j * 97) & Series<T>::MASK];
+                high[r * SYMBOLS + j] = s.high;
+                low[r * SYMBOLS + j] = s.low;
+                close[r * SYMBOLS + j] = s.close;
+            }
+        }
+    }
+
+    inline size_t next() noexcept {
+        const size_t offset = row * SYMBOLS;
+        row = (row + 1) & (ROWS - 1);
+        return offset;
+    }
+};
+
+template<class I, class T>
+struct BankPrice {
+    T operator()(I &i, const Sample<T> &) const {i.bank.update_all(i.close.data() + i.next()); return i.bank.get(0);}
+};
+
+template<class I, class T>
+struct BankPriceTest {
+    T operator()(I &i, const Sample<T> &) const {i.bank.test_all(i.close.data() + i.next()); return i.bank.get(0);}
+};
+
+template<class I, class T>
+struct BankHighLowClose {
+    T operator()(I &i, const Sample<T> &) const {
+        const size_t offset = i.next();
+        i.bank.update_all(i.high.data() + offset, i.low.data() + offset, i.close.data() + offset);
+        return i.bank.get(0);
+    }
+};
+
+template<class I, class T>
+struct BankHighLowCloseTest {
+    T operator()(I &i, const Sample<T> &) const {
+        const size_t offset = i.next();
+        i.bank.test_all(i.high.data() + offset, i.low.data() + offset, i.close.data() + offset);
+        return i.bank.get(0);
+    }
+};
+
+template<class BANK, class T>
+void add_bank(Suite &suite, const std::string &name, const size_t max_period = std::numeric_limits<size_t>::max()) {
+    typedef BankStream<BANK, T> Stream;
+    suite.add<T>(name,
+        [](const size_t p) {return new Stream(p);},
+        BankPrice<Stream, T>(), BankPriceTest<Stream, T>(), max_period);
+}
+
+/* индикатор с обычной парой update(in)/test(in) и get() */
+template<class I, class T, class... ARGS>
+void add_price(Suite &suite, const std::string &name, ARGS... args) {
+    suite.add<T>(name,
+        [=](const size_t p) {return new I(p, args...);},
+        Price<I, T>(), PriceTest<I, T>());
+}
+
+template<class I, class T, class... ARGS>
+void add_price_out(Suite &suite, const std::string &name, ARGS... args) {
+    suite.add<T>(name,
+        [=](const size_t p) {return new I(p, args...);},
+        PriceOut<I, T>(), PriceOutTest<I, T>());
+}
+
+template<class I, class T>
+void add_hlc(Suite &suite, const std::string &name) {
+    suite.add<T>(name,
+        [](const size_t p) {return new I(p);},
+        HighLowClose<I, T>(), HighLowCloseTest<I, T>());
+}
+
+/* индикаторы с периодом в параметре шаблона */
+template<class T, size_t N>
+void add_fixed(Suite &suite) {
+    if (std::find(suite.periods.begin(), suite.periods.end(), N) == suite.periods.end()) return;
+    const std::string type = TypeName<T>::get();
+    if (suite.is_selected("FixedSMA")) {
+        FixedSMA<T, N> sma;
+        suite.run_instance<T>("FixedSMA", N, sma, Price<FixedSMA<T, N>, T>(), PriceTest<FixedSMA<T, N>, T>(), true);
+    }
+    if (suite.is_selected("FixedSUM")) {
+        FixedSUM<T, N> sum;
+        suite.run_instance<T>("FixedSUM", N, sum, Price<FixedSUM<T, N>, T>(), PriceTest<FixedSUM<T, N>, T>(), true);
+    }
+    if (suite.is_selected("FixedEMA")) {
+        FixedEMA<T, N> ema;
+        suite.run_instance<T>("FixedEMA", N, ema, Price<FixedEMA<T, N>, T>(), PriceTest<FixedEMA<T, N>, T>(), true);
+    }
+    if (suite.is_selected("FixedDelayLine")) {
+        FixedDelayLine<T, N> delay_line;
+        suite.run_instance<T>("FixedDelayLine", N, delay_line, Price<FixedDelayLine<T, N>, T>(), PriceTest<FixedDelayLine<T, N>, T>(), true);
+    }
+}
+
+template<class T>
+void run_indicators(Suite &suite) {
+    add_price<SMA<T>, T>(suite, "SMA");
+    add_price<EMA<T>, T>(suite, "EMA");
+    add_price<MMA<T>, T>(suite, "MMA");
+    add_price<WMA<T>, T>(suite, "WMA");
+    add_price<SUM<T>, T>(suite, "SUM");
+    add_price<LRMA<T>, T>(suite, "LRMA");
+    add_price<MAV<T>, T>(suite, "MAV");
+    add_price<StdDev<T>, T>(suite, "StdDev");
+    add_price<Zscore<T>, T>(suite, "Zscore");
+    add_price<DelayLine<T>, T>(suite, "DelayLine");
+    add_price<PercentDifference<T>, T>(suite, "PercentDifference");
+    add_price<RoC<T>, T>(suite, "RoC");
+    add_price<PRI<T>, T>(suite, "PRI");
+    add_price<RSI<T, SMA<T>>, T>(suite, "RSI<SMA>");
+    add_price<RSI<T, MMA<T>>, T>(suite, "RSI<MMA>");
+    add_price<MAD<T, SMA<T>>, T>(suite, "MAD<SMA>");
+    add_price<PercentRank<T>, T>(suite, "PercentRank", false);
+    add_price<TrendDirectionForceIndex<T, EMA<T>>, T>(suite, "TrendDirectionForceIndex<EMA>");
+    add_price<FisherV1<T>, T>(suite, "FisherV1");
+    add_price<FisherV2<T>, T>(suite, "FisherV2");
+    add_price<FisherV3<T>, T>(suite, "FisherV3");
+    add_price<RollingSkewness<T>, T>(suite, "RollingSkewness");
+    add_price<RollingKurtosis<T>, T>(suite, "RollingKurtosis");
+    suite.add<T>("MinMaxDiff",
+        [](const size_t p) {return new MinMaxDiff<T>(p);},
+        Price<MinMaxDiff<T>, T>(), PriceTest<MinMaxDiff<T>, T>());
+
+    suite.add<T>("MinMax",
+        [](const size_t p) {return new MinMax<T>(p);},
+        MinMaxUpdate<MinMax<T>, T>(), MinMaxTest<MinMax<T>, T>());
+    suite.add<T>("FastMinMax",
+        [](const size_t p) {return new FastMinMax<T>(p);},
+        MinMaxUpdate<FastMinMax<T>, T>(), MinMaxTest<FastMinMax<T>, T>());
+    suite.add<T>("BollingerBands",
+        [](const size_t p) {return new BollingerBands<T>(p, 2);},
+        BandsUpdate<BollingerBands<T>, T>(), BandsTest<BollingerBands<T>, T>());
+    suite.add<T>("Stochastics<SMA>",
+        [](const size_t p) {return new Stochastics<T, SMA<T>>(p, 3, 3);},
+        Price<Stochastics<T, SMA<T>>, T>(), PriceTest<Stochastics<T, SMA<T>>, T>());
+    suite.add<T>("CRSI<SMA>",
+        [](const size_t p) {return new CRSI<T, SMA<T>>(p, 2, p);},
+        Price<CRSI<T, SMA<T>>, T>(), PriceTest<CRSI<T, SMA<T>>, T>());
+    suite.add<T>("MAZ",
+        [](const size_t p) {return new MAZ<T>(p, p);},
+        Price<MAZ<T>, T>(), PriceTest<MAZ<T>, T>());
+    suite.add<T>("OsMa",
+        [](const size_t p) {return new OsMa<T>(p, 2 * p, p);},
+        PriceOut<OsMa<T>, T>(), PriceOutTest<OsMa<T>, T>());
+    // test копирует всю накопленную историю, замеряется только update
+    suite.add_update<T>("AMA",
+        [](const size_t p) {return new AMA<T>((uint32_t)p);},
+        PriceOut<AMA<T>, T>());
+    suite.add_update<T>("NoLagMa",
+        [](const size_t p) {return new NoLagMa<T>((uint32_t)p);},
+        PriceOut<NoLagMa<T>, T>());
+    suite.add<T>("AverageSpeed",
+        [](const size_t p) {return new AverageSpeed<T>(p);},
+        PriceOut<AverageSpeed<T>, T>(), PriceOutTest<AverageSpeed<T>, T>());
+    suite.add<T>("LowPassFilter",
+        [](const size_t p) {return new LowPassFilter<T>(1, (T)p);},
+        PriceOut<LowPassFilter<T>, T>(), PriceOutTest<LowPassFilter<T>, T>());
+    suite.add<T>("RSHILLMA<SMA,SMA>",
+        [](const size_t p) {return new RSHILLMA<T, SMA<T>, SMA<T>>(p, p, p, 2);},
+        Price<RSHILLMA<T, SMA<T>, SMA<T>>, T>(), PriceTest<RSHILLMA<T, SMA<T>, SMA<T>>, T>());
+    suite.add<T>("VWMA",
+        [](const size_t p) {return new VWMA<T>(p);},
+        [](VWMA<T> &i, const Sample<T> &s) {i.update(s.close, s.volume); return i.get();},
+        [](VWMA<T> &i, const Sample<T> &s) {i.test(s.close, s.volume); return i.get();});
+    suite.add<T>("MFI<SMA>",
+        [](const size_t p) {return new MFI<T, SMA<T>>(p);},
+        [](MFI<T, SMA<T>> &i, const Sample<T> &s) {T out = 0; i.update(s.high, s.low, s.close, s.volume, out); return out;},
+        [](MFI<T, SMA<T>> &i, const Sample<T> &s) {T out = 0; i.test(s.high, s.low, s.close, s.volume, out); return out;});
+    suite.add<T>("AwesomeOscillator<SMA>",
+        [](const size_t p) {return new AwesomeOscillator<T>(p, 2 * p);},
+        HighLow<AwesomeOscillator<T>, T>(), HighLowTest<AwesomeOscillator<T>, T>());
+    suite.add<T>("MaBBandsYxf",
+        [](const size_t p) {return new MaBBandsYxf<T>(p, 12, p);},
+        [](MaBBandsYxf<T> &i, const Sample<T> &s) {T out = 0; i.update(s.high, s.low, s.close, out); return out;},
+        [](MaBBandsYxf<T> &i, const Sample<T> &s) {T out = 0; i.test(s.high, s.low, s.close, out); return out;});
+    suite.add<T>("CurrencyCorrelation",
+        [](const size_t p) {return new CurrencyCorrelation<T>(p, 2);},
+        [](CurrencyCorrelation<T> &i, const Sample<T> &s) {return (T)i.update(s.close, (size_t)(s.timestamp & 1));},
+        [](CurrencyCorrelation<T> &i, const Sample<T> &s) {return (T)i.test(s.close, (size_t)(s.timestamp & 1));});
+    suite.add_update<T>("DetectorWaveform",
+        [](const size_t p) {return new DetectorWaveform<T>((int)p);},
+        [](DetectorWaveform<T> &i, const Sample<T> &s) {T out = 0; i.update(s.close, out, 4); return out;});
+    // каждое обновление считает ДПФ окна, поэтому только малые периоды
+    suite.add_update<T>("FreqHist",
+        [](const size_t p) {return new FreqHist<T>(p, dft::RECTANGULAR_WINDOW);},
+        [](FreqHist<T> &i, const Sample<T> &s) {
+            static std::vector<T> histogram;
+            i.update(s.close, histogram);
+            return histogram.empty() ? (T)0 : histogram[0];
+        }, 100);
+
+    suite.add_update<T>("PeriodStatsV1",
+        [](const size_t p) {return new PeriodStatsV1Stream<T>(p);},
+        PeriodStatsV1Update<PeriodStatsV1Stream<T>, T>());
+
+    add_bank<IndicatorBank<SMA<T>>, T>(suite, "IndicatorBank<SMA>");
+    add_bank<IndicatorBank<EMA<T>>, T>(suite, "IndicatorBank<EMA>");
+    // дисперсия окна пересчитывается целиком на каждом шаге
+    add_bank<IndicatorBank<StdDev<T>>, T>(suite, "IndicatorBank<StdDev>", 1000);
+    add_bank<IndicatorBank<RSI<T, SMA<T>>>, T>(suite, "IndicatorBank<RSI<SMA>>");
+    suite.add<T>("IndicatorBank<ATR<SMA>>",
+        [](const size_t p) {return new BankStream<IndicatorBank<ATR<T, SMA<T>>>, T>(p);},
+        BankHighLowClose<BankStream<IndicatorBank<ATR<T, SMA<T>>>, T>, T>(),
+        BankHighLowCloseTest<BankStream<IndicatorBank<ATR<T, SMA<T>>>, T>, T>());
+
+    add_hlc<ATR<T, SMA<T>>, T>(suite, "ATR<SMA>");
+    add_hlc<ATR<T, MMA<T>>, T>(suite, "ATR<MMA>");
+    add_hlc<CCI<T, SMA<T>>, T>(suite, "CCI<SMA>");
+    suite.add<T>("SuperTrend<SMA>",
+        [](const size_t p) {return new SuperTrend<T, SMA<T>>(p, p);},
+        HighLowClose<SuperTrend<T, SMA<T>>, T>(), HighLowCloseTest<SuperTrend<T, SMA<T>>, T>());
+    suite.add<T>("BodyFilter<SMA>",
+        [](const size_t p) {return new BodyFilter<T, SMA<T>>(p);},
+        [](BodyFilter<T, SMA<T>> &i, const Sample<T> &s) {i.update(s.open, s.high, s.low, s.close); return i.get();},
+        [](BodyFilter<T, SMA<T>> &i, const Sample<T> &s) {i.test(s.open, s.high, s.low, s.close); return i.get();});
+
+    add_fixed<T, 10>(suite);
+    add_fixed<T, 100>(suite);
+    add_fixed<T, 1000>(suite);
+    add_fixed<T, 10000>(suite);
+
+    suite.add_once<T, CMA<T>>("CMA",
+        [](CMA<T> &i, const Sample<T> &s) {T out = 0; i.update(s.close, out); return out;},
+        [](CMA<T> &i, const Sample<T> &s) {T out = 0; i.test(s.close, out); return out;});
+    suite.add_once<T, VCMA<T>>("VCMA",
+        [](VCMA<T> &i, const Sample<T> &s) {T out = 0; i.update(s.close, s.volume, out); return out;},
+        [](VCMA<T> &i, const Sample<T> &s) {T out = 0; i.test(s.close, s.volume, out); return out;});
+    suite.add_once<T, TrueRange<T>>("TrueRange",
+        HighLowClose<TrueRange<T>, T>(), HighLowCloseTest<TrueRange<T>, T>());
+    suite.add_once<T, BasicFractals<T>>("BasicFractals",
+        [](BasicFractals<T> &i, const Sample<T> &s) {return (T)i.update(s.high, s.low);},
+        [](BasicFractals<T> &i, const Sample<T> &s) {return (T)i.test(s.high, s.low);});
+    suite.add_once<T, Fractals<T>>("Fractals",
+        [](Fractals<T> &i, const Sample<T> &s) {return (T)i.update(s.high, s.low);},
+        [](Fractals<T> &i, const Sample<T> &s) {return (T)i.test(s.high, s.low);});
+    suite.add_once<T, BasicFractalsLevel<T>>("BasicFractalsLevel",
+        [](BasicFractalsLevel<T> &i, const Sample<T> &s) {return (T)i.update(s.high, s.low);},
+        [](BasicFractalsLevel<T> &i, const Sample<T> &s) {return (T)i.test(s.high, s.low);});
+    suite.add_once<T, FractalsLevel<T>>("FractalsLevel",
+        [](FractalsLevel<T> &i, const Sample<T> &s) {return (T)i.update(s.high, s.low);},
+        [](FractalsLevel<T> &i, const Sample<T> &s) {return (T)i.test(s.high, s.low);});
+
+    /* формирователи баров, период - длительность бара в секундах
+     * или размер бара для информационных баров
+     */
+    suite.add_update<T>("BasicBarShaper",
+        [](const size_t p) {return new BasicBarShaper<T>(p);},
+        Tick<BasicBarShaper<T>, T>());
+    suite.add_update<T>("BarShaperV1",
+        [](const size_t p) {
+            BarShaperV1<T> *shaper = new BarShaperV1<T>(p);
+            shaper->on_close_bar = [](const typename BarShaperV1<T>::Bar &) {};
+            return shaper;
+        },
+        Tick<BarShaperV1<T>, T>());
+    suite.add_update<T>("MultiBarShaper",
+        [](const size_t p) {return new MultiBarShaper<T>(std::vector<uint64_t>{p, 5 * p, 15 * p});},
+        Tick<MultiBarShaper<T>, T>());
+    suite.add_update<T>("RenkoChart",
+        [](const size_t p) {return new RenkoChart<T>(5, p);},
+        Tick<RenkoChart<T>, T>());
+    suite.add_update<T>("TickBarShaper",
+        [](const size_t p) {return new InfoBarShaper<TickBarShaper<T>>(p);},
+        TickVolume<InfoBarShaper<TickBarShaper<T>>, T>());
+    suite.add_update<T>("VolumeBarShaper",
+        [](const size_t p) {return new InfoBarShaper<VolumeBarShaper<T>>(p);},
+        TickVolume<InfoBarShaper<VolumeBarShaper<T>>, T>());
+    suite.add_update<T>("RangeBarShaper",
+        [](const size_t p) {return new InfoBarShaper<RangeBarShaper<T>>(p);},
+        TickVolume<InfoBarShaper<RangeBarShaper<T>>, T>());
+    suite.add_update<T>("RenkoBarShaper",
+        [](const size_t p) {return new InfoBarShaper<RenkoBarShaper<T>>(p);},
+        TickVolume<InfoBarShaper<RenkoBarShaper<T>>, T>());
+    suite.add_update<T>("TickImbalanceBarShaper",
+        [](const size_t p) {return new InfoBarShaper<TickImbalanceBarShaper<T>>(p);},
+        TickVolume<InfoBarShaper<TickImbalanceBarShaper<T>>, T>());
+}
+
+/* ClusterShaper работает только с double */
+void run_cluster_shaper(Suite &suite) {
+    suite.add_update<double>("ClusterShaper",
+        [](const size_t p) {
+            ClusterShaper *shaper = new ClusterShaper(p, 0.00001);
+            shaper->on_close_bar = [](const ClusterShaper::Cluster &) {};
+            return shaper;
+        },
+        [](ClusterShaper &i, const Sample<double> &s) {return (double)i.update(s.close, s.timestamp / 1000);});
+}
+
+/* PeriodStatsV2 не зависит от типа, замеряется только для double */
+void run_period_stats(Suite &suite) {
+    suite.add_update<double>("PeriodStatsV2",
+        [](const size_t p) {return new PeriodStatsV2Stream(p);},
+        [](PeriodStatsV2Stream &i, const Sample<double> &s) {
+            i.stats.add((int)(s.close * 1000), ++i.time, s.close > s.open ? 1 : -1);
+            i.stats.calc_norm(10, i.out);
+            return i.out.total_winrate;
+        });
+}
+
+template<class T>
+void run_arrays(Suite &suite) {
+    using namespace xtechnical_statistics;
+    typedef std::vector<T> Array;
+
+    suite.add_array<T>("statistics::calc_mean_value", [](const Array &in, const size_t) {return calc_mean_value<T>(in);});
+    suite.add_array<T>("statistics::calc_root_mean_square", [](const Array &in, const size_t) {return calc_root_mean_square<T>(in);});
+    suite.add_array<T>("statistics::calc_harmonic_mean", [](const Array &in, const size_t) {return calc_harmonic_mean<T>(in);});
+    suite.add_array<T>("statistics::calc_geometric_mean", [](const Array &in, const size_t) {return calc_geometric_mean<T>(in);});
+    suite.add_array<T>("statistics::calc_median", [](const Array &in, const size_t) {return calc_median<T>(in);});
+    suite.add_array<T>("statistics::calc_std_dev_sample", [](const Array &in, const size_t) {return calc_std_dev_sample<T>(in);});
+    suite.add_array<T>("statistics::calc_std_dev_population", [](const Array &in, const size_t) {return calc_std_dev_population<T>(in);});
+    suite.add_array<T>("statistics::calc_median_absolute_deviation", [](const Array &in, const size_t) {return calc_median_absolute_deviation<T>(in);});
+    suite.add_array<T>("statistics::calc_mean_absolute_deviation", [](const Array &in, const size_t) {return calc_mean_absolute_deviation<T>(in);});
+    suite.add_array<T>("statistics::calc_skewness", [](const Array &in, const size_t) {return calc_skewness<T>(in);});
+    suite.add_array<T>("statistics::calc_excess", [](const Array &in, const size_t) {return calc_excess<T>(in);});
+    suite.add_array<T>("statistics::calc_standard_error", [](const Array &in, const size_t) {return calc_standard_error<T>(in);});
+    suite.add_array<T>("statistics::calc_coefficient_variance", [](const Array &in, const size_t) {return calc_coefficient_variance<T>(in);});
+    suite.add_array<T>("statistics::calc_signal_to_noise_ratio", [](const Array &in, const size_t) {return calc_signal_to_noise_ratio<T>(in);});
+    suite.add_array<T>("statistics::calc_moments", [](const Array &in, const size_t) {return calc_moments<T>(in).get_excess();});
+
+    suite.add_array<T>("normalization::calculate_min_max", [](const Array &in, const size_t size) {
+        static Array out;
+        out.resize(size);
+        normalization::calculate_min_max(in, out, common::MINMAX_SIGNED);
+        return out.back();
+    });
+    suite.add_array<T>("normalization::calculate_zscore", [](const Array &in, const size_t size) {
+        static Array out;
+        out.resize(size);
+        normalization::calculate_zscore(in, out);
+        return out.back();
+    });
+    suite.add_array<T>("normalization::calculate_difference", [](const Array &in, const size_t size) {
+        static Array out;
+        out.resize(size - 1);
+        normalization::calculate_difference(in, out);
+        return out.back();
+    });
+    suite.add_array<T>("normalization::normalize_amplitudes", [](const Array &in, const size_t size) {
+        static Array out;
+        out.resize(size);
+        normalization::normalize_amplitudes(in, out, (T)1);
+        return out.back();
+    });
+    suite.add_array<T>("normalization::calculate_log", [](const Array &in, const size_t size) {
+        static Array out;
+        out.resize(size);
+        normalization::calculate_log(in, out);
+        return out.back();
+    });
+    suite.add_array<T>("normalization::calc_automatic_gain_control", [](const Array &in, const size_t size) {
+        static Array out;
+        out.resize(size);
+        normalization::calc_automatic_gain_control<SMA<T>>(in, out, std::max((size_t)1, size / 10));
+        return out.back();
+    });
+
+    suite.add_array<T>("correlation::calculate_pearson_correlation_coefficient", [](const Array &in, const size_t) {
+        static Array x, y;
+        x.assign(in.begin(), in.end());
+        y.assign(in.rbegin(), in.rend());
+        T rxy = 0;
+        correlation::calculate_pearson_correlation_coefficient(x, y, rxy);
+        return rxy;
+    });
+    suite.add_array<T>("correlation::calculate_spearman_rank_correlation_coefficient", [](const Array &in, const size_t) {
+        static Array x, y;
+        x.assign(in.begin(), in.end());
+        y.assign(in.rbegin(), in.rend());
+        T p = 0;
+        correlation::calculate_spearman_rank_correlation_coefficient(x, y, p);
+        return p;
+    });
+
+    // ДПФ считается напрямую за O(n^2)
+    suite.add_array<T>("dft::DftReal::update", [](const Array &in, const size_t) {
+        static dft::DftReal<T> dft;
+        static Array amplitude, frequencies;
+        dft.update(in, amplitude, frequencies);
+        return amplitude.back();
+    }, 1000);
+
+    // SVD траекторной матрицы, длина окна ограничена
+    suite.add_array<T>("SSA::calc", [](const Array &in, const size_t size) {
+        static SSA<T> ssa;
+        static size_t ssa_size = 0;
+        if (ssa_size != size) {
+            ssa = SSA<T>(size);
+            for (const T value : in) ssa.update(value);
+            ssa_size = size;
+        }
+        ssa.calc(1, std::min((size_t)32, size / 2), 1, 1);
+        return ssa.get_last_forecast();
+    }, 1000);
+}
+
+static std::string escape_json(const std::string &str) {
+    std::string out;
+    for (const char c : str) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+static bool write_json(const std::string &file_name, const std::vector<Result> &results, const double reference) {
+    std::ofstream file(file_name);
+    if (!file) return false;
+    file << "{\n";
+    file << "  \"version\": 1,\n";
+#   if defined(__VERSION__)
+    file << "  \"compiler\": \"" << escape_json(__VERSION__) << "\",\n";
+#   endif
+    file << "  \"reference\": " << std::fixed << std::setprecision(3) << reference << ",\n";
+    file << "  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result &r = results[i];
+        file << "    {\"name\": \"" << escape_json(r.name)
+            << "\", \"type\": \"" << r.type
+            << "\", \"period\": " << r.period
+            << ", \"op\": \"" << r.op
+            << "\", \"ns\": " << std::fixed << std::setprecision(3) << r.ns
+            << ", \"spread\": " << r.spread
+            << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    file << "  ]\n";
+    file << "}\n";
+    return true;
+}
+
+/* значение ключа внутри одного объекта JSON без вложенных объектов */
+static std::string find_json_value(const std::string &object, const std::string &key) {
+    const std::string pattern = "\"" + key + "\"";
+    size_t pos = object.find(pattern);
+    if (pos == std::string::npos) return std::string();
+    pos = object.find(':', pos + pattern.size());
+    if (pos == std::string::npos) return std::string();
+    ++pos;
+    while (pos < object.size() && std::isspace((unsigned char)object[pos])) ++pos;
+    if (pos >= object.size()) return std::string();
+    if (object[pos] == '"') {
+        std::string value;
+        for (++pos; pos < object.size() && object[pos] != '"'; ++pos) {
+            if (object[pos] == '\\' && pos + 1 < object.size()) ++pos;
+            value += object[pos];
+        }
+        return value;
+    }
+    const size_t end = object.find_first_of(",}", pos);
+    return object.substr(pos, end == std::string::npos ? std::string::npos : end - pos);
+}
+
+/* разбор файла в формате write_json */
+static bool read_json(const std::string &file_name, std::vector<Result> &results, double &reference) {
+    std::ifstream file(file_name);
+    if (!file) return false;
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    const std::string text = buffer.str();
+    size_t pos = text.find("\"results\"");
+    if (pos == std::string::npos) return false;
+    reference = std::strtod(find_json_value(text.substr(0, pos), "reference").c_str(), nullptr);
+    results.clear();
+    for (;;) {
+        const size_t begin = text.find('{', pos);
+        if (begin == std::string::npos) break;
+        const size_t end = text.find('}', begin);
+        if (end == std::string::npos) break;
+        const std::string object = text.substr(begin, end - begin + 1);
+        Result r;
+        r.name = find_json_value(object, "name");
+        r.type = find_json_value(object, "type");
+        r.period = (size_t)std::strtoull(find_json_value(object, "period").c_str(), nullptr, 10);
+        r.op = find_json_value(object, "op");
+        r.ns = std::strtod(find_json_value(object, "ns").c_str(), nullptr);
+        r.spread = std::strtod(find_json_value(object, "spread").c_str(), nullptr);
+        results.push_back(r);
+        pos = end + 1;
+    }
+    return true;
+}
+
+/* сравнение с базой, возвращает число замедлений больше допуска
+ *
+ * Время базы приводится к текущей скорости машины по медиане отношений
+ * времен общих замеров, при малом числе общих замеров (--filter) -
+ * по отношению опорных времен прогона и базы.
+ * Имена замедлившихся замеров добавляются в regressed.
+ */
+static size_t compare(
+        const std::vector<Result> &results,
+        const double reference,
+        const std::vector<Result> &baseline,
+        const double base_reference,
+        const double tolerance,
+        std::set<std::string> &regressed) {
+    // разница меньше полунаносекунды или разброса замера между прогонами базы
+    // не считается, это уровень шума
+    const double min_difference = 0.5;
+    std::map<std::string, const Result*> base;
+    for (const Result &r : baseline) base[r.key()] = &r;
+    // опорная нагрузка не всегда замедляется вместе с замерами,
+    // медиана отношений по всем замерам устойчивее
+    const size_t min_scale_cases = 20;
+    std::vector<double> ratios;
+    for (const Result &r : results) {
+        auto it = base.find(r.key());
+        if (it != base.end() && it->second->ns > 0) ratios.push_back(r.ns / it->second->ns);
+    }
+    double scale = (base_reference > 0 && reference > 0) ? reference / base_reference : 1.0;
+    if (ratios.size() >= min_scale_cases) scale = calc_median(ratios);
+    std::cout << "reference " << std::fixed << std::setprecision(3) << reference
+        << " ns, baseline " << base_reference << " ns, scale " << scale << std::endl;
+    size_t regressions = 0, improvements = 0, missing = 0;
+    for (const Result &r : results) {
+        auto it = base.find(r.key());
+        if (it == base.end()) {
+            ++missing;
+            continue;
+        }
+        const Result &b = *it->second;
+        const double base_ns = b.ns * scale;
+        const double ratio = base_ns > 0 ? r.ns / base_ns : 1.0;
+        const double difference = r.ns - base_ns;
+        const double noise = std::max(min_difference, b.spread * scale);
+        if (ratio > (1.0 + tolerance) && difference > noise) {
+            ++regressions;
+            regressed.insert(r.name);
+            std::cout << "REGRESSION ";
+        } else
+        if (ratio < 1.0 / (1.0 + tolerance) && -difference > noise) {
+            ++improvements;
+            std::cout << "IMPROVEMENT ";
+        } else {
+            continue;
+        }
+        std::cout << r.name << " " << r.type << " " << r.period << " " << r.op
+            << " " << std::fixed << std::setprecision(2) << base_ns << " -> " << r.ns
+            << " ns (x" << std::setprecision(2) << ratio << ")" << std::endl;
+    }
+    std::cout << "regressions " << regressions
+        << " improvements " << improvements
+        << " not in baseline " << missing << std::endl;
+    return regressions;
+}
+
+/* прогон всех замеров, выбранных в suite */
+static void run_suite(Suite &suite) {
+    suite.results.clear();
+    run_indicators<float>(suite);
+    run_indicators<double>(suite);
+    run_cluster_shaper(suite);
+    run_period_stats(suite);
+    run_arrays<float>(suite);
+    run_arrays<double>(suite);
+}
+
+/* для каждого замера оставить лучшее время и разброс между прогонами */
+static void merge_best(std::vector<Result> &best, const std::vector<Result> &results) {
+    std::map<std::string, size_t> index;
+    for (size_t i = 0; i < best.size(); ++i) index[best[i].key()] = i;
+    for (const Result &r : results) {
+        auto it = index.find(r.key());
+        if (it == index.end()) {
+            index[r.key()] = best.size();
+            best.push_back(r);
+            continue;
+        }
+        Result &b = best[it->second];
+        const double worst = std::max(b.ns + b.spread, r.ns);
+        b.ns = std::min(b.ns, r.ns);
+        b.spread = worst - b.ns;
+    }
+}
+
+/* чтение имен замеров для --cases, по одному в строке */
+static bool read_cases(const std::string &file_name, std::set<std::string> &cases) {
+    std::ifstream file(file_name);
+    if (!file) return false;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (!line.empty()) cases.insert(line);
+    }
+    return !cases.empty();
+}
+
+/* повторный замер имен из cases в новом процессе
+ *
+ * Время замера в одном процессе может устойчиво отличаться в разы
+ * из-за размещения данных в памяти, поэтому повтор в том же процессе
+ * не отсеивает такой шум. Если запустить процесс не удалось,
+ * замеры повторяются в текущем.
+ */
+static void recheck_cases(
+        const std::string &program,
+        const std::string &json_file,
+        const std::set<std::string> &cases,
+        const bool is_quick,
+        Suite &suite,
+        std::vector<Result> &best) {
+    const std::string cases_file = json_file + ".cases";
+    const std::string recheck_file = json_file + ".recheck";
+    {
+        std::ofstream file(cases_file);
+        for (const std::string &name : cases) file << name << std::endl;
+    }
+    std::string command = "\"" + program + "\" --rechecks 0 --cases \"" + cases_file +
+        "\" --json \"" + recheck_file + "\"" + (is_quick ? " --quick" : "");
+#   ifdef _WIN32
+    // cmd.exe снимает первую и последнюю кавычки строки
+    command = "\"" + command + "\"";
+#   endif
+    std::vector<Result> results;
+    double reference = 0;
+    if (std::system(command.c_str()) == 0 && read_json(recheck_file, results, reference)) {
+        merge_best(best, results);
+    } else {
+        suite.recheck = cases;
+        run_suite(suite);
+        merge_best(best, suite.results);
+        suite.recheck.clear();
+    }
+    std::remove(cases_file.c_str());
+    std::remove(recheck_file.c_str());
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "Hello world!" << std::endl;
+
+    std::string json_file = "benchmark.json";
+    std::string baseline_file;
+    double tolerance = 1.0;
+    bool is_update_baseline = false;
+    size_t runs = 1;
+    size_t rechecks = 3;
+    bool is_quick = false;
+    Suite suite;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool is_value = (i + 1) < argc;
+        if (arg == "--json" && is_value) json_file = argv[++i];
+        else if (arg == "--baseline" && is_value) baseline_file = argv[++i];
+        else if (arg == "--tolerance" && is_value) tolerance = std::atof(argv[++i]);
+        else if (arg == "--filter" && is_value) suite.filter = argv[++i];
+        else if (arg == "--runs" && is_value) runs = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--rechecks" && is_value) rechecks = std::max(0, std::atoi(argv[++i]));
+        else if (arg == "--update-baseline") is_update_baseline = true;
+        else if (arg == "--cases" && is_value) {
+            if (!read_cases(argv[++i], suite.recheck)) {
+                std::cout << "failed to read " << argv[i] << std::endl;
+                return 2;
+            }
+        } else if (arg == "--quick") {
+            is_quick = true;
+            suite.periods = {10, 100};
+            suite.batch_time = 0.001;
+            suite.repeats = 5;
+        } else {
+            std::cout << "unknown argument " << arg << std::endl;
+            return 2;
+        }
+    }
+    if (is_update_baseline && baseline_file.empty()) {
+        std::cout << "--update-baseline requires --baseline <file>" << std::endl;
+        return 2;
+    }
+
+    const auto t1 = std::chrono::steady_clock::now();
+    // при нескольких прогонах для каждого замера берется лучший
+    std::vector<Result> best;
+    for (size_t run = 0; run < runs; ++run) {
+        run_suite(suite);
+        merge_best(best, suite.results);
+    }
+    // повторные замеры не меняют опорное время прогона
+    const double reference = suite.get_reference();
+    const auto t2 = std::chrono::steady_clock::now();
+    std::cout << "results " << best.size()
+        << " time (s) " << std::chrono::duration<double>(t2 - t1).count() << std::endl;
+
+    size_t regressions = 0;
+    if (!baseline_file.empty() && !is_update_baseline) {
+        std::vector<Result> baseline;
+        double base_reference = 0;
+        if (read_json(baseline_file, baseline, base_reference)) {
+            std::set<std::string> regressed;
+            regressions = compare(best, reference, baseline, base_reference, tolerance, regressed);
+            // замедлившиеся замеры повторяются, чтобы отсеять шум
+            for (size_t recheck = 0; recheck < rechecks && regressions != 0; ++recheck) {
+                std::cout << "recheck " << (recheck + 1) << " of " << rechecks << std::endl;
+                recheck_cases(argv[0], json_file, regressed, is_quick, suite, best);
+                regressed.clear();
+                regressions = compare(best, reference, baseline, base_reference, tolerance, regressed);
+            }
+        } else {
+            std::cout << "baseline " << baseline_file << " not found, comparison skipped" << std::endl;
+        }
+    }
+
+    if (!write_json(json_file, best, reference)) {
+        std::cout << "failed to write " << json_file << std::endl;
+        return 2;
+    }
+    if (is_update_baseline) {
+        if (!write_json(baseline_file, best, reference)) {
+            std::cout << "failed to write " << baseline_file << std::endl;
+            return 2;
+        }
+        std::cout << "baseline updated " << baseline_file << std::endl;
+    }
+    return regressions == 0 ? 0 : 1;
+}
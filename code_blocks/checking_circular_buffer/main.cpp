@@ -60,6 +60,7 @@ int main() {
     std::cout << "middle " << circular_buffer.middle() << std::endl;
     std::cout << "sum " << circular_buffer.sum() << std::endl;
     std::cout << "mean " << circular_buffer.mean() << std::endl;
+    std::cout << "memory usage " << circular_buffer.memory_usage() << std::endl;
 
     /* очищаем и повторно заполняем буфер данными и выводим на экран */
     circular_buffer.clear();
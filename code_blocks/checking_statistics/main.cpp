@@ -53,6 +53,12 @@ int main() {
     double p_bet = xtechnical_statistics::calc_probability_winrate<double>(0.6, 31, 44);
     std::cout << "p_bet: " << p_bet << std::endl; // получим ответ 93.6
 
+    p_bet = xtechnical_statistics::calc_probability_winrate<double>(0.6, 31, 44, 0.01);
+    std::cout << "p_bet (0.01): " << p_bet << std::endl;
+
+    p_bet = xtechnical_statistics::calc_probability_winrate_exact<double>(0.6, 31, 44);
+    std::cout << "p_bet (exact): " << p_bet << std::endl;
+
     p_bet = xtechnical_statistics::calc_probability_winrate<double>(0.56, 5700, 10000);
     std::cout << "p_bet: " << p_bet << std::endl;
 
@@ -61,5 +67,45 @@ int main() {
 
     p_bet = xtechnical_statistics::calc_probability_winrate<double>(0.57, 1, 1);
     std::cout << "p_bet (1): " << p_bet << std::endl;
+
+    std::vector<int> wins = {31, 5700, 5700, 1, 0, 300};
+    std::vector<int> deals = {44, 10000, 10000, 1, 0, 500};
+    std::vector<double> p_bets(wins.size());
+    xtechnical_statistics::calc_probability_winrate(0.56, wins, deals, p_bets);
+    for(size_t i = 0; i < p_bets.size(); ++i) {
+        std::cout << "p_bets[" << i << "]: " << p_bets[i] << std::endl;
+    }
+    xtechnical_statistics::calc_probability_winrate_exact(0.56, wins, deals, p_bets);
+    for(size_t i = 0; i < p_bets.size(); ++i) {
+        std::cout << "p_bets exact[" << i << "]: " << p_bets[i] << std::endl;
+    }
+
+    xtechnical_statistics::Moments<double> moments;
+    moments.update(test_data4);
+    std::cout << "moments mean: " << moments.get_mean()
+        << " std_dev: " << moments.get_std_dev_sample()
+        << " skewness: " << moments.get_skewness()
+        << " excess: " << moments.get_excess() << std::endl;
+
+    xtechnical_statistics::Moments<double> moments_part1, moments_part2;
+    moments_part1.update(test_data4, 0, 4);
+    moments_part2.update(test_data4, 4, test_data4.size());
+    moments_part1.merge(moments_part2);
+    std::cout << "merged moments mean: " << moments_part1.get_mean()
+        << " std_dev: " << moments_part1.get_std_dev_sample()
+        << " skewness: " << moments_part1.get_skewness()
+        << " excess: " << moments_part1.get_excess() << std::endl;
+
+    /* значения другого арифметического типа добавляются по одному */
+    xtechnical_statistics::Moments<double> moments_scalar;
+    moments_scalar.update(1.0f);
+    moments_scalar.update(2);
+    moments_scalar.update(3.0);
+    std::cout << "scalar moments mean: " << moments_scalar.get_mean()
+        << " std_dev: " << moments_scalar.get_std_dev_sample() << std::endl;
+    if (moments_scalar.get_mean() != 2.0) {
+        std::cout << "scalar moments error" << std::endl;
+        return 1;
+    }
     return 0;
 }
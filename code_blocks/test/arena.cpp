@@ -0,0 +1,119 @@
+#include <iostream>
+#include "xtechnical_indicators.hpp"
+#include "xtechnical_arena.hpp"
+#include <random>
+#include <chrono>
+
+/* индикаторы одного символа, создаваемые вместе */
+class SymbolIndicators {
+public:
+    xtechnical::SMA<double> sma;
+    xtechnical::StdDev<double> std_dev;
+    xtechnical::BollingerBands<double> bb;
+    xtechnical::DelayLine<double> delay_line;
+    /* обычный буфер всегда в куче, даже внутри ArenaScope */
+    xtechnical::circular_buffer<double> heap_window;
+    /* буфер в арене текущего контекста */
+    xtechnical::arena_circular_buffer<double> window;
+    /* буфер с явно заданной ареной, не зависит от контекста */
+    xtechnical::arena_circular_buffer<double> explicit_window;
+
+    SymbolIndicators(const size_t p, xtechnical::Arena *arena) :
+        sma(p), std_dev(p), bb(p, 2), delay_line(p), heap_window(p), window(p),
+        explicit_window(p, xtechnical::ArenaAllocator<double>(arena)) {
+    }
+
+    double update(const double value) {
+        sma.update(value);
+        std_dev.update(value);
+        bb.update(value);
+        delay_line.update(value);
+        heap_window.update(value);
+        window.update(value);
+        explicit_window.update(value);
+        return sma.get() + std_dev.get() + bb.get_tl() + delay_line.get();
+    }
+};
+
+static void create(std::vector<SymbolIndicators> &symbols, const size_t n, xtechnical::Arena *arena) {
+    symbols.clear();
+    symbols.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        symbols.emplace_back(10 + i % 50, arena);
+    }
+}
+
+static double replay(std::vector<SymbolIndicators> &symbols) {
+    std::mt19937 gen(1);
+    double sum = 0;
+    for (size_t k = 0; k < 100; ++k) {
+        for (auto &symbol : symbols) {
+            const double value = 100.0 + (double)(gen() % 1000) / 100.0;
+            const double out = symbol.update(value);
+            if (!std::isnan(out)) sum += out;
+        }
+    }
+    return sum;
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "Hello world!" << std::endl;
+
+    const size_t symbols_size = 3000;
+    std::vector<SymbolIndicators> heap_symbols, arena_symbols;
+
+    auto t1 = std::chrono::high_resolution_clock::now();
+    create(heap_symbols, symbols_size, nullptr);
+    auto t2 = std::chrono::high_resolution_clock::now();
+    std::cout << "heap create us " << std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() << std::endl;
+
+    xtechnical::Arena arena(1024 * 1024);
+    t1 = std::chrono::high_resolution_clock::now();
+    {
+        xtechnical::ArenaScope scope(arena);
+        create(arena_symbols, symbols_size, &arena);
+    }
+    t2 = std::chrono::high_resolution_clock::now();
+    std::cout << "arena create us " << std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() << std::endl;
+    std::cout << "arena size " << arena.size() << " memory usage " << arena.memory_usage() << std::endl;
+
+    /* буферы arena_circular_buffer внутри контекста лежат в арене, остальные - в куче */
+    size_t errors = 0;
+    for (size_t i = 0; i < symbols_size; ++i) {
+        if (!arena.contains(&arena_symbols[i].window.view().first[0])) ++errors;
+        if (arena.contains(&heap_symbols[i].window.view().first[0])) ++errors;
+        if (!arena.contains(&arena_symbols[i].explicit_window.view().first[0])) ++errors;
+        if (arena.contains(&heap_symbols[i].explicit_window.view().first[0])) ++errors;
+        if (arena.contains(&arena_symbols[i].heap_window.view().first[0])) ++errors;
+    }
+
+    /* явно заданная арена используется и вне контекста */
+    xtechnical::Arena explicit_arena;
+    xtechnical::arena_circular_buffer<double> window(
+        100, xtechnical::ArenaAllocator<double>(&explicit_arena));
+    if (!explicit_arena.contains(&window.view().first[0])) ++errors;
+
+    t1 = std::chrono::high_resolution_clock::now();
+    const double heap_sum = replay(heap_symbols);
+    t2 = std::chrono::high_resolution_clock::now();
+    std::cout << "heap replay us " << std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() << std::endl;
+    t1 = std::chrono::high_resolution_clock::now();
+    const double arena_sum = replay(arena_symbols);
+    t2 = std::chrono::high_resolution_clock::now();
+    std::cout << "arena replay us " << std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() << std::endl;
+    if (heap_sum != arena_sum) ++errors;
+
+    /* сброс арены целиком и повторное создание в тех же блоках */
+    const size_t memory_usage = arena.memory_usage();
+    arena_symbols.clear();
+    arena.clear();
+    {
+        xtechnical::ArenaScope scope(arena);
+        create(arena_symbols, symbols_size, &arena);
+    }
+    if (arena.memory_usage() != memory_usage) ++errors;
+    if (replay(arena_symbols) != heap_sum) ++errors;
+
+    std::cout << "errors " << errors << std::endl;
+    return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,470 @@
+#include <iostream>
+#include "xtechnical_circular_buffer.hpp"
+#include <random>
+#include <cmath>
+
+namespace previous {
+
+    /* прежняя реализация circular_buffer с буфером для теста и размером,
+     * округленным до степени двойки, используется для сравнения результатов
+     */
+    template<class T>
+    class circular_buffer {
+    private:
+	
+        std::vector<T> buffer;      /**< Основной буфер */
+        std::vector<T> buffer_test; /**< Буфер для теста */
+        uint32_t buffer_size;       /**< Размер буфера */
+        uint32_t buffer_size_div2;  /**< Индекс середины массива */
+        uint32_t buffer_offset;     /**< Смещение в буфере для размера массива не кратного степени двойки */
+        uint32_t count;             /**< Количество элементов в буфере */
+        uint32_t count_test;        /**< Количество элементов в буфере для теста */
+        uint32_t offset;            /**< Смещение в буфере */
+        uint32_t offset_test;
+        uint32_t mask;              /**< Маска */
+        bool is_power_of_two;       /**< Флаг степени двойки */
+        bool is_test;               /**< Флаг теста */
+
+        inline const uint32_t cpl2(uint32_t x) const {
+            x = x - 1;
+            x = x | (x >> 1);
+            x = x | (x >> 2);
+            x = x | (x >> 4);
+            x = x | (x >> 8);
+            x = x | (x >> 16);
+            return x + 1;
+        }
+
+        inline const bool check_power_of_two(const uint32_t value) const {
+            return value && !(value & (value - 1));
+        }
+		
+    public:
+	
+        typedef T value_t;
+
+        /** \brief Конструктор циклического буфера
+         */
+        circular_buffer() :
+            buffer_size(0), buffer_size_div2(0), buffer_offset(0),
+            count(0), count_test(0), offset(0), offset_test(0), mask(0),
+            is_power_of_two(false), is_test(false) {};
+
+        /** \brief Конструктор циклического буфера
+         * \param user_size Размер циклического буфера
+         */
+        circular_buffer(const size_t user_size) :
+                buffer_size(user_size), buffer_size_div2(0), buffer_offset(0),
+                count(0), count_test(0), offset(0), offset_test(0),
+                is_power_of_two(false), is_test(false) {
+            if(check_power_of_two(user_size)) {
+                buffer.resize(buffer_size);
+                buffer_test.resize(buffer_size);
+                mask = user_size - 1;
+                is_power_of_two = true;
+            } else {
+                const size_t new_size = cpl2(buffer_size);
+                buffer.resize(new_size);
+                buffer_test.resize(new_size);
+                mask = new_size - 1;
+                buffer_offset = buffer_size - new_size;
+                is_power_of_two = false;
+            }
+            buffer_size_div2 = buffer_size / 2;
+        };
+
+        /** \brief Добавить значение в циклический буфер
+         * \param value Значение
+         */
+        inline void push_back(const T value) {
+            buffer[offset++] = value;
+            if(offset > count) count = offset;
+            offset &= mask;
+        }
+
+        /** \brief Получить размер циклического буфера
+         * \return Размер циклического буфера. Может быть меньше максимального, если буфер еще не заполнился.
+         */
+        inline size_t size() const {
+            return is_test ? std::min((size_t)count_test, (size_t)buffer_size) : std::min((size_t)count, (size_t)buffer_size);
+        }
+
+        /** \brief Проверить, если циклическй буфер пуст
+         * \return Вернет true, если циклическй буфер пуст
+         */
+        inline bool empty() const {
+            return is_test ? (count_test == 0) : (count == 0);
+        }
+
+        /** \brief Проверить, если циклическй буфер полн
+         * \return Вернет true, если циклическй буфер полн
+         */
+        inline bool full() const {
+            if(is_test) return (count_test >= buffer_size);
+            return (count >= buffer_size);
+        }
+
+        void fill(const T value) {
+            if(is_test) std::fill(buffer_test.begin(), buffer_test.end(), value);
+            else std::fill(buffer.begin(), buffer.end(), value);
+        }
+
+        /** \brief Обновить состояние циклического буфера
+         * \param value Новое значение
+         * \return Вернет true, если циклическй буфер полн
+         */
+        inline bool update(const T value) {
+            is_test = false;
+            push_back(value);
+            return full();
+        }
+
+        /** \brief Протестировать состояние циклического буфера
+         * \param value Новое значение
+         * \return Вернет true, если циклическй буфер полн
+         */
+        inline bool test(const double value) {
+            if(!is_test) {
+                is_test = true;
+                buffer_test = buffer;
+                offset_test = offset;
+                count_test = count;
+                buffer_test[offset_test++] = value;
+                if(offset_test > count_test) count_test = offset_test;
+                offset_test &= mask;
+            } else {
+                buffer_test[(offset_test - 1) & mask] = value;
+            }
+            return full();
+        }
+
+        /** \brief Получить значение циклического буфера по индексу
+         * \param index Индекс
+         * \return Значение циклического буфера
+         */
+        inline T &get(const uint32_t index) {
+            if(is_test) return buffer_test[(offset_test + (is_power_of_two ? index : (index - buffer_offset))) & mask];
+            return buffer[(offset + (is_power_of_two ? index : (index - buffer_offset))) & mask];
+        }
+
+        /** \brief Получить значение циклического буфера по индексу
+         * \param index Индекс
+         * \return Значение циклического буфера
+         */
+        T& operator[](std::size_t index) {
+            if(is_test) return buffer_test[(offset_test + (is_power_of_two ? index : (index - buffer_offset))) & mask];
+            return buffer[(offset + (is_power_of_two ? index : (index - buffer_offset))) & mask];
+        }
+
+        /** \brief Получить значение циклического буфера по индексу
+         * \param index Индекс
+         * \return Значение циклического буфера
+         */
+        const T& operator[](std::size_t index) const {
+            if(is_test) return buffer_test[(offset_test + (is_power_of_two ? index : (index - buffer_offset))) & mask];
+            return buffer[(offset + (is_power_of_two ? index : (index - buffer_offset))) & mask];
+        }
+
+        /** \brief Доступ к первому элементу
+         * \return Возвращает ссылку на первый элемент циклического буфера
+         */
+        inline T &front() {
+            if(is_test) return buffer_test[(offset_test - (is_power_of_two ? 0 : buffer_offset)) & mask];
+            return buffer[(offset - (is_power_of_two ? 0 : buffer_offset)) & mask];
+        }
+
+        /** \brief Доступ к первому элементу
+         * \return Возвращает ссылку на первый элемент циклического буфера
+         */
+        inline const T &front() const {
+            if(is_test) return buffer_test[(offset_test - (is_power_of_two ? 0 : buffer_offset)) & mask];
+            return buffer[(offset - (is_power_of_two ? 0 : buffer_offset)) & mask];
+        }
+
+        /** \brief Доступ к последнему элементу
+         * \return Возвращает ссылку на первый элемент циклического буфера
+         */
+        inline T &back() {
+            if(is_test) return buffer_test[(offset_test - 1) & mask];
+            return buffer[(offset - 1) & mask];
+        }
+
+        /** \brief Доступ к последнему элементу
+         * \return Возвращает ссылку на первый элемент циклического буфера
+         */
+        inline const T &back() const {
+            if(is_test) return buffer_test[(offset_test - 1) & mask];
+            return buffer[(offset - 1) & mask];
+        }
+
+        /** \brief Доступ к среднему элементу
+         * \return Возвращает ссылку на первый элемент циклического буфера
+         */
+        inline T &middle() {
+            if(is_test) {
+                if(full()) return buffer_test[(offset_test + (is_power_of_two ? buffer_size_div2 : buffer_size_div2 - buffer_offset)) & mask];
+                else return buffer_test[(offset_test + (is_power_of_two ? (count_test/2) : (count_test/2) - buffer_offset)) & mask];
+            }
+            if(full()) return buffer[(offset + (is_power_of_two ? buffer_size_div2 : buffer_size_div2 - buffer_offset)) & mask];
+            else return buffer[(offset + (is_power_of_two ? (count/2) : (count/2) - buffer_offset)) & mask];
+        }
+
+        /** \brief Доступ к среднему элементу
+         * \return Возвращает ссылку на первый элемент циклического буфера
+         */
+        inline const T &middle() const {
+            if(is_test) {
+                if(full()) return buffer_test[(offset_test + (is_power_of_two ? buffer_size_div2 : buffer_size_div2 - buffer_offset)) & mask];
+                return buffer_test[(offset_test + (is_power_of_two ? (count_test/2) : (count_test/2) - buffer_offset)) & mask];
+            }
+            if(full()) return buffer[(offset + (is_power_of_two ? buffer_size_div2 : buffer_size_div2 - buffer_offset)) & mask];
+            return buffer[(offset + (is_power_of_two ? (count/2) : (count/2) - buffer_offset)) & mask];
+        }
+
+        /** \brief Получить сумму
+         * \return Возвращает сумму элементов циклического буфера
+         */
+        inline const T sum() const {
+            T temp = 0;
+            if(is_test) {
+                if(is_power_of_two) {
+                    for(uint32_t index = 0; index < buffer_size; ++index) {
+                        temp += buffer_test[(offset_test + index) & mask];
+                    }
+                    return temp;
+                } else {
+                    for(uint32_t index = 0; index < buffer_size; ++index) {
+                        temp += buffer_test[(offset_test + (index - buffer_offset)) & mask];
+                    }
+                    return temp;
+                }
+            } else {
+                if(is_power_of_two) {
+                    for(uint32_t index = 0; index < buffer_size; ++index) {
+                        temp += buffer[(offset + index) & mask];
+                    }
+                    return temp;
+                } else {
+                    for(uint32_t index = 0; index < buffer_size; ++index) {
+                        temp += buffer[(offset + (index - buffer_offset)) & mask];
+                    }
+                    return temp;
+                }
+            }
+        }
+
+        /** \brief Получить сумму
+         * \param start_index Начальный индекс
+         * \param stop_index Конечный индекс
+         * \return Возвращает сумму элементов циклического буфера
+         */
+        inline const T sum(const uint32_t start_index, const uint32_t stop_index) const {
+            T temp = 0;
+            if(is_test) {
+                if(is_power_of_two) {
+                    for(uint32_t index = start_index; index < stop_index; ++index) {
+                        temp += buffer_test[(offset_test + index) & mask];
+                    }
+                    return temp;
+                } else {
+                    for(uint32_t index = start_index; index < stop_index; ++index) {
+                        temp += buffer_test[(offset_test + (index - buffer_offset)) & mask];
+                    }
+                    return temp;
+                }
+            } else {
+                if(is_power_of_two) {
+                    for(uint32_t index = start_index; index < stop_index; ++index) {
+                        temp += buffer[(offset + index) & mask];
+                    }
+                    return temp;
+                } else {
+                    for(uint32_t index = start_index; index < stop_index; ++index) {
+                        temp += buffer[(offset + (index - buffer_offset)) & mask];
+                    }
+                    return temp;
+                }
+            }
+        }
+
+        /** \brief Получить среднее значение
+         * \return Возвращает среднее значение элементов циклического буфера
+         */
+        inline const T mean() const {
+            return sum() / (T)buffer_size;
+        }
+
+        /** \brief Преобразовать к вектору
+         * \return Вектор
+         */
+        std::vector<T> to_vector() {
+            std::vector<T> temp;
+            temp.reserve(buffer_size);
+            const uint32_t max_index = buffer_size - 1;
+            if(is_test) {
+                uint32_t start_index = 0;
+                uint32_t stop_index = 0;
+                if(is_power_of_two) {
+                    start_index = (offset_test) & mask;
+                    stop_index = (offset_test + max_index) & mask;
+                } else {
+                    start_index = (offset_test - buffer_offset) & mask;
+                    stop_index = (offset_test + (max_index - buffer_offset)) & mask;
+                }
+                if(start_index > stop_index) {
+                    std::copy(buffer_test.begin() + start_index, buffer_test.end(), std::back_inserter(temp));
+                    std::copy(buffer_test.begin(), buffer_test.begin() + stop_index + 1, std::back_inserter(temp));
+                } else {
+                    std::copy(buffer_test.begin() + start_index, buffer_test.begin() + stop_index + 1, std::back_inserter(temp));
+                }
+            } else {
+                uint32_t start_index = 0;
+                uint32_t stop_index = 0;
+                if(is_power_of_two) {
+                    start_index = offset & mask;
+                    stop_index = (offset + max_index) & mask;
+                } else {
+                    start_index = (offset- buffer_offset) & mask;
+                    stop_index = (offset + (max_index - buffer_offset)) & mask;
+                }
+                if(start_index > stop_index) {
+                    std::copy(buffer.begin() + start_index, buffer.end(), std::back_inserter(temp));
+                    std::copy(buffer.begin(), buffer.begin() + stop_index + 1, std::back_inserter(temp));
+                } else {
+                    std::copy(buffer.begin() + start_index, buffer.begin() + stop_index + 1, std::back_inserter(temp));
+                }
+            }
+            return temp;
+        }
+
+        /** \brief Очистить данные циклического буфера
+         */
+        inline void clear() {
+            count = 0;
+            count_test = 0;
+            offset = 0;
+            offset_test = 0;
+            is_test = false;
+            //fill(0);
+        }
+    };
+};
+
+/* сравнение состояния буферов
+ * \param is_valid_window Все элементы окна определены (после clear()
+ *                        незаполненная часть окна содержит старые данные)
+ */
+size_t compare_state(
+        xtechnical::circular_buffer<double> &buffer,
+        previous::circular_buffer<double> &prev_buffer,
+        const size_t buffer_size,
+        const bool is_valid_window) {
+    size_t errors = 0;
+    if (buffer.size() != prev_buffer.size() ||
+        buffer.empty() != prev_buffer.empty() ||
+        buffer.full() != prev_buffer.full()) return 1;
+    if (buffer.empty()) return 0;
+
+    /* элементы, которые точно были добавлены */
+    const size_t start_index = buffer_size - buffer.size();
+    for (size_t i = start_index; i < buffer_size; ++i) {
+        if (buffer[i] != prev_buffer[i] || buffer.get(i) != prev_buffer.get(i)) ++errors;
+    }
+    if (buffer.back() != prev_buffer.back()) ++errors;
+    if (buffer.sum(start_index, buffer_size) != prev_buffer.sum(start_index, buffer_size)) ++errors;
+    if (!is_valid_window && !buffer.full()) return errors;
+
+    if (buffer.front() != prev_buffer.front() ||
+        buffer.middle() != prev_buffer.middle() ||
+        buffer.sum() != prev_buffer.sum() ||
+        buffer.mean() != prev_buffer.mean() ||
+        buffer.to_vector() != prev_buffer.to_vector()) ++errors;
+    for (size_t i = 0; i < buffer_size; ++i) {
+        if (buffer[i] != prev_buffer[i]) ++errors;
+    }
+    const size_t a = buffer_size / 3;
+    const size_t b = buffer_size - buffer_size / 4;
+    if (buffer.sum(a, b) != prev_buffer.sum(a, b)) ++errors;
+
+    /* окно без копирования совпадает с прежним порядком элементов */
+    const xtechnical::circular_buffer_view<double> view = buffer.view();
+    if (view.size() != buffer_size) ++errors;
+    for (size_t i = 0; i < view.size(); ++i) {
+        if (view[i] != prev_buffer[i]) ++errors;
+    }
+    if (std::abs(view.sum() - prev_buffer.sum()) > 1e-6) ++errors;
+    return errors;
+}
+
+/* случайная последовательность update, test и clear для буфера заданного размера */
+size_t compare_random(const size_t buffer_size, const uint32_t seed) {
+    xtechnical::circular_buffer<double> buffer(buffer_size);
+    previous::circular_buffer<double> prev_buffer(buffer_size);
+    std::mt19937 gen(seed);
+    size_t errors = 0;
+    bool is_valid_window = true;
+    for (size_t i = 0; i < 20000; ++i) {
+        const double value = (double)(gen() % 2001) - 1000.0;
+        const uint32_t r = gen() % 100;
+        if (r < 55) {
+            if (buffer.update(value) != prev_buffer.update(value)) ++errors;
+        } else
+        if (r < 98) {
+            /* подряд идущие test, затем update или clear */
+            if (buffer.test(value) != prev_buffer.test(value)) ++errors;
+        } else {
+            buffer.clear();
+            prev_buffer.clear();
+            is_valid_window = false;
+        }
+        errors += compare_state(buffer, prev_buffer, buffer_size, is_valid_window);
+        if (buffer.full()) is_valid_window = true;
+    }
+    return errors;
+}
+
+/* частично заполненный буфер: test, test, update и test, clear */
+size_t compare_sequences(const size_t buffer_size) {
+    size_t errors = 0;
+    xtechnical::circular_buffer<double> buffer(buffer_size);
+    previous::circular_buffer<double> prev_buffer(buffer_size);
+    for (size_t n = 0; n < 2 * buffer_size + 2; ++n) {
+        const double value = (double)n + 1.0;
+        if (buffer.test(value) != prev_buffer.test(value)) ++errors;
+        errors += compare_state(buffer, prev_buffer, buffer_size, true);
+        if (buffer.test(-value) != prev_buffer.test(-value)) ++errors;
+        errors += compare_state(buffer, prev_buffer, buffer_size, true);
+        if (buffer.update(value) != prev_buffer.update(value)) ++errors;
+        errors += compare_state(buffer, prev_buffer, buffer_size, true);
+    }
+
+    xtechnical::circular_buffer<double> cleared(buffer_size);
+    previous::circular_buffer<double> prev_cleared(buffer_size);
+    for (size_t n = 0; n < buffer_size; ++n) {
+        cleared.update(n);
+        prev_cleared.update(n);
+    }
+    cleared.test(-1);
+    prev_cleared.test(-1);
+    cleared.clear();
+    prev_cleared.clear();
+    errors += compare_state(cleared, prev_cleared, buffer_size, false);
+    for (size_t n = 0; n < buffer_size; ++n) {
+        if (cleared.update(100 + n) != prev_cleared.update(100 + n)) ++errors;
+        errors += compare_state(cleared, prev_cleared, buffer_size, false);
+    }
+    return errors;
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "Hello world!" << std::endl;
+
+    size_t errors = 0;
+    for (size_t buffer_size = 1; buffer_size < 70; ++buffer_size) {
+        const size_t e = compare_random(buffer_size, buffer_size) + compare_sequences(buffer_size);
+        if (e != 0) std::cout << "size " << buffer_size << " errors " << e << std::endl;
+        errors += e;
+    }
+    std::cout << "errors " << errors << std::endl;
+    return errors == 0 ? 0 : 1;
+}
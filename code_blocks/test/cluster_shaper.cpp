@@ -25,7 +25,7 @@ int main(int argc, char* argv[]) {
             std::cout << std::endl;
             std::copy(no_normalized_cluster.begin(), no_normalized_cluster.end(), std::ostream_iterator<double>(std::cout, " "));
             std::cout << std::endl;
-            print_map(cluster.distribution);
+            print_map(cluster.distribution.to_map());
         }
 
         std::cout << "o: " << cluster.open << " c: " << cluster.close << " m: " << cluster.get_center_mass() << std::endl;
@@ -0,0 +1,105 @@
+#include <iostream>
+#include "xtechnical_indicators.hpp"
+#include "indicators/xtechnical_awesome_oscillator.hpp"
+#include <random>
+#include <chrono>
+
+/* сравниваем индикаторы с периодом на этапе компиляции с обычными */
+
+static bool is_equal(const double a, const double b) {
+    return (std::isnan(a) && std::isnan(b)) || a == b;
+}
+
+template<size_t N>
+size_t check(const unsigned seed) {
+    std::mt19937 gen(seed);
+    xtechnical::SMA<double> sma(N);
+    xtechnical::FixedSMA<double, N> fixed_sma;
+    xtechnical::SUM<double> sum(N);
+    xtechnical::FixedSUM<double, N> fixed_sum;
+    xtechnical::EMA<double> ema(N);
+    xtechnical::FixedEMA<double, N> fixed_ema;
+    xtechnical::DelayLine<double> delay_line(N);
+    xtechnical::FixedDelayLine<double, N> fixed_delay_line;
+    xtechnical::circular_buffer<double> buffer(N);
+    xtechnical::fixed_circular_buffer<double, N> fixed_buffer;
+    size_t errors = 0;
+    for (size_t i = 0; i < 10000; ++i) {
+        const double value = (double)(gen() % 1000) / 7.0;
+        double a = 0, b = 0;
+        if ((gen() % 4) == 0) {
+            if (sma.test(value, a) != fixed_sma.test(value, b) || !is_equal(a, b)) ++errors;
+            if (sum.test(value, a) != fixed_sum.test(value, b) || !is_equal(a, b)) ++errors;
+            if (ema.test(value, a) != fixed_ema.test(value, b) || !is_equal(a, b)) ++errors;
+            if (delay_line.test(value, a) != fixed_delay_line.test(value, b) || !is_equal(a, b)) ++errors;
+            if (buffer.test(value) != fixed_buffer.test(value)) ++errors;
+        } else {
+            if (sma.update(value, a) != fixed_sma.update(value, b) || !is_equal(a, b)) ++errors;
+            if (sum.update(value, a) != fixed_sum.update(value, b) || !is_equal(a, b)) ++errors;
+            if (ema.update(value, a) != fixed_ema.update(value, b) || !is_equal(a, b)) ++errors;
+            if (delay_line.update(value, a) != fixed_delay_line.update(value, b) || !is_equal(a, b)) ++errors;
+            if (buffer.update(value) != fixed_buffer.update(value)) ++errors;
+        }
+        if (buffer.full() && (buffer.to_vector() != fixed_buffer.to_vector() || buffer.sum() != fixed_buffer.sum())) ++errors;
+    }
+    std::cout << "period " << N << " errors " << errors << std::endl;
+    return errors;
+}
+
+/* замер test + update, в контрольную сумму попадают только готовые значения */
+template<class INDICATOR>
+double measure(INDICATOR &indicator, double &sum) {
+    const size_t n = 10000000;
+    double out = 0;
+    auto t1 = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < n; ++i) {
+        if (indicator.test((double)(i & 1023), out) == xtechnical::common::OK) sum += out;
+        if (indicator.update((double)(i & 1023), out) == xtechnical::common::OK) sum += out;
+    }
+    auto t2 = std::chrono::high_resolution_clock::now();
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count() / (double)n;
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "Hello world!" << std::endl;
+
+    size_t errors = 0;
+    errors += check<1>(1);
+    errors += check<5>(2);
+    errors += check<8>(3);
+    errors += check<9>(4);
+    errors += check<34>(5);
+
+    xtechnical::AwesomeOscillator<double> ao(5, 34);
+    xtechnical::FixedAwesomeOscillator<double> fixed_ao;
+    std::mt19937 gen(6);
+    size_t ao_errors = 0;
+    for (size_t i = 0; i < 10000; ++i) {
+        const double high = 100 + gen() % 50;
+        const double low = high - gen() % 10;
+        double a = 0, b = 0;
+        if (ao.update(high, low, a) != fixed_ao.update(high, low, b) || !is_equal(a, b)) ++ao_errors;
+    }
+    std::cout << "AwesomeOscillator errors " << ao_errors << std::endl;
+    errors += ao_errors;
+
+    /* время test + update, лучшее из нескольких прогонов */
+    double s = 0, fixed_s = 0;
+    double best = std::numeric_limits<double>::max(), fixed_best = std::numeric_limits<double>::max();
+    for (size_t r = 0; r < 5; ++r) {
+        xtechnical::SMA<double> sma(10);
+        xtechnical::FixedSMA<double, 10> fixed_sma;
+        s = fixed_s = 0;
+        best = std::min(best, measure(sma, s));
+        fixed_best = std::min(fixed_best, measure(fixed_sma, fixed_s));
+    }
+    if (s != fixed_s) ++errors;
+    std::cout
+        << "SMA(10) test+update ns " << best
+        << " FixedSMA<10> test+update ns " << fixed_best
+        << " sum " << s << " " << fixed_s << std::endl;
+    std::cout << "errors " << errors << std::endl;
+
+    std::system("pause");
+    return 0;
+}
@@ -2,6 +2,7 @@
 #include "xtechnical_indicators.hpp"
 #include <random>
 #include <array>
+#include <chrono>
 
 int main(int argc, char* argv[]) {
     std::cout << "Hello world!" << std::endl;
@@ -49,6 +50,51 @@ int main(int argc, char* argv[]) {
             << std::endl;
     }
 
+    /* пакетный поиск фракталов должен совпадать с потоковым */
+    std::mt19937 gen(1);
+    const size_t bars = 1000003;
+    std::vector<double> high(bars), low(bars);
+    double price = 100;
+    for (size_t i = 0; i < bars; ++i) {
+        price += (double)((int)(gen() % 5) - 2);
+        high[i] = price + (double)(gen() % 3);
+        low[i] = price - (double)(gen() % 3);
+    }
+    std::vector<uint64_t> stream_up((bars + 63) / 64, 0), stream_dn((bars + 63) / 64, 0);
+    xtechnical::BasicFractals<double> basic_fractals;
+    class Sink {
+    public:
+        std::vector<uint64_t> &up, &dn;
+        size_t index = 0;
+        Sink(std::vector<uint64_t> &u, std::vector<uint64_t> &d) : up(u), dn(d) {};
+        void on_up(const double value) {up[index >> 6] |= (uint64_t)1 << (index & 63);}
+        void on_dn(const double value) {dn[index >> 6] |= (uint64_t)1 << (index & 63);}
+    } sink(stream_up, stream_dn);
+    const auto t1 = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < bars; ++i) {
+        sink.index = i;
+        basic_fractals.update(high[i], low[i], sink);
+    }
+    const auto t2 = std::chrono::high_resolution_clock::now();
+    std::cout << "stream us " << std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() << std::endl;
+
+    const std::vector<float> high_f(high.begin(), high.end()), low_f(low.begin(), low.end());
+    const char *names[] = {"scalar", "sse2", "avx2", "avx512"};
+    for (int s = 0; s <= 3; ++s) {
+        if (!xtechnical::simd::set_instruction_set((xtechnical::simd::InstructionSet)s)) continue;
+        std::vector<uint64_t> up, dn, up_f, dn_f;
+        const auto t3 = std::chrono::high_resolution_clock::now();
+        xtechnical::calculate_fractals(high, low, up, dn);
+        const auto t4 = std::chrono::high_resolution_clock::now();
+        xtechnical::calculate_fractals(high_f, low_f, up_f, dn_f);
+        std::cout
+            << names[s]
+            << " double " << (up == stream_up && dn == stream_dn ? "ok" : "error")
+            << " float " << (up_f == stream_up && dn_f == stream_dn ? "ok" : "error")
+            << " us " << std::chrono::duration_cast<std::chrono::microseconds>(t4 - t3).count()
+            << std::endl;
+    }
+
     std::system("pause");
     return 0;
 }
@@ -0,0 +1,99 @@
+#include <iostream>
+#include "xtechnical_indicators.hpp"
+#include "backtest/xtechnical_winrate_statistics.hpp"
+#include "backtest/xtechnical_history_file.hpp"
+#include <random>
+#include <chrono>
+
+int main(int argc, char* argv[]) {
+    std::cout << "Hello world!" << std::endl;
+
+    const std::string tick_path = "test_ticks.xth";
+    const std::string bar_path = "test_bars.xth";
+
+    /* пишем синтетические тики и минутные бары */
+    xtechnical::TickFileWriter tick_writer;
+    xtechnical::BarFileWriter bar_writer;
+    xtechnical::BarShaperV1<double> writer_shaper(60);
+    writer_shaper.on_close_bar = [&](const xtechnical::BarShaperV1<double>::Bar &bar) {
+        bar_writer.add(bar.timestamp, bar.open, bar.high, bar.low, bar.close);
+    };
+
+    std::mt19937 gen(1);
+    std::uniform_int_distribution<int> step(-1, 1);
+    const size_t ticks = 10000000;
+    tick_writer.reserve(ticks);
+    double price = 1.1;
+    uint64_t timestamp = 1600000000000ULL;
+    for(size_t i = 0; i < ticks; ++i) {
+        timestamp += 1 + gen() % 500;
+        price += step(gen) * 0.00001;
+        tick_writer.add(timestamp, price, price + 0.00002, 1);
+        writer_shaper.update(price + 0.00001, timestamp / 1000);
+    }
+    std::cout << "save ticks " << tick_writer.save(tick_path) << std::endl;
+    std::cout << "save bars " << bar_writer.save(bar_path) << std::endl;
+
+    xtechnical::TickFile tick_file;
+    xtechnical::BarFile bar_file;
+    std::cout << "open ticks " << tick_file.open(tick_path) << " size " << tick_file.size() << std::endl;
+    std::cout << "open bars " << bar_file.open(bar_path) << " size " << bar_file.size() << std::endl;
+
+    /* поиск по времени */
+    const uint64_t t_begin = tick_file.timestamps()[ticks / 2] - 100;
+    const size_t index = tick_file.find(t_begin);
+    std::cout << "find " << index << " timestamp " << tick_file.timestamps()[index]
+        << " prev " << tick_file.timestamps()[index - 1] << " target " << t_begin << std::endl;
+
+    /* простое чтение столбцов */
+    auto begin = std::chrono::steady_clock::now();
+    double sum = 0;
+    xtechnical::replay_ticks(tick_file, [&](const uint64_t t, const double bid, const double ask, const double volume) {
+        sum += bid + ask + volume;
+    });
+    auto end = std::chrono::steady_clock::now();
+    const double seconds = std::chrono::duration<double>(end - begin).count();
+    std::cout << "replay sum " << sum << " speed (GB/s) "
+        << (double)(tick_file.size() * 32) / seconds / 1.0e9 << std::endl;
+
+    /* тики в формирователи баров и статистику винрейта */
+    xtechnical::BarShaperV1<double> bar_shaper(60);
+    size_t bars = 0;
+    bar_shaper.on_close_bar = [&](const xtechnical::BarShaperV1<double>::Bar &bar) {
+        ++bars;
+    };
+    xtechnical::ClusterShaper cluster_shaper(60, 0.00001);
+    size_t clusters = 0;
+    cluster_shaper.on_close_bar = [&](const xtechnical::ClusterShaper::Cluster &cluster) {
+        ++clusters;
+    };
+    xtechnical::WinrateStats<int> stats;
+    const size_t handle = stats.get_handle("broker", "EURUSD");
+    auto bar_sink = xtechnical::make_mid_price_sink(bar_shaper, 1000);
+    auto cluster_sink = xtechnical::make_mid_price_sink(cluster_shaper, 1000);
+    auto stats_sink = xtechnical::make_winrate_sink(stats, handle);
+
+    begin = std::chrono::steady_clock::now();
+    size_t n = 0;
+    xtechnical::replay_ticks(tick_file, [&](const uint64_t t, const double bid, const double ask, const double volume) {
+        bar_sink(t, bid, ask, volume);
+        cluster_sink(t, bid, ask, volume);
+        stats_sink(t, bid, ask, volume);
+        if((++n % 1000) == 0) stats.place_bet(handle, t, (n % 2000) == 0 ? 1 : -1);
+    });
+    end = std::chrono::steady_clock::now();
+    std::cout << "bars " << bars << " (file " << bar_file.size() << ") clusters " << clusters
+        << " winrate " << stats.get_winrate() << " deals " << stats.get_deals()
+        << " time (ms) " << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << std::endl;
+
+    /* бары в индикатор */
+    xtechnical::SMA<double> sma(20);
+    xtechnical::replay_bars(bar_file, xtechnical::make_close_price_sink(sma));
+    std::cout << "sma " << sma.get() << std::endl;
+
+    tick_file.close();
+    bar_file.close();
+    std::remove(tick_path.c_str());
+    std::remove(bar_path.c_str());
+    return 0;
+}
@@ -0,0 +1,156 @@
+#include <iostream>
+#include "xtechnical_indicators.hpp"
+#include <random>
+#include <vector>
+#include <chrono>
+
+template<class T>
+static bool is_same_value(const T a, const T b) {
+    if (std::isnan(a) && std::isnan(b)) return true;
+    return a == b;
+}
+
+template<class INDICATOR>
+struct Factory {
+    static INDICATOR make(const size_t period) {return INDICATOR(period);}
+};
+
+/* у TrueRange нет периода */
+template<class T>
+struct Factory<xtechnical::TrueRange<T>> {
+    static xtechnical::TrueRange<T> make(const size_t) {return xtechnical::TrueRange<T>();}
+};
+
+/* банк и отдельные экземпляры получают одинаковые цены,
+ * выход каждого символа должен совпадать побитно
+ */
+template<class INDICATOR, class T>
+static size_t check(const size_t symbols, const size_t period) {
+    std::mt19937 gen(period);
+    std::uniform_real_distribution<> price(90.0, 110.0);
+    std::vector<INDICATOR> single(symbols, Factory<INDICATOR>::make(period));
+    xtechnical::IndicatorBank<INDICATOR> bank(symbols, period);
+    std::vector<T> in(symbols);
+    size_t errors = 0;
+    for (size_t k = 0; k < 3 * period + 20; ++k) {
+        for (auto &item : in) item = (T)price(gen);
+        // каждое третье значение тестовое
+        const bool is_test = (k % 3) == 2;
+        const int err = is_test ? bank.test_all(in.data()) : bank.update_all(in.data());
+        for (size_t i = 0; i < symbols; ++i) {
+            const int e = is_test ? single[i].test(in[i]) : single[i].update(in[i]);
+            if (e != err || !is_same_value(single[i].get(), bank.get(i))) ++errors;
+        }
+    }
+    return errors;
+}
+
+template<class INDICATOR, class T>
+static size_t check_bars(const size_t symbols, const size_t period) {
+    std::mt19937 gen(period);
+    std::uniform_real_distribution<> price(90.0, 110.0);
+    std::vector<INDICATOR> single(symbols, Factory<INDICATOR>::make(period));
+    xtechnical::IndicatorBank<INDICATOR> bank(symbols, period);
+    std::vector<T> high(symbols), low(symbols), close(symbols);
+    size_t errors = 0;
+    for (size_t k = 0; k < 3 * period + 20; ++k) {
+        for (size_t i = 0; i < symbols; ++i) {
+            const T a = (T)price(gen), b = (T)price(gen);
+            high[i] = std::max(a, b);
+            low[i] = std::min(a, b);
+            close[i] = (k % 5) == 0 ? high[i] : (T)price(gen);
+        }
+        const bool is_test = (k % 3) == 2;
+        const int err = is_test ?
+            bank.test_all(high.data(), low.data(), close.data()) :
+            bank.update_all(high.data(), low.data(), close.data());
+        for (size_t i = 0; i < symbols; ++i) {
+            const int e = is_test ?
+                single[i].test(high[i], low[i], close[i]) :
+                single[i].update(high[i], low[i], close[i]);
+            if (e != err || !is_same_value(single[i].get(), bank.get(i))) ++errors;
+        }
+    }
+    return errors;
+}
+
+template<class T>
+static size_t check_all(const size_t symbols, const size_t period) {
+    using namespace xtechnical;
+    size_t errors = 0;
+    errors += check<SMA<T>, T>(symbols, period);
+    errors += check<EMA<T>, T>(symbols, period);
+    errors += check<MMA<T>, T>(symbols, period);
+    errors += check<StdDev<T>, T>(symbols, period);
+    errors += check<RSI<T, SMA<T>>, T>(symbols, period);
+    errors += check<RSI<T, MMA<T>>, T>(symbols, period);
+    errors += check<TrueRange<T>, T>(symbols, period);
+    errors += check<ATR<T, SMA<T>>, T>(symbols, period);
+    errors += check<ATR<T, EMA<T>>, T>(symbols, period);
+    errors += check_bars<TrueRange<T>, T>(symbols, period);
+    errors += check_bars<ATR<T, SMA<T>>, T>(symbols, period);
+    errors += check_bars<ATR<T, MMA<T>>, T>(symbols, period);
+    return errors;
+}
+
+/* время пересчета всех символов после закрытия бара */
+template<class INDICATOR>
+static void measure(const char *name, const size_t symbols, const size_t period) {
+    std::mt19937 gen(1);
+    std::uniform_real_distribution<> price(90.0, 110.0);
+    const size_t bars = 2000;
+    std::vector<double> prices(symbols * bars);
+    for (auto &item : prices) item = price(gen);
+
+    std::vector<INDICATOR> single(symbols, Factory<INDICATOR>::make(period));
+    xtechnical::IndicatorBank<INDICATOR> bank(symbols, period);
+
+    double sum_single = 0, sum_bank = 0;
+    auto t1 = std::chrono::high_resolution_clock::now();
+    for (size_t k = 0; k < bars; ++k) {
+        const double *in = prices.data() + k * symbols;
+        for (size_t i = 0; i < symbols; ++i) single[i].update(in[i]);
+        sum_single += single[symbols / 2].get();
+    }
+    auto t2 = std::chrono::high_resolution_clock::now();
+    for (size_t k = 0; k < bars; ++k) {
+        bank.update_all(prices.data() + k * symbols);
+        sum_bank += bank.get(symbols / 2);
+    }
+    auto t3 = std::chrono::high_resolution_clock::now();
+    const double single_ns = std::chrono::duration<double, std::nano>(t2 - t1).count() / (double)bars;
+    const double bank_ns = std::chrono::duration<double, std::nano>(t3 - t2).count() / (double)bars;
+    std::cout << name << " p=" << period << " single ns/bar " << single_ns
+        << " bank ns/bar " << bank_ns
+        << (is_same_value(sum_single, sum_bank) ? "" : " MISMATCH") << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "Hello world!" << std::endl;
+
+    const char *names[] = {"scalar", "sse2", "avx2", "avx512"};
+    for (int s = 0; s <= 3; ++s) {
+        if (!xtechnical::simd::set_instruction_set((xtechnical::simd::InstructionSet)s)) {
+            std::cout << names[s] << ": not supported" << std::endl;
+            continue;
+        }
+        size_t errors = 0;
+        const size_t periods[] = {1, 2, 5, 14, 50};
+        for (const size_t period : periods) {
+            errors += check_all<double>(37, period);
+            errors += check_all<float>(37, period);
+        }
+        std::cout << names[s] << " errors " << errors << std::endl;
+    }
+
+    using namespace xtechnical;
+    const size_t symbols = 2000;
+    measure<SMA<double>>("SMA", symbols, 14);
+    measure<EMA<double>>("EMA", symbols, 14);
+    measure<StdDev<double>>("StdDev", symbols, 14);
+    measure<StdDev<double>>("StdDev", symbols, 100);
+    measure<RSI<double, MMA<double>>>("RSI", symbols, 14);
+    measure<ATR<double, SMA<double>>>("ATR", symbols, 14);
+    std::system("pause");
+    return 0;
+}
@@ -0,0 +1,73 @@
+#include <iostream>
+#include "xtechnical_indicators.hpp"
+#include <random>
+#include <chrono>
+
+int main(int argc, char* argv[]) {
+    std::cout << "Hello world!" << std::endl;
+
+    /* спокойные и активные участки рынка */
+    std::mt19937 gen(1);
+    std::normal_distribution<double> quiet(0, 0.00001);
+    std::normal_distribution<double> active(0, 0.0001);
+    std::vector<double> prices;
+    std::vector<uint64_t> timestamps;
+    double price = 1.1;
+    uint64_t timestamp = 1600000000;
+    for(size_t i = 0; i < 10000000; ++i) {
+        const bool is_active = ((i / 100000) % 10) == 0;
+        timestamp += is_active ? (gen() % 2) : (1 + gen() % 3);
+        price += is_active ? active(gen) : quiet(gen);
+        prices.push_back(price);
+        timestamps.push_back(timestamp);
+    }
+
+    const double pips_size = 0.00001;
+    xtechnical::InfoBarRing tick_ring(1024), volume_ring(1024), range_ring(1024), renko_ring(1024), imbalance_ring(1024);
+    xtechnical::TickBarShaper<double> tick_shaper(100, pips_size, tick_ring);
+    xtechnical::VolumeBarShaper<double> volume_shaper(500, pips_size, volume_ring);
+    xtechnical::RangeBarShaper<double> range_shaper(50, pips_size, range_ring);
+    xtechnical::RenkoBarShaper<double> renko_shaper(20, pips_size, renko_ring);
+    xtechnical::TickImbalanceBarShaper<double> imbalance_shaper(100, pips_size, imbalance_ring);
+
+    size_t errors = 0;
+    auto begin = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < prices.size(); ++i) {
+        const uint64_t volume = 1 + (i % 7);
+        if (tick_shaper.update(prices[i], timestamps[i]) && tick_ring.back().ticks != 100) ++errors;
+        if (volume_shaper.update(prices[i], timestamps[i], volume) && volume_ring.back().volume < 500) ++errors;
+        if (range_shaper.update(prices[i], timestamps[i]) && (range_ring.back().high - range_ring.back().low) < 50) ++errors;
+        const size_t bricks = renko_shaper.update(prices[i], timestamps[i]);
+        for (size_t b = 0; b < bricks; ++b) {
+            const xtechnical::InfoBar &brick = renko_ring.back(b);
+            if (std::abs(brick.close - brick.open) != 20 || (brick.close % 20) != 0) ++errors;
+        }
+        imbalance_shaper.update(prices[i], timestamps[i]);
+    }
+    auto end = std::chrono::steady_clock::now();
+    const double ns = std::chrono::duration<double, std::nano>(end - begin).count() / (double)prices.size();
+
+    /* для сравнения количество минутных баров */
+    xtechnical::BasicBarShaper<double, xtechnical::BarShaperSink<double>> time_shaper(60);
+    class Counter : public xtechnical::BarShaperSink<double> {
+    public:
+        size_t bars = 0;
+        inline void on_close_bar(const xtechnical::BarShaperV1<double>::Bar &bar) {
+            ++bars;
+        }
+    } counter;
+    for(size_t i = 0; i < prices.size(); ++i) {
+        time_shaper.update(prices[i], timestamps[i], counter);
+    }
+
+    std::cout << "time bars " << counter.bars << std::endl;
+    std::cout << "tick bars " << tick_ring.get_total() << std::endl;
+    std::cout << "volume bars " << volume_ring.get_total() << std::endl;
+    std::cout << "range bars " << range_ring.get_total() << std::endl;
+    std::cout << "renko bricks " << renko_ring.get_total() << std::endl;
+    std::cout << "tick imbalance bars " << imbalance_ring.get_total() << " threshold " << imbalance_shaper.get_threshold() << std::endl;
+    std::cout << "last renko close " << renko_ring.back().get_close_price() << std::endl;
+    std::cout << "errors " << errors << std::endl;
+    std::cout << "ns per tick (5 shapers) " << ns << std::endl;
+    return 0;
+}
@@ -0,0 +1,163 @@
+#include <iostream>
+#include "xtechnical_indicators.hpp"
+#include <random>
+#include <chrono>
+
+/* бар и признак несформированного бара в порядке вызовов */
+class BarEvent {
+public:
+    double open = 0, high = 0, low = 0, close = 0;
+    uint64_t timestamp = 0;
+    bool is_unformed = false;
+
+    BarEvent() {};
+
+    template<class BAR>
+    BarEvent(const BAR &bar, const bool u) :
+        open(bar.open), high(bar.high), low(bar.low), close(bar.close),
+        timestamp(bar.timestamp), is_unformed(u) {
+    }
+
+    bool operator!=(const BarEvent &other) const {
+        return open != other.open || high != other.high || low != other.low ||
+            close != other.close || timestamp != other.timestamp || is_unformed != other.is_unformed;
+    }
+};
+
+/* сравнение всех баров, в том числе несформированных, с отдельными BarShaperV1
+ * для одной комбинации флагов
+ */
+size_t compare_flags(
+        const std::vector<uint64_t> &periods,
+        const std::vector<double> &prices,
+        const std::vector<uint64_t> &timestamps,
+        const bool oepc,
+        const bool ubst,
+        const bool uf) {
+    xtechnical::MultiBarShaper<double> multi_shaper(periods, oepc, ubst, uf);
+    std::vector<std::vector<BarEvent>> multi_events(periods.size());
+    multi_shaper.on_close_bar = [&](const size_t index, const xtechnical::MultiBarShaper<double>::Bar &bar) {
+        multi_events[index].push_back(BarEvent(bar, false));
+    };
+    multi_shaper.on_unformed_bar = [&](const size_t index, const xtechnical::MultiBarShaper<double>::Bar &bar) {
+        multi_events[index].push_back(BarEvent(bar, true));
+    };
+
+    std::vector<xtechnical::BarShaperV1<double>> shapers;
+    std::vector<std::vector<BarEvent>> events(periods.size());
+    for(size_t i = 0; i < periods.size(); ++i) {
+        shapers.push_back(xtechnical::BarShaperV1<double>(periods[i], oepc, ubst, uf));
+    }
+    for(size_t i = 0; i < periods.size(); ++i) {
+        shapers[i].on_close_bar = [&, i](const xtechnical::BarShaperV1<double>::Bar &bar) {
+            events[i].push_back(BarEvent(bar, false));
+        };
+        shapers[i].on_unformed_bar = [&, i](const xtechnical::BarShaperV1<double>::Bar &bar) {
+            events[i].push_back(BarEvent(bar, true));
+        };
+    }
+
+    for(size_t i = 0; i < prices.size(); ++i) {
+        multi_shaper.update(prices[i], timestamps[i]);
+        for(auto &shaper : shapers) shaper.update(prices[i], timestamps[i]);
+    }
+
+    size_t errors = 0;
+    size_t closed = 0;
+    for(size_t i = 0; i < periods.size(); ++i) {
+        if(multi_events[i].size() != events[i].size()) {
+            ++errors;
+            continue;
+        }
+        for(size_t j = 0; j < events[i].size(); ++j) {
+            if(multi_events[i][j] != events[i][j]) ++errors;
+            if(!events[i][j].is_unformed) ++closed;
+        }
+    }
+    std::cout << "oepc " << oepc << " ubst " << ubst << " uf " << uf
+        << " closed bars " << closed << " errors " << errors << std::endl;
+    return errors;
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "Hello world!" << std::endl;
+
+    /* M1, M5, M15, H1, D1 */
+    const std::vector<uint64_t> periods = {60, 300, 900, 3600, 86400};
+
+    /* данные с разрывами, чтобы проверить заполнение пропущенных баров */
+    std::vector<double> gap_prices;
+    std::vector<uint64_t> gap_timestamps;
+    {
+        std::mt19937 gen(2);
+        std::uniform_int_distribution<int> step(-1, 1);
+        double price = 1.1;
+        uint64_t timestamp = 1600000000;
+        for(size_t i = 0; i < 1000000; ++i) {
+            const uint32_t r = gen() % 1000;
+            if(r < 5) timestamp += 60 + gen() % 20000;
+            else if(r < 250) ++timestamp;
+            price += step(gen) * 0.00001;
+            gap_prices.push_back(price);
+            gap_timestamps.push_back(timestamp);
+        }
+    }
+    size_t errors = 0;
+    for(int flags = 0; flags < 8; ++flags) {
+        errors += compare_flags(periods, gap_prices, gap_timestamps,
+            (flags & 1) != 0, (flags & 2) != 0, (flags & 4) != 0);
+    }
+
+    /* скорость на непрерывных данных */
+    xtechnical::MultiBarShaper<double> multi_shaper(periods, true, false, true);
+    std::vector<size_t> multi_bars(periods.size(), 0);
+    multi_shaper.on_close_bar = [&](const size_t index, const xtechnical::MultiBarShaper<double>::Bar &) {
+        ++multi_bars[index];
+    };
+
+    std::vector<xtechnical::BarShaperV1<double>> shapers;
+    std::vector<size_t> bars(periods.size(), 0);
+    for(size_t i = 0; i < periods.size(); ++i) {
+        shapers.push_back(xtechnical::BarShaperV1<double>(periods[i], true, false, true));
+    }
+    for(size_t i = 0; i < periods.size(); ++i) {
+        shapers[i].on_close_bar = [&, i](const xtechnical::BarShaperV1<double>::Bar &) {
+            ++bars[i];
+        };
+    }
+
+    std::mt19937 gen(1);
+    std::uniform_int_distribution<int> step(-1, 1);
+    std::vector<double> prices;
+    std::vector<uint64_t> timestamps;
+    double price = 1.1;
+    uint64_t timestamp = 1600000000;
+    for(size_t i = 0; i < 10000000; ++i) {
+        if(gen() % 4 == 0) ++timestamp;
+        price += step(gen) * 0.00001;
+        prices.push_back(price);
+        timestamps.push_back(timestamp);
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < prices.size(); ++i) {
+        multi_shaper.update(prices[i], timestamps[i]);
+    }
+    auto end = std::chrono::steady_clock::now();
+    std::cout << "multi bar shaper time (ms) " << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << std::endl;
+
+    begin = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < prices.size(); ++i) {
+        for(auto &shaper : shapers) shaper.update(prices[i], timestamps[i]);
+    }
+    end = std::chrono::steady_clock::now();
+    std::cout << "bar shapers time (ms) " << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << std::endl;
+
+    for(size_t i = 0; i < periods.size(); ++i) {
+        if(multi_bars[i] != bars[i]) ++errors;
+        std::cout << "period " << periods[i]
+            << " bars " << multi_bars[i] << " (" << bars[i] << ")" << std::endl;
+    }
+    std::cout << "errors " << errors << std::endl;
+    return errors == 0 ? 0 : 1;
+}
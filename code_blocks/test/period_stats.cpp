@@ -2,10 +2,378 @@
 #include "xtechnical_indicators.hpp"
 #include <random>
 #include <array>
+#include <cmath>
+
+namespace previous {
+
+    /* прежняя реализация PeriodStatsV1 на std::map, используется для сравнения результатов */
+    template<class T>
+    class PeriodStatsV1 {
+    private:
+        std::map<uint64_t, T> data;
+        uint64_t start_time = 0;
+        uint64_t last_time = 0;
+        uint64_t life_time = 0;
+
+        inline void remove(const uint64_t time, const uint64_t lifetime) noexcept {
+            const uint64_t end_life_time = time - lifetime;
+            auto it = data.upper_bound(end_life_time);
+            if (it != data.end()) data.erase(data.begin(), it);
+        }
+
+    public:
+
+        PeriodStatsV1(const uint64_t user_life_time) :
+            life_time(user_life_time) {
+        }
+
+        inline void add(const int value, const uint64_t time) noexcept {
+            data[time] = value;
+            remove(time, life_time);
+            last_time = time;
+            if (start_time == 0) start_time = time;
+        }
+
+        inline bool empty() noexcept {
+            return data.empty();
+        }
+
+        inline T get_max_value() noexcept {
+            T max_values = std::numeric_limits<T>::lowest();
+            for (auto &item : data) {
+                max_values = std::max(max_values, item.second);
+            }
+            return max_values;
+        }
+
+        inline T get_min_value() noexcept {
+            T min_value = std::numeric_limits<T>::max();
+            for (auto &item : data) {
+                min_value = std::min(min_value, item.second);
+            }
+            return min_value;
+        }
+
+        inline T get_max_weight() noexcept {
+            std::multiset<T> counter;
+            int max_counter = 0;
+            T value = 0;
+            for (auto &item : data) {
+                counter.insert(item.second);
+                const int c = counter.count(item.second);
+                if (c >= max_counter) {
+                    max_counter = c;
+                    value = item.second;
+                }
+            }
+            return value;
+        }
+
+        inline T get_center_mass() noexcept {
+            T sum = 0;
+            for (auto &item : data) {
+                sum += item.second;
+            }
+            return sum / data.size();
+        }
+
+        inline bool init() noexcept {
+            const uint64_t diff = (last_time - start_time);
+            return (diff >= life_time);
+        }
+
+        inline void clear() noexcept {
+            data.clear();
+            start_time = 0;
+        }
+    };
+
+    /* прежняя реализация PeriodStatsV2 на std::map, используется для сравнения результатов */
+    class PeriodStatsV2 {
+    private:
+        // значение / время / win / loss
+        std::map<int, std::map<uint64_t, std::pair<int, int>>> data;
+        uint64_t life_time = 0;
+
+        inline void remove(const uint64_t time, const uint64_t lifetime) noexcept {
+            const uint64_t end_life_time = time - lifetime;
+            for (auto &item : data) {
+                auto it = item.second.upper_bound(end_life_time);
+                if (it != item.second.end()) item.second.erase(item.second.begin(), it);
+            }
+            auto it = data.begin();
+            while(it != data.end()) {
+                if (it->second.empty()) it = data.erase(it);
+                else it++;
+            }
+        }
+
+    public:
+
+        typedef xtechnical::PeriodStatsV2::Stats Stats;
+
+        PeriodStatsV2(const uint64_t user_life_time) :
+            life_time(user_life_time) {
+        }
+
+        inline void add(const int value, const uint64_t time, const int result) noexcept {
+            auto it = data.find(value);
+            if (it == data.end()) {
+                if (result > 0) data[value][time] = std::pair<int, int>(result, 0);
+                else if (result < 0) data[value][time] = std::pair<int, int>(0, -result);
+            } else {
+                auto it2 = it->second.find(time);
+                if (it2 == it->second.end()) {
+                    if (result > 0) data[value][time] = std::pair<int, int>(result, 0);
+                    else if (result < 0) data[value][time] = std::pair<int, int>(0, -result);
+                } else {
+                    if (result > 0) it2->second.first += result;
+                    else if (result < 0) it2->second.second += -result;
+                }
+            }
+            remove(time, life_time);
+        }
+
+        inline bool empty() noexcept {
+            return !data.empty();
+        }
+
+        inline int get_max_value() noexcept {
+            int max_values = std::numeric_limits<int>::min();
+            for (auto &item : data) {
+                max_values = std::max(max_values, item.first);
+            }
+            return max_values;
+        }
+
+        inline Stats calc() noexcept {
+            Stats stats;
+            for (auto &item : data) {
+                stats.values.push_back(item.first);
+                uint32_t wins = 0;
+                uint32_t losses = 0;
+                for (auto &item2 : item.second) {
+                    wins += item2.second.first;
+                    losses += item2.second.second;
+                }
+                stats.wins.push_back(wins);
+                stats.losses.push_back(losses);
+                const uint32_t d = wins + losses;
+                stats.deals.push_back(d);
+                const double w = d == 0 ? 0 : (double)wins / (double)d;
+                stats.winrates.push_back(w);
+                stats.total_wins += wins;
+                stats.total_losses += losses;
+            }
+            stats.total_deals = stats.total_wins + stats.total_losses;
+            stats.total_winrate = stats.total_deals == 0 ? 0 : (double)stats.total_wins / (double)stats.total_deals;
+            return stats;
+        };
+
+        inline Stats calc_norm(const uint32_t threshold_deals) noexcept {
+            Stats stats;
+            int start_value = 0;
+            uint32_t wins = 0;
+            uint32_t losses = 0;
+            bool is_init_element = false;
+            for (auto &item : data) {
+                if (!is_init_element) {
+                    is_init_element = true;
+                    start_value = item.first;
+                }
+                for (auto &item2 : item.second) {
+                    wins += item2.second.first;
+                    losses += item2.second.second;
+                    stats.total_wins += item2.second.first;
+                    stats.total_losses += item2.second.second;
+                }
+                const uint32_t d = wins + losses;
+                if (d >= threshold_deals) {
+                    const double w = d == 0 ? 0 : (double)wins / (double)d;
+                    stats.values.push_back(start_value);
+                    stats.wins.push_back(wins);
+                    stats.losses.push_back(losses);
+                    stats.deals.push_back(d);
+                    stats.winrates.push_back(w);
+                    is_init_element = false;
+                    wins = 0;
+                    losses = 0;
+                }
+            }
+            if (is_init_element) {
+                const uint32_t d = wins + losses;
+                const double w = d == 0 ? 0 : (double)wins / (double)d;
+                stats.values.push_back(start_value);
+                stats.wins.push_back(wins);
+                stats.losses.push_back(losses);
+                stats.deals.push_back(d);
+                stats.winrates.push_back(w);
+            }
+            stats.total_deals = stats.total_wins + stats.total_losses;
+            stats.total_winrate = stats.total_deals == 0 ? 0 : (double)stats.total_wins / (double)stats.total_deals;
+            return stats;
+        };
+
+        inline Stats calc_norm_up(const uint32_t threshold_deals) noexcept {
+            Stats stats;
+            uint32_t wins = 0;
+            uint32_t losses = 0;
+            bool is_init_element = false;
+            for (auto &item : data) {
+                if (!is_init_element) {
+                    is_init_element = true;
+                    stats.values.push_back(item.first);
+                    stats.wins.push_back(0);
+                    stats.losses.push_back(0);
+                    stats.deals.push_back(0);
+                    stats.winrates.push_back(0);
+                }
+                for (auto &item2 : item.second) {
+                    wins += item2.second.first;
+                    losses += item2.second.second;
+                    stats.total_wins += item2.second.first;
+                    stats.total_losses += item2.second.second;
+                    for (size_t i = 0; i < stats.values.size(); ++i) {
+                        stats.wins[i] += item2.second.first;
+                        stats.losses[i] += item2.second.second;
+                    }
+                }
+                const uint32_t d = wins + losses;
+                if (d >= threshold_deals) {
+                    wins = 0;
+                    losses = 0;
+                    is_init_element = false;
+                }
+            }
+            for (size_t i = 0; i < stats.values.size(); ++i) {
+                stats.deals[i] = stats.wins[i] + stats.losses[i];
+                stats.winrates[i] = stats.deals[i] == 0 ? 0 : (double)stats.wins[i] / (double)stats.deals[i];
+            }
+            stats.total_deals = stats.total_wins + stats.total_losses;
+            stats.total_winrate = stats.total_deals == 0 ? 0 : (double)stats.total_wins / (double)stats.total_deals;
+            return stats;
+        };
+    };
+};
+
+/* сравнение статистики PeriodStatsV2 */
+bool is_equal(
+        const xtechnical::PeriodStatsV2::Stats &a,
+        const xtechnical::PeriodStatsV2::Stats &b) {
+    return a.values == b.values && a.wins == b.wins && a.losses == b.losses &&
+        a.deals == b.deals && a.winrates == b.winrates &&
+        a.total_deals == b.total_deals && a.total_wins == b.total_wins &&
+        a.total_losses == b.total_losses && a.total_winrate == b.total_winrate;
+}
+
+/* сравнение PeriodStatsV2 с прежней реализацией на случайных данных
+ * с повторяющимися и идущими не по порядку метками времени
+ */
+size_t compare_v2(const uint64_t life_time, const uint32_t seed) {
+    xtechnical::PeriodStatsV2 stats(life_time);
+    previous::PeriodStatsV2 prev_stats(life_time);
+    xtechnical::PeriodStatsV2::Stats temp;
+    std::mt19937 gen(seed);
+    const std::array<uint32_t, 4> thresholds = {0, 1, 4, 10};
+    size_t errors = 0;
+    /* начинаем с малых меток времени, чтобы проверить time < life_time */
+    uint64_t time = 1;
+    for (size_t i = 0; i < 50000; ++i) {
+        const uint32_t r = gen() % 100;
+        uint64_t t = time;
+        if (r < 20) {
+            // повтор метки времени
+        } else
+        if (r < 30) {
+            // метка времени в прошлом
+            const uint64_t back = gen() % (life_time + 10);
+            t = time > back ? time - back : 1;
+        } else {
+            time += 1 + gen() % 5;
+            t = time;
+        }
+        const int value = gen() % 15 - 7;
+        const int result = (int)(gen() % 5) - 2;
+        stats.add(value, t, result);
+        prev_stats.add(value, t, result);
+
+        if (stats.empty() != prev_stats.empty() ||
+            stats.get_max_value() != prev_stats.get_max_value()) {
+            ++errors;
+            continue;
+        }
+        if (!is_equal(stats.calc(), prev_stats.calc())) ++errors;
+        for (size_t j = 0; j < thresholds.size(); ++j) {
+            stats.calc_norm(thresholds[j], temp);
+            if (!is_equal(temp, prev_stats.calc_norm(thresholds[j]))) ++errors;
+            stats.calc_norm_up(thresholds[j], temp);
+            if (!is_equal(temp, prev_stats.calc_norm_up(thresholds[j]))) ++errors;
+        }
+    }
+    std::cout << "v2 life time " << life_time << " errors " << errors << std::endl;
+    return errors;
+}
+
+/* сравнение PeriodStatsV1 с прежней реализацией на случайных данных
+ * с повторяющимися и идущими не по порядку метками времени
+ */
+size_t compare_v1(const uint64_t life_time, const uint32_t seed) {
+    xtechnical::PeriodStatsV1<double> stats(life_time);
+    previous::PeriodStatsV1<double> prev_stats(life_time);
+    std::mt19937 gen(seed);
+    size_t errors = 0;
+    /* начинаем с малых меток времени, чтобы проверить time < life_time */
+    uint64_t time = 1;
+    for (size_t i = 0; i < 200000; ++i) {
+        const uint32_t r = gen() % 100;
+        uint64_t t = time;
+        if (r < 20) {
+            // повтор метки времени
+        } else
+        if (r < 30) {
+            // метка времени в прошлом
+            const uint64_t back = gen() % (life_time + 10);
+            t = time > back ? time - back : 1;
+        } else
+        if (r < 31) {
+            stats.clear();
+            prev_stats.clear();
+            continue;
+        } else {
+            time += 1 + gen() % 5;
+            t = time;
+        }
+        const int value = gen() % 7;
+        stats.add(value, t);
+        prev_stats.add(value, t);
+
+        if (stats.empty() != prev_stats.empty() ||
+            stats.init() != prev_stats.init() ||
+            stats.get_max_value() != prev_stats.get_max_value() ||
+            stats.get_min_value() != prev_stats.get_min_value() ||
+            stats.get_max_weight() != prev_stats.get_max_weight()) {
+            ++errors;
+            continue;
+        }
+        if (prev_stats.empty()) continue;
+        const double center_mass = stats.get_center_mass();
+        const double prev_center_mass = prev_stats.get_center_mass();
+        if (std::abs(center_mass - prev_center_mass) > 1e-9) ++errors;
+    }
+    std::cout << "v1 life time " << life_time << " errors " << errors << std::endl;
+    return errors;
+}
 
 int main(int argc, char* argv[]) {
     std::cout << "Hello world!" << std::endl;
 
+    size_t errors = 0;
+    const std::array<uint64_t, 4> life_times = {0, 1, 5, 60};
+    for (size_t i = 0; i < life_times.size(); ++i) {
+        errors += compare_v1(life_times[i], i + 1);
+        errors += compare_v2(life_times[i], i + 1);
+    }
+
     xtechnical::PeriodStatsV1<double> period_stats(60);
 
     period_stats.add(10, 10000);
@@ -38,6 +406,17 @@ int main(int argc, char* argv[]) {
     std::cout <<  "e " << period_stats.empty() << " mv " << period_stats.get_max_value() << std::endl;
     std::cout <<  "w " << period_stats.get_max_weight() << " c " << period_stats.get_center_mass() << std::endl;
 
-    std::system("pause");
-    return 0;
+    xtechnical::PeriodStatsV2 period_stats_v2(60);
+    xtechnical::PeriodStatsV2::Stats stats;
+    for (uint64_t t = 10000; t < 10200; t += 5) {
+        period_stats_v2.add((t / 5) % 7, t, (t % 3) == 0 ? -1 : 1);
+        period_stats_v2.calc_norm(4, stats);
+    }
+    for (size_t i = 0; i < stats.values.size(); ++i) {
+        std::cout << "v " << stats.values[i] << " d " << stats.deals[i] << " wr " << stats.winrates[i] << std::endl;
+    }
+    std::cout << "total wr " << stats.total_winrate << std::endl;
+
+    std::cout << "errors " << errors << std::endl;
+    return errors == 0 ? 0 : 1;
 }
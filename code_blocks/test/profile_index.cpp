@@ -0,0 +1,133 @@
+#include <iostream>
+#include "xtechnical_indicators.hpp"
+#include <random>
+#include <chrono>
+
+int main(int argc, char* argv[]) {
+    std::cout << "Hello world!" << std::endl;
+
+    const size_t dim = 32;
+    const size_t k = 10;
+    xtechnical::ProfileIndex<float> index(dim, xtechnical::ProfileIndex<float>::EUCLIDEAN);
+    xtechnical::ProfileIndex<float> cosine_index(dim, xtechnical::ProfileIndex<float>::COSINE);
+
+    /* профили разной длины: треугольные распределения с шумом */
+    std::mt19937 gen(1);
+    std::uniform_int_distribution<size_t> length_dist(5, 60);
+    std::uniform_real_distribution<double> noise(0.0, 0.3);
+    auto make_profile = [&]() -> std::vector<double> {
+        const size_t length = length_dist(gen);
+        std::vector<double> profile = xtechnical::ClusterShaper::get_triangular_distribution(length, gen() % length);
+        for (auto &item : profile) item = std::min(1.0, item + noise(gen));
+        return profile;
+    };
+
+    const size_t profiles = 1000000;
+    auto begin = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < profiles; ++i) {
+        const std::vector<double> profile = make_profile();
+        index.add(profile);
+        cosine_index.add(profile);
+    }
+    auto end = std::chrono::steady_clock::now();
+    std::cout << "add time (ms) " << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << std::endl;
+
+    /* сравнение с перебором функциями ClusterShaper */
+    std::vector<double> query = make_profile();
+    std::vector<float> resampled(dim);
+    xtechnical::ProfileIndex<float>::resample(query.data(), query.size(), resampled.data(), dim);
+    const std::vector<double> query_vec(resampled.begin(), resampled.end());
+
+    std::vector<std::pair<double, size_t>> reference;
+    std::vector<std::pair<double, size_t>> cosine_reference;
+    std::vector<float> item;
+    begin = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < index.size(); ++i) {
+        index.get(i, item);
+        const std::vector<double> item_vec(item.begin(), item.end());
+        reference.push_back(std::make_pair(-xtechnical::ClusterShaper::get_euclidean_distance(query_vec, item_vec), i));
+        cosine_reference.push_back(std::make_pair(-xtechnical::ClusterShaper::get_cosine_similarity(query_vec, item_vec), i));
+    }
+    std::partial_sort(reference.begin(), reference.begin() + k, reference.end());
+    std::partial_sort(cosine_reference.begin(), cosine_reference.begin() + k, cosine_reference.end());
+    end = std::chrono::steady_clock::now();
+    std::cout << "scalar search time (ms) " << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << std::endl;
+
+    std::vector<xtechnical::ProfileIndex<float>::Result> results;
+    begin = std::chrono::steady_clock::now();
+    index.search(query, k, results);
+    end = std::chrono::steady_clock::now();
+    std::cout << "index search time (us) " << std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count() << std::endl;
+
+    size_t errors = 0;
+    for (size_t i = 0; i < k; ++i) {
+        std::cout << results[i].id << " " << results[i].similarity << " " << reference[i].second << " " << -reference[i].first << std::endl;
+        if (std::abs(results[i].similarity + reference[i].first) > 1e-6) ++errors;
+    }
+
+    std::vector<xtechnical::ProfileIndex<float>::Result> cosine_results;
+    cosine_index.search(query, k, cosine_results);
+    for (size_t i = 0; i < k; ++i) {
+        if (std::abs(cosine_results[i].similarity + cosine_reference[i].first) > 1e-6) ++errors;
+    }
+    std::cout << "errors " << errors << std::endl;
+
+    /* приближенный поиск */
+    std::vector<std::vector<float>> stored;
+    for (size_t i = 0; i < index.size(); i += 9973) {
+        index.get(i, item);
+        stored.push_back(item);
+    }
+    begin = std::chrono::steady_clock::now();
+    index.build_ivf(1024);
+    end = std::chrono::steady_clock::now();
+    std::cout << "build ivf time (ms) " << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << std::endl;
+
+    /* после переноса векторов в списки точный поиск и get не меняются */
+    std::vector<xtechnical::ProfileIndex<float>::Result> moved_results;
+    index.search(query, k, moved_results);
+    for (size_t i = 0; i < k; ++i) {
+        if (moved_results[i].id != results[i].id || moved_results[i].similarity != results[i].similarity) ++errors;
+    }
+    for (size_t i = 0, j = 0; i < index.size(); i += 9973, ++j) {
+        index.get(i, item);
+        if (item != stored[j]) ++errors;
+    }
+
+    const size_t queries = 100;
+    size_t found = 0;
+    double exact_time = 0, ivf_time = 0;
+    for (size_t q = 0; q < queries; ++q) {
+        const std::vector<double> profile = make_profile();
+        std::vector<xtechnical::ProfileIndex<float>::Result> exact, approx;
+        begin = std::chrono::steady_clock::now();
+        index.search(profile, k, exact);
+        end = std::chrono::steady_clock::now();
+        exact_time += std::chrono::duration<double>(end - begin).count();
+        begin = std::chrono::steady_clock::now();
+        index.search_ivf(profile, k, approx, 16);
+        end = std::chrono::steady_clock::now();
+        ivf_time += std::chrono::duration<double>(end - begin).count();
+        for (auto &a : approx) {
+            for (auto &e : exact) {
+                if (a.id == e.id) ++found;
+            }
+        }
+    }
+    std::cout << "exact search time (us) " << exact_time * 1e6 / queries << std::endl;
+    std::cout << "ivf search time (us) " << ivf_time * 1e6 / queries << std::endl;
+    std::cout << "ivf recall " << (double)found / (double)(queries * k) << std::endl;
+
+    /* добавление в списки и повторное построение */
+    const std::vector<double> added = make_profile();
+    const size_t added_id = index.add(added);
+    std::vector<xtechnical::ProfileIndex<float>::Result> added_results;
+    index.search(added, 1, added_results);
+    if (added_results.empty() || added_results[0].similarity != 1.0) ++errors;
+    index.build_ivf(256);
+    index.get(added_id, item);
+    xtechnical::ProfileIndex<float>::resample(added.data(), added.size(), resampled.data(), dim);
+    if (item != resampled) ++errors;
+    std::cout << "errors after rebuild ivf " << errors << std::endl;
+    return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,133 @@
+#include <iostream>
+#include "backtest/xtechnical_replay_runner.hpp"
+#include <random>
+#include <chrono>
+
+/* индикаторы стратегии одного символа */
+class Strategy {
+public:
+    xtechnical::RSI<double, xtechnical::EMA<double>> rsi;
+    xtechnical::BollingerBands<double> bb;
+
+    Strategy() : rsi(14), bb(20, 2) {};
+};
+
+typedef xtechnical::ReplayRunner<Strategy> Runner;
+
+/* сделки в порядке вызова функций обратного вызова */
+class Deal {
+public:
+    std::string symbol;
+    uint64_t t1 = 0;
+    double open = 0, close = 0;
+    int result = 0;
+
+    bool operator==(const Deal &other) const {
+        return symbol == other.symbol && t1 == other.t1 &&
+            open == other.open && close == other.close && result == other.result;
+    }
+};
+
+static void init(Runner::Shard &shard) {
+    shard.shaper.on_close_bar = [&shard](const Runner::Bar &bar) {
+        Strategy &s = shard.strategy;
+        s.rsi.update(bar.close);
+        s.bb.update(bar.close);
+        if (std::isnan(s.rsi.get()) || std::isnan(s.bb.get_tl())) return;
+        const uint64_t timestamp = bar.timestamp * 1000 + 60000;
+        if (s.rsi.get() > 60 && bar.close > s.bb.get_ml()) shard.place_bet(timestamp, -1);
+        else if (s.rsi.get() < 40 && bar.close < s.bb.get_ml()) shard.place_bet(timestamp, 1);
+    };
+}
+
+/* символы получают разное число тиков, чтобы нагрузка шардов была неравной */
+static void replay(Runner::Shard &shard) {
+    std::mt19937 gen(shard.index + 1);
+    std::uniform_int_distribution<int> step(-1, 1);
+    const size_t ticks = 20000 + (shard.index % 7) * 20000;
+    uint64_t timestamp = 1600000000000ULL;
+    double price = 1.0;
+    for (size_t i = 0; i < ticks; ++i) {
+        timestamp += 100 + gen() % 2000;
+        // редкие разрывы дают ошибки сделок
+        if (gen() % 5000 == 0) timestamp += 30000;
+        price += step(gen) * 0.00001;
+        shard(timestamp, price, price + 0.00002, 0);
+    }
+}
+
+static size_t run(
+        const std::vector<std::string> &symbols,
+        const size_t num_threads,
+        const Runner &reference,
+        const std::vector<Deal> &reference_deals,
+        std::vector<Deal> &deals,
+        Runner &runner) {
+    deals.clear();
+    auto add = [&deals](const Runner::Bet &bet, const int result) {
+        Deal deal;
+        deal.symbol = bet.symbol;
+        deal.t1 = bet.t1;
+        deal.open = bet.open;
+        deal.close = bet.close;
+        deal.result = result;
+        deals.push_back(deal);
+    };
+    runner.on_win = [&](const Runner::Bet &bet) {add(bet, 1);};
+    runner.on_loss = [&](const Runner::Bet &bet) {add(bet, -1);};
+    runner.on_error = [&](const Runner::Bet &bet) {add(bet, 0);};
+    auto t1 = std::chrono::high_resolution_clock::now();
+    runner.run(symbols, init, replay, num_threads);
+    auto t2 = std::chrono::high_resolution_clock::now();
+    std::cout << "threads " << num_threads
+        << " wins " << runner.wins << " losses " << runner.losses << " errors " << runner.errors
+        << " winrate " << runner.get_winrate()
+        << " ms " << std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count() << std::endl;
+    if (reference_deals.empty()) return 0;
+    size_t errors = 0;
+    if (runner.wins != reference.wins || runner.losses != reference.losses || runner.errors != reference.errors) ++errors;
+    if (!(deals == reference_deals)) ++errors;
+    return errors;
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "Hello world!" << std::endl;
+
+    std::vector<std::string> symbols;
+    for (size_t i = 0; i < 50; ++i) symbols.push_back("SYM" + std::to_string(i));
+
+    Runner reference;
+    std::vector<Deal> reference_deals;
+    run(symbols, 1, reference, reference_deals, reference_deals, reference);
+
+    /* итог и порядок сделок не зависят от числа потоков */
+    size_t errors = 0;
+    const size_t threads[] = {2, 3, 4, 8, 64, 0};
+    for (const size_t num_threads : threads) {
+        Runner runner;
+        std::vector<Deal> deals;
+        errors += run(symbols, num_threads, reference, reference_deals, deals, runner);
+    }
+
+    /* сумма итогов символов совпадает с общим итогом */
+    uint64_t wins = 0, losses = 0;
+    for (const auto &result : reference.get_results()) {
+        wins += result.wins;
+        losses += result.losses;
+    }
+    if (wins != reference.wins || losses != reference.losses) ++errors;
+
+    /* исключение из рабочего потока передается вызывающему */
+    bool is_thrown = false;
+    try {
+        xtechnical::WorkStealingPool::run(100, 4, [](const size_t task, const size_t) {
+            if (task == 77) throw std::runtime_error("task");
+        });
+    } catch(const std::runtime_error &) {
+        is_thrown = true;
+    }
+    if (!is_thrown) ++errors;
+
+    std::cout << "deals " << reference_deals.size() << " errors " << errors << std::endl;
+    return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,48 @@
+#include <iostream>
+#include "xtechnical_indicators.hpp"
+#include "xtechnical_statistics.hpp"
+#include <random>
+#include <array>
+
+int main(int argc, char* argv[]) {
+    std::cout << "Hello world!" << std::endl;
+
+    const size_t period = 50;
+    xtechnical::RollingSkewness<double> skewness(period);
+    xtechnical::RollingKurtosis<double> kurtosis(period);
+
+    std::mt19937 gen(1);
+    std::gamma_distribution<double> dist(2.0, 2.0);
+    std::deque<double> window;
+
+    double max_err_skew = 0, max_err_excess = 0;
+    for(size_t i = 0; i < 100000; ++i) {
+        const double value = 1000.0 + dist(gen);
+
+        /* test не должен менять состояние индикатора */
+        skewness.test(value + 1.0);
+        kurtosis.test(value + 1.0);
+
+        skewness.update(value);
+        kurtosis.update(value);
+
+        window.push_back(value);
+        if(window.size() > period) window.pop_front();
+        if(window.size() < period) {
+            if(!std::isnan(skewness.get())) std::cout << "error: not NaN" << std::endl;
+            continue;
+        }
+
+        const double ref_skew = xtechnical_statistics::calc_moments<double>(window).get_skewness();
+        const double ref_excess = xtechnical_statistics::calc_excess<double>(window);
+        max_err_skew = std::max(max_err_skew, std::abs(skewness.get() - ref_skew));
+        max_err_excess = std::max(max_err_excess, std::abs(kurtosis.get() - ref_excess));
+        if(i % 10000 == 0) {
+            std::cout << "skewness " << skewness.get() << " (" << ref_skew << ")"
+                << " excess " << kurtosis.get() << " (" << ref_excess << ")" << std::endl;
+        }
+    }
+    std::cout << "max error skewness " << max_err_skew << std::endl;
+    std::cout << "max error excess " << max_err_excess << std::endl;
+    return 0;
+}
@@ -0,0 +1,94 @@
+#include <iostream>
+#include "xtechnical_indicators.hpp"
+#include <random>
+#include <chrono>
+#include <deque>
+
+int main(int argc, char* argv[]) {
+    std::cout << "Hello world!" << std::endl;
+
+    const size_t period = 60;
+    xtechnical::RollingVolumeProfile profile(period, 0.7);
+
+    /* для сравнения профиль пересобирается из последних кластеров */
+    std::deque<std::map<int, int>> window;
+    size_t errors = 0;
+    size_t bars = 0;
+    double rebuild_time = 0;
+    double rolling_time = 0;
+
+    xtechnical::ClusterShaper cluster_shaper(60, 0.00001);
+    cluster_shaper.on_close_bar = [&](const xtechnical::ClusterShaper::Cluster &cluster) {
+        auto begin = std::chrono::steady_clock::now();
+        profile.update(cluster);
+        const int poc = profile.get_poc();
+        int val = 0, vah = 0;
+        profile.get_value_area(val, vah);
+        auto end = std::chrono::steady_clock::now();
+        rolling_time += std::chrono::duration<double>(end - begin).count();
+
+        begin = std::chrono::steady_clock::now();
+        window.push_back(cluster.distribution.to_map());
+        if (window.size() > period) window.pop_front();
+        std::map<int, int64_t> sum;
+        for (const auto &item : window) {
+            for (const auto &level : item) sum[level.first] += level.second;
+        }
+        int64_t total = 0;
+        int64_t max_volume = 0;
+        int max_tick = 0;
+        for (const auto &level : sum) {
+            total += level.second;
+            if (level.second > max_volume) {
+                max_volume = level.second;
+                max_tick = level.first;
+            }
+        }
+        /* зона стоимости отсекает по 15% объема снизу и сверху */
+        const double cut = (double)total * 0.15;
+        int64_t acc = 0;
+        int ref_val = 0, ref_vah = 0;
+        bool is_val = false, is_vah = false;
+        for (int tick = sum.begin()->first; tick <= sum.rbegin()->first; ++tick) {
+            auto it = sum.find(tick);
+            if (it != sum.end()) acc += it->second;
+            if (!is_val && (double)acc > cut) {
+                ref_val = tick;
+                is_val = true;
+            }
+            if (!is_vah && (double)acc >= (double)total - cut) {
+                ref_vah = tick;
+                is_vah = true;
+            }
+        }
+        end = std::chrono::steady_clock::now();
+        rebuild_time += std::chrono::duration<double>(end - begin).count();
+
+        if (poc != max_tick || val != ref_val || vah != ref_vah || total != profile.get_volume()) {
+            ++errors;
+        }
+        ++bars;
+    };
+
+    std::mt19937 gen(1);
+    std::normal_distribution<double> step(0, 0.00003);
+    double price = 1.1;
+    uint64_t timestamp = 1600000000;
+    for(size_t i = 0; i < 5000000; ++i) {
+        if(gen() % 4 == 0) ++timestamp;
+        price += step(gen);
+        cluster_shaper.update(price, timestamp);
+    }
+
+    std::vector<double> hvn, lvn;
+    profile.get_high_volume_nodes(hvn);
+    profile.get_low_volume_nodes(lvn);
+    double val = 0, vah = 0;
+    profile.get_value_area_price(val, vah);
+    std::cout << "poc " << profile.get_poc_price() << " val " << val << " vah " << vah << std::endl;
+    std::cout << "hvn " << hvn.size() << " lvn " << lvn.size() << std::endl;
+    std::cout << "bars " << bars << " errors " << errors << std::endl;
+    std::cout << "rolling profile time (ms) " << rolling_time * 1000.0 << std::endl;
+    std::cout << "rebuild profile time (ms) " << rebuild_time * 1000.0 << std::endl;
+    return 0;
+}
@@ -0,0 +1,85 @@
+#include <iostream>
+#include "xtechnical_statistics.hpp"
+#include "xtechnical_normalization.hpp"
+#include "xtechnical_correlation.hpp"
+#include "xtechnical_circular_buffer.hpp"
+#include <random>
+#include <vector>
+#include <chrono>
+
+int main(int argc, char* argv[]) {
+    std::cout << "Hello world!" << std::endl;
+
+    std::mt19937 gen(1);
+    std::normal_distribution<> nd(1.0, 2.0);
+
+    const size_t data_size = 1000003;
+    std::vector<double> x(data_size), y(data_size);
+    for (auto &item : x) item = nd(gen);
+    for (auto &item : y) item = nd(gen);
+    std::vector<float> xf(x.begin(), x.end());
+    std::vector<double> out(data_size);
+
+    const char *names[] = {"scalar", "sse2", "avx2", "avx512"};
+    std::cout.precision(15);
+    for (int s = 0; s <= 3; ++s) {
+        if (!xtechnical::simd::set_instruction_set((xtechnical::simd::InstructionSet)s)) {
+            std::cout << names[s] << ": not supported" << std::endl;
+            continue;
+        }
+        const auto t1 = std::chrono::high_resolution_clock::now();
+        const double mean = xtechnical_statistics::calc_mean_value<double>(x);
+        const double mean_f = xtechnical_statistics::calc_mean_value<double>(xf);
+        const double std_dev = xtechnical_statistics::calc_std_dev_sample<double>(x);
+        const double skewness = xtechnical_statistics::calc_skewness<double>(x);
+        const double excess = xtechnical_statistics::calc_excess<double>(x);
+        xtechnical::normalization::calculate_zscore(x, out, 1.0, 3.0);
+        const double zscore = out[data_size / 2];
+        xtechnical::normalization::calculate_min_max(x, out, xtechnical::common::MINMAX_SIGNED);
+        const double min_max = out[data_size / 2];
+        double rxy = 0;
+        xtechnical::correlation::calculate_pearson_correlation_coefficient(x, y, rxy);
+        /* блок из 1000 векторов размерности 100 и запрос из y */
+        std::vector<double> block_out(1000);
+        xtechnical::simd::block_sq_dist(xf.data(), xf.data() + 100000, 100, 1000, block_out.data());
+        const double block_dist = block_out[999];
+        xtechnical::simd::block_dot(x.data(), y.data(), 100, 1000, block_out.data());
+        const double block_dot = block_out[999];
+        const double dot = xtechnical::simd::dot(x.data(), y.data(), data_size);
+        /* окно циклического буфера, разделенное на два участка */
+        xtechnical::circular_buffer<double> buffer_x(1000), buffer_y(1000);
+        for (size_t i = 0; i < 1500; ++i) {
+            buffer_x.update(x[i]);
+            buffer_y.update(y[i]);
+        }
+        const xtechnical::circular_buffer_view<double> view_x = buffer_x.view();
+        const double view_sum = view_x.sum();
+        const double view_dot = view_x.dot(buffer_y.view(1, 1000));
+        double view_min = 0, view_max = 0;
+        view_x.min_max(view_min, view_max);
+        const auto t2 = std::chrono::high_resolution_clock::now();
+
+        std::cout
+            << names[s]
+            << " mean " << mean
+            << " mean(float) " << mean_f
+            << " std_dev " << std_dev
+            << " skewness " << skewness
+            << " excess " << excess
+            << " zscore " << zscore
+            << " min_max " << min_max
+            << " rxy " << rxy
+            << " block_dist " << block_dist
+            << " block_dot " << block_dot
+            << " dot " << dot
+            << " view_sum " << view_sum
+            << " view_dot " << view_dot
+            << " view_min " << view_min
+            << " view_max " << view_max
+            << " us " << std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count()
+            << std::endl;
+    }
+
+    std::system("pause");
+    return 0;
+}
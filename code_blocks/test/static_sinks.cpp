@@ -0,0 +1,229 @@
+#include <iostream>
+#include "xtechnical_indicators.hpp"
+#include "indicators/xtechnical_fractals_level.hpp"
+#include <random>
+#include <chrono>
+
+/* Итоги, полученные на тех же данных версиями BarShaperV1, ClusterShaper,
+ * RenkoChart, Fractals и FractalsLevel до перехода на статические приемники
+ */
+static const size_t GOLDEN_BARS = 41698;
+static const double GOLDEN_BAR_SUM = 183965.89096000328;
+static const uint64_t GOLDEN_BAR_TIME = 66768961279140ULL;
+static const size_t GOLDEN_CLUSTERS = 41698;
+static const int64_t GOLDEN_CLUSTER_SUM = 66791969173679LL;
+/* прежний RenkoChart не выдает ни одного бара на любых данных: при росте уровня
+ * цикл идет вниз от last_level - 1 до level, при падении - вверх от last_level + 1,
+ * и ни одна итерация не выполняется. BasicRenkoChart повторяет эти циклы,
+ * поэтому сравнение ниже проверяет только отсутствие баров у обоих,
+ * а формирование кирпичей BasicRenkoChart этим тестом не проверено
+ */
+static const size_t GOLDEN_RENKO_BARS = 0;
+static const size_t GOLDEN_UP = 120816;
+static const size_t GOLDEN_DN = 120862;
+static const double GOLDEN_FRACTALS_SUM = -13.666559999914536;
+static const size_t GOLDEN_LEVEL_UP = 207834;
+static const size_t GOLDEN_LEVEL_DN = 207881;
+static const double GOLDEN_LEVEL_SUM = 27.763880000234273;
+
+/* приемник баров, методы которого компилятор может встроить */
+class BarCounter : public xtechnical::BarShaperSink<double> {
+public:
+    size_t bars = 0;
+    double sum = 0;
+    uint64_t time = 0;
+
+    inline void on_close_bar(const xtechnical::BarShaperV1<double>::Bar &bar) {
+        ++bars;
+        sum += bar.open + bar.high + bar.low + bar.close;
+        time += bar.timestamp;
+    }
+};
+
+class ClusterCounter : public xtechnical::ClusterShaperSink {
+public:
+    size_t clusters = 0;
+    int64_t sum = 0;
+
+    inline void on_close_bar(const xtechnical::ClusterShaper::Cluster &cluster) {
+        ++clusters;
+        sum += cluster.open + cluster.close + cluster.high + cluster.low +
+            cluster.volume + cluster.max_volume + cluster.max_index +
+            (int64_t)cluster.distribution.size() + (int64_t)cluster.timestamp;
+    }
+};
+
+class RenkoCounter {
+public:
+    size_t bars = 0;
+    double sum = 0;
+    uint64_t time = 0;
+
+    inline void on_close_bar(const xtechnical::RenkoChart<double>::Bar &bar) {
+        ++bars;
+        sum += bar.close;
+        time += bar.timestamp;
+    }
+};
+
+class FractalsCounter : public xtechnical::FractalsSink {
+public:
+    size_t up = 0;
+    size_t dn = 0;
+    double sum = 0;
+
+    inline void on_up(const double value) {
+        ++up;
+        sum += value;
+    }
+
+    inline void on_dn(const double value) {
+        ++dn;
+        sum -= value;
+    }
+};
+
+int main(int argc, char* argv[]) {
+    std::cout << "Hello world!" << std::endl;
+
+    std::mt19937 gen(1);
+    std::uniform_int_distribution<int> step(-1, 1);
+    std::vector<double> prices;
+    std::vector<uint64_t> timestamps;
+    double price = 1.1;
+    uint64_t timestamp = 1600000000;
+    for(size_t i = 0; i < 10000000; ++i) {
+        if(gen() % 4 == 0) ++timestamp;
+        price += step(gen) * 0.00001;
+        prices.push_back(price);
+        timestamps.push_back(timestamp);
+    }
+
+    /* формирователь баров */
+    xtechnical::BarShaperV1<double> shaper(60);
+    BarCounter bar_counter;
+    shaper.on_close_bar = [&](const xtechnical::BarShaperV1<double>::Bar &bar) {
+        bar_counter.on_close_bar(bar);
+    };
+    xtechnical::BasicBarShaper<double, BarCounter> basic_shaper(60);
+
+    auto begin = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < prices.size(); ++i) {
+        shaper.update(prices[i], timestamps[i]);
+    }
+    auto end = std::chrono::steady_clock::now();
+    std::cout << "BarShaperV1 time (ms) " << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << std::endl;
+
+    begin = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < prices.size(); ++i) {
+        basic_shaper.update(prices[i], timestamps[i]);
+    }
+    end = std::chrono::steady_clock::now();
+    std::cout << "BasicBarShaper time (ms) " << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << std::endl;
+
+    if(bar_counter.bars != GOLDEN_BARS || bar_counter.sum != GOLDEN_BAR_SUM || bar_counter.time != GOLDEN_BAR_TIME ||
+        basic_shaper.sink.bars != GOLDEN_BARS || basic_shaper.sink.sum != GOLDEN_BAR_SUM || basic_shaper.sink.time != GOLDEN_BAR_TIME) {
+        std::cout << "bar shaper error: " << bar_counter.bars << " " << basic_shaper.sink.bars << std::endl;
+        return 1;
+    }
+    std::cout << "bars " << bar_counter.bars << " ok" << std::endl;
+
+    /* формирователь кластеров */
+    xtechnical::ClusterShaper cluster_shaper(60, 0.00001);
+    ClusterCounter cluster_counter;
+    cluster_shaper.on_close_bar = [&](const xtechnical::ClusterShaper::Cluster &cluster) {
+        cluster_counter.on_close_bar(cluster);
+    };
+    xtechnical::BasicClusterShaper<ClusterCounter> basic_cluster_shaper(60, 0.00001);
+
+    begin = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < prices.size(); ++i) {
+        cluster_shaper.update(prices[i], timestamps[i]);
+    }
+    end = std::chrono::steady_clock::now();
+    std::cout << "ClusterShaper time (ms) " << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << std::endl;
+
+    begin = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < prices.size(); ++i) {
+        basic_cluster_shaper.update(prices[i], timestamps[i]);
+    }
+    end = std::chrono::steady_clock::now();
+    std::cout << "BasicClusterShaper time (ms) " << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << std::endl;
+
+    if(cluster_counter.clusters != GOLDEN_CLUSTERS || cluster_counter.sum != GOLDEN_CLUSTER_SUM ||
+        basic_cluster_shaper.sink.clusters != GOLDEN_CLUSTERS || basic_cluster_shaper.sink.sum != GOLDEN_CLUSTER_SUM) {
+        std::cout << "cluster shaper error: " << cluster_counter.clusters << " " << basic_cluster_shaper.sink.clusters << std::endl;
+        return 1;
+    }
+    std::cout << "clusters " << cluster_counter.clusters << " ok" << std::endl;
+
+    /* график ренко */
+    xtechnical::RenkoChart<double> renko(5, 10);
+    RenkoCounter renko_counter;
+    renko.on_close_bar = [&](const xtechnical::RenkoChart<double>::Bar &bar) {
+        renko_counter.on_close_bar(bar);
+    };
+    xtechnical::BasicRenkoChart<double, RenkoCounter> basic_renko(5, 10);
+
+    begin = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < prices.size(); ++i) {
+        renko.update(prices[i], timestamps[i]);
+    }
+    end = std::chrono::steady_clock::now();
+    std::cout << "RenkoChart time (ms) " << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << std::endl;
+
+    begin = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < prices.size(); ++i) {
+        basic_renko.update(prices[i], timestamps[i]);
+    }
+    end = std::chrono::steady_clock::now();
+    std::cout << "BasicRenkoChart time (ms) " << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << std::endl;
+
+    if(renko_counter.bars != GOLDEN_RENKO_BARS || basic_renko.sink.bars != GOLDEN_RENKO_BARS ||
+        renko_counter.sum != basic_renko.sink.sum || renko_counter.time != basic_renko.sink.time) {
+        std::cout << "renko error: " << renko_counter.bars << " " << basic_renko.sink.bars << std::endl;
+        return 1;
+    }
+    std::cout << "renko " << renko_counter.bars << " ok (bricks unverified, see GOLDEN_RENKO_BARS)" << std::endl;
+
+    /* фракталы и уровни по фракталам */
+    xtechnical::Fractals<double> fractals;
+    xtechnical::FractalsLevel<double> fractals_level;
+    xtechnical::BasicFractals<double, FractalsCounter> basic_fractals;
+    xtechnical::BasicFractalsLevel<double, FractalsCounter> basic_fractals_level;
+    FractalsCounter fractals_counter, level_counter;
+
+    begin = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < prices.size(); i += 10) {
+        fractals.update(prices[i] + 0.0001, prices[i] - 0.0001,
+            [&](const double value){fractals_counter.on_up(value);},
+            [&](const double value){fractals_counter.on_dn(value);});
+        fractals_level.update(prices[i] + 0.0001, prices[i] - 0.0001,
+            [&](const double value){level_counter.on_up(value);},
+            [&](const double value){level_counter.on_dn(value);});
+    }
+    end = std::chrono::steady_clock::now();
+    std::cout << "Fractals + FractalsLevel time (ms) " << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << std::endl;
+
+    begin = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < prices.size(); i += 10) {
+        basic_fractals.update(prices[i] + 0.0001, prices[i] - 0.0001);
+        basic_fractals_level.update(prices[i] + 0.0001, prices[i] - 0.0001);
+    }
+    end = std::chrono::steady_clock::now();
+    std::cout << "BasicFractals + BasicFractalsLevel time (ms) " << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << std::endl;
+
+    if(fractals_counter.up != GOLDEN_UP || fractals_counter.dn != GOLDEN_DN || fractals_counter.sum != GOLDEN_FRACTALS_SUM ||
+        basic_fractals.sink.up != GOLDEN_UP || basic_fractals.sink.dn != GOLDEN_DN || basic_fractals.sink.sum != GOLDEN_FRACTALS_SUM ||
+        level_counter.up != GOLDEN_LEVEL_UP || level_counter.dn != GOLDEN_LEVEL_DN || level_counter.sum != GOLDEN_LEVEL_SUM ||
+        basic_fractals_level.sink.up != GOLDEN_LEVEL_UP || basic_fractals_level.sink.dn != GOLDEN_LEVEL_DN ||
+        basic_fractals_level.sink.sum != GOLDEN_LEVEL_SUM ||
+        fractals.get_up() != basic_fractals.get_up() ||
+        fractals_level.get_dn() != basic_fractals_level.get_dn()) {
+        std::cout << "fractals error" << std::endl;
+        return 1;
+    }
+    std::cout << "fractals " << fractals_counter.up << " " << fractals_counter.dn
+        << " levels " << level_counter.up << " " << level_counter.dn << " ok" << std::endl;
+    return 0;
+}
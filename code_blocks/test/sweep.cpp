@@ -0,0 +1,138 @@
+#include <iostream>
+#include "xtechnical_indicators.hpp"
+#include "xtechnical_sweep.hpp"
+#include <random>
+#include <vector>
+#include <chrono>
+
+/* отклонение матрицы от отдельных индикаторов для каждого периода */
+template<class INDICATOR, class T>
+static double check(const std::vector<T> &input, const std::vector<size_t> &periods, const std::vector<T> &output) {
+    const size_t m = periods.size();
+    double max_error = 0;
+    for (size_t k = 0; k < m; ++k) {
+        INDICATOR indicator(periods[k]);
+        for (size_t t = 0; t < input.size(); ++t) {
+            indicator.update(input[t]);
+            const T a = indicator.get(), b = output[t * m + k];
+            if (std::isnan(a) != std::isnan(b)) return std::numeric_limits<double>::infinity();
+            if (std::isnan(a)) continue;
+            max_error = std::max(max_error, std::abs((double)a - (double)b) / std::max(1.0, std::abs((double)a)));
+        }
+    }
+    return max_error;
+}
+
+/* расчет отдельными индикаторами для каждого периода в ту же матрицу */
+template<class INDICATOR, class T>
+static void measure_single(const std::vector<T> &input, const std::vector<size_t> &periods, std::vector<T> &output) {
+    const size_t m = periods.size();
+    output.resize(input.size() * m);
+    for (size_t k = 0; k < m; ++k) {
+        INDICATOR indicator(periods[k]);
+        for (size_t t = 0; t < input.size(); ++t) {
+            indicator.update(input[t]);
+            output[t * m + k] = indicator.get();
+        }
+    }
+}
+
+/* вывести отклонение и сравнить его с допуском */
+static size_t report(const char *name, const int err, const double error, const double tolerance) {
+    std::cout << name << " " << (err == xtechnical::common::OK ? "" : "error ") << error << std::endl;
+    return (err != xtechnical::common::OK || !(error <= tolerance)) ? 1 : 0;
+}
+
+/* SMA, SUM, EMA и MMA совпадают с индикаторами побитно,
+ * StdDev, WMA и LRMA - с точностью до tolerance
+ */
+template<class T>
+static size_t test(const size_t n, const std::vector<size_t> &periods, const double tolerance_std_dev, const double tolerance) {
+    using namespace xtechnical;
+    std::mt19937 gen(1);
+    std::normal_distribution<> nd(0.0, 0.001);
+    std::vector<T> input(n);
+    double price = 100.0;
+    for (auto &item : input) {
+        price *= 1.0 + nd(gen);
+        item = (T)price;
+    }
+    std::vector<T> output;
+    size_t errors = 0;
+    int err = sweep::calculate_sma(input, periods, output);
+    errors += report("SMA", err, check<SMA<T>>(input, periods, output), 0);
+    err = sweep::calculate_sum(input, periods, output);
+    errors += report("SUM", err, check<SUM<T>>(input, periods, output), 0);
+    err = sweep::calculate_std_dev(input, periods, output);
+    errors += report("StdDev", err, check<StdDev<T>>(input, periods, output), tolerance_std_dev);
+    err = sweep::calculate_wma(input, periods, output);
+    errors += report("WMA", err, check<WMA<T>>(input, periods, output), tolerance);
+    err = sweep::calculate_lrma(input, periods, output);
+    errors += report("LRMA", err, check<LRMA<T>>(input, periods, output), tolerance);
+    err = sweep::calculate_ema(input, periods, output);
+    errors += report("EMA", err, check<EMA<T>>(input, periods, output), 0);
+    err = sweep::calculate_mma(input, periods, output);
+    errors += report("MMA", err, check<MMA<T>>(input, periods, output), 0);
+    return errors;
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "Hello world!" << std::endl;
+    using namespace xtechnical;
+
+    /* периоды в произвольном порядке и с повторами */
+    std::vector<size_t> periods = {7, 2, 30, 3, 7, 100, 1, 64};
+    size_t errors = 0;
+    std::cout << "double" << std::endl;
+    errors += test<double>(5000, periods, 1e-9, 1e-9);
+    std::cout << "float" << std::endl;
+    errors += test<float>(5000, periods, 1e-3, 1e-4);
+
+    /* периоды 2..500 на одном ряду */
+    std::vector<double> input(20000);
+    std::mt19937 gen(2);
+    std::normal_distribution<> nd(0.0, 0.001);
+    double price = 100.0;
+    for (auto &item : input) {
+        price *= 1.0 + nd(gen);
+        item = price;
+    }
+    periods = sweep::make_periods(2, 500);
+    /* матрица выделяется заранее, чтобы не замерять выделение 80 МБ памяти */
+    std::vector<double> output(input.size() * periods.size());
+
+    auto t1 = std::chrono::high_resolution_clock::now();
+    measure_single<SMA<double>>(input, periods, output);
+    auto t2 = std::chrono::high_resolution_clock::now();
+    sweep::calculate_sma(input, periods, output);
+    auto t3 = std::chrono::high_resolution_clock::now();
+    std::cout << "SMA single ms " << std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count()
+        << " sweep ms " << std::chrono::duration_cast<std::chrono::milliseconds>(t3 - t2).count() << std::endl;
+
+    t1 = std::chrono::high_resolution_clock::now();
+    measure_single<WMA<double>>(input, std::vector<size_t>(periods.begin(), periods.begin() + 50), output);
+    t2 = std::chrono::high_resolution_clock::now();
+    sweep::calculate_wma(input, std::vector<size_t>(periods.begin(), periods.begin() + 50), output);
+    t3 = std::chrono::high_resolution_clock::now();
+    std::cout << "WMA 2..51 single ms " << std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count()
+        << " sweep ms " << std::chrono::duration_cast<std::chrono::milliseconds>(t3 - t2).count() << std::endl;
+
+    t1 = std::chrono::high_resolution_clock::now();
+    measure_single<StdDev<double>>(input, periods, output);
+    t2 = std::chrono::high_resolution_clock::now();
+    sweep::calculate_std_dev(input, periods, output);
+    t3 = std::chrono::high_resolution_clock::now();
+    std::cout << "StdDev single ms " << std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count()
+        << " sweep ms " << std::chrono::duration_cast<std::chrono::milliseconds>(t3 - t2).count() << std::endl;
+
+    t1 = std::chrono::high_resolution_clock::now();
+    measure_single<EMA<double>>(input, periods, output);
+    t2 = std::chrono::high_resolution_clock::now();
+    sweep::calculate_ema(input, periods, output);
+    t3 = std::chrono::high_resolution_clock::now();
+    std::cout << "EMA single ms " << std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count()
+        << " sweep ms " << std::chrono::duration_cast<std::chrono::milliseconds>(t3 - t2).count() << std::endl;
+    std::cout << "errors " << errors << std::endl;
+    std::system("pause");
+    return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,142 @@
+#include <iostream>
+#include "backtest/xtechnical_tick_archive.hpp"
+#include <random>
+#include <chrono>
+#include <thread>
+#include <fstream>
+#include <iterator>
+
+/* записать копию архива, в которой изменен заголовок блока по смещению offset */
+static bool open_corrupted(
+        const std::vector<char> &bytes,
+        const std::string &path,
+        const size_t offset,
+        const std::function<void(xtechnical::archive::BlockHeader &)> &corrupt) {
+    std::vector<char> copy(bytes);
+    xtechnical::archive::BlockHeader block_header;
+    std::memcpy(&block_header, copy.data() + offset, sizeof(block_header));
+    corrupt(block_header);
+    std::memcpy(copy.data() + offset, &block_header, sizeof(block_header));
+    {
+        std::ofstream file(path, std::ios::binary);
+        file.write(copy.data(), copy.size());
+    }
+    xtechnical::TickArchive tick_archive;
+    const bool is_open = tick_archive.open(path);
+    tick_archive.close();
+    std::remove(path.c_str());
+    return is_open;
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "Hello world!" << std::endl;
+
+    const std::string tick_path = "test_ticks.xth";
+    const std::string archive_path = "test_ticks.xta";
+    const double pips_size = 0.00001;
+
+    /* синтетические тики с ценами, кратными пункту */
+    xtechnical::TickFileWriter tick_writer;
+    std::mt19937 gen(1);
+    std::uniform_int_distribution<int> step(-2, 2);
+    const size_t ticks = 10000000;
+    tick_writer.reserve(ticks);
+    int64_t price = 110000;
+    uint64_t timestamp = 1600000000000ULL;
+    for(size_t i = 0; i < ticks; ++i) {
+        timestamp += 1 + gen() % 500;
+        price += step(gen);
+        const int64_t spread = 10 + gen() % 3;
+        tick_writer.add(timestamp, (double)price * pips_size, (double)(price + spread) * pips_size, 1 + gen() % 10);
+    }
+    tick_writer.save(tick_path);
+
+    xtechnical::TickFile tick_file;
+    tick_file.open(tick_path);
+
+    xtechnical::TickArchiveWriter archive_writer;
+    archive_writer.open(archive_path, pips_size);
+    archive_writer.add(tick_file);
+    std::cout << "close archive " << archive_writer.close() << std::endl;
+
+    xtechnical::TickArchive tick_archive;
+    std::cout << "open archive " << tick_archive.open(archive_path)
+        << " ticks " << tick_archive.size()
+        << " blocks " << tick_archive.block_count() << std::endl;
+
+    FILE *f1 = std::fopen(tick_path.c_str(), "rb");
+    std::fseek(f1, 0, SEEK_END);
+    const double raw_size = std::ftell(f1);
+    std::fclose(f1);
+    FILE *f2 = std::fopen(archive_path.c_str(), "rb");
+    std::fseek(f2, 0, SEEK_END);
+    const double archive_size = std::ftell(f2);
+    std::fclose(f2);
+    std::cout << "raw size " << raw_size << " archive size " << archive_size
+        << " ratio " << (raw_size / archive_size) << std::endl;
+
+    size_t errors = 0;
+    if(!tick_archive.is_open()) ++errors;
+
+    /* проверка и скорость декодирования */
+    const size_t threads = std::max(1U, std::thread::hardware_concurrency());
+    for(size_t num_threads : {(size_t)1, threads}) {
+        xtechnical::TickBlock data;
+        auto begin = std::chrono::steady_clock::now();
+        tick_archive.decode(data, num_threads);
+        auto end = std::chrono::steady_clock::now();
+        size_t decode_errors = 0;
+        for(size_t i = 0; i < data.size(); ++i) {
+            if(data.timestamp[i] != tick_file.timestamps()[i] ||
+                std::abs(data.bid[i] - tick_file.bid()[i]) > pips_size / 2 ||
+                std::abs(data.ask[i] - tick_file.ask()[i]) > pips_size / 2 ||
+                data.volume[i] != tick_file.volume()[i]) ++decode_errors;
+        }
+        if(data.size() != ticks) ++decode_errors;
+        errors += decode_errors;
+        const double seconds = std::chrono::duration<double>(end - begin).count();
+        std::cout << "threads " << num_threads << " errors " << decode_errors
+            << " decode (Mticks/s) " << (double)data.size() / seconds / 1.0e6 << std::endl;
+    }
+
+    /* воспроизведение с параллельным декодированием */
+    double sum = 0;
+    auto begin = std::chrono::steady_clock::now();
+    tick_archive.replay([&](const uint64_t, const double bid, const double, const double) {
+        sum += bid;
+    }, threads);
+    auto end = std::chrono::steady_clock::now();
+    std::cout << "replay sum " << sum << " time (ms) "
+        << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << std::endl;
+
+    const size_t block = tick_archive.find_block(tick_file.timestamps()[ticks / 2]);
+    std::cout << "find block " << block
+        << " first tick " << tick_archive.get_block_info(block).first_tick << std::endl;
+
+    /* поврежденные заголовки блоков должны отклоняться при открытии */
+    const size_t offset = (size_t)tick_archive.get_block_info(block).offset;
+    tick_file.close();
+    tick_archive.close();
+    std::vector<char> bytes;
+    {
+        std::ifstream file(archive_path, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    const std::string corrupted_path = "test_ticks_corrupted.xta";
+    const bool is_intact = open_corrupted(bytes, corrupted_path, offset,
+        [](xtechnical::archive::BlockHeader &) {});
+    const bool is_count = open_corrupted(bytes, corrupted_path, offset,
+        [](xtechnical::archive::BlockHeader &h) {h.count += 1;});
+    const bool is_stream = open_corrupted(bytes, corrupted_path, offset,
+        [](xtechnical::archive::BlockHeader &h) {h.volume_bytes += 1;});
+    const bool is_overflow = open_corrupted(bytes, corrupted_path, offset,
+        [](xtechnical::archive::BlockHeader &h) {h.timestamp_bytes = 0xFFFFFFFF;});
+    if(!is_intact || is_count || is_stream || is_overflow) ++errors;
+    std::cout << "corrupted block headers rejected " << (!is_count && !is_stream && !is_overflow)
+        << " intact copy opened " << is_intact << std::endl;
+
+    std::remove(tick_path.c_str());
+    std::remove(archive_path.c_str());
+    std::cout << "errors " << errors << std::endl;
+    return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,71 @@
+#include <iostream>
+#include "backtest/xtechnical_winrate_statistics.hpp"
+#include "backtest/xtechnical_winrate_grid_statistics.hpp"
+#include <random>
+#include <chrono>
+
+int main(int argc, char* argv[]) {
+    std::cout << "Hello world!" << std::endl;
+
+    std::vector<uint64_t> expirations;
+    std::vector<uint64_t> delays;
+    for(size_t i = 0; i < 50; ++i) expirations.push_back(60000 + i * 60000);
+    for(size_t i = 0; i < 20; ++i) delays.push_back(i * 100);
+    std::vector<xtechnical::WinrateGridStats::Config> grid =
+        xtechnical::WinrateGridStats::make_grid(expirations, delays, 0, 20000);
+    /* конфигурации с периодом, их порядок закрытия зависит от времени сигнала */
+    const std::vector<xtechnical::WinrateGridStats::Config> aligned_grid =
+        xtechnical::WinrateGridStats::make_grid({60000, 180000, 300000}, delays, 60000, 20000);
+    grid.insert(grid.end(), aligned_grid.begin(), aligned_grid.end());
+
+    xtechnical::WinrateGridStats grid_stats(grid);
+
+    /* для сравнения считаем несколько конфигураций по отдельности */
+    const std::vector<size_t> check_index = {0, 21, 333, 999, 1000, 1031, 1059};
+    std::vector<xtechnical::WinrateStats<int>> check_stats(check_index.size());
+    for(size_t i = 0; i < check_index.size(); ++i) {
+        check_stats[i].config.expiration = grid[check_index[i]].expiration;
+        check_stats[i].config.delay = grid[check_index[i]].delay;
+        check_stats[i].config.period = grid[check_index[i]].period;
+        check_stats[i].config.between_ticks = grid[check_index[i]].between_ticks;
+    }
+
+    const size_t handle = grid_stats.get_handle("broker", "EURUSD");
+    std::mt19937 gen(1);
+    std::uniform_int_distribution<int> step(-1, 1);
+    double price = 1.0;
+    uint64_t timestamp = 1600000000000ULL;
+
+    auto begin = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < 1000000; ++i) {
+        timestamp += 1 + gen() % 1000;
+        price += step(gen) * 0.00001;
+        grid_stats.update(handle, price, price + 0.00002, timestamp);
+        for(auto &stats : check_stats) stats.update("broker", "EURUSD", price, price + 0.00002, timestamp);
+
+        if(gen() % 100 == 0) {
+            const int direction = (gen() % 2) ? 1 : -1;
+            grid_stats.place_bet(handle, timestamp, direction);
+            for(auto &stats : check_stats) stats.place_bet("broker", "EURUSD", timestamp, direction);
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    std::cout << "time (ms) " << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << std::endl;
+
+    size_t errors = 0;
+    for(size_t i = 0; i < check_index.size(); ++i) {
+        const size_t index = check_index[i];
+        if(grid_stats.get_wins()[index] != check_stats[i].wins ||
+            grid_stats.get_losses()[index] != check_stats[i].losses) ++errors;
+        std::cout << "config " << index
+            << " expiration " << grid[index].expiration
+            << " period " << grid[index].period
+            << " delay " << grid[index].delay
+            << " winrate " << grid_stats.get_winrate(index)
+            << " deals " << grid_stats.get_deals(index)
+            << " (winrate " << check_stats[i].get_winrate()
+            << " deals " << check_stats[i].get_deals() << ")" << std::endl;
+    }
+    std::cout << "errors " << errors << std::endl;
+    return errors == 0 ? 0 : 1;
+}
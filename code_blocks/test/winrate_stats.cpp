@@ -0,0 +1,300 @@
+#include <iostream>
+#include "backtest/xtechnical_winrate_statistics.hpp"
+#include <random>
+#include <chrono>
+#include <deque>
+#include <map>
+
+/* прежняя реализация WinrateStats с обходом всех ставок на каждом тике,
+ * используется для сравнения результатов
+ */
+namespace previous {
+
+    template<class T>
+    class WinrateStats {
+    public:
+
+        class Tick {
+        public:
+            double bid = 0;
+            double ask = 0;
+            uint64_t timestamp = 0;
+
+            Tick() {};
+
+            Tick(const double b, const double a, const uint64_t t) :
+                bid(b), ask(a), timestamp(t) {
+            }
+        };
+
+        class Bet {
+        public:
+            std::string broker;
+            std::string symbol;
+            int direction = 0;
+            uint64_t t1 = 0;
+            uint64_t t2 = 0;
+            uint64_t last_t = 0;
+            double open = 0;
+            double close = 0;
+            bool init_open = false;
+            bool init_close = false;
+            T user_data;
+        };
+
+    private:
+        std::deque<Bet> bets;
+        std::map<std::string, std::map<std::string, Tick>> ticks;
+
+    public:
+
+        class Config {
+        public:
+            uint64_t expiration = 60000;
+            uint64_t delay = 150;
+            uint64_t period = 0;
+            uint64_t between_ticks = 20000;
+            std::function<void(const Bet &bet)> on_error = nullptr;
+            std::function<void(const Bet &bet)> on_win = nullptr;
+            std::function<void(const Bet &bet)> on_loss = nullptr;
+        } config;
+
+        uint64_t wins = 0;
+        uint64_t losses = 0;
+
+        void place_bet(
+                const std::string &broker,
+                const std::string &symbol,
+                const uint64_t timestamp,
+                const int direction,
+                std::function<void(Bet &bet)> callback = nullptr) noexcept {
+            Bet bet;
+            bet.broker = broker;
+            bet.symbol = symbol;
+            bet.direction = direction;
+            const uint64_t t1 = timestamp + config.delay;
+            bet.t1 = config.period == 0 ? t1 : (t1 - (t1 % config.period) + config.period);
+            bet.t2 = bet.t1 + config.expiration;
+            auto it_broker = ticks.find(broker);
+            if (it_broker == ticks.end()) return;
+            auto it_symbol = it_broker->second.find(symbol);
+            if (it_symbol == it_broker->second.end()) return;
+            bet.open = (it_symbol->second.ask + it_symbol->second.bid) / 2.0;
+            if (callback != nullptr) callback(bet);
+            bets.push_back(bet);
+        }
+
+        void update(
+                const std::string &broker,
+                const std::string &symbol,
+                const double bid,
+                const double ask,
+                const uint64_t timestamp) noexcept {
+            const Tick tick(bid, ask, timestamp);
+            ticks[broker][symbol] = tick;
+            size_t index = 0;
+            while (index < bets.size()) {
+                Bet &bet = bets[index];
+                if (bet.broker != broker || bet.symbol != symbol) {
+                    ++index;
+                    continue;
+                }
+                if (!bet.init_open && bet.t1 >= tick.timestamp) bet.open = (tick.ask + tick.bid) / 2.0;
+                if (!bet.init_open && bet.t1 <= tick.timestamp) bet.init_open = true;
+                if (!bet.init_close && bet.t2 >= tick.timestamp) {
+                    bet.close = (tick.ask + tick.bid) / 2.0;
+                    bet.last_t = tick.timestamp;
+                }
+                if (!bet.init_close && bet.t2 <= tick.timestamp) {
+                    bet.init_close = true;
+                    if ((bet.t2 - bet.last_t) > config.between_ticks) {
+                        if (config.on_error != nullptr) config.on_error(bet);
+                        bets.erase(bets.begin() + index);
+                        continue;
+                    }
+                }
+                if (!bet.init_close || !bet.init_open) {
+                    ++index;
+                    continue;
+                }
+                const bool is_win = bet.direction == 1 ? (bet.close > bet.open) : (bet.close < bet.open);
+                if (is_win) {
+                    ++wins;
+                    if (config.on_win != nullptr) config.on_win(bet);
+                } else {
+                    ++losses;
+                    if (config.on_loss != nullptr) config.on_loss(bet);
+                }
+                bets.erase(bets.begin() + index);
+            }
+        }
+    };
+};
+
+/* событие обратного вызова: тип, номер ставки и цены */
+class Settlement {
+public:
+    int type = 0;   /**< 0 - ошибка, 1 - победа, 2 - поражение */
+    int id = 0;
+    uint64_t t2 = 0;
+    double open = 0;
+    double close = 0;
+
+    Settlement() {};
+
+    Settlement(const int ty, const int i, const uint64_t t, const double o, const double c) :
+        type(ty), id(i), t2(t), open(o), close(c) {
+    }
+
+    bool operator<(const Settlement &other) const {
+        return id < other.id;
+    }
+
+    bool operator==(const Settlement &other) const {
+        return type == other.type && id == other.id && t2 == other.t2 &&
+            open == other.open && close == other.close;
+    }
+};
+
+/* сравнение с прежней реализацией на случайных тиках нескольких символов,
+ * с повторяющимися метками времени, разрывами и тиками точно в t1 и t2.
+ * Внутри одного тика прежняя реализация закрывает ставки в порядке их
+ * размещения, новая - по времени t2, затем в порядке размещения,
+ * поэтому события одного тика сравниваются как наборы,
+ * а для новой реализации дополнительно проверяется порядок
+ */
+static size_t compare_with_previous(const uint64_t period, const uint32_t seed) {
+    xtechnical::WinrateStats<int> stats;
+    previous::WinrateStats<int> prev;
+    stats.config.expiration = prev.config.expiration = 3000;
+    stats.config.delay = prev.config.delay = 150;
+    stats.config.period = prev.config.period = period;
+    stats.config.between_ticks = prev.config.between_ticks = 1000;
+
+    std::vector<Settlement> events, prev_events;
+    stats.config.on_error = [&](const xtechnical::WinrateStats<int>::Bet &bet) {
+        events.push_back(Settlement(0, bet.user_data, bet.t2, bet.open, bet.close));
+    };
+    stats.config.on_win = [&](const xtechnical::WinrateStats<int>::Bet &bet) {
+        events.push_back(Settlement(1, bet.user_data, bet.t2, bet.open, bet.close));
+    };
+    stats.config.on_loss = [&](const xtechnical::WinrateStats<int>::Bet &bet) {
+        events.push_back(Settlement(2, bet.user_data, bet.t2, bet.open, bet.close));
+    };
+    prev.config.on_error = [&](const previous::WinrateStats<int>::Bet &bet) {
+        prev_events.push_back(Settlement(0, bet.user_data, bet.t2, bet.open, bet.close));
+    };
+    prev.config.on_win = [&](const previous::WinrateStats<int>::Bet &bet) {
+        prev_events.push_back(Settlement(1, bet.user_data, bet.t2, bet.open, bet.close));
+    };
+    prev.config.on_loss = [&](const previous::WinrateStats<int>::Bet &bet) {
+        prev_events.push_back(Settlement(2, bet.user_data, bet.t2, bet.open, bet.close));
+    };
+
+    const std::vector<std::string> symbols = {"EURUSD", "GBPUSD", "AUDCAD"};
+    std::mt19937 gen(seed);
+    std::vector<double> prices(symbols.size(), 1.0);
+    std::vector<uint64_t> timestamps(symbols.size(), 100000);
+
+    size_t errors = 0;
+    int id = 0;
+    for (size_t i = 0; i < 200000; ++i) {
+        const size_t s = gen() % symbols.size();
+        const uint32_t r = gen() % 100;
+        // повтор метки времени, мелкий шаг, шаг на 50 мс или разрыв больше between_ticks
+        if (r < 10) timestamps[s] += 0;
+        else if (r < 80) timestamps[s] += 1 + gen() % 200;
+        else if (r < 97) timestamps[s] += 50;
+        else timestamps[s] += 1000 + gen() % 2000;
+        prices[s] += ((int)(gen() % 3) - 1) * 0.00001;
+
+        events.clear();
+        prev_events.clear();
+        stats.update("broker", symbols[s], prices[s], prices[s] + 0.00002, timestamps[s]);
+        prev.update("broker", symbols[s], prices[s], prices[s] + 0.00002, timestamps[s]);
+
+        for (size_t j = 1; j < events.size(); ++j) {
+            if (events[j].t2 < events[j - 1].t2 ||
+                (events[j].t2 == events[j - 1].t2 && events[j].id < events[j - 1].id)) ++errors;
+        }
+        std::sort(events.begin(), events.end());
+        std::sort(prev_events.begin(), prev_events.end());
+        if (events != prev_events) ++errors;
+
+        if (gen() % 3 == 0) {
+            const uint64_t timestamp = timestamps[s] + gen() % 100;
+            const int direction = (gen() % 2) ? 1 : -1;
+            stats.place_bet("broker", symbols[s], timestamp, direction,
+                [&](xtechnical::WinrateStats<int>::Bet &bet) {bet.user_data = id;});
+            prev.place_bet("broker", symbols[s], timestamp, direction,
+                [&](previous::WinrateStats<int>::Bet &bet) {bet.user_data = id;});
+            ++id;
+        }
+    }
+    if (stats.wins != prev.wins || stats.losses != prev.losses) ++errors;
+    std::cout << "period " << period << " wins " << stats.wins << " / " << prev.wins
+        << " losses " << stats.losses << " / " << prev.losses
+        << " errors " << errors << std::endl;
+    return errors;
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "Hello world!" << std::endl;
+
+    size_t errors = 0;
+    errors += compare_with_previous(0, 1);
+    errors += compare_with_previous(1000, 2);
+
+    xtechnical::WinrateStats<int> stats;
+    stats.config.expiration = 60000;
+    stats.config.delay = 150;
+    stats.config.between_ticks = 20000;
+
+    const std::vector<std::string> symbols = {"EURUSD", "GBPUSD", "AUDCAD", "USDJPY"};
+    std::vector<size_t> handles;
+    for(size_t s = 0; s < symbols.size(); ++s) {
+        handles.push_back(stats.get_handle("broker", symbols[s]));
+    }
+
+    std::mt19937 gen(1);
+    std::uniform_int_distribution<int> step(-1, 1);
+    std::vector<double> prices(symbols.size(), 1.0);
+    std::vector<uint64_t> timestamps(symbols.size(), 1600000000000ULL);
+
+    size_t max_open_bets = 0;
+    auto begin = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < 2000000; ++i) {
+        const size_t s = gen() % symbols.size();
+        timestamps[s] += 1 + gen() % 100;
+        prices[s] += step(gen) * 0.00001;
+        stats.update(handles[s], prices[s], prices[s] + 0.00002, timestamps[s]);
+
+        /* ставки делаем часто, чтобы одновременно были открыты тысячи ставок */
+        if(gen() % 2 == 0) {
+            stats.place_bet(handles[s], timestamps[s], (gen() % 2) ? 1 : -1);
+        }
+        max_open_bets = std::max(max_open_bets, stats.get_open_bets());
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    std::cout << "wins " << stats.wins << " losses " << stats.losses
+        << " winrate " << stats.get_winrate()
+        << " max open bets " << max_open_bets << std::endl;
+    std::cout << "time (ms) " << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << std::endl;
+
+    /* работа через имена брокера и символа */
+    xtechnical::WinrateStats<int> stats_by_name;
+    stats_by_name.update("broker", "EURUSD", 1.1000, 1.1002, 1000);
+    stats_by_name.place_bet("broker", "EURUSD", 1000, 1, [](xtechnical::WinrateStats<int>::Bet &bet) {
+        bet.user_data = 42;
+    });
+    stats_by_name.config.on_win = [](const xtechnical::WinrateStats<int>::Bet &bet) {
+        std::cout << "win " << bet.broker << " " << bet.symbol << " " << bet.user_data
+            << " open " << bet.open << " close " << bet.close << std::endl;
+    };
+    stats_by_name.update("broker", "EURUSD", 1.1001, 1.1003, 30000);
+    stats_by_name.update("broker", "EURUSD", 1.1005, 1.1007, 61150);
+    std::cout << "deals " << stats_by_name.get_deals() << std::endl;
+    std::cout << "errors " << errors << std::endl;
+    return errors == 0 ? 0 : 1;
+}
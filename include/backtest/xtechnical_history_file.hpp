@@ -0,0 +1,593 @@
+#ifndef XTECHNICAL_HISTORY_FILE_HPP_INCLUDED
+#define XTECHNICAL_HISTORY_FILE_HPP_INCLUDED
+
+#include <string>
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <limits>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+
+#if defined(_WIN32)
+#   ifndef NOMINMAX
+#       define NOMINMAX
+#   endif
+#   include <windows.h>
+#else
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <fcntl.h>
+#   include <unistd.h>
+#endif
+
+namespace xtechnical {
+
+    /** \brief Непрерывный участок памяти только для чтения
+     *
+     * Не владеет данными, используется для доступа к столбцам файла без копирования
+     */
+    template<class T>
+    class ConstSpan {
+    private:
+        const T *ptr = nullptr;
+        size_t length = 0;
+    public:
+        ConstSpan() {};
+
+        ConstSpan(const T *p, const size_t l) : ptr(p), length(l) {};
+
+        inline const T *data() const noexcept {return ptr;};
+        inline size_t size() const noexcept {return length;};
+        inline bool empty() const noexcept {return length == 0;};
+        inline const T *begin() const noexcept {return ptr;};
+        inline const T *end() const noexcept {return ptr + length;};
+        inline const T &operator[](const size_t index) const noexcept {return ptr[index];};
+
+        /** \brief Получить часть участка
+         * \param offset    Смещение
+         * \param count     Количество элементов
+         * \return Участок памяти
+         */
+        inline ConstSpan subspan(const size_t offset, const size_t count) const noexcept {
+            if (offset >= length) return ConstSpan(ptr + length, 0);
+            return ConstSpan(ptr + offset, std::min(count, length - offset));
+        }
+    };
+
+    /** \brief Файл, отображенный в память только для чтения
+     */
+    class MappedFile {
+    private:
+        const char *ptr = nullptr;
+        size_t length = 0;
+#       if defined(_WIN32)
+        HANDLE file = INVALID_HANDLE_VALUE;
+        HANDLE mapping = NULL;
+#       else
+        int fd = -1;
+#       endif
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile &operator=(const MappedFile&) = delete;
+
+    public:
+
+        MappedFile() {};
+
+        ~MappedFile() {
+            close();
+        }
+
+        /** \brief Открыть файл
+         * \param path  Путь к файлу
+         * \return Вернет true в случае успеха
+         */
+        bool open(const std::string &path) noexcept {
+            close();
+#           if defined(_WIN32)
+            file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+            if (file == INVALID_HANDLE_VALUE) return false;
+            LARGE_INTEGER file_size;
+            if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+                close();
+                return false;
+            }
+            mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+            if (mapping == NULL) {
+                close();
+                return false;
+            }
+            ptr = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            if (ptr == nullptr) {
+                close();
+                return false;
+            }
+            length = (size_t)file_size.QuadPart;
+#           else
+            fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) return false;
+            struct stat st;
+            if (fstat(fd, &st) != 0 || st.st_size == 0) {
+                close();
+                return false;
+            }
+            void *p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+            if (p == MAP_FAILED) {
+                close();
+                return false;
+            }
+            ptr = (const char*)p;
+            length = (size_t)st.st_size;
+            madvise(p, length, MADV_SEQUENTIAL);
+#           endif
+            return true;
+        }
+
+        /** \brief Закрыть файл
+         */
+        void close() noexcept {
+#           if defined(_WIN32)
+            if (ptr != nullptr) UnmapViewOfFile(ptr);
+            if (mapping != NULL) CloseHandle(mapping);
+            if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+            mapping = NULL;
+            file = INVALID_HANDLE_VALUE;
+#           else
+            if (ptr != nullptr) munmap((void*)ptr, length);
+            if (fd >= 0) ::close(fd);
+            fd = -1;
+#           endif
+            ptr = nullptr;
+            length = 0;
+        }
+
+        inline const char *data() const noexcept {return ptr;};
+        inline size_t size() const noexcept {return length;};
+        inline bool is_open() const noexcept {return ptr != nullptr;};
+    };
+
+    /** \brief Колоночный файл истории с записями фиксированного размера
+     *
+     * Формат файла (little-endian):
+     * - заголовок Header;
+     * - столбец меток времени uint64_t[count];
+     * - COLUMNS столбцов double[count];
+     * - разреженный индекс времени: метка каждой index_step-й записи.
+     * Каждый столбец выровнен на 64 байта, поэтому столбцы можно
+     * использовать напрямую из отображенной памяти.
+     * Метки времени должны идти по неубыванию.
+     */
+    template<size_t COLUMNS, uint32_t TYPE>
+    class ColumnFile {
+    public:
+
+        /** \brief Заголовок файла
+         */
+        class Header {
+        public:
+            char magic[8] = {'X','T','H','I','S','T','0','1'};
+            uint32_t type = TYPE;               /**< Тип данных (тики или бары) */
+            uint32_t columns = COLUMNS;         /**< Число столбцов double */
+            uint64_t count = 0;                 /**< Число записей */
+            uint64_t column_stride = 0;         /**< Расстояние между столбцами в байтах */
+            uint64_t data_offset = 0;           /**< Смещение столбца меток времени */
+            uint64_t index_offset = 0;          /**< Смещение индекса времени */
+            uint64_t index_step = 0;            /**< Шаг индекса времени в записях */
+            uint64_t index_count = 0;           /**< Число элементов индекса */
+        };
+
+        static const uint64_t ALIGNMENT = 64;
+        static const uint64_t DEFAULT_INDEX_STEP = 4096;
+
+        static inline uint64_t align(const uint64_t value) noexcept {
+            return (value + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+        }
+
+        /** \brief Записать файл
+         * \param path          Путь к файлу
+         * \param timestamps    Метки времени
+         * \param columns       Столбцы данных
+         * \param index_step    Шаг индекса времени
+         * \return Вернет true в случае успеха
+         */
+        static bool write(
+                const std::string &path,
+                const std::vector<uint64_t> &timestamps,
+                const std::array<std::vector<double>, COLUMNS> &columns,
+                const uint64_t index_step = DEFAULT_INDEX_STEP) noexcept {
+            const uint64_t count = timestamps.size();
+            for (size_t c = 0; c < COLUMNS; ++c) {
+                if (columns[c].size() != count) return false;
+            }
+            if (index_step == 0) return false;
+
+            Header header;
+            header.count = count;
+            header.column_stride = align(count * sizeof(uint64_t));
+            header.data_offset = align(sizeof(Header));
+            header.index_offset = header.data_offset + header.column_stride * (COLUMNS + 1);
+            header.index_step = index_step;
+            header.index_count = (count + index_step - 1) / index_step;
+
+            std::vector<uint64_t> index(header.index_count);
+            for (uint64_t i = 0; i < header.index_count; ++i) {
+                index[i] = timestamps[i * index_step];
+            }
+
+            FILE *file = std::fopen(path.c_str(), "wb");
+            if (file == nullptr) return false;
+            const std::vector<char> padding(ALIGNMENT, 0);
+            bool is_ok = std::fwrite(&header, sizeof(Header), 1, file) == 1;
+            auto write_padding = [&](const uint64_t written) {
+                const uint64_t pad = align(written) - written;
+                if (pad != 0 && is_ok) is_ok = std::fwrite(padding.data(), 1, pad, file) == pad;
+            };
+            write_padding(sizeof(Header));
+            if (is_ok && count != 0) is_ok = std::fwrite(timestamps.data(), sizeof(uint64_t), count, file) == count;
+            write_padding(count * sizeof(uint64_t));
+            for (size_t c = 0; c < COLUMNS; ++c) {
+                if (is_ok && count != 0) is_ok = std::fwrite(columns[c].data(), sizeof(double), count, file) == count;
+                write_padding(count * sizeof(double));
+            }
+            if (is_ok && !index.empty()) is_ok = std::fwrite(index.data(), sizeof(uint64_t), index.size(), file) == index.size();
+            if (std::fclose(file) != 0) is_ok = false;
+            return is_ok;
+        }
+
+    private:
+        MappedFile file;
+        Header header;
+        const uint64_t *timestamp_ptr = nullptr;
+        std::array<const double*, COLUMNS> column_ptr;
+        const uint64_t *index_ptr = nullptr;
+
+    public:
+
+        ColumnFile() {
+            column_ptr.fill(nullptr);
+        };
+
+        /** \brief Открыть файл
+         * \param path  Путь к файлу
+         * \return Вернет true в случае успеха
+         */
+        bool open(const std::string &path) noexcept {
+            close();
+            if (!file.open(path)) return false;
+            if (file.size() < sizeof(Header)) {
+                close();
+                return false;
+            }
+            std::memcpy(&header, file.data(), sizeof(Header));
+            const Header expected;
+            if (std::memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0 ||
+                header.type != TYPE ||
+                header.columns != COLUMNS ||
+                header.index_step == 0 ||
+                header.index_offset + header.index_count * sizeof(uint64_t) > file.size() ||
+                header.data_offset + header.column_stride * (COLUMNS + 1) > file.size() ||
+                header.count * sizeof(uint64_t) > header.column_stride) {
+                close();
+                return false;
+            }
+            timestamp_ptr = (const uint64_t*)(file.data() + header.data_offset);
+            for (size_t c = 0; c < COLUMNS; ++c) {
+                column_ptr[c] = (const double*)(file.data() + header.data_offset + header.column_stride * (c + 1));
+            }
+            index_ptr = (const uint64_t*)(file.data() + header.index_offset);
+            return true;
+        }
+
+        /** \brief Закрыть файл
+         */
+        void close() noexcept {
+            file.close();
+            header = Header();
+            timestamp_ptr = nullptr;
+            column_ptr.fill(nullptr);
+            index_ptr = nullptr;
+        }
+
+        inline bool is_open() const noexcept {
+            return file.is_open();
+        }
+
+        /** \brief Получить число записей
+         */
+        inline size_t size() const noexcept {
+            return (size_t)header.count;
+        }
+
+        /** \brief Получить столбец меток времени
+         */
+        inline ConstSpan<uint64_t> timestamps() const noexcept {
+            return ConstSpan<uint64_t>(timestamp_ptr, size());
+        }
+
+        /** \brief Получить столбец данных
+         * \param index Номер столбца
+         */
+        inline ConstSpan<double> column(const size_t index) const noexcept {
+            return ConstSpan<double>(column_ptr[index], size());
+        }
+
+        /** \brief Найти первую запись с меткой времени не меньше заданной
+         *
+         * Сначала бинарный поиск идет по разреженному индексу,
+         * затем внутри одного блока столбца меток времени.
+         * \param timestamp Метка времени
+         * \return Номер записи или size(), если такой записи нет
+         */
+        size_t find(const uint64_t timestamp) const noexcept {
+            if (size() == 0) return 0;
+            const uint64_t *index_end = index_ptr + header.index_count;
+            const uint64_t *it = std::lower_bound(index_ptr, index_end, timestamp);
+            // нужная запись лежит в блоке перед найденным элементом индекса
+            const size_t block = it == index_ptr ? 0 : (size_t)(it - index_ptr - 1);
+            const size_t begin = block * (size_t)header.index_step;
+            const size_t end = std::min(size(), begin + (size_t)header.index_step * 2);
+            return (size_t)(std::lower_bound(timestamp_ptr + begin, timestamp_ptr + end, timestamp) - timestamp_ptr);
+        }
+
+        /** \brief Найти диапазон записей по времени
+         * \param t_begin   Начальная метка времени (включительно)
+         * \param t_end     Конечная метка времени (не включительно)
+         * \return Пара номеров записей [first, second)
+         */
+        inline std::pair<size_t, size_t> find_range(const uint64_t t_begin, const uint64_t t_end) const noexcept {
+            const size_t begin = find(t_begin);
+            const size_t end = std::max(begin, find(t_end));
+            return std::make_pair(begin, end);
+        }
+    };
+
+    /** \brief Файл тиков: метка времени, bid, ask, объем
+     */
+    class TickFile : public ColumnFile<3, 1> {
+    public:
+        enum {
+            BID = 0,
+            ASK = 1,
+            VOLUME = 2,
+        };
+
+        inline ConstSpan<double> bid() const noexcept {return column(BID);};
+        inline ConstSpan<double> ask() const noexcept {return column(ASK);};
+        inline ConstSpan<double> volume() const noexcept {return column(VOLUME);};
+    };
+
+    /** \brief Файл баров: метка времени, open, high, low, close, объем
+     */
+    class BarFile : public ColumnFile<5, 2> {
+    public:
+        enum {
+            OPEN = 0,
+            HIGH = 1,
+            LOW = 2,
+            CLOSE = 3,
+            VOLUME = 4,
+        };
+
+        inline ConstSpan<double> open_price() const noexcept {return column(OPEN);};
+        inline ConstSpan<double> high() const noexcept {return column(HIGH);};
+        inline ConstSpan<double> low() const noexcept {return column(LOW);};
+        inline ConstSpan<double> close_price() const noexcept {return column(CLOSE);};
+        inline ConstSpan<double> volume() const noexcept {return column(VOLUME);};
+    };
+
+    /** \brief Буфер для записи файла тиков
+     *
+     * Данные накапливаются в памяти и записываются при вызове save()
+     */
+    class TickFileWriter {
+    private:
+        std::vector<uint64_t> timestamps;
+        std::array<std::vector<double>, 3> columns;
+    public:
+
+        TickFileWriter() {};
+
+        inline void reserve(const size_t count) noexcept {
+            timestamps.reserve(count);
+            for (auto &c : columns) c.reserve(count);
+        }
+
+        /** \brief Добавить тик
+         * \param timestamp Метка времени
+         * \param bid       Цена bid
+         * \param ask       Цена ask
+         * \param volume    Объем
+         */
+        inline void add(const uint64_t timestamp, const double bid, const double ask, const double volume = 0) noexcept {
+            timestamps.push_back(timestamp);
+            columns[TickFile::BID].push_back(bid);
+            columns[TickFile::ASK].push_back(ask);
+            columns[TickFile::VOLUME].push_back(volume);
+        }
+
+        /** \brief Записать файл
+         * \param path  Путь к файлу
+         * \return Вернет true в случае успеха
+         */
+        inline bool save(const std::string &path, const uint64_t index_step = TickFile::DEFAULT_INDEX_STEP) const noexcept {
+            return TickFile::write(path, timestamps, columns, index_step);
+        }
+
+        inline size_t size() const noexcept {
+            return timestamps.size();
+        }
+
+        inline void clear() noexcept {
+            timestamps.clear();
+            for (auto &c : columns) c.clear();
+        }
+    };
+
+    /** \brief Буфер для записи файла баров
+     *
+     * Данные накапливаются в памяти и записываются при вызове save()
+     */
+    class BarFileWriter {
+    private:
+        std::vector<uint64_t> timestamps;
+        std::array<std::vector<double>, 5> columns;
+    public:
+
+        BarFileWriter() {};
+
+        inline void reserve(const size_t count) noexcept {
+            timestamps.reserve(count);
+            for (auto &c : columns) c.reserve(count);
+        }
+
+        /** \brief Добавить бар
+         */
+        inline void add(
+                const uint64_t timestamp,
+                const double open,
+                const double high,
+                const double low,
+                const double close,
+                const double volume = 0) noexcept {
+            timestamps.push_back(timestamp);
+            columns[BarFile::OPEN].push_back(open);
+            columns[BarFile::HIGH].push_back(high);
+            columns[BarFile::LOW].push_back(low);
+            columns[BarFile::CLOSE].push_back(close);
+            columns[BarFile::VOLUME].push_back(volume);
+        }
+
+        /** \brief Записать файл
+         * \param path  Путь к файлу
+         * \return Вернет true в случае успеха
+         */
+        inline bool save(const std::string &path, const uint64_t index_step = BarFile::DEFAULT_INDEX_STEP) const noexcept {
+            return BarFile::write(path, timestamps, columns, index_step);
+        }
+
+        inline size_t size() const noexcept {
+            return timestamps.size();
+        }
+
+        inline void clear() noexcept {
+            timestamps.clear();
+            for (auto &c : columns) c.clear();
+        }
+    };
+
+    /** \brief Воспроизвести тики
+     *
+     * Функция sink вызывается как sink(timestamp, bid, ask, volume)
+     * \param file      Файл тиков
+     * \param sink      Приемник тиков
+     * \param begin     Номер первой записи
+     * \param end       Номер записи после последней
+     */
+    template<class SINK>
+    void replay_ticks(const TickFile &file, SINK &&sink, size_t begin = 0, size_t end = std::numeric_limits<size_t>::max()) {
+        end = std::min(end, file.size());
+        const uint64_t *timestamp = file.timestamps().data();
+        const double *bid = file.bid().data();
+        const double *ask = file.ask().data();
+        const double *volume = file.volume().data();
+        for (size_t i = begin; i < end; ++i) {
+            sink(timestamp[i], bid[i], ask[i], volume[i]);
+        }
+    }
+
+    /** \brief Воспроизвести бары
+     *
+     * Функция sink вызывается как sink(timestamp, open, high, low, close, volume)
+     * \param file      Файл баров
+     * \param sink      Приемник баров
+     * \param begin     Номер первой записи
+     * \param end       Номер записи после последней
+     */
+    template<class SINK>
+    void replay_bars(const BarFile &file, SINK &&sink, size_t begin = 0, size_t end = std::numeric_limits<size_t>::max()) {
+        end = std::min(end, file.size());
+        const uint64_t *timestamp = file.timestamps().data();
+        const double *o = file.open_price().data();
+        const double *h = file.high().data();
+        const double *l = file.low().data();
+        const double *c = file.close_price().data();
+        const double *v = file.volume().data();
+        for (size_t i = begin; i < end; ++i) {
+            sink(timestamp[i], o[i], h[i], l[i], c[i], v[i]);
+        }
+    }
+
+    /** \brief Приемник тиков для формирователей баров
+     *
+     * Передает среднюю цену (bid + ask) / 2 в метод update(price, timestamp),
+     * подходит для BarShaperV1 и ClusterShaper. Метка времени делится на divider,
+     * например 1000 для перевода миллисекунд в секунды.
+     */
+    template<class SHAPER>
+    class MidPriceSink {
+    private:
+        SHAPER &shaper;
+        uint64_t divider = 1;
+    public:
+        MidPriceSink(SHAPER &s, const uint64_t d = 1) : shaper(s), divider(d) {};
+
+        inline void operator()(const uint64_t timestamp, const double bid, const double ask, const double) {
+            shaper.update((bid + ask) / 2.0, timestamp / divider);
+        }
+    };
+
+    template<class SHAPER>
+    inline MidPriceSink<SHAPER> make_mid_price_sink(SHAPER &shaper, const uint64_t divider = 1) {
+        return MidPriceSink<SHAPER>(shaper, divider);
+    }
+
+    /** \brief Приемник тиков для WinrateStats
+     */
+    template<class STATS>
+    class WinrateSink {
+    private:
+        STATS &stats;
+        size_t handle = 0;
+    public:
+        WinrateSink(STATS &s, const size_t h) : stats(s), handle(h) {};
+
+        inline void operator()(const uint64_t timestamp, const double bid, const double ask, const double) {
+            stats.update(handle, bid, ask, timestamp);
+        }
+    };
+
+    template<class STATS>
+    inline WinrateSink<STATS> make_winrate_sink(STATS &stats, const size_t handle) {
+        return WinrateSink<STATS>(stats, handle);
+    }
+
+    /** \brief Приемник баров для индикаторов с методом update(close)
+     */
+    template<class INDICATOR>
+    class ClosePriceSink {
+    private:
+        INDICATOR &indicator;
+    public:
+        ClosePriceSink(INDICATOR &i) : indicator(i) {};
+
+        inline void operator()(
+                const uint64_t,
+                const double,
+                const double,
+                const double,
+                const double close,
+                const double) {
+            indicator.update(close);
+        }
+    };
+
+    template<class INDICATOR>
+    inline ClosePriceSink<INDICATOR> make_close_price_sink(INDICATOR &indicator) {
+        return ClosePriceSink<INDICATOR>(indicator);
+    }
+};
+
+#endif // XTECHNICAL_HISTORY_FILE_HPP_INCLUDED
@@ -0,0 +1,369 @@
+#ifndef XTECHNICAL_REPLAY_RUNNER_HPP_INCLUDED
+#define XTECHNICAL_REPLAY_RUNNER_HPP_INCLUDED
+
+#include "../xtechnical_indicators.hpp"
+#include "xtechnical_winrate_statistics.hpp"
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <future>
+#include <thread>
+#include <exception>
+#include <algorithm>
+#include <functional>
+#include <cstdint>
+
+namespace xtechnical {
+
+    /** \brief Пул потоков с перехватом задач
+     *
+     * Задачи - номера от 0 до count - 1. Перед запуском они делятся
+     * на равные непрерывные части по очередям потоков. Поток берет задачи
+     * из начала своей очереди, а когда она пуста - забирает задачи
+     * с конца очередей других потоков. Новые задачи в процессе работы
+     * не появляются, поэтому поток завершается, когда пусты все очереди.
+     * Нулевой поток - вызывающий.
+     */
+    class WorkStealingPool {
+    private:
+
+        class Queue {
+        public:
+            std::mutex mutex;
+            std::deque<size_t> tasks;
+        };
+
+        static bool pop(Queue &queue, size_t &task) {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.tasks.empty()) return false;
+            task = queue.tasks.front();
+            queue.tasks.pop_front();
+            return true;
+        }
+
+        static bool steal(Queue &queue, size_t &task) {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.tasks.empty()) return false;
+            task = queue.tasks.back();
+            queue.tasks.pop_back();
+            return true;
+        }
+
+    public:
+
+        /** \brief Выполнить задачи
+         *
+         * Функция func вызывается как func(task, worker) и должна допускать
+         * одновременный вызов из разных потоков. Исключение, брошенное
+         * в любом потоке, передается вызывающему после завершения всех потоков.
+         * \param count         Число задач
+         * \param num_threads   Число потоков, 0 - по числу ядер процессора
+         * \param func          Функция задачи
+         */
+        template<class F>
+        static void run(const size_t count, size_t num_threads, F &&func) {
+            if (count == 0) return;
+            if (num_threads == 0) num_threads = std::max((unsigned)1, std::thread::hardware_concurrency());
+            const size_t threads = std::min(num_threads, count);
+            std::vector<Queue> queues(threads);
+            for (size_t w = 0; w < threads; ++w) {
+                const size_t first = count * w / threads;
+                const size_t last = count * (w + 1) / threads;
+                for (size_t i = first; i < last; ++i) queues[w].tasks.push_back(i);
+            }
+
+            auto worker = [&queues, &func, threads](const size_t w) {
+                size_t task = 0;
+                for (;;) {
+                    if (pop(queues[w], task)) {
+                        func(task, w);
+                        continue;
+                    }
+                    bool is_stolen = false;
+                    for (size_t k = 1; k < threads && !is_stolen; ++k) {
+                        is_stolen = steal(queues[(w + k) % threads], task);
+                    }
+                    if (!is_stolen) return;
+                    func(task, w);
+                }
+            };
+
+            std::vector<std::future<void>> futures;
+            for (size_t w = 1; w < threads; ++w) {
+                futures.push_back(std::async(std::launch::async, worker, w));
+            }
+            std::exception_ptr error;
+            try {
+                worker(0);
+            } catch(...) {
+                error = std::current_exception();
+            }
+            for (auto &f : futures) {
+                try {
+                    f.get();
+                } catch(...) {
+                    if (!error) error = std::current_exception();
+                }
+            }
+            if (error) std::rethrow_exception(error);
+        }
+    };
+
+    /** \brief Параллельный прогон стратегии по множеству символов
+     *
+     * Каждый символ обрабатывается отдельным шардом, который владеет
+     * своим формирователем баров BarShaperV1, стратегией STRATEGY
+     * (индикаторы и состояние пользователя) и статистикой WinrateStats.
+     * Шарды не делят состояние, поэтому распределяются по потокам пулом
+     * с перехватом задач. Итоги шардов объединяются после завершения всех
+     * потоков в порядке символов, а функции обратного вызова on_win, on_loss
+     * и on_error вызываются в вызывающем потоке в том же порядке.
+     * Результат не зависит от числа потоков.
+     *
+     * Пример:
+     * \code
+     * ReplayRunner<MyStrategy> runner;
+     * runner.config.bar_period = 60;
+     * runner.config.divider = 1000;
+     * runner.run(symbols, [](ReplayRunner<MyStrategy>::Shard &shard) {
+     *     shard.shaper.on_close_bar = [&shard](const ReplayRunner<MyStrategy>::Bar &bar) {
+     *         shard.strategy.rsi.update(bar.close);
+     *         if (shard.strategy.rsi.get() > 70) shard.place_bet(bar.timestamp * 1000, -1);
+     *     };
+     * }, [&](ReplayRunner<MyStrategy>::Shard &shard) {
+     *     archives[shard.index].replay(shard);
+     * }, 0);
+     * \endcode
+     */
+    template<class STRATEGY, class T = double, class BET_DATA = int>
+    class ReplayRunner {
+    public:
+        typedef WinrateStats<BET_DATA> Stats;
+        typedef typename Stats::Bet Bet;
+        typedef typename BarShaperV1<T>::Bar Bar;
+
+        /** \brief Класс конфигурации
+         */
+        class Config {
+        public:
+            uint64_t bar_period = 60;       /**< Период баров в единицах timestamp / divider */
+            uint64_t divider = 1000;        /**< Делитель метки времени тика для формирователя баров */
+            bool is_open_equal_prev_close = false;  /**< Флаг BarShaperV1, цена открытия равна цене закрытия предыдущего бара */
+            bool is_use_bar_stop_time = false;      /**< Флаг BarShaperV1, время бара - время его окончания */
+            bool is_fill = false;                   /**< Флаг BarShaperV1, заполнение пропущенных баров */
+            uint64_t expiration = 60000;    /**< Экспирация ставок */
+            uint64_t delay = 150;           /**< Задержка ставок */
+            uint64_t period = 0;            /**< Период ставок в миллисекундах */
+            uint64_t between_ticks = 20000; /**< Задержка между тиками */
+        } config;
+
+        /** \brief Итог ставки
+         */
+        enum class BetResult {
+            WIN,
+            LOSS,
+            FAILED, /**< Ошибка сделки, см. WinrateStats::Config::on_error */
+        };
+
+        /** \brief Записанный итог ставки
+         */
+        class Outcome {
+        public:
+            Bet bet;
+            BetResult result = BetResult::FAILED;
+
+            Outcome() {};
+
+            Outcome(const Bet &b, const BetResult r) :
+                bet(b), result(r) {
+            }
+        };
+
+        /** \brief Итоги символа
+         */
+        class Result {
+        public:
+            std::string symbol;
+            uint64_t wins = 0;
+            uint64_t losses = 0;
+            uint64_t errors = 0;
+            std::vector<Outcome> outcomes;  /**< Итоги ставок в порядке закрытия, если заданы функции обратного вызова */
+        };
+
+        /** \brief Шард символа
+         *
+         * Создается в рабочем потоке и живет до конца прогона символа.
+         * Шард является приемником тиков sink(timestamp, bid, ask, volume),
+         * поэтому его можно передать в replay_ticks или TickArchive::replay.
+         */
+        class Shard {
+        private:
+            Result &result;
+            size_t handle = 0;
+            uint64_t divider = 1;
+
+        public:
+            const size_t index;         /**< Номер символа */
+            const std::string &symbol;  /**< Символ */
+            BarShaperV1<T> shaper;      /**< Формирователь баров */
+            STRATEGY strategy;          /**< Индикаторы и состояние стратегии */
+            Stats stats;                /**< Статистика ставок символа */
+
+            Shard(const size_t i, const Config &c, const bool is_record, Result &r) :
+                    result(r),
+                    divider(std::max(c.divider, (uint64_t)1)),
+                    index(i),
+                    symbol(r.symbol),
+                    shaper(c.bar_period, c.is_open_equal_prev_close, c.is_use_bar_stop_time, c.is_fill) {
+                stats.config.expiration = c.expiration;
+                stats.config.delay = c.delay;
+                stats.config.period = c.period;
+                stats.config.between_ticks = c.between_ticks;
+                handle = stats.get_handle(std::string(), symbol);
+                stats.config.on_error = [this, is_record](const Bet &bet) {
+                    ++result.errors;
+                    if (is_record) result.outcomes.push_back(Outcome(bet, BetResult::FAILED));
+                };
+                if (!is_record) return;
+                stats.config.on_win = [this](const Bet &bet) {
+                    result.outcomes.push_back(Outcome(bet, BetResult::WIN));
+                };
+                stats.config.on_loss = [this](const Bet &bet) {
+                    result.outcomes.push_back(Outcome(bet, BetResult::LOSS));
+                };
+            }
+
+            Shard(const Shard&) = delete;
+            Shard &operator=(const Shard&) = delete;
+
+            /** \brief Обновить состояние шарда
+             *
+             * Сначала обновляются ставки, затем формирователь баров,
+             * поэтому ставка из on_close_bar открывается по цене этого тика.
+             * \param bid       Цена bid
+             * \param ask       Цена ask
+             * \param timestamp Метка времени в миллисекундах
+             */
+            inline void update(const double bid, const double ask, const uint64_t timestamp) {
+                stats.update(handle, bid, ask, timestamp);
+                shaper.update((T)((bid + ask) / 2.0), timestamp / divider);
+            }
+
+            /** \brief Приемник тиков для replay_ticks и TickArchive::replay, объем не используется
+             */
+            inline void operator()(const uint64_t timestamp, const double bid, const double ask, const double) {
+                update(bid, ask, timestamp);
+            }
+
+            /** \brief Сделать ставку
+             * \param timestamp     Метка времени в миллисекундах
+             * \param direction     Направление, 1 - BUY, -1 - SELL
+             * \param callback      Функция обратного вызова для передачи структуры ставки
+             */
+            inline void place_bet(
+                    const uint64_t timestamp,
+                    const int direction,
+                    std::function<void(Bet &bet)> callback = nullptr) {
+                const std::string &s = symbol;
+                stats.place_bet(handle, timestamp, direction, [&](Bet &bet) {
+                    bet.symbol = s;
+                    if (callback != nullptr) callback(bet);
+                });
+            }
+        };
+
+    private:
+        std::vector<Result> results;
+
+    public:
+
+        std::function<void(const Bet &bet)> on_error = nullptr; /**< Ошибка ставки, вызывается после прогона */
+        std::function<void(const Bet &bet)> on_win = nullptr;   /**< Удачная ставка, вызывается после прогона */
+        std::function<void(const Bet &bet)> on_loss = nullptr;  /**< Убыточная ставка, вызывается после прогона */
+
+        uint64_t wins = 0;      /**< Число удачных сделок по всем символам */
+        uint64_t losses = 0;    /**< Число убыточных сделок по всем символам */
+        uint64_t errors = 0;    /**< Число ошибок сделок по всем символам */
+
+        ReplayRunner() {};
+
+        /** \brief Прогнать символы
+         *
+         * Функции init(shard) и replay(shard) вызываются в рабочих потоках
+         * для каждого символа и не должны менять общее состояние без синхронизации.
+         * init настраивает стратегию и shaper.on_close_bar, replay передает
+         * тики символа в shard.update или shard(timestamp, bid, ask, volume).
+         * \param symbols       Символы
+         * \param init          Функция настройки шарда
+         * \param replay        Функция воспроизведения тиков символа
+         * \param num_threads   Число потоков, 0 - по числу ядер процессора
+         */
+        template<class INIT, class REPLAY>
+        void run(
+                const std::vector<std::string> &symbols,
+                INIT &&init,
+                REPLAY &&replay,
+                const size_t num_threads = 1) {
+            clear();
+            results.resize(symbols.size());
+            for (size_t i = 0; i < symbols.size(); ++i) {
+                results[i].symbol = symbols[i];
+            }
+            const bool is_record = on_win != nullptr || on_loss != nullptr || on_error != nullptr;
+            WorkStealingPool::run(symbols.size(), num_threads, [&](const size_t i, const size_t) {
+                Shard shard(i, config, is_record, results[i]);
+                init(shard);
+                replay(shard);
+                results[i].wins = shard.stats.wins;
+                results[i].losses = shard.stats.losses;
+            });
+
+            // объединение в порядке символов не зависит от порядка выполнения
+            for (auto &result : results) {
+                for (const Outcome &outcome : result.outcomes) {
+                    switch (outcome.result) {
+                    case BetResult::WIN:
+                        if (on_win != nullptr) on_win(outcome.bet);
+                        break;
+                    case BetResult::LOSS:
+                        if (on_loss != nullptr) on_loss(outcome.bet);
+                        break;
+                    case BetResult::FAILED:
+                        if (on_error != nullptr) on_error(outcome.bet);
+                        break;
+                    };
+                }
+                wins += result.wins;
+                losses += result.losses;
+                errors += result.errors;
+            }
+        }
+
+        /** \brief Получить итоги символов в порядке списка символов
+         */
+        inline const std::vector<Result> &get_results() const noexcept {
+            return results;
+        }
+
+        /** \brief Получить винрейт по всем символам
+         */
+        inline double get_winrate() const noexcept {
+            const uint64_t deals = wins + losses;
+            return deals == 0 ? 0 : (double)wins / (double)deals;
+        }
+
+        /** \brief Получить число сделок по всем символам
+         */
+        inline uint64_t get_deals() const noexcept {
+            return wins + losses;
+        }
+
+        void clear() noexcept {
+            results.clear();
+            wins = losses = errors = 0;
+        }
+    };
+};
+
+#endif // XTECHNICAL_REPLAY_RUNNER_HPP_INCLUDED
@@ -0,0 +1,563 @@
+#ifndef XTECHNICAL_TICK_ARCHIVE_HPP_INCLUDED
+#define XTECHNICAL_TICK_ARCHIVE_HPP_INCLUDED
+
+#include "xtechnical_history_file.hpp"
+#include <future>
+#include <deque>
+#include <cmath>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace xtechnical {
+
+    /** \brief Кодирование целых чисел для архива тиков
+     */
+    namespace archive {
+
+        /** \brief Заголовок архива
+         */
+        class Header {
+        public:
+            char magic[8] = {'X','T','A','R','C','H','0','1'};
+            uint32_t version = 1;
+            uint32_t block_size = 0;    /**< Максимальное число тиков в блоке */
+            double pips_size = 0;       /**< Размер пункта цены */
+            double volume_step = 0;     /**< Шаг объема */
+            uint64_t count = 0;         /**< Число тиков */
+            uint64_t block_count = 0;   /**< Число блоков */
+            uint64_t index_offset = 0;  /**< Смещение индекса блоков */
+        };
+
+        /** \brief Элемент индекса блоков
+         */
+        class BlockInfo {
+        public:
+            uint64_t offset = 0;            /**< Смещение блока в файле */
+            uint64_t first_tick = 0;        /**< Номер первого тика блока */
+            uint64_t first_timestamp = 0;   /**< Метка времени первого тика */
+            uint64_t last_timestamp = 0;    /**< Метка времени последнего тика */
+            uint32_t count = 0;             /**< Число тиков в блоке */
+            uint32_t size = 0;              /**< Размер блока в байтах */
+        };
+
+        /** \brief Заголовок блока
+         *
+         * За заголовком идут потоки varint: метки времени (delta-of-delta),
+         * bid (разность в пунктах), спред (разность в пунктах), объем (разность в шагах)
+         * и PADDING нулевых байт, чтобы декодер мог читать по 8 байт без проверок.
+         */
+        class BlockHeader {
+        public:
+            uint32_t count = 0;
+            uint32_t timestamp_bytes = 0;
+            uint32_t bid_bytes = 0;
+            uint32_t spread_bytes = 0;
+            uint32_t volume_bytes = 0;
+            uint32_t reserved = 0;
+        };
+
+        static const size_t PADDING = 8;
+
+        inline uint64_t zigzag_encode(const int64_t value) noexcept {
+            return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+        }
+
+        inline int64_t zigzag_decode(const uint64_t value) noexcept {
+            return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+        }
+
+        /** \brief Число младших нулевых бит, value не равно 0
+         */
+        inline unsigned count_trailing_zeros(const uint64_t value) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+            return (unsigned)__builtin_ctzll(value);
+#elif defined(_MSC_VER) && defined(_M_X64)
+            unsigned long bit = 0;
+            _BitScanForward64(&bit, value);
+            return (unsigned)bit;
+#else
+            unsigned bit = 0;
+            while (((value >> bit) & 1) == 0) ++bit;
+            return bit;
+#endif
+        }
+
+        inline void write_varint(std::vector<uint8_t> &out, uint64_t value) {
+            while (value >= 0x80) {
+                out.push_back((uint8_t)(value | 0x80));
+                value >>= 7;
+            }
+            out.push_back((uint8_t)value);
+        }
+
+        /** \brief Прочитать varint
+         *
+         * Однобайтовые числа (самый частый случай для разностей) читаются сразу.
+         * Числа до 8 байт (56 бит) читаются одним словом без цикла по байтам:
+         * длина находится по первому байту без старшего бита, затем 7-битные группы
+         * сжимаются сдвигами. Требует 8 доступных байт после ptr.
+         * Читает не более 10 байт, даже если данные повреждены.
+         */
+        inline uint64_t read_varint(const uint8_t *&ptr) noexcept {
+            if ((ptr[0] & 0x80) == 0) return *ptr++;
+            uint64_t word;
+            std::memcpy(&word, ptr, sizeof(word));
+            const uint64_t stop = ~word & 0x8080808080808080ULL;
+            if (stop != 0) {
+                const unsigned bits = count_trailing_zeros(stop) + 1;
+                ptr += bits >> 3;
+                uint64_t x = word & (bits == 64 ? ~0ULL : ((1ULL << bits) - 1)) & 0x7F7F7F7F7F7F7F7FULL;
+                x = (x & 0x007F007F007F007FULL) | ((x & 0x7F007F007F007F00ULL) >> 1);
+                x = (x & 0x00003FFF00003FFFULL) | ((x & 0x3FFF00003FFF0000ULL) >> 2);
+                x = (x & 0x000000000FFFFFFFULL) | ((x & 0x0FFFFFFF00000000ULL) >> 4);
+                return x;
+            }
+            // более 8 байт
+            uint64_t value = 0;
+            unsigned shift = 0;
+            while (true) {
+                const uint8_t b = *ptr++;
+                value |= (uint64_t)(b & 0x7F) << shift;
+                if ((b & 0x80) == 0 || shift >= 63) break;
+                shift += 7;
+            }
+            return value;
+        }
+    };
+
+    /** \brief Данные одного блока тиков
+     */
+    class TickBlock {
+    public:
+        std::vector<uint64_t> timestamp;
+        std::vector<double> bid;
+        std::vector<double> ask;
+        std::vector<double> volume;
+
+        inline void resize(const size_t size) {
+            timestamp.resize(size);
+            bid.resize(size);
+            ask.resize(size);
+            volume.resize(size);
+        }
+
+        inline size_t size() const noexcept {
+            return timestamp.size();
+        }
+    };
+
+    /** \brief Запись сжатого архива тиков
+     *
+     * Тики копятся до block_size штук и сбрасываются в файл блоками,
+     * каждый блок декодируется независимо. Цены хранятся в целых пунктах
+     * pips_size, поэтому должны быть кратны размеру пункта.
+     */
+    class TickArchiveWriter {
+    private:
+        FILE *file = nullptr;
+        archive::Header header;
+        std::vector<archive::BlockInfo> index;
+        uint64_t offset = 0;
+        double inv_pips_size = 0;
+        double inv_volume_step = 0;
+
+        std::vector<uint64_t> timestamps;
+        std::vector<int64_t> bids;
+        std::vector<int64_t> spreads;
+        std::vector<int64_t> volumes;
+        std::vector<uint8_t> buffer[4];
+        std::vector<uint8_t> block;
+        bool is_error = false;
+
+        inline bool write(const void *data, const size_t size) noexcept {
+            if (is_error) return false;
+            if (size != 0 && std::fwrite(data, 1, size, file) != size) is_error = true;
+            offset += size;
+            return !is_error;
+        }
+
+        void flush() noexcept {
+            if (timestamps.empty()) return;
+            for (auto &b : buffer) b.clear();
+            int64_t prev_timestamp = 0, prev_delta = 0, prev_bid = 0, prev_spread = 0, prev_volume = 0;
+            for (size_t i = 0; i < timestamps.size(); ++i) {
+                const int64_t delta = (int64_t)timestamps[i] - prev_timestamp;
+                archive::write_varint(buffer[0], archive::zigzag_encode(delta - prev_delta));
+                prev_timestamp = (int64_t)timestamps[i];
+                prev_delta = delta;
+                archive::write_varint(buffer[1], archive::zigzag_encode(bids[i] - prev_bid));
+                prev_bid = bids[i];
+                archive::write_varint(buffer[2], archive::zigzag_encode(spreads[i] - prev_spread));
+                prev_spread = spreads[i];
+                archive::write_varint(buffer[3], archive::zigzag_encode(volumes[i] - prev_volume));
+                prev_volume = volumes[i];
+            }
+
+            archive::BlockHeader block_header;
+            block_header.count = (uint32_t)timestamps.size();
+            block_header.timestamp_bytes = (uint32_t)buffer[0].size();
+            block_header.bid_bytes = (uint32_t)buffer[1].size();
+            block_header.spread_bytes = (uint32_t)buffer[2].size();
+            block_header.volume_bytes = (uint32_t)buffer[3].size();
+
+            block.resize(sizeof(block_header));
+            std::memcpy(block.data(), &block_header, sizeof(block_header));
+            for (auto &b : buffer) block.insert(block.end(), b.begin(), b.end());
+            block.insert(block.end(), archive::PADDING, 0);
+
+            archive::BlockInfo info;
+            info.offset = offset;
+            info.first_tick = header.count;
+            info.first_timestamp = timestamps.front();
+            info.last_timestamp = timestamps.back();
+            info.count = block_header.count;
+            info.size = (uint32_t)block.size();
+            index.push_back(info);
+
+            write(block.data(), block.size());
+            header.count += timestamps.size();
+            timestamps.clear();
+            bids.clear();
+            spreads.clear();
+            volumes.clear();
+        }
+
+    public:
+
+        TickArchiveWriter() {};
+
+        ~TickArchiveWriter() {
+            close();
+        }
+
+        /** \brief Открыть архив для записи
+         * \param path          Путь к файлу
+         * \param pips_size     Размер пункта цены, например 0.00001
+         * \param block_size    Число тиков в блоке
+         * \param volume_step   Шаг объема
+         * \return Вернет true в случае успеха
+         */
+        bool open(
+                const std::string &path,
+                const double pips_size,
+                const uint32_t block_size = 65536,
+                const double volume_step = 1.0) noexcept {
+            close();
+            if (pips_size <= 0 || volume_step <= 0 || block_size == 0) return false;
+            file = std::fopen(path.c_str(), "wb");
+            if (file == nullptr) return false;
+            header = archive::Header();
+            header.block_size = block_size;
+            header.pips_size = pips_size;
+            header.volume_step = volume_step;
+            inv_pips_size = 1.0 / pips_size;
+            inv_volume_step = 1.0 / volume_step;
+            index.clear();
+            offset = 0;
+            is_error = false;
+            timestamps.reserve(block_size);
+            bids.reserve(block_size);
+            spreads.reserve(block_size);
+            volumes.reserve(block_size);
+            return write(&header, sizeof(header));
+        }
+
+        /** \brief Добавить тик
+         * \param timestamp Метка времени
+         * \param bid       Цена bid
+         * \param ask       Цена ask
+         * \param volume    Объем
+         */
+        inline void add(const uint64_t timestamp, const double bid, const double ask, const double volume = 0) noexcept {
+            if (file == nullptr) return;
+            const int64_t bid_pips = std::llround(bid * inv_pips_size);
+            timestamps.push_back(timestamp);
+            bids.push_back(bid_pips);
+            spreads.push_back(std::llround(ask * inv_pips_size) - bid_pips);
+            volumes.push_back(std::llround(volume * inv_volume_step));
+            if (timestamps.size() >= header.block_size) flush();
+        }
+
+        /** \brief Добавить все тики из файла тиков
+         * \param tick_file Файл тиков
+         */
+        void add(const TickFile &tick_file) noexcept {
+            replay_ticks(tick_file, [&](const uint64_t t, const double bid, const double ask, const double volume) {
+                add(t, bid, ask, volume);
+            });
+        }
+
+        /** \brief Завершить запись архива
+         * \return Вернет true в случае успеха
+         */
+        bool close() noexcept {
+            if (file == nullptr) return false;
+            flush();
+            header.block_count = index.size();
+            header.index_offset = offset;
+            if (!index.empty()) write(index.data(), index.size() * sizeof(archive::BlockInfo));
+            if (!is_error) {
+                if (std::fseek(file, 0, SEEK_SET) != 0 ||
+                    std::fwrite(&header, sizeof(header), 1, file) != 1) is_error = true;
+            }
+            if (std::fclose(file) != 0) is_error = true;
+            file = nullptr;
+            return !is_error;
+        }
+    };
+
+    /** \brief Чтение сжатого архива тиков
+     *
+     * Архив отображается в память, блоки декодируются независимо,
+     * поэтому декодирование можно вести параллельно.
+     */
+    class TickArchive {
+    private:
+        MappedFile file;
+        archive::Header header;
+        std::vector<archive::BlockInfo> index;
+
+    public:
+
+        TickArchive() {};
+
+        /** \brief Открыть архив
+         * \param path  Путь к файлу
+         * \return Вернет true в случае успеха
+         */
+        bool open(const std::string &path) noexcept {
+            close();
+            if (!file.open(path)) return false;
+            if (file.size() < sizeof(archive::Header)) {
+                close();
+                return false;
+            }
+            std::memcpy(&header, file.data(), sizeof(header));
+            const archive::Header expected;
+            if (std::memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0 ||
+                header.version != expected.version ||
+                header.index_offset > file.size() ||
+                header.block_count > (file.size() - header.index_offset) / sizeof(archive::BlockInfo)) {
+                close();
+                return false;
+            }
+            /* смещение индекса не выровнено, поэтому элементы копируются */
+            index.resize((size_t)header.block_count);
+            if (!index.empty()) {
+                std::memcpy(index.data(), file.data() + header.index_offset, index.size() * sizeof(archive::BlockInfo));
+            }
+            /* блок должен лежать до индекса, его заголовок - совпадать с индексом,
+             * а потоки вместе с PADDING - помещаться в блок, иначе декодер
+             * выйдет за массивы размера get_block_info(block).count или за файл
+             */
+            for (size_t i = 0; i < header.block_count; ++i) {
+                const archive::BlockInfo &info = index[i];
+                if (info.offset > header.index_offset ||
+                    info.size > header.index_offset - info.offset ||
+                    info.size < sizeof(archive::BlockHeader) ||
+                    info.first_tick > header.count ||
+                    info.count > header.count - info.first_tick) {
+                    close();
+                    return false;
+                }
+                archive::BlockHeader block_header;
+                std::memcpy(&block_header, file.data() + info.offset, sizeof(block_header));
+                const uint64_t stream_bytes =
+                    (uint64_t)block_header.timestamp_bytes +
+                    (uint64_t)block_header.bid_bytes +
+                    (uint64_t)block_header.spread_bytes +
+                    (uint64_t)block_header.volume_bytes;
+                if (block_header.count != info.count ||
+                    sizeof(archive::BlockHeader) + stream_bytes + archive::PADDING > info.size) {
+                    close();
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        void close() noexcept {
+            file.close();
+            header = archive::Header();
+            index.clear();
+        }
+
+        inline bool is_open() const noexcept {
+            return file.is_open();
+        }
+
+        /** \brief Получить число тиков
+         */
+        inline size_t size() const noexcept {
+            return (size_t)header.count;
+        }
+
+        /** \brief Получить число блоков
+         */
+        inline size_t block_count() const noexcept {
+            return (size_t)header.block_count;
+        }
+
+        /** \brief Получить описание блока
+         */
+        inline const archive::BlockInfo &get_block_info(const size_t block) const noexcept {
+            return index[block];
+        }
+
+        inline double get_pips_size() const noexcept {
+            return header.pips_size;
+        }
+
+        /** \brief Найти первый блок, который может содержать метку времени
+         * \param timestamp Метка времени
+         * \return Номер блока или block_count()
+         */
+        size_t find_block(const uint64_t timestamp) const noexcept {
+            size_t lo = 0, hi = block_count();
+            while (lo < hi) {
+                const size_t mid = (lo + hi) / 2;
+                if (index[mid].last_timestamp < timestamp) lo = mid + 1;
+                else hi = mid;
+            }
+            return lo;
+        }
+
+        /** \brief Декодировать блок в массивы
+         *
+         * Массивы должны вмещать get_block_info(block).count элементов.
+         * Чтение каждого потока ограничено его размером из заголовка блока:
+         * если поврежденный поток закончился раньше, остальные значения
+         * повторяют последнее декодированное.
+         * \param block     Номер блока
+         * \param timestamp Метки времени
+         * \param bid       Цены bid
+         * \param ask       Цены ask
+         * \param volume    Объемы
+         */
+        void decode_block(
+                const size_t block,
+                uint64_t *timestamp,
+                double *bid,
+                double *ask,
+                double *volume) const noexcept {
+            const uint8_t *data = (const uint8_t*)file.data() + index[block].offset;
+            archive::BlockHeader block_header;
+            std::memcpy(&block_header, data, sizeof(block_header));
+            const uint8_t *ptr_timestamp = data + sizeof(block_header);
+            const uint8_t *ptr_bid = ptr_timestamp + block_header.timestamp_bytes;
+            const uint8_t *ptr_spread = ptr_bid + block_header.bid_bytes;
+            const uint8_t *ptr_volume = ptr_spread + block_header.spread_bytes;
+            const uint8_t *end_timestamp = ptr_bid;
+            const uint8_t *end_bid = ptr_spread;
+            const uint8_t *end_spread = ptr_volume;
+            const uint8_t *end_volume = ptr_volume + block_header.volume_bytes;
+            const size_t count = block_header.count;
+
+            int64_t t = 0, delta = 0;
+            for (size_t i = 0; i < count; ++i) {
+                if (ptr_timestamp < end_timestamp) {
+                    delta += archive::zigzag_decode(archive::read_varint(ptr_timestamp));
+                    t += delta;
+                }
+                timestamp[i] = (uint64_t)t;
+            }
+            const double pips_size = header.pips_size;
+            int64_t b = 0, s = 0;
+            for (size_t i = 0; i < count; ++i) {
+                if (ptr_bid < end_bid) b += archive::zigzag_decode(archive::read_varint(ptr_bid));
+                if (ptr_spread < end_spread) s += archive::zigzag_decode(archive::read_varint(ptr_spread));
+                bid[i] = (double)b * pips_size;
+                ask[i] = (double)(b + s) * pips_size;
+            }
+            const double volume_step = header.volume_step;
+            int64_t v = 0;
+            for (size_t i = 0; i < count; ++i) {
+                if (ptr_volume < end_volume) v += archive::zigzag_decode(archive::read_varint(ptr_volume));
+                volume[i] = (double)v * volume_step;
+            }
+        }
+
+        /** \brief Декодировать блок
+         * \param block     Номер блока
+         * \param out       Данные блока
+         */
+        void decode_block(const size_t block, TickBlock &out) const {
+            out.resize(index[block].count);
+            decode_block(block, out.timestamp.data(), out.bid.data(), out.ask.data(), out.volume.data());
+        }
+
+        /** \brief Декодировать весь архив
+         * \param out           Данные всех тиков
+         * \param num_threads   Число потоков
+         */
+        void decode(TickBlock &out, const size_t num_threads = 1) const {
+            out.resize(size());
+            const size_t blocks = block_count();
+            const size_t threads = std::max((size_t)1, std::min(num_threads, blocks));
+            auto task = [this, &out, threads, blocks](const size_t part) {
+                for (size_t i = part; i < blocks; i += threads) {
+                    const size_t first = (size_t)index[i].first_tick;
+                    decode_block(i, &out.timestamp[first], &out.bid[first], &out.ask[first], &out.volume[first]);
+                }
+            };
+            std::vector<std::future<void>> futures;
+            for (size_t part = 1; part < threads; ++part) {
+                futures.push_back(std::async(std::launch::async, task, part));
+            }
+            if (blocks != 0) task(0);
+            for (auto &f : futures) f.get();
+        }
+
+        /** \brief Воспроизвести тики
+         *
+         * При num_threads > 1 следующие блоки декодируются параллельно
+         * с обработкой текущего, порядок тиков сохраняется.
+         * Функция sink вызывается как sink(timestamp, bid, ask, volume)
+         * \param sink          Приемник тиков
+         * \param num_threads   Число потоков декодирования
+         * \param first_block   Первый блок
+         * \param last_block    Блок после последнего
+         */
+        template<class SINK>
+        void replay(
+                SINK &&sink,
+                const size_t num_threads = 1,
+                const size_t first_block = 0,
+                size_t last_block = std::numeric_limits<size_t>::max()) const {
+            last_block = std::min(last_block, block_count());
+            if (first_block >= last_block) return;
+            if (num_threads <= 1) {
+                TickBlock data;
+                for (size_t b = first_block; b < last_block; ++b) {
+                    decode_block(b, data);
+                    for (size_t i = 0; i < data.size(); ++i) {
+                        sink(data.timestamp[i], data.bid[i], data.ask[i], data.volume[i]);
+                    }
+                }
+                return;
+            }
+            std::deque<std::future<TickBlock>> queue;
+            size_t next = first_block;
+            auto start = [&]() {
+                const size_t b = next++;
+                queue.push_back(std::async(std::launch::async, [this, b]() {
+                    TickBlock data;
+                    decode_block(b, data);
+                    return data;
+                }));
+            };
+            while (next < last_block && queue.size() < num_threads) start();
+            while (!queue.empty()) {
+                TickBlock data = queue.front().get();
+                queue.pop_front();
+                if (next < last_block) start();
+                for (size_t i = 0; i < data.size(); ++i) {
+                    sink(data.timestamp[i], data.bid[i], data.ask[i], data.volume[i]);
+                }
+            }
+        }
+    };
+};
+
+#endif // XTECHNICAL_TICK_ARCHIVE_HPP_INCLUDED
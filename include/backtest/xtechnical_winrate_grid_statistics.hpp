@@ -0,0 +1,473 @@
+#ifndef XTECHNICAL_WINRATE_GRID_STATISTICS_HPP_INCLUDED
+#define XTECHNICAL_WINRATE_GRID_STATISTICS_HPP_INCLUDED
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <algorithm>
+#include <cstdint>
+
+namespace xtechnical {
+
+    /** \brief Статистика винрейта для сетки параметров
+     *
+     * Один поток тиков и сигналов place_bet обрабатывается сразу для всех
+     * конфигураций (экспирация, задержка, период, задержка между тиками).
+     * Для каждой пары брокер/символ хранится история тиков начиная с самого
+     * старого незакрытого сигнала, цены открытия и закрытия для каждой
+     * конфигурации находятся бинарным поиском по этой истории.
+     * Результат для каждой конфигурации совпадает с WinrateStats
+     * с той же конфигурацией.
+     *
+     * Для конфигураций без периода t2 - timestamp не зависит от сигнала,
+     * поэтому их порядок закрытия считается один раз в set_configs.
+     * Отдельно для каждого сигнала сортируются только конфигурации
+     * с периодом, у которых порядок t2 зависит от времени сигнала.
+     */
+    class WinrateGridStats {
+    public:
+
+        /** \brief Класс тика
+         */
+        class Tick {
+        public:
+            double bid = 0;         /**< Цена bid */
+            double ask = 0;         /**< Цена ask */
+            uint64_t timestamp = 0; /**< Метка времени */
+
+            Tick() {};
+
+            Tick(const double b, const double a, const uint64_t t) :
+                bid(b), ask(a), timestamp(t) {
+            }
+        };
+
+        /** \brief Класс конфигурации
+         */
+        class Config {
+        public:
+            uint64_t expiration = 60000;    /**< Экспирация */
+            uint64_t delay = 150;           /**< Задержка */
+            uint64_t period = 0;            /**< Период в миллисекундах */
+            uint64_t between_ticks = 20000; /**< Задержка между тиками */
+
+            Config() {};
+
+            Config(const uint64_t e, const uint64_t d, const uint64_t p = 0, const uint64_t bt = 20000) :
+                expiration(e), delay(d), period(p), between_ticks(bt) {
+            }
+        };
+
+    private:
+
+        /** \brief Сигнал, общий для всех конфигураций
+         */
+        class Signal {
+        public:
+            size_t handle = 0;
+            uint64_t timestamp = 0;
+            uint64_t tick_index = 0;        /**< Номер тика, актуального на момент ставки */
+            size_t fixed_pos = 0;           /**< Следующая конфигурация без периода для закрытия */
+            std::vector<uint32_t> aligned_order;    /**< Конфигурации с периодом по возрастанию t2 */
+            size_t aligned_pos = 0;         /**< Следующая конфигурация с периодом для закрытия */
+            int direction = 0;
+            bool active = false;
+        };
+
+        /** \brief Событие закрытия ставок сигнала
+         */
+        class Event {
+        public:
+            uint64_t time = 0;
+            size_t index = 0;
+
+            Event() {};
+
+            Event(const uint64_t t, const size_t i) :
+                time(t), index(i) {
+            }
+        };
+
+        class EventGreater {
+        public:
+            inline bool operator()(const Event &a, const Event &b) const noexcept {
+                if (a.time != b.time) return a.time > b.time;
+                return a.index > b.index;
+            }
+        };
+
+        /** \brief Данные пары брокер/символ
+         */
+        class Market {
+        public:
+            std::deque<Tick> history;       /**< Тики начиная с самого старого открытого сигнала */
+            uint64_t history_begin = 0;     /**< Номер первого тика в истории */
+            uint64_t tick_count = 0;        /**< Число полученных тиков */
+            std::deque<size_t> signals;     /**< Сигналы в порядке поступления */
+            std::vector<Event> events;      /**< Min-heap событий закрытия */
+        };
+
+        std::vector<Config> configs;
+        std::vector<uint32_t> fixed_order;      /**< Конфигурации без периода по возрастанию t2 */
+        std::vector<uint32_t> aligned_configs;  /**< Конфигурации с периодом */
+        std::vector<uint64_t> wins;
+        std::vector<uint64_t> losses;
+        std::vector<uint64_t> errors;
+
+        std::vector<Market> markets;
+        std::unordered_map<std::string, std::unordered_map<std::string, size_t>> handles;
+        std::vector<Signal> signals;
+        std::vector<size_t> free_signals;
+
+        inline uint64_t get_t1(const uint64_t timestamp, const Config &config) const noexcept {
+            const uint64_t t1 = timestamp + config.delay;
+            return config.period == 0 ? t1 : (t1 - (t1 % config.period) + config.period);
+        }
+
+        inline uint64_t get_t2(const uint64_t timestamp, const Config &config) const noexcept {
+            return get_t1(timestamp, config) + config.expiration;
+        }
+
+        /** \brief Найти следующую конфигурацию сигнала по возрастанию t2
+         * \param signal        Сигнал
+         * \param config_index  Индекс конфигурации
+         * \param is_fixed      Конфигурация без периода
+         * \return false, если все конфигурации сигнала закрыты
+         */
+        inline bool get_next(const Signal &signal, size_t &config_index, bool &is_fixed) const noexcept {
+            const bool has_fixed = signal.fixed_pos < fixed_order.size();
+            const bool has_aligned = signal.aligned_pos < signal.aligned_order.size();
+            if (!has_fixed && !has_aligned) return false;
+            if (has_fixed && has_aligned) {
+                const size_t a = fixed_order[signal.fixed_pos];
+                const size_t b = signal.aligned_order[signal.aligned_pos];
+                is_fixed = get_t2(signal.timestamp, configs[a]) <= get_t2(signal.timestamp, configs[b]);
+                config_index = is_fixed ? a : b;
+                return true;
+            }
+            is_fixed = has_fixed;
+            config_index = is_fixed ? fixed_order[signal.fixed_pos] : signal.aligned_order[signal.aligned_pos];
+            return true;
+        }
+
+        class TimeLess {
+        public:
+            inline bool operator()(const Tick &tick, const uint64_t t) const noexcept {
+                return tick.timestamp < t;
+            }
+        };
+
+        /** \brief Найти тик, цена которого фиксируется для времени t
+         *
+         * Это первый тик с меткой t, если он есть, иначе последний тик до t.
+         * \return Итератор тика или begin, если такого тика нет
+         */
+        template<class ITERATOR>
+        static inline ITERATOR find_tick(const ITERATOR begin, const ITERATOR end, const uint64_t t) noexcept {
+            ITERATOR it = std::lower_bound(begin, end, t, TimeLess());
+            if (it != end && it->timestamp == t) return it;
+            if (it == begin) return begin;
+            return --it;
+        }
+
+        void settle(const Market &market, const Signal &signal, const size_t index) noexcept {
+            const Config &config = configs[index];
+            const uint64_t t1 = get_t1(signal.timestamp, config);
+            const uint64_t t2 = t1 + config.expiration;
+
+            const size_t p = signal.tick_index - market.history_begin;
+            auto begin = market.history.begin() + p;
+            auto end = market.history.end();
+
+            // цена открытия: по тикам после ставки, иначе тик на момент ставки
+            auto it_open = find_tick(begin + 1, end, t1);
+            if (it_open == begin + 1 && (it_open == end || it_open->timestamp > t1)) it_open = begin;
+            const double open = (it_open->ask + it_open->bid) / 2.0;
+
+            // цена закрытия: только по тикам после ставки
+            double close = 0;
+            uint64_t last_t = 0;
+            auto it_close = find_tick(begin + 1, end, t2);
+            if (it_close != end && it_close->timestamp <= t2) {
+                close = (it_close->ask + it_close->bid) / 2.0;
+                last_t = it_close->timestamp;
+            }
+
+            if ((t2 - last_t) > config.between_ticks) {
+                ++errors[index];
+                return;
+            }
+            if (signal.direction == 1) {
+                if (close > open) ++wins[index];
+                else ++losses[index];
+            } else
+            if (signal.direction == -1) {
+                if (close < open) ++wins[index];
+                else ++losses[index];
+            }
+        }
+
+    public:
+
+        WinrateGridStats() {};
+
+        /** \brief Конструктор статистики для сетки параметров
+         * \param c     Массив конфигураций
+         */
+        WinrateGridStats(const std::vector<Config> &c) {
+            set_configs(c);
+        }
+
+        /** \brief Установить конфигурации
+         *
+         * Сбрасывает счетчики сделок
+         * \param c     Массив конфигураций
+         */
+        void set_configs(const std::vector<Config> &c) noexcept {
+            configs = c;
+            wins.assign(configs.size(), 0);
+            losses.assign(configs.size(), 0);
+            errors.assign(configs.size(), 0);
+            fixed_order.clear();
+            aligned_configs.clear();
+            for (size_t i = 0; i < configs.size(); ++i) {
+                if (configs[i].period == 0) fixed_order.push_back((uint32_t)i);
+                else aligned_configs.push_back((uint32_t)i);
+            }
+            std::sort(fixed_order.begin(), fixed_order.end(),
+                    [&](const uint32_t a, const uint32_t b) {
+                return (configs[a].delay + configs[a].expiration) < (configs[b].delay + configs[b].expiration);
+            });
+        }
+
+        /** \brief Создать сетку конфигураций
+         * \param expirations   Массив экспираций
+         * \param delays        Массив задержек
+         * \param period        Период в миллисекундах
+         * \param between_ticks Задержка между тиками
+         * \return Массив конфигураций, индекс = i_expiration * delays.size() + i_delay
+         */
+        static std::vector<Config> make_grid(
+                const std::vector<uint64_t> &expirations,
+                const std::vector<uint64_t> &delays,
+                const uint64_t period = 0,
+                const uint64_t between_ticks = 20000) {
+            std::vector<Config> grid;
+            grid.reserve(expirations.size() * delays.size());
+            for (size_t i = 0; i < expirations.size(); ++i) {
+                for (size_t j = 0; j < delays.size(); ++j) {
+                    grid.push_back(Config(expirations[i], delays[j], period, between_ticks));
+                }
+            }
+            return grid;
+        }
+
+        /** \brief Получить идентификатор пары брокер/символ
+         * \param broker        Имя брокера
+         * \param symbol        Символ
+         * \return Идентификатор для place_bet и update
+         */
+        size_t get_handle(const std::string &broker, const std::string &symbol) noexcept {
+            auto &symbols = handles[broker];
+            auto it = symbols.find(symbol);
+            if (it != symbols.end()) return it->second;
+            const size_t handle = markets.size();
+            markets.resize(handle + 1);
+            symbols[symbol] = handle;
+            return handle;
+        }
+
+        /** \brief Сделать ставку сразу для всех конфигураций
+         * \param handle        Идентификатор пары брокер/символ, см. get_handle
+         * \param timestamp     Метка времени
+         * \param direction     Направление, 1 - BUY, -1 - SELL
+         */
+        void place_bet(
+                const size_t handle,
+                const uint64_t timestamp,
+                const int direction) noexcept {
+            if (handle >= markets.size() || configs.empty()) return;
+            Market &market = markets[handle];
+            if (market.tick_count == 0) return;
+
+            size_t index = 0;
+            if (free_signals.empty()) {
+                index = signals.size();
+                signals.resize(index + 1);
+            } else {
+                index = free_signals.back();
+                free_signals.pop_back();
+            }
+            Signal &signal = signals[index];
+            signal.handle = handle;
+            signal.timestamp = timestamp;
+            signal.tick_index = market.tick_count - 1;
+            signal.direction = direction;
+            signal.fixed_pos = 0;
+            signal.aligned_pos = 0;
+            signal.active = true;
+            // порядок зависит от времени сигнала только у конфигураций с периодом
+            signal.aligned_order.assign(aligned_configs.begin(), aligned_configs.end());
+            std::sort(signal.aligned_order.begin(), signal.aligned_order.end(),
+                    [&](const uint32_t a, const uint32_t b) {
+                return get_t2(timestamp, configs[a]) < get_t2(timestamp, configs[b]);
+            });
+
+            size_t config_index = 0;
+            bool is_fixed = false;
+            get_next(signal, config_index, is_fixed);
+            market.signals.push_back(index);
+            market.events.push_back(Event(get_t2(timestamp, configs[config_index]), index));
+            std::push_heap(market.events.begin(), market.events.end(), EventGreater());
+        }
+
+        /** \brief Сделать ставку сразу для всех конфигураций
+         * \param broker        Имя брокера
+         * \param symbol        Символ
+         * \param timestamp     Метка времени
+         * \param direction     Направление, 1 - BUY, -1 - SELL
+         */
+        void place_bet(
+                const std::string &broker,
+                const std::string &symbol,
+                const uint64_t timestamp,
+                const int direction) noexcept {
+            auto it_broker = handles.find(broker);
+            if (it_broker == handles.end()) return;
+            auto it_symbol = it_broker->second.find(symbol);
+            if (it_symbol == it_broker->second.end()) return;
+            place_bet(it_symbol->second, timestamp, direction);
+        }
+
+        /** \brief Обновить состояние сделок
+         *
+         * Метки времени тиков одного символа должны идти по возрастанию.
+         * \param handle        Идентификатор пары брокер/символ, см. get_handle
+         * \param tick          Данные тика
+         */
+        void update(const size_t handle, const Tick &tick) noexcept {
+            if (handle >= markets.size()) return;
+            Market &market = markets[handle];
+            market.history.push_back(tick);
+            ++market.tick_count;
+
+            while (!market.events.empty() &&
+                   market.events.front().time <= tick.timestamp) {
+                const size_t index = market.events.front().index;
+                std::pop_heap(market.events.begin(), market.events.end(), EventGreater());
+                market.events.pop_back();
+
+                Signal &signal = signals[index];
+                size_t config_index = 0;
+                bool is_fixed = false;
+                bool is_open = false;
+                while (get_next(signal, config_index, is_fixed)) {
+                    const uint64_t t2 = get_t2(signal.timestamp, configs[config_index]);
+                    if (t2 > tick.timestamp) {
+                        market.events.push_back(Event(t2, index));
+                        std::push_heap(market.events.begin(), market.events.end(), EventGreater());
+                        is_open = true;
+                        break;
+                    }
+                    settle(market, signal, config_index);
+                    if (is_fixed) ++signal.fixed_pos;
+                    else ++signal.aligned_pos;
+                }
+                if (!is_open) signal.active = false;
+            }
+
+            // освобождаем закрытые сигналы и удаляем тики, которые больше не нужны открытым
+            while (!market.signals.empty() && !signals[market.signals.front()].active) {
+                free_signals.push_back(market.signals.front());
+                market.signals.pop_front();
+            }
+            const uint64_t keep = market.signals.empty() ?
+                (market.tick_count - 1) : signals[market.signals.front()].tick_index;
+            while (market.history_begin < keep) {
+                market.history.pop_front();
+                ++market.history_begin;
+            }
+        }
+
+        inline void update(
+                const size_t handle,
+                const double bid,
+                const double ask,
+                const uint64_t timestamp) noexcept {
+            update(handle, Tick(bid, ask, timestamp));
+        }
+
+        /** \brief Обновить состояние сделок
+         * \param broker        Имя брокера
+         * \param symbol        Символ
+         * \param tick          Данные тика
+         */
+        inline void update(
+                const std::string &broker,
+                const std::string &symbol,
+                const Tick &tick) noexcept {
+            update(get_handle(broker, symbol), tick);
+        }
+
+        inline void update(
+                const std::string &broker,
+                const std::string &symbol,
+                const double bid,
+                const double ask,
+                const uint64_t timestamp) noexcept {
+            update(broker, symbol, Tick(bid, ask, timestamp));
+        }
+
+        /** \brief Получить число конфигураций
+         */
+        inline size_t size() const noexcept {
+            return configs.size();
+        }
+
+        /** \brief Получить конфигурацию
+         * \param index Индекс конфигурации
+         */
+        inline const Config &get_config(const size_t index) const noexcept {
+            return configs[index];
+        }
+
+        /** \brief Получить массив удачных сделок по конфигурациям
+         */
+        inline const std::vector<uint64_t> &get_wins() const noexcept {
+            return wins;
+        }
+
+        /** \brief Получить массив убыточных сделок по конфигурациям
+         */
+        inline const std::vector<uint64_t> &get_losses() const noexcept {
+            return losses;
+        }
+
+        /** \brief Получить массив ошибочных сделок по конфигурациям
+         */
+        inline const std::vector<uint64_t> &get_errors() const noexcept {
+            return errors;
+        }
+
+        /** \brief Получить винрейт
+         * \param index Индекс конфигурации
+         * \return Винрейт
+         */
+        inline double get_winrate(const size_t index) const noexcept {
+            const double deals = wins[index] + losses[index];
+            const double winrate = deals == 0 ? 0 : (double)wins[index] / (double)deals;
+            return winrate;
+        }
+
+        /** \brief Получить число сделок
+         * \param index Индекс конфигурации
+         * \return Число сделок
+         */
+        inline uint64_t get_deals(const size_t index) const noexcept {
+            return wins[index] + losses[index];
+        }
+    };
+};
+
+#endif // XTECHNICAL_WINRATE_GRID_STATISTICS_HPP_INCLUDED
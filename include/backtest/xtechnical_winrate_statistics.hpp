@@ -2,8 +2,10 @@
 #define XTECHNICAL_WINRATE_STATISTICS_HPP_INCLUDED
 
 #include <string>
-#include <map>
-#include <deque>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <cstdint>
 #include <functional>
 
 namespace xtechnical {
@@ -33,8 +35,9 @@ namespace xtechnical {
          */
         class Bet {
         public:
-            std::string broker;
-            std::string symbol;
+            std::string broker;     /**< Имя брокера (заполняется только при ставке по имени) */
+            std::string symbol;     /**< Символ (заполняется только при ставке по имени) */
+            size_t handle = 0;      /**< Идентификатор пары брокер/символ */
             int direction = 0;
             uint64_t t1 = 0;
             uint64_t t2 = 0;
@@ -47,8 +50,91 @@ namespace xtechnical {
         };
 
     private:
-        std::deque<Bet> bets;
-        std::map<std::string, std::map<std::string, Tick>> ticks;
+
+        /** \brief Ставка в пуле и номер последнего тика на момент ставки
+         */
+        class BetSlot {
+        public:
+            Bet bet;
+            uint64_t tick_index = 0;
+            uint64_t order = 0;
+            bool active = false;
+        };
+
+        /** \brief Событие открытия или закрытия ставки
+         */
+        class Event {
+        public:
+            uint64_t time = 0;
+            uint64_t order = 0;
+            size_t index = 0;
+
+            Event() {};
+
+            Event(const uint64_t t, const uint64_t o, const size_t i) :
+                time(t), order(o), index(i) {
+            }
+        };
+
+        /** \brief Сравнение для min-heap событий (по времени, затем по порядку ставок)
+         */
+        class EventGreater {
+        public:
+            inline bool operator()(const Event &a, const Event &b) const noexcept {
+                if (a.time != b.time) return a.time > b.time;
+                return a.order > b.order;
+            }
+        };
+
+        /** \brief Данные пары брокер/символ
+         */
+        class Market {
+        public:
+            std::string broker;
+            std::string symbol;
+            Tick tick;
+            uint64_t tick_index = 0;        /**< Число полученных тиков */
+            std::vector<Event> open_events; /**< Ставки, ожидающие времени t1 */
+            std::vector<Event> close_events;/**< Ставки, ожидающие времени t2 */
+        };
+
+        std::vector<Market> markets;
+        std::unordered_map<std::string, std::unordered_map<std::string, size_t>> handles;
+        std::vector<BetSlot> slots;
+        std::vector<size_t> free_slots;
+        uint64_t bet_counter = 0;
+
+        inline void free_slot(const size_t index) noexcept {
+            slots[index].active = false;
+            free_slots.push_back(index);
+        }
+
+        inline bool is_event_valid(const Event &event) const noexcept {
+            return slots[event.index].active && slots[event.index].order == event.order;
+        }
+
+        void settle(const size_t index) noexcept {
+            Bet &bet = slots[index].bet;
+            if (bet.direction == 1) {
+                if (bet.close > bet.open) {
+                    ++wins;
+                    if (config.on_win != nullptr) config.on_win(bet);
+                } else {
+                    ++losses;
+                    if (config.on_loss != nullptr) config.on_loss(bet);
+                }
+            } else
+            if (bet.direction == -1) {
+                if (bet.close < bet.open) {
+                    ++wins;
+                    if (config.on_win != nullptr) config.on_win(bet);
+                } else {
+                    ++losses;
+                    if (config.on_loss != nullptr) config.on_loss(bet);
+                }
+            }
+            free_slot(index);
+        }
 
     public:
 
@@ -70,122 +156,207 @@ namespace xtechnical {
 
         WinrateStats() {};
 
-        /** \brief Сделать ставку
+        /** \brief Получить идентификатор пары брокер/символ
+         *
+         * Идентификатор создается при первом обращении и далее не меняется.
          * \param broker        Имя брокера
          * \param symbol        Символ
+         * \return Идентификатор для place_bet и update
+         */
+        size_t get_handle(const std::string &broker, const std::string &symbol) noexcept {
+            auto &symbols = handles[broker];
+            auto it = symbols.find(symbol);
+            if (it != symbols.end()) return it->second;
+            const size_t handle = markets.size();
+            markets.resize(handle + 1);
+            markets.back().broker = broker;
+            markets.back().symbol = symbol;
+            symbols[symbol] = handle;
+            return handle;
+        }
+
+        /** \brief Получить имя брокера по идентификатору
+         */
+        inline const std::string &get_broker(const size_t handle) const noexcept {
+            return markets[handle].broker;
+        }
+
+        /** \brief Получить символ по идентификатору
+         */
+        inline const std::string &get_symbol(const size_t handle) const noexcept {
+            return markets[handle].symbol;
+        }
+
+        /** \brief Сделать ставку
+         * \param handle        Идентификатор пары брокер/символ, см. get_handle
          * \param timestamp     Метка времени
          * \param direction     Направление, 1 - BUY, -1 - SELL
          * \param callback      Функция обратного вызова для передачи структуры ставки
          */
         void place_bet(
-                const std::string &broker,
-                const std::string &symbol,
+                const size_t handle,
                 const uint64_t timestamp,
                 const int direction,
                 std::function<void(Bet &bet)> callback = nullptr) noexcept {
-            Bet bet;
-            bet.broker = broker;
-            bet.symbol = symbol;
-            bet.direction = direction;
+            if (handle >= markets.size()) return;
+            Market &market = markets[handle];
+            // ищем котировку
+            if (market.tick_index == 0) return;
+
+            size_t index = 0;
+            if (free_slots.empty()) {
+                index = slots.size();
+                slots.resize(index + 1);
+            } else {
+                index = free_slots.back();
+                free_slots.pop_back();
+            }
+            BetSlot &slot = slots[index];
+            slot.bet = Bet();
+            slot.tick_index = market.tick_index;
+            slot.order = bet_counter++;
+            slot.active = true;
 
+            Bet &bet = slot.bet;
+            bet.handle = handle;
+            bet.direction = direction;
             const uint64_t t1 = timestamp + config.delay;
             bet.t1 = config.period == 0 ? t1 : (t1 - (t1 % config.period) + config.period);
             bet.t2 = bet.t1 + config.expiration;
-            // ищем котировку
-            auto it_broker = ticks.find(broker);
-            if (it_broker == ticks.end()) return;
-            auto it_symbol = it_broker->second.find(symbol);
-            if (it_symbol == it_broker->second.end()) return;
-
-            bet.open = (it_symbol->second.ask + it_symbol->second.bid) / 2.0d;
+            bet.open = (market.tick.ask + market.tick.bid) / 2.0;
             if (callback != nullptr) callback(bet);
-            bets.push_back(bet);
+
+            market.open_events.push_back(Event(bet.t1, slot.order, index));
+            std::push_heap(market.open_events.begin(), market.open_events.end(), EventGreater());
+            market.close_events.push_back(Event(bet.t2, slot.order, index));
+            std::push_heap(market.close_events.begin(), market.close_events.end(), EventGreater());
         }
 
-        /** \brief Обновить состояние сделок
+        /** \brief Сделать ставку
          * \param broker        Имя брокера
          * \param symbol        Символ
-         * \param tick          Данные тика
+         * \param timestamp     Метка времени
+         * \param direction     Направление, 1 - BUY, -1 - SELL
+         * \param callback      Функция обратного вызова для передачи структуры ставки
          */
-        void update(
+        void place_bet(
                 const std::string &broker,
                 const std::string &symbol,
-                const Tick &tick) noexcept {
-            ticks[broker][symbol] = tick;
-            if (bets.empty()) return;
-            size_t index = 0;
-            while (index < bets.size()) {
-                if (bets[index].broker != broker) {
-                    ++index;
-                    continue;
-                }
-                if (bets[index].symbol != symbol) {
-                    ++index;
-                    continue;
-                }
-
-                if (!bets[index].init_open && bets[index].t1 >= tick.timestamp) {
-                    bets[index].open = (tick.ask + tick.bid) / 2.0d;
-                }
-                if (!bets[index].init_open && bets[index].t1 <= tick.timestamp) {
-                    bets[index].init_open = true;
-                }
+                const uint64_t timestamp,
+                const int direction,
+                std::function<void(Bet &bet)> callback = nullptr) noexcept {
+            auto it_broker = handles.find(broker);
+            if (it_broker == handles.end()) return;
+            auto it_symbol = it_broker->second.find(symbol);
+            if (it_symbol == it_broker->second.end()) return;
+            place_bet(it_symbol->second, timestamp, direction,
+                    [&](Bet &bet) {
+                bet.broker = broker;
+                bet.symbol = symbol;
+                if (callback != nullptr) callback(bet);
+            });
+        }
 
-                if (!bets[index].init_close && bets[index].t2 >= tick.timestamp) {
-                    bets[index].close = (tick.ask + tick.bid) / 2.0d;
-                    bets[index].last_t = tick.timestamp;
-                }
-                if (!bets[index].init_close && bets[index].t2 <= tick.timestamp) {
-                    bets[index].init_close = true;
-                    if ((bets[index].t2 - bets[index].last_t) > config.between_ticks) {
-                        // ошибка сделки, слишком долго не было тика
-                        if (config.on_error != nullptr) config.on_error(bets[index]);
-                        bets.erase(bets.begin() + index);
-                        continue;
-                    }
-                }
+        /** \brief Обновить состояние сделок
+         *
+         * Тик затрагивает только те ставки, у которых наступило время t1 или t2.
+         * Цена открытия - цена последнего тика с меткой времени не больше t1,
+         * цена закрытия - цена последнего тика после ставки с меткой времени не больше t2.
+         * Метки времени тиков одного символа должны идти по возрастанию.
+         *
+         * Ставки, закрытые одним тиком, передаются в on_win, on_loss и on_error
+         * в порядке времени t2, при равном t2 - в порядке размещения.
+         * Прежняя реализация вызывала их в порядке размещения ставок.
+         * \param handle       Идентификатор пары брокер/символ, см. get_handle
+         * \param tick          Данные тика
+         */
+        void update(const size_t handle, const Tick &tick) noexcept {
+            if (handle >= markets.size()) return;
+            Market &market = markets[handle];
+            const double price = (tick.ask + tick.bid) / 2.0;
+            const double last_price = (market.tick.ask + market.tick.bid) / 2.0;
 
-                if (!bets[index].init_close ||
-                    !bets[index].init_open) {
-                    ++index;
-                    continue;
+            while (!market.open_events.empty() &&
+                   market.open_events.front().time <= tick.timestamp) {
+                const Event event = market.open_events.front();
+                std::pop_heap(market.open_events.begin(), market.open_events.end(), EventGreater());
+                market.open_events.pop_back();
+                if (!is_event_valid(event)) continue;
+                BetSlot &slot = slots[event.index];
+                if (slot.bet.t1 == tick.timestamp) {
+                    slot.bet.open = price;
+                } else
+                if (market.tick_index > slot.tick_index) {
+                    slot.bet.open = last_price;
                 }
+                slot.bet.init_open = true;
+            }
 
-                if (bets[index].direction == 1) {
-                    if (bets[index].close > bets[index].open) {
-                        ++wins;
-                        if (config.on_win != nullptr) config.on_win(bets[index]);
-                    } else {
-                        ++losses;
-                        if (config.on_loss != nullptr) config.on_loss(bets[index]);
-                    }
-                    bets.erase(bets.begin() + index);
-                    continue;
+            while (!market.close_events.empty() &&
+                   market.close_events.front().time <= tick.timestamp) {
+                const Event event = market.close_events.front();
+                std::pop_heap(market.close_events.begin(), market.close_events.end(), EventGreater());
+                market.close_events.pop_back();
+                if (!is_event_valid(event)) continue;
+                BetSlot &slot = slots[event.index];
+                if (slot.bet.t2 == tick.timestamp) {
+                    slot.bet.close = price;
+                    slot.bet.last_t = tick.timestamp;
                 } else
-                if (bets[index].direction == -1) {
-                    if (bets[index].close < bets[index].open) {
-                        ++wins;
-                        if (config.on_win != nullptr) config.on_win(bets[index]);
-                    } else {
-                        ++losses;
-                        if (config.on_loss != nullptr) config.on_loss(bets[index]);
-                    }
-                    bets.erase(bets.begin() + index);
+                if (market.tick_index > slot.tick_index) {
+                    slot.bet.close = last_price;
+                    slot.bet.last_t = market.tick.timestamp;
+                }
+                slot.bet.init_close = true;
+                if ((slot.bet.t2 - slot.bet.last_t) > config.between_ticks) {
+                    // ошибка сделки, слишком долго не было тика
+                    if (config.on_error != nullptr) config.on_error(slot.bet);
+                    free_slot(event.index);
                     continue;
                 }
-                ++index;
-            } // while
+                settle(event.index);
+            }
+
+            market.tick = tick;
+            ++market.tick_index;
+        }
+
+        inline void update(
+                const size_t handle,
+                const double bid,
+                const double ask,
+                const uint64_t timestamp) noexcept {
+            update(handle, Tick(bid, ask, timestamp));
+        }
+
+        /** \brief Обновить состояние сделок
+         * \param broker        Имя брокера
+         * \param symbol        Символ
+         * \param tick          Данные тика
+         */
+        inline void update(
+                const std::string &broker,
+                const std::string &symbol,
+                const Tick &tick) noexcept {
+            update(get_handle(broker, symbol), tick);
         }
-		
+
 		inline void update(
                 const std::string &broker,
                 const std::string &symbol,
                 const double bid,
 				const double ask,
 				const uint64_t timestamp) noexcept {
-			update(broker, symbol, Tick(bid, ask, timestamp));	
+			update(broker, symbol, Tick(bid, ask, timestamp));
 		}
 
+        /** \brief Получить число открытых ставок
+         * \return Число ставок, ожидающих закрытия
+         */
+        inline size_t get_open_bets() const noexcept {
+            return slots.size() - free_slots.size();
+        }
+
         /** \brief Получить винрейт
          * \return Винрейт
          */
@@ -5,15 +5,16 @@
 #include "xtechnical_sma.hpp"
 
 namespace xtechnical {
-    using namespace xtechnical_common;
 
     /** \brief Awesome Oscillator
+     *
+     * Для стандартных периодов 5 и 34 используйте FixedAwesomeOscillator
      */
-    template <class T, class MA_TYPE = SMA<T>>
+    template <class T, class MA_TYPE = SMA<T>, class SLOW_MA_TYPE = MA_TYPE>
     class AwesomeOscillator {
     private:
         MA_TYPE fast;
-		MA_TYPE slow;
+		SLOW_MA_TYPE slow;
 		T output_value = std::numeric_limits<T>::quiet_NaN();
     public:
 
@@ -35,8 +36,9 @@ namespace xtechnical {
 			fast.update(price);
 			slow.update(price);
 			if (std::isnan(fast.get()) || 
-				std::isnan(slow.get())) return INDICATOR_NOT_READY_TO_WORK;
+				std::isnan(slow.get())) return common::INDICATOR_NOT_READY_TO_WORK;
 			output_value = fast.get() - slow.get();
+			return common::OK;
 		}
 
         /** \brief Обновить состояние индикатора
@@ -80,8 +82,9 @@ namespace xtechnical {
 			fast.test(price);
 			slow.test(price);
 			if (std::isnan(fast.get()) || 
-				std::isnan(slow.get())) return INDICATOR_NOT_READY_TO_WORK;
+				std::isnan(slow.get())) return common::INDICATOR_NOT_READY_TO_WORK;
 			output_value = fast.get() - slow.get();
+			return common::OK;
 		}
 		
 		/** \brief Протестировать индикатор
@@ -103,7 +106,7 @@ namespace xtechnical {
 		inline int test(const T high, const T low, T &out) noexcept {
             const int err = test(high, low);
             out = output_value;
-            return OK;
+            return err;
         }
 		
         /** \brief Протестировать индикатор
@@ -132,6 +135,11 @@ namespace xtechnical {
 			slow.clear();
         }
     };
+
+    /** \brief Awesome Oscillator со стандартными периодами 5 и 34, заданными на этапе компиляции
+     */
+    template <class T>
+    using FixedAwesomeOscillator = AwesomeOscillator<T, FixedSMA<T, 5>, FixedSMA<T, 34>>;
 }; // xtechnical
 
 #endif // XTECHNICAL_AWESOME_OSCILLATOR_HPP_INCLUDED
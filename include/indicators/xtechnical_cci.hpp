@@ -28,11 +28,12 @@ namespace xtechnical {
             ma.update(in);
             if (!buffer.full()) return common::INDICATOR_NOT_READY_TO_WORK;
             if (std::isnan(ma.get())) return common::INDICATOR_NOT_READY_TO_WORK;
-            std::vector<T> temp(buffer.to_vector());
+            const circular_buffer_view<T> temp(buffer.view());
+            const T mean = ma.get();
             T sum = 0;
-            for (size_t  i = 0; i < temp.size(); ++i) {
-                sum += std::abs(temp[i] - ma.get());
-            }
+            temp.for_each([&](const T value) {
+                sum += std::abs(value - mean);
+            });
             const T mad = sum / (T)temp.size();
             output_value = (in - ma.get()) / (coeff * mad);
             return common::OK;
@@ -60,11 +61,12 @@ namespace xtechnical {
             ma.test(in);
             if (!buffer.full()) return common::INDICATOR_NOT_READY_TO_WORK;
             if (std::isnan(ma.get())) return common::INDICATOR_NOT_READY_TO_WORK;
-            const std::vector<T> temp(buffer.to_vector());
+            const circular_buffer_view<T> temp(buffer.view());
+            const T mean = ma.get();
             T sum = 0;
-            for (size_t  i = 0; i < temp.size(); ++i) {
-                sum += std::abs(temp[i] - ma.get());
-            }
+            temp.for_each([&](const T value) {
+                sum += std::abs(value - mean);
+            });
             const T mad = sum / (T)temp.size();
             output_value = (in - ma.get()) / (coeff * mad);
             return common::OK;
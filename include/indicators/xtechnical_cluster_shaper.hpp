@@ -5,16 +5,132 @@
 
 namespace xtechnical {
 
-	/** \brief Формирователь Кластеров
+	/** \brief Кластер и общие функции формирователя кластеров
 	 */
-	class ClusterShaper {
+	class ClusterShaperBase {
 	public:
 
+		/** \brief Распределение объема по уровням цены
+		 *
+		 * Объемы хранятся в плотном массиве, индекс которого равен уровню цены
+		 * минус начало массива. При выходе уровня за пределы массива он
+		 * увеличивается вдвое и занятая часть переносится в середину, поэтому
+		 * добавление тика в среднем O(1). Очистка не освобождает память.
+		 */
+		class Distribution {
+		private:
+			std::vector<int> buffer;
+			int origin = 0;		/**< Уровень цены, соответствующий buffer[0] */
+			int low = 0;		/**< Минимальный занятый уровень */
+			int high = 0;		/**< Максимальный занятый уровень */
+			bool is_empty = true;
+
+			inline bool is_inside(const int tick) const noexcept {
+				return tick >= origin && (int64_t)tick < ((int64_t)origin + (int64_t)buffer.size());
+			}
+
+			void grow(const int l, const int h) {
+				const size_t length = (size_t)((int64_t)h - (int64_t)l + 1);
+				const size_t capacity = std::max(std::max(buffer.size() * 2, length * 2), (size_t)16);
+				std::vector<int> temp(capacity, 0);
+				const int new_origin = l - (int)((capacity - length) / 2);
+				if (!is_empty) {
+					std::copy(
+						buffer.begin() + (low - origin),
+						buffer.begin() + (high - origin + 1),
+						temp.begin() + (low - new_origin));
+				}
+				buffer.swap(temp);
+				origin = new_origin;
+			}
+
+		public:
+
+			/** \brief Добавить объем на уровень цены
+			 * \param tick		Уровень цены
+			 * \param value	Объем
+			 * \return Объем уровня после добавления
+			 */
+			inline int add(const int tick, const int value = 1) {
+				if (is_empty) {
+					if (!is_inside(tick)) {
+						if (buffer.empty()) grow(tick, tick);
+						else origin = tick - (int)(buffer.size() / 2);
+					}
+					low = high = tick;
+					is_empty = false;
+				} else {
+					if (!is_inside(tick)) grow(std::min(tick, low), std::max(tick, high));
+					if (tick < low) low = tick;
+					else if (tick > high) high = tick;
+				}
+				return buffer[tick - origin] += value;
+			}
+
+			/** \brief Получить объем уровня цены
+			 * \param tick		Уровень цены
+			 * \return Объем уровня
+			 */
+			inline int get(const int tick) const noexcept {
+				if (is_empty || tick < low || tick > high) return 0;
+				return buffer[tick - origin];
+			}
+
+			inline int operator[](const int tick) const noexcept {
+				return get(tick);
+			}
+
+			/** \brief Указатель на объем минимального уровня
+			 *
+			 * Объемы уровней от get_low() до get_high() лежат подряд
+			 */
+			inline const int *data() const noexcept {
+				return is_empty ? nullptr : buffer.data() + (low - origin);
+			}
+
+			/** \brief Количество уровней от минимального до максимального
+			 */
+			inline size_t size() const noexcept {
+				return is_empty ? 0 : (size_t)(high - low + 1);
+			}
+
+			inline bool empty() const noexcept {
+				return is_empty;
+			}
+
+			inline int get_low() const noexcept {
+				return low;
+			}
+
+			inline int get_high() const noexcept {
+				return high;
+			}
+
+			/** \brief Получить непустые уровни в виде std::map
+			 */
+			std::map<int, int> to_map() const {
+				std::map<int, int> temp;
+				for (int tick = low; !is_empty && tick <= high; ++tick) {
+					const int value = buffer[tick - origin];
+					if (value != 0) temp[tick] = value;
+				}
+				return temp;
+			}
+
+			/** \brief Очистить распределение без освобождения памяти
+			 */
+			inline void clear() noexcept {
+				if (is_empty) return;
+				std::fill(buffer.begin() + (low - origin), buffer.begin() + (high - origin + 1), 0);
+				is_empty = true;
+			}
+		};
+
 		/** \brief Кластер
 		*/
 		class Cluster {
 		public:
-			std::map<int, int> distribution;
+			Distribution distribution;
 			int open = 0;
 			int close = 0;
 			int high = 0;
@@ -22,6 +138,7 @@ namespace xtechnical {
 			int volume = 0;
 			int max_volume = 0;
 			int max_index = 0;
+			int64_t tick_sum = 0;	/**< Сумма уровней цены, взвешенных по объему */
 			uint64_t timestamp = 0;
 			double pips_size = 0.0;
 
@@ -33,37 +150,41 @@ namespace xtechnical {
 				return (double)open * pips_size;
 			}
 
+			/** \brief Получить объемы уровней от low до high
+			 * \param out	Массив объемов
+			 */
+			inline void get_array(std::vector<double> &out) const noexcept {
+				const int *values = distribution.data();
+				out.assign(values, values + distribution.size());
+			}
+
 			inline std::vector<double> get_array() const noexcept {
-				if (distribution.empty()) return std::vector<double>();
 				std::vector<double> temp;
-				temp.reserve(distribution.size());
-				int last_tick = 0;
-				int index = 0;
-				for (const auto &item : distribution) {
-					if (index == 0) {
-						temp.push_back(item.second);
-						last_tick = item.first;
-					} else {
-						const int diff = (item.first - last_tick);
-						last_tick = item.first;
-						for(int i = 1; i < diff; ++i) {
-							temp.push_back(0.0d);
-						}
-						temp.push_back(item.second);
-					}
-					++index;
+				get_array(temp);
+				return temp;
+			}
+
+			/** \brief Получить объемы уровней, деленные на максимальный объем
+			 * \param out	Массив нормированных объемов
+			 */
+			inline void get_normalized_array(std::vector<double> &out) const noexcept {
+				if (max_volume <= 0) {
+					out.assign(distribution.size(), 0.0d);
+					return;
+				}
+				const int *values = distribution.data();
+				const size_t length = distribution.size();
+				const double scale = 1.0d / (double)max_volume;
+				out.resize(length);
+				for (size_t i = 0; i < length; ++i) {
+					out[i] = (double)values[i] * scale;
 				}
-				return std::move(temp);
 			}
 
 			inline std::vector<double> get_normalized_array() const noexcept {
-				std::vector<double> temp(get_array());
-				if (max_volume > 0) {
-					for (auto &item : temp) {
-						item /= (double)max_volume;
-					}
-				} else return std::vector<double>(temp.size());
-				return std::move(temp);
+				std::vector<double> temp;
+				get_normalized_array(temp);
+				return temp;
 			}
 
 			inline double get_max_volume_price() const noexcept {
@@ -71,21 +192,11 @@ namespace xtechnical {
 			}
 
 			inline double get_center_mass_price() const noexcept {
-				int64_t sum = 0;
-				for (auto &item : distribution) {
-					sum += item.first * item.second;
-				}
-				sum /= volume;
-				return (double)sum * pips_size;
+				return (double)(tick_sum / volume) * pips_size;
 			}
 
 			inline double get_center_mass() const noexcept {
-				int64_t sum = 0;
-				for (auto &item : distribution) {
-					sum += item.first * item.second;
-				}
-				sum /= volume;
-				return sum;
+				return tick_sum / volume;
 			}
 
 			inline double get_center_mass_norm() const noexcept {
@@ -94,6 +205,68 @@ namespace xtechnical {
 			}
 		};
 
+		static inline std::vector<double> get_triangular_distribution(
+				size_t length,
+				size_t vertex_position) {
+			if (length == 0) return std::vector<double>();
+			if (length == 1) return std::vector<double>(1,1.0d);
+			std::vector<double> temp(length, 0.0d);
+			if (vertex_position >= length) vertex_position = length - 1;
+			const double step_up = vertex_position <= 1 ? 1.0d : (1.0d / (double)vertex_position);
+			const size_t diff = (length - 1) - vertex_position;
+			const double step_dn = diff <= 1 ? 1.0d : (1.0d / (double)diff);
+			double step = vertex_position == 0 ? 1.0d : 0.0d;
+			for (size_t i = 0; i <= vertex_position; ++i) {
+				temp[i] = step;
+				step += step_up;
+			}
+			step = 1.0d - step_dn;
+			for (size_t i = vertex_position + 1; i < length; ++i) {
+				temp[i] = step;
+				step -= step_dn;
+			}
+			return std::move(temp);
+		}
+
+		static inline double get_euclidean_distance(const  std::vector<double> &x, const std::vector<double> &y) {
+			double sum = 0;
+			for (size_t i = 0; i < x.size(); ++i) {
+				const double diff = x[i] - y[i];
+				sum += diff * diff;
+			}
+			return 1.0d / (1.0d + std::sqrt(sum));
+		}
+
+		static inline double get_cosine_similarity(const  std::vector<double> &x, const std::vector<double> &y) {
+			double sum = 0;
+			double sum_x = 0;
+			double sum_y = 0;
+			for (size_t i = 0; i < x.size(); ++i) {
+				sum += x[i] * y[i];
+				sum_x += x[i] * x[i];
+				sum_y += y[i] * y[i];
+			}
+			return sum / (std::sqrt(sum_x) * std::sqrt(sum_y));
+		}
+	}; // ClusterShaperBase
+
+	/** \brief Пустой приемник кластеров
+	 *
+	 * Приемник для BasicClusterShaper должен иметь методы on_close_bar и on_unformed_bar,
+	 * от этого класса можно наследоваться, чтобы не писать ненужный метод
+	 */
+	class ClusterShaperSink {
+	public:
+		inline void on_close_bar(const ClusterShaperBase::Cluster &) {};
+		inline void on_unformed_bar(const ClusterShaperBase::Cluster &) {};
+	};
+
+	/** \brief Формирователь Кластеров со статическим приемником кластеров
+	 *
+	 * Методы приемника вызываются напрямую и могут быть встроены компилятором
+	 */
+	template<class SINK = ClusterShaperSink>
+	class BasicClusterShaper : public ClusterShaperBase {
 	private:
 		Cluster cluster;
 		uint64_t period = 0;
@@ -105,25 +278,36 @@ namespace xtechnical {
 		bool is_once = false;
 
 	public:
-		ClusterShaper() {};
+
+		SINK sink;	/**< Приемник кластеров */
+
+		BasicClusterShaper() {};
 
 		/** \brief Инициализировать формирователь баров
 		 * \param p		Период индикатора в секундах
 		 * \param ps	Точность цены, например 0.00001
 		 * \param ubst	Флаг, включает использование последней метки времени бара вместо начала бара, как времени бара
+		 * \param s		Приемник кластеров
 		 */
-		ClusterShaper(const size_t p, const double ps, const bool ubst = false) :
-			period(p), pips_size(ps), is_use_bar_stop_time(ubst)  {
+		BasicClusterShaper(const size_t p, const double ps, const bool ubst = false, const SINK &s = SINK()) :
+			period(p), pips_size(ps), is_use_bar_stop_time(ubst), sink(s) {
 		}
 
-		std::function<void(const Cluster &cluster)> on_close_bar;				/**< Функция обратного вызова в момент закрытия бара */
-		std::function<void(const Cluster &cluster)> on_unformed_bar = nullptr;	/**< Функция обратного вызова для несформированного бара */
-
 		/** \brief Обновить состояние индикатора
 		 * \param input		Текущая цена
 		 * \param timestamp Метка времени в секундах
 		 */
-		int update(const double input, const uint64_t timestamp) noexcept {
+		inline int update(const double input, const uint64_t timestamp) noexcept {
+			return update(input, timestamp, sink);
+		}
+
+		/** \brief Обновить состояние индикатора с указанным приемником кластеров
+		 * \param input		Текущая цена
+		 * \param timestamp Метка времени в секундах
+		 * \param s			Приемник кластеров
+		 */
+		template<class S>
+		int update(const double input, const uint64_t timestamp, S &s) noexcept {
 			if(period == 0) return common::NO_INIT;
 			const uint64_t current_bar = timestamp / period;
 			if (last_bar == 0) {
@@ -137,14 +321,15 @@ namespace xtechnical {
 				if (is_once) {
 					cluster.timestamp = is_use_bar_stop_time ?
 						(last_bar * period + period) : (last_bar * period);
-					on_close_bar(cluster);
+					s.on_close_bar(cluster);
 					cluster.distribution.clear();
-					cluster.distribution[tick] = 1;
+					cluster.distribution.add(tick);
 					last_bar = current_bar;
 					cluster.timestamp = is_use_bar_stop_time ?
 						(last_bar * period + period) : (last_bar * period);
 					cluster.open = cluster.close = tick;
 					cluster.volume = 1;
+					cluster.tick_sum = tick;
 					cluster.max_volume = 1;
 					cluster.max_index = tick;
 					cluster.high = cluster.low = tick;
@@ -152,12 +337,13 @@ namespace xtechnical {
 					return common::OK;
 				}
 				cluster.distribution.clear();
-				cluster.distribution[tick] = 1;
+				cluster.distribution.add(tick);
 				last_bar = current_bar;
 				cluster.timestamp = is_use_bar_stop_time ?
 						(last_bar * period + period) : (last_bar * period);
 				cluster.open = cluster.close = tick;
 				cluster.volume = 1;
+				cluster.tick_sum = tick;
 				cluster.max_volume = 1;
 				cluster.max_index = tick;
 				cluster.high = cluster.low = tick;
@@ -167,78 +353,87 @@ namespace xtechnical {
 			} else
 			if (current_bar == last_bar) {
 				if (is_once) {
-					auto it = cluster.distribution.find(tick);
-					if (it == cluster.distribution.end()) {
-						cluster.distribution[tick] = 1;
-					} else {
-						++it->second;
-						if (it->second > cluster.max_volume) {
-							cluster.max_volume = it->second;
-							cluster.max_index = tick;
-						}
+					const int value = cluster.distribution.add(tick);
+					if (value > cluster.max_volume) {
+						cluster.max_volume = value;
+						cluster.max_index = tick;
 					}
 					cluster.close = tick;
 					if (tick > cluster.high) cluster.high = tick;
 					if (tick < cluster.low) cluster.low = tick;
 					++cluster.volume;
-					if (on_unformed_bar != nullptr) {
-						on_unformed_bar(cluster);
-					}
+					cluster.tick_sum += tick;
+					s.on_unformed_bar(cluster);
 				}
 			}
 			return common::OK;
 		}
 
-		static inline std::vector<double> get_triangular_distribution(
-				size_t length,
-				size_t vertex_position) {
-			if (length == 0) return std::vector<double>();
-			if (length == 1) return std::vector<double>(1,1.0d);
-			std::vector<double> temp(length, 0.0d);
-			if (vertex_position >= length) vertex_position = length - 1;
-			const double step_up = vertex_position <= 1 ? 1.0d : (1.0d / (double)vertex_position);
-			const size_t diff = (length - 1) - vertex_position;
-			const double step_dn = diff <= 1 ? 1.0d : (1.0d / (double)diff);
-			double step = vertex_position == 0 ? 1.0d : 0.0d;
-			for (size_t i = 0; i <= vertex_position; ++i) {
-				temp[i] = step;
-				step += step_up;
-			}
-			step = 1.0d - step_dn;
-			for (size_t i = vertex_position + 1; i < length; ++i) {
-				temp[i] = step;
-				step -= step_dn;
-			}
-			return std::move(temp);
+		/** \brief Очистить данные индикатора
+		 */
+		inline void clear() noexcept {
+			cluster = Cluster();
+			last_bar = 0;
+			is_once = false;
 		}
+	}; // BasicClusterShaper
 
-		static inline double get_euclidean_distance(const  std::vector<double> &x, const std::vector<double> &y) {
-			double sum = 0;
-			for (size_t i = 0; i < x.size(); ++i) {
-				const double diff = x[i] - y[i];
-				sum += diff * diff;
+	/** \brief Формирователь Кластеров
+	 *
+	 * Версия с функциями обратного вызова std::function поверх BasicClusterShaper
+	 */
+	class ClusterShaper : public ClusterShaperBase {
+	private:
+
+		class FunctionSink {
+		public:
+			const std::function<void(const Cluster &cluster)> &close_bar;
+			const std::function<void(const Cluster &cluster)> &unformed_bar;
+
+			FunctionSink(
+				const std::function<void(const Cluster &cluster)> &c,
+				const std::function<void(const Cluster &cluster)> &u) :
+				close_bar(c), unformed_bar(u) {};
+
+			inline void on_close_bar(const Cluster &cluster) {
+				close_bar(cluster);
 			}
-			return 1.0d / (1.0d + std::sqrt(sum));
-		}
 
-		static inline double get_cosine_similarity(const  std::vector<double> &x, const std::vector<double> &y) {
-			double sum = 0;
-			double sum_x = 0;
-			double sum_y = 0;
-			for (size_t i = 0; i < x.size(); ++i) {
-				sum += x[i] * y[i];
-				sum_x += x[i] * x[i];
-				sum_y += y[i] * y[i];
+			inline void on_unformed_bar(const Cluster &cluster) {
+				if (unformed_bar != nullptr) unformed_bar(cluster);
 			}
-			return sum / (std::sqrt(sum_x) * std::sqrt(sum_y));
+		};
+
+		BasicClusterShaper<> shaper;
+
+	public:
+		ClusterShaper() {};
+
+		/** \brief Инициализировать формирователь баров
+		 * \param p		Период индикатора в секундах
+		 * \param ps	Точность цены, например 0.00001
+		 * \param ubst	Флаг, включает использование последней метки времени бара вместо начала бара, как времени бара
+		 */
+		ClusterShaper(const size_t p, const double ps, const bool ubst = false) :
+			shaper(p, ps, ubst) {
+		}
+
+		std::function<void(const Cluster &cluster)> on_close_bar;				/**< Функция обратного вызова в момент закрытия бара */
+		std::function<void(const Cluster &cluster)> on_unformed_bar = nullptr;	/**< Функция обратного вызова для несформированного бара */
+
+		/** \brief Обновить состояние индикатора
+		 * \param input		Текущая цена
+		 * \param timestamp Метка времени в секундах
+		 */
+		int update(const double input, const uint64_t timestamp) noexcept {
+			FunctionSink sink(on_close_bar, on_unformed_bar);
+			return shaper.update(input, timestamp, sink);
 		}
 
 		/** \brief Очистить данные индикатора
 		 */
 		inline void clear() noexcept {
-			cluster = Cluster();
-			last_bar = 0;
-			is_once = false;
+			shaper.clear();
 		}
 	}; // ClusterShaper
 
@@ -102,6 +102,74 @@ namespace xtechnical {
             output_value = std::numeric_limits<T>::quiet_NaN();
         }
     };
+    /** \brief Линия задержки с периодом, заданным на этапе компиляции
+     */
+    template <typename T, size_t N>
+    class FixedDelayLine {
+    private:
+        fixed_delay_buffer<T, (N > 0 ? N : 1)> buffer;
+        T output_value = std::numeric_limits<T>::quiet_NaN();
+    public:
+
+        FixedDelayLine() {};
+
+        /** \brief Конструктор для совместимости с DelayLine
+         * \param p     Период, должен совпадать с параметром шаблона N
+         */
+        explicit FixedDelayLine(const size_t p) {
+            assert(p == N);
+            (void)p;
+        };
+
+        int update(const T in) noexcept {
+            if(N == 0) {
+                output_value = in;
+                return common::OK;
+            }
+            if(!buffer.ready()) {
+                buffer.push(in);
+                output_value = std::numeric_limits<T>::quiet_NaN();
+                return common::INDICATOR_NOT_READY_TO_WORK;
+            }
+            output_value = buffer.lag();
+            buffer.push(in);
+            return common::OK;
+        }
+
+        int update(const T in, T &out) noexcept {
+            const int err = update(in);
+            out = output_value;
+            return err;
+        }
+
+        int test(const T in) noexcept {
+            if(N == 0) {
+                output_value = in;
+                return common::OK;
+            }
+            if(!buffer.ready()) {
+                output_value = std::numeric_limits<T>::quiet_NaN();
+                return common::INDICATOR_NOT_READY_TO_WORK;
+            }
+            output_value = buffer.lag();
+            return common::OK;
+        }
+
+        int test(const T in, T &out) noexcept {
+            const int err = test(in);
+            out = output_value;
+            return err;
+        }
+
+        inline T get() const noexcept {
+            return output_value;
+        }
+
+        inline void clear() noexcept {
+            buffer.clear();
+            output_value = std::numeric_limits<T>::quiet_NaN();
+        }
+    };
 }; // xtechnical
 
 #endif // XTECHNICAL_FAST_MIN_MAX_HPP_INCLUDED
@@ -44,7 +44,7 @@ namespace xtechnical {
 			T value = diff == 0 ? (0.33 * 2 * (0 - 0.5) + 0.67 * prev_value) :
 				(0.33 * 2 * ((price - min_low.get_min()) / (diff) - 0.5) + 0.67 * prev_value);
 
-			value = std::min(std::max(value, -0.999), 0.999);
+			value = std::min(std::max(value, (T)-0.999), (T)0.999);
 
 			if ((1 - value) == 0) output_value = 0.5 + 0.5 * prev_fish;
 			else output_value = 0.5 * std::log((1 + value)/(1 - value)) + 0.5 * prev_fish;
@@ -102,7 +102,7 @@ namespace xtechnical {
 			T value = diff == 0 ? (0.33 * 2 * (0 - 0.5) + 0.67 * prev_value) :
 				(0.33 * 2 * ((price - min_low.get_min()) / (diff) - 0.5) + 0.67 * prev_value);
 
-			value = std::min(std::max(value, -0.999), 0.999);
+			value = std::min(std::max(value, (T)-0.999), (T)0.999);
 
 			if ((1 - value) == 0) output_value = 0.5 + 0.5 * prev_fish;
 			else output_value = 0.5 * std::log((1 + value)/(1 - value)) + 0.5 * prev_fish;
@@ -193,7 +193,7 @@ namespace xtechnical {
 			T value = diff == 0 ? (0.33 * 2 * (0 - 0.5) + 0.67 * prev_value) :
 				(0.33 * 2 * ((price - min_max.get_min()) / (diff) - 0.5) + 0.67 * prev_value);
 
-			value = std::min(std::max(value, -0.999), 0.999);
+			value = std::min(std::max(value, (T)-0.999), (T)0.999);
 
 			if ((1 - value) == 0) output_value = 0.5 + 0.5 * prev_fish;
 			else output_value = 0.5 * std::log((1 + value)/(1 - value)) + 0.5 * prev_fish;
@@ -228,7 +228,7 @@ namespace xtechnical {
 			T value = diff == 0 ? (0.33 * 2 * (0 - 0.5) + 0.67 * prev_value) :
 				(0.33 * 2 * ((price - min_max.get_min()) / (diff) - 0.5) + 0.67 * prev_value);
 
-			value = std::min(std::max(value, -0.999), 0.999);
+			value = std::min(std::max(value, (T)-0.999), (T)0.999);
 
 			if ((1 - value) == 0) output_value = 0.5 + 0.5 * prev_fish;
 			else output_value = 0.5 * std::log((1 + value)/(1 - value)) + 0.5 * prev_fish;
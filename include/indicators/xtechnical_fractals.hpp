@@ -2,26 +2,189 @@
 #define XTECHNICAL_FRACTALS_HPP_INCLUDED
 
 #include "../xtechnical_common.hpp"
+#include "../math/xtechnical_simd.hpp"
 
 namespace xtechnical {
 
-	/** \brief Фракталы Билла Вильямса
+	/** \brief Пустой приемник фракталов
+	 *
+	 * Приемник для BasicFractals должен иметь методы on_up и on_dn,
+	 * от этого класса можно наследоваться, чтобы не писать ненужный метод
+	 */
+	class FractalsSink {
+	public:
+		inline void on_up(const double) {};
+		inline void on_dn(const double) {};
+	};
+
+	/** \brief Фракталы Билла Вильямса со статическим приемником фракталов
+	 *
+	 * Методы приемника вызываются напрямую и могут быть встроены компилятором.
 	 * Оригинал: https://www.mql5.com/en/code/viewcode/7982/130162/Fractals.mq4
 	 */
-	template <typename T>
-	class Fractals {
+	template <typename T, class SINK = FractalsSink>
+	class BasicFractals {
 	private:
-		circular_buffer<T> buffer_up;
-		circular_buffer<T> buffer_dn;
+		static const size_t WINDOW = 9;
+
+		// регистры сдвига, 0 - самый старый бар, 8 - самый новый
+		std::array<T, WINDOW> values_up;
+		std::array<T, WINDOW> values_dn;
+		size_t count = 0;
 
 		T save_output_up = std::numeric_limits<T>::quiet_NaN();
 		T save_output_dn = std::numeric_limits<T>::quiet_NaN();
 		T output_up = std::numeric_limits<T>::quiet_NaN();
 		T output_dn = std::numeric_limits<T>::quiet_NaN();
 
+		static inline void shift(std::array<T, WINDOW> &values, const T value) noexcept {
+			for (size_t i = 1; i < WINDOW; ++i) values[i - 1] = values[i];
+			values[WINDOW - 1] = value;
+		}
+
+		template<class S>
+		int process(const T *up, const T *dn, S &s, const bool is_save) noexcept {
+			// Fractals up
+			if (simd::scalar::is_fractal_up(up)) {
+				output_up = up[6];
+				if (is_save) save_output_up = output_up;
+				s.on_up(up[6]);
+			} else {
+				output_up = save_output_up;
+			}
+			// Fractals down
+			if (simd::scalar::is_fractal_dn(dn)) {
+				output_dn = dn[6];
+				if (is_save) save_output_dn = output_dn;
+				s.on_dn(dn[6]);
+			} else {
+				output_dn = save_output_dn;
+			}
+			return common::OK;
+		}
+
 	public:
-	
-		Fractals() : buffer_up(9), buffer_dn(9) {};
+
+		SINK sink;	/**< Приемник фракталов */
+
+		BasicFractals() {
+			values_up.fill(0);
+			values_dn.fill(0);
+		};
+
+		BasicFractals(const SINK &s) : sink(s) {
+			values_up.fill(0);
+			values_dn.fill(0);
+		};
+
+		/** \brief Обновить состояние индикатора
+		 * \param high		Максимальное значение бара
+		 * \param low		Минимальное значение бара
+		 * \return Вернет 0 в случае успеха, иначе см. ErrorType
+		 */
+		inline int update(const T high, const T low) noexcept {
+			return update(high, low, sink);
+		}
+
+		/** \brief Обновить состояние индикатора с указанным приемником фракталов
+		 * \param high		Максимальное значение бара
+		 * \param low		Минимальное значение бара
+		 * \param s			Приемник фракталов
+		 * \return Вернет 0 в случае успеха, иначе см. ErrorType
+		 */
+		template<class S>
+		int update(const T high, const T low, S &s) noexcept {
+			shift(values_up, high);
+			shift(values_dn, low);
+			if (count < WINDOW) ++count;
+			if (count < WINDOW) return common::INDICATOR_NOT_READY_TO_WORK;
+			return process(values_up.data(), values_dn.data(), s, true);
+		}
+
+		/** \brief Протестировать индикатор
+		 * \param high		Максимальное значение бара
+		 * \param low		Минимальное значение бара
+		 * \return Вернет 0 в случае успеха, иначе см. ErrorType
+		 */
+		inline int test(const T high, const T low) noexcept {
+			return test(high, low, sink);
+		}
+
+		/** \brief Протестировать индикатор с указанным приемником фракталов
+		 * \param high		Максимальное значение бара
+		 * \param low		Минимальное значение бара
+		 * \param s			Приемник фракталов
+		 * \return Вернет 0 в случае успеха, иначе см. ErrorType
+		 */
+		template<class S>
+		int test(const T high, const T low, S &s) noexcept {
+			if ((count + 1) < WINDOW) return common::INDICATOR_NOT_READY_TO_WORK;
+			std::array<T, WINDOW> test_up = values_up;
+			std::array<T, WINDOW> test_dn = values_dn;
+			shift(test_up, high);
+			shift(test_dn, low);
+			return process(test_up.data(), test_dn.data(), s, false);
+		}
+
+		/** \brief Получить значение нижнего фрактала
+		 * \return Значение нижнего фрактала
+		 */
+		inline T get_up() const noexcept {
+			return output_up;
+		}
+
+		/** \brief Получить значение верхнего фрактала
+		 * \return Значение верхнего фрактала
+		 */
+		inline T get_dn() const noexcept {
+			return output_dn;
+		}
+
+		/** \brief Очистить данные индикатора
+		 */
+		inline void clear() noexcept {
+			count = 0;
+			output_up = std::numeric_limits<T>::quiet_NaN();
+			output_dn = std::numeric_limits<T>::quiet_NaN();
+			save_output_up = std::numeric_limits<T>::quiet_NaN();
+			save_output_dn = std::numeric_limits<T>::quiet_NaN();
+		}
+	};
+
+	/** \brief Приемник фракталов, вызывающий функции std::function
+	 */
+	class FractalsFunctionSink {
+	public:
+		const std::function<void(const double value)> &up;
+		const std::function<void(const double value)> &dn;
+
+		FractalsFunctionSink(
+			const std::function<void(const double value)> &u,
+			const std::function<void(const double value)> &d) :
+			up(u), dn(d) {};
+
+		inline void on_up(const double value) {
+			if (up) up(value);
+		}
+
+		inline void on_dn(const double value) {
+			if (dn) dn(value);
+		}
+	};
+
+	/** \brief Фракталы Билла Вильямса
+	 *
+	 * Версия с функциями обратного вызова std::function поверх BasicFractals.
+	 * Оригинал: https://www.mql5.com/en/code/viewcode/7982/130162/Fractals.mq4
+	 */
+	template <typename T>
+	class Fractals {
+	private:
+		BasicFractals<T> fractals;
+
+	public:
+
+		Fractals() {};
 
 		/** \brief Обновить состояние индикатора
 		 * \param high		Максимальное значение бара
@@ -31,130 +194,12 @@ namespace xtechnical {
 		 * \return Вернет 0 в случае успеха, иначе см. ErrorType
 		 */
 		int update(
-				const T high, 
-				const T low, 
-				std::function<void(const double value)> on_up = nullptr, 
+				const T high,
+				const T low,
+				std::function<void(const double value)> on_up = nullptr,
 				std::function<void(const double value)> on_dn = nullptr) noexcept {
-			buffer_up.update(high);
-			buffer_dn.update(low);
-
-			if(buffer_up.full()) {
-				// Fractals up
-				const std::vector<T> values = buffer_up.to_vector();
-				// 0 1 2 3 4 5 6 7 8
-
-				// 5 bars Fractal
-				if (values[6] > values[4] &&
-					values[6] > values[5] &&
-					values[6] > values[7] &&
-					values[6] > values[8]) {
-					save_output_up = output_up = values[6];
-					if (on_up) on_up(values[6]);
-				} else
-				// 6 bars Fractal
-				if (values[6] > values[3] &&
-					values[6] > values[4] &&
-					values[6] == values[5] &&
-					values[6] > values[7] &&
-					values[6] > values[8]) {
-					save_output_up = output_up = values[6];
-					if (on_up) on_up(values[6]);
-				} else
-				// 7 bars Fractal
-				if (values[6] > values[2] &&
-					values[6] > values[3] &&
-					values[6] == values[4] &&
-					values[6] >= values[5] &&
-					values[6] > values[7] &&
-					values[6] > values[8]) {
-					save_output_up = output_up = values[6];
-					if (on_up) on_up(values[6]);
-				} else
-				// 8 bars Fractal
-				if (values[6] > values[1] &&
-					values[6] > values[2] &&
-					values[6] == values[3] &&
-					values[6] == values[4] &&
-					values[6] >= values[5] &&
-					values[6] > values[7] &&
-					values[6] > values[8]) {
-					save_output_up = output_up = values[6];
-					if (on_up) on_up(values[6]);
-				} else
-				// 9 bars Fractal
-				if (values[6] > values[0] &&
-					values[6] > values[1] &&
-					values[6] == values[2] &&
-					values[6] >= values[3] &&
-					values[6] == values[4] &&
-					values[6] >= values[5] &&
-					values[6] > values[7] &&
-					values[6] > values[8]) {
-					save_output_up = output_up = values[6];
-					if (on_up) on_up(values[6]);
-				} else {
-					output_up = save_output_up;
-				}
-			} else return common::INDICATOR_NOT_READY_TO_WORK;
-			if(buffer_dn.full()) {
-				// Fractals down
-				const std::vector<T> values = buffer_dn.to_vector();
-				// 0 1 2 3 4 5 6 7 8
-
-				// 5 bars Fractal
-				if (values[6] < values[4] &&
-					values[6] < values[5] &&
-					values[6] < values[7] &&
-					values[6] < values[8]) {
-					save_output_dn = output_dn = values[6];
-					if (on_dn) on_dn(values[6]);
-				} else
-				// 6 bars Fractal
-				if (values[6] < values[3] &&
-					values[6] < values[4] &&
-					values[6] == values[5] &&
-					values[6] < values[7] &&
-					values[6] < values[8]) {
-					save_output_dn = output_dn = values[6];
-					if (on_dn) on_dn(values[6]);
-				} else
-				// 7 bars Fractal
-				if (values[6] < values[2] &&
-					values[6] < values[3] &&
-					values[6] == values[4] &&
-					values[6] <= values[5] &&
-					values[6] < values[7] &&
-					values[6] < values[8]) {
-					save_output_dn = output_dn = values[6];
-					if (on_dn) on_dn(values[6]);
-				} else
-				// 8 bars Fractal
-				if (values[6] < values[1] &&
-					values[6] < values[2] &&
-					values[6] == values[3] &&
-					values[6] == values[4] &&
-					values[6] <= values[5] &&
-					values[6] < values[7] &&
-					values[6] < values[8]) {
-					save_output_dn = output_dn = values[6];
-					if (on_dn) on_dn(values[6]);
-				} else
-				// 9 bars Fractal
-				if (values[6] < values[0] &&
-					values[6] < values[1] &&
-					values[6] == values[2] &&
-					values[6] <= values[3] &&
-					values[6] == values[4] &&
-					values[6] <= values[5] &&
-					values[6] < values[7] &&
-					values[6] < values[8]) {
-					save_output_dn = output_dn = values[6];
-					if (on_dn) on_dn(values[6]);
-				} else {
-					output_dn = save_output_dn;
-				}
-			} else return common::INDICATOR_NOT_READY_TO_WORK;
-			return common::OK;
+			FractalsFunctionSink sink(on_up, on_dn);
+			return fractals.update(high, low, sink);
 		}
 
 		/** \brief Протестировать индикатор
@@ -165,158 +210,73 @@ namespace xtechnical {
 		 * \return Вернет 0 в случае успеха, иначе см. ErrorType
 		 */
 		int test(
-				const T high, 
-				const T low, 
-				std::function<void(const double value)> on_up = nullptr, 
+				const T high,
+				const T low,
+				std::function<void(const double value)> on_up = nullptr,
 				std::function<void(const double value)> on_dn = nullptr) noexcept {
-			buffer_up.test(high);
-			buffer_dn.test(low);
-
-			if(buffer_up.full()) {
-				// Fractals up
-				const std::vector<T> values = buffer_up.to_vector();
-				// 0 1 2 3 4 5 6 7 8
-
-				// 5 bars Fractal
-				if (values[6] > values[4] &&
-					values[6] > values[5] &&
-					values[6] > values[7] &&
-					values[6] > values[8]) {
-					output_up = values[6];
-					if (on_up) on_up(values[6]);
-				} else
-				// 6 bars Fractal
-				if (values[6] > values[3] &&
-					values[6] > values[4] &&
-					values[6] == values[5] &&
-					values[6] > values[7] &&
-					values[6] > values[8]) {
-					output_up = values[6];
-					if (on_up) on_up(values[6]);
-				} else
-				// 7 bars Fractal
-				if (values[6] > values[2] &&
-					values[6] > values[3] &&
-					values[6] == values[4] &&
-					values[6] >= values[5] &&
-					values[6] > values[7] &&
-					values[6] > values[8]) {
-					output_up = values[6];
-					if (on_up) on_up(values[6]);
-				} else
-				// 8 bars Fractal
-				if (values[6] > values[1] &&
-					values[6] > values[2] &&
-					values[6] == values[3] &&
-					values[6] == values[4] &&
-					values[6] >= values[5] &&
-					values[6] > values[7] &&
-					values[6] > values[8]) {
-					output_up = values[6];
-					if (on_up) on_up(values[6]);
-				} else
-				// 9 bars Fractal
-				if (values[6] > values[0] &&
-					values[6] > values[1] &&
-					values[6] == values[2] &&
-					values[6] >= values[3] &&
-					values[6] == values[4] &&
-					values[6] >= values[5] &&
-					values[6] > values[7] &&
-					values[6] > values[8]) {
-					output_up = values[6];
-					if (on_up) on_up(values[6]);
-				} else {
-					output_up = save_output_up;
-				}
-			} else return common::INDICATOR_NOT_READY_TO_WORK;
-			if(buffer_dn.full()) {
-				// Fractals down
-				const std::vector<T> values = buffer_dn.to_vector();
-				// 0 1 2 3 4 5 6 7 8
-
-				// 5 bars Fractal
-				if (values[6] < values[4] &&
-					values[6] < values[5] &&
-					values[6] < values[7] &&
-					values[6] < values[8]) {
-					output_dn = values[6];
-					if (on_dn) on_dn(values[6]);
-				} else
-				// 6 bars Fractal
-				if (values[6] < values[3] &&
-					values[6] < values[4] &&
-					values[6] == values[5] &&
-					values[6] < values[7] &&
-					values[6] < values[8]) {
-					output_dn = values[6];
-					if (on_dn) on_dn(values[6]);
-				} else
-				// 7 bars Fractal
-				if (values[6] < values[2] &&
-					values[6] < values[3] &&
-					values[6] == values[4] &&
-					values[6] <= values[5] &&
-					values[6] < values[7] &&
-					values[6] < values[8]) {
-					output_dn = values[6];
-					if (on_dn) on_dn(values[6]);
-				} else
-				// 8 bars Fractal
-				if (values[6] < values[1] &&
-					values[6] < values[2] &&
-					values[6] == values[3] &&
-					values[6] == values[4] &&
-					values[6] <= values[5] &&
-					values[6] < values[7] &&
-					values[6] < values[8]) {
-					output_dn = values[6];
-					if (on_dn) on_dn(values[6]);
-				} else
-				// 9 bars Fractal
-				if (values[6] < values[0] &&
-					values[6] < values[1] &&
-					values[6] == values[2] &&
-					values[6] <= values[3] &&
-					values[6] == values[4] &&
-					values[6] <= values[5] &&
-					values[6] < values[7] &&
-					values[6] < values[8]) {
-					output_dn = values[6];
-					if (on_dn) on_dn(values[6]);
-				} else {
-					output_dn = save_output_dn;
-				}
-			} else return common::INDICATOR_NOT_READY_TO_WORK;
-			return common::OK;
+			FractalsFunctionSink sink(on_up, on_dn);
+			return fractals.test(high, low, sink);
 		}
 
 		/** \brief Получить значение нижнего фрактала
 		 * \return Значение нижнего фрактала
 		 */
 		inline T get_up() const noexcept {
-			return output_up;
+			return fractals.get_up();
 		}
 
 		/** \brief Получить значение верхнего фрактала
 		 * \return Значение верхнего фрактала
 		 */
 		inline T get_dn() const noexcept {
-			return output_dn;
+			return fractals.get_dn();
 		}
 
 		/** \brief Очистить данные индикатора
 		 */
 		inline void clear() noexcept {
-			buffer_up.clear();
-			buffer_dn.clear();
-			output_up = std::numeric_limits<T>::quiet_NaN();
-			output_dn = std::numeric_limits<T>::quiet_NaN();
-			save_output_up = std::numeric_limits<T>::quiet_NaN();
-			save_output_dn = std::numeric_limits<T>::quiet_NaN();
+			fractals.clear();
 		}
 	};
 
+	/** \brief Найти фракталы Билла Вильямса в массивах баров
+	 *
+	 * Пакетная версия BasicFractals::update для исторических данных.
+	 * Бит j массива up (dn) устанавливается, если после бара j образовался
+	 * верхний (нижний) фрактал с вершиной на баре j - 2.
+	 * Для непрерывных массивов float/double используются векторные ядра.
+	 * \param high	Максимальные значения баров
+	 * \param low		Минимальные значения баров
+	 * \param up		Битовый массив верхних фракталов
+	 * \param dn		Битовый массив нижних фракталов
+	 * \return Вернет 0 в случае успеха, иначе см. ErrorType
+	 */
+	template<class T1>
+	int calculate_fractals(const T1 &high, const T1 &low, std::vector<uint64_t> &up, std::vector<uint64_t> &dn) {
+		const size_t n = high.size();
+		if (n == 0 || low.size() != n) return common::INVALID_PARAMETER;
+		up.resize((n + 63) / 64);
+		dn.resize((n + 63) / 64);
+		typedef simd::contiguous_array<T1> array_t;
+		if (array_t::value) {
+			simd::fractals(array_t::data(high), array_t::data(low), n, up.data(), dn.data());
+			return common::OK;
+		}
+		const std::vector<double> h(high.begin(), high.end());
+		const std::vector<double> l(low.begin(), low.end());
+		simd::fractals(h.data(), l.data(), n, up.data(), dn.data());
+		return common::OK;
+	}
+
+	/** \brief Проверить бит в битовом массиве фракталов
+	 * \param bits	Битовый массив из calculate_fractals
+	 * \param index	Индекс бара
+	 * \return Вернет true, если бит установлен
+	 */
+	inline bool check_fractal_bit(const std::vector<uint64_t> &bits, const size_t index) noexcept {
+		return ((bits[index >> 6] >> (index & 63)) & 1) != 0;
+	}
+
 }; // xtechnical
 
 #endif // XTECHNICAL_FRACTALS_HPP_INCLUDED
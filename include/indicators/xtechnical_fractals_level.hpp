@@ -6,12 +6,52 @@
 
 namespace xtechnical {
 
-	/** \brief Уровни по фракталам Билла Вильямса
+	/** \brief Уровни по фракталам Билла Вильямса со статическим приемником уровней
+	 *
+	 * Методы приемника (on_up и on_dn, см. FractalsSink) вызываются напрямую
+	 * и могут быть встроены компилятором
 	 */
-	template <typename T>
-	class FractalsLevel {
+	template <typename T, class SINK = FractalsSink>
+	class BasicFractalsLevel {
 	private:
-		Fractals<T> fractals;
+
+		/** \brief Приемник фракталов, добавляющий их в буферы уровней
+		 */
+		class UpdateSink {
+		public:
+			circular_buffer<T> &up;
+			circular_buffer<T> &dn;
+
+			UpdateSink(circular_buffer<T> &u, circular_buffer<T> &d) : up(u), dn(d) {};
+
+			inline void on_up(const double value) {
+				up.update(value);
+			}
+
+			inline void on_dn(const double value) {
+				dn.update(value);
+			}
+		};
+
+		/** \brief Приемник фракталов для тестирования буферов уровней
+		 */
+		class TestSink {
+		public:
+			circular_buffer<T> &up;
+			circular_buffer<T> &dn;
+
+			TestSink(circular_buffer<T> &u, circular_buffer<T> &d) : up(u), dn(d) {};
+
+			inline void on_up(const double value) {
+				up.test(value);
+			}
+
+			inline void on_dn(const double value) {
+				dn.test(value);
+			}
+		};
+
+		BasicFractals<T> fractals;
 		circular_buffer<T> buffer_up;
 		circular_buffer<T> buffer_dn;
 
@@ -19,59 +59,33 @@ namespace xtechnical {
 		T output_dn = std::numeric_limits<T>::quiet_NaN();
 		T save_output_up = std::numeric_limits<T>::quiet_NaN();
 		T save_output_dn = std::numeric_limits<T>::quiet_NaN();
-	public:
-	
-		std::function<void(const double value)> on_up = nullptr;
-		std::function<void(const double value)> on_dn = nullptr;
 
-		FractalsLevel() : buffer_up(3), buffer_dn(3) {};
-
-		/** \brief Обновить состояние индикатора
-		 * \param high		Максимальное значение бара
-		 * \param low		Минимальное значение бара
-		 * \param on_up		Функция обратного вызова для верхнего уровня
-		 * \param on_dn		Функция обратного вызова для нижнего уровня
-		 * \return Вернет 0 в случае успеха, иначе см. ErrorType
-		 */
-		int update(
-				const T high, 
-				const T low, 
-				std::function<void(const double value)> on_up = nullptr, 
-				std::function<void(const double value)> on_dn = nullptr) noexcept {
-			
-			fractals.update(
-				high, 
-				low, 
-				[&](const double value){
-					buffer_up.update(value);
-				},
-				[&](const double value){
-					buffer_dn.update(value);
-				}
-			);
-			
+		template<class S>
+		int process(S &s, const bool is_save) noexcept {
 			if(buffer_up.full()) {
 				// Fractals up
-				const std::vector<T> values = buffer_up.to_vector();
+				const circular_buffer_view<T> values = buffer_up.view();
 				// 0 1 2
 
 				if (values[1] > values[0] &&
 					values[1] > values[2]) {
-					save_output_up = output_up = values[1];
-					if (on_up) on_up(values[1]);
+					output_up = values[1];
+					if (is_save) save_output_up = output_up;
+					s.on_up(values[1]);
 				} else {
 					output_up = save_output_up;
 				}
 			} else return common::INDICATOR_NOT_READY_TO_WORK;
 			if(buffer_dn.full()) {
 				// Fractals down
-				std::vector<T> values = buffer_dn.to_vector();
+				const circular_buffer_view<T> values = buffer_dn.view();
 				// 0 1 2
 
 				if (values[1] < values[0] &&
 					values[1] < values[2]) {
-					save_output_dn = output_dn = values[1];
-					if (on_dn) on_dn(values[1]);
+					output_dn = values[1];
+					if (is_save) save_output_dn = output_dn;
+					s.on_dn(values[1]);
 				} else {
 					output_dn = save_output_dn;
 				}
@@ -79,57 +93,56 @@ namespace xtechnical {
 			return common::OK;
 		}
 
-		/** \brief Протестировать индикатор
+	public:
+
+		SINK sink;	/**< Приемник уровней */
+
+		BasicFractalsLevel() : buffer_up(3), buffer_dn(3) {};
+
+		BasicFractalsLevel(const SINK &s) : buffer_up(3), buffer_dn(3), sink(s) {};
+
+		/** \brief Обновить состояние индикатора
 		 * \param high		Максимальное значение бара
 		 * \param low		Минимальное значение бара
-		 * \param on_up		Функция обратного вызова для верхнего уровня
-		 * \param on_dn		Функция обратного вызова для нижнего уровня
 		 * \return Вернет 0 в случае успеха, иначе см. ErrorType
 		 */
-		int test(
-				const T high, 
-				const T low, 
-				std::function<void(const double value)> on_up = nullptr, 
-				std::function<void(const double value)> on_dn = nullptr) noexcept {
-		   
-			fractals.test(
-				high, 
-				low, 
-				[&](const double value){
-					buffer_up.test(value);
-				},
-				[&](const double value){
-					buffer_dn.test(value);
-				}
-			);
-			
-			if(buffer_up.full()) {
-				// Fractals up
-				const std::vector<T> values = buffer_up.to_vector();
-				// 0 1 2
+		inline int update(const T high, const T low) noexcept {
+			return update(high, low, sink);
+		}
 
-				if (values[1] > values[0] &&
-					values[1] > values[2]) {
-					output_up = values[1];
-					if (on_up) on_up(values[1]);
-				} else {
-					output_up = save_output_up;
-				}
-			} else return common::INDICATOR_NOT_READY_TO_WORK;
-			if(buffer_dn.full()) {
-				// Fractals down
-				std::vector<T> values = buffer_dn.to_vector();
-				// 0 1 2
+		/** \brief Обновить состояние индикатора с указанным приемником уровней
+		 * \param high		Максимальное значение бара
+		 * \param low		Минимальное значение бара
+		 * \param s			Приемник уровней
+		 * \return Вернет 0 в случае успеха, иначе см. ErrorType
+		 */
+		template<class S>
+		int update(const T high, const T low, S &s) noexcept {
+			UpdateSink levels(buffer_up, buffer_dn);
+			fractals.update(high, low, levels);
+			return process(s, true);
+		}
 
-				if (values[1] < values[0] &&
-					values[1] < values[2]) {
-					output_dn = values[1];
-					if (on_dn) on_dn(values[1]);
-				} else {
-					output_dn = save_output_dn;
-				}
-			} else return common::INDICATOR_NOT_READY_TO_WORK;
-			return common::OK;
+		/** \brief Протестировать индикатор
+		 * \param high		Максимальное значение бара
+		 * \param low		Минимальное значение бара
+		 * \return Вернет 0 в случае успеха, иначе см. ErrorType
+		 */
+		inline int test(const T high, const T low) noexcept {
+			return test(high, low, sink);
+		}
+
+		/** \brief Протестировать индикатор с указанным приемником уровней
+		 * \param high		Максимальное значение бара
+		 * \param low		Минимальное значение бара
+		 * \param s			Приемник уровней
+		 * \return Вернет 0 в случае успеха, иначе см. ErrorType
+		 */
+		template<class S>
+		int test(const T high, const T low, S &s) noexcept {
+			TestSink levels(buffer_up, buffer_dn);
+			fractals.test(high, low, levels);
+			return process(s, false);
 		}
 
 		/** \brief Получить значение нижнего фрактала
@@ -159,6 +172,75 @@ namespace xtechnical {
 		}
 	};
 
+	/** \brief Уровни по фракталам Билла Вильямса
+	 *
+	 * Версия с функциями обратного вызова std::function поверх BasicFractalsLevel
+	 */
+	template <typename T>
+	class FractalsLevel {
+	private:
+		BasicFractalsLevel<T> levels;
+
+	public:
+
+		std::function<void(const double value)> on_up = nullptr;
+		std::function<void(const double value)> on_dn = nullptr;
+
+		FractalsLevel() {};
+
+		/** \brief Обновить состояние индикатора
+		 * \param high		Максимальное значение бара
+		 * \param low		Минимальное значение бара
+		 * \param on_up		Функция обратного вызова для верхнего уровня
+		 * \param on_dn		Функция обратного вызова для нижнего уровня
+		 * \return Вернет 0 в случае успеха, иначе см. ErrorType
+		 */
+		int update(
+				const T high,
+				const T low,
+				std::function<void(const double value)> on_up = nullptr,
+				std::function<void(const double value)> on_dn = nullptr) noexcept {
+			FractalsFunctionSink sink(on_up, on_dn);
+			return levels.update(high, low, sink);
+		}
+
+		/** \brief Протестировать индикатор
+		 * \param high		Максимальное значение бара
+		 * \param low		Минимальное значение бара
+		 * \param on_up		Функция обратного вызова для верхнего уровня
+		 * \param on_dn		Функция обратного вызова для нижнего уровня
+		 * \return Вернет 0 в случае успеха, иначе см. ErrorType
+		 */
+		int test(
+				const T high,
+				const T low,
+				std::function<void(const double value)> on_up = nullptr,
+				std::function<void(const double value)> on_dn = nullptr) noexcept {
+			FractalsFunctionSink sink(on_up, on_dn);
+			return levels.test(high, low, sink);
+		}
+
+		/** \brief Получить значение нижнего фрактала
+		 * \return Значение нижнего фрактала
+		 */
+		inline T get_up() const noexcept {
+			return levels.get_up();
+		}
+
+		/** \brief Получить значение верхнего фрактала
+		 * \return Значение верхнего фрактала
+		 */
+		inline T get_dn() const noexcept {
+			return levels.get_dn();
+		}
+
+		/** \brief Очистить данные индикатора
+		 */
+		inline void clear() noexcept {
+			levels.clear();
+		}
+	};
+
 }; // xtechnical
 
 #endif // XTECHNICAL_FRACTALS_LEVEL_HPP_INCLUDED
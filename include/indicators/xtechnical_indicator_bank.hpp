@@ -0,0 +1,598 @@
+#ifndef XTECHNICAL_INDICATOR_BANK_HPP_INCLUDED
+#define XTECHNICAL_INDICATOR_BANK_HPP_INCLUDED
+
+#include "../xtechnical_common.hpp"
+#include "../math/xtechnical_simd.hpp"
+#include "xtechnical_sma.hpp"
+#include "xtechnical_rsi.hpp"
+#include "xtechnical_true_range.hpp"
+#include "xtechnical_atr.hpp"
+#include <vector>
+#include <limits>
+#include <cmath>
+
+namespace xtechnical {
+
+    template <class T> class EMA;
+    template <class T> class MMA;
+    template <typename T> class StdDev;
+
+    /** \brief Банк индикаторов одного типа для множества символов
+     *
+     * Состояние хранится структурой массивов: элемент i каждого массива
+     * относится к символу i, а кольцевой буфер лежит по слотам
+     * [слот][символ]. Все символы обновляются одновременно одним вызовом
+     * update_all по массиву цен закрытия бара, который проходит
+     * по символам векторными ядрами simd::lane_*.
+     * Выход каждого символа побитно совпадает с отдельным экземпляром
+     * индикатора, получившим те же данные.
+     *
+     * Банк реализован для SMA, EMA, MMA, StdDev, RSI, TrueRange и ATR.
+     *
+     * Пример:
+     * \code
+     * xtechnical::IndicatorBank<xtechnical::SMA<double>> bank(symbols, 20);
+     * bank.update_all(close.data());
+     * double value = bank.get(symbol);
+     * \endcode
+     */
+    template <class INDICATOR>
+    class IndicatorBank;
+
+    /** \brief Банк простых скользящих средних
+     */
+    template <class T>
+    class IndicatorBank<SMA<T>> {
+    private:
+        std::vector<T> ring;    /**< Кольцевой буфер [слот][символ] */
+        std::vector<T> sum;
+        std::vector<T> output;
+        size_t symbols = 0;
+        size_t period = 0;
+        size_t pos = 0;
+        size_t count = 0;
+
+        inline void set_nan() noexcept {
+            std::fill(output.begin(), output.end(), std::numeric_limits<T>::quiet_NaN());
+        }
+
+    public:
+
+        IndicatorBank() {};
+
+        /** \brief Конструктор банка
+         * \param s     Количество символов
+         * \param p     Период
+         */
+        IndicatorBank(const size_t s, const size_t p) :
+            ring(s * p), sum(s, 0), output(s, std::numeric_limits<T>::quiet_NaN()),
+            symbols(s), period(p) {
+        }
+
+        /** \brief Обновить состояние всех символов
+         * \param in    Массив сигналов на входе длиной size()
+         * \return Вернет 0 в случае успеха, иначе см. ErrorType
+         */
+        int update_all(const T *in) noexcept {
+            if (period == 0) {
+                set_nan();
+                return common::NO_INIT;
+            }
+            T *slot = ring.data() + pos * symbols;
+            if (++pos == period) pos = 0;
+            if (count < period) {
+                ++count;
+                std::copy(in, in + symbols, slot);
+                simd::lane_add(sum.data(), in, symbols);
+                set_nan();
+                return common::INDICATOR_NOT_READY_TO_WORK;
+            }
+            simd::lane_sma_update(sum.data(), slot, in, output.data(), symbols, (T)period);
+            return common::OK;
+        }
+
+        /** \brief Протестировать все символы
+         *
+         * Данная функция отличается от update_all тем,
+         * что не влияет на внутреннее состояние индикаторов
+         * \param in    Массив сигналов на входе длиной size()
+         * \return Вернет 0 в случае успеха, иначе см. ErrorType
+         */
+        int test_all(const T *in) noexcept {
+            if (period == 0 || count < period) {
+                set_nan();
+                return period == 0 ? common::NO_INIT : common::INDICATOR_NOT_READY_TO_WORK;
+            }
+            simd::lane_sma_test(sum.data(), ring.data() + pos * symbols, in, output.data(), symbols, (T)period);
+            return common::OK;
+        }
+
+        /** \brief Получить значение индикатора символа
+         * \param symbol    Индекс символа
+         */
+        inline T get(const size_t symbol) const noexcept {
+            return output[symbol];
+        }
+
+        /** \brief Получить массив значений всех символов
+         */
+        inline const T *get_data() const noexcept {
+            return output.data();
+        }
+
+        /** \brief Количество символов
+         */
+        inline size_t size() const noexcept {
+            return symbols;
+        }
+
+        inline size_t get_period() const noexcept {
+            return period;
+        }
+
+        /** \brief Очистить данные всех символов
+         */
+        void clear() noexcept {
+            std::fill(sum.begin(), sum.end(), 0);
+            set_nan();
+            pos = count = 0;
+        }
+    };
+
+    /** \brief Банк экспоненциально взвешенных скользящих средних
+     */
+    template <class T>
+    class IndicatorBank<EMA<T>> {
+    protected:
+        std::vector<T> last_data;
+        std::vector<T> output;
+        size_t symbols = 0;
+        size_t period = 0;
+        size_t count = 0;
+        T a = 0;
+
+        IndicatorBank(const size_t s, const size_t p, const T alpha) :
+            last_data(s, 0), output(s, std::numeric_limits<T>::quiet_NaN()),
+            symbols(s), period(p), a(alpha) {
+        }
+
+    public:
+
+        IndicatorBank() {};
+
+        /** \brief Конструктор банка
+         * \param s     Количество символов
+         * \param p     Период
+         */
+        IndicatorBank(const size_t s, const size_t p) :
+            IndicatorBank(s, p, 2.0/(T)(p + 1.0d)) {
+        }
+
+        /** \brief Обновить состояние всех символов
+         * \param in    Массив сигналов на входе длиной size()
+         * \return Вернет 0 в случае успеха, иначе см. ErrorType
+         */
+        int update_all(const T *in) noexcept {
+            if (period == 0) {
+                std::copy(in, in + symbols, output.begin());
+                return common::NO_INIT;
+            }
+            if (count < period) {
+                // пока период не набран, last_data хранит сумму, как std::accumulate в EMA
+                simd::lane_add(last_data.data(), in, symbols);
+                if (++count == period) {
+                    for (size_t i = 0; i < symbols; ++i) last_data[i] = last_data[i] / (T)period;
+                }
+                return common::INDICATOR_NOT_READY_TO_WORK;
+            }
+            simd::lane_ema_update(last_data.data(), in, output.data(), symbols, a);
+            return common::OK;
+        }
+
+        /** \brief Протестировать все символы
+         *
+         * Данная функция отличается от update_all тем,
+         * что не влияет на внутреннее состояние индикаторов
+         * \param in    Массив сигналов на входе длиной size()
+         * \return Вернет 0 в случае успеха, иначе см. ErrorType
+         */
+        int test_all(const T *in) noexcept {
+            if (period == 0) {
+                std::copy(in, in + symbols, output.begin());
+                return common::NO_INIT;
+            }
+            if (count < period) return common::INDICATOR_NOT_READY_TO_WORK;
+            simd::lane_ema_test(last_data.data(), in, output.data(), symbols, a);
+            return common::OK;
+        }
+
+        inline T get(const size_t symbol) const noexcept {
+            return output[symbol];
+        }
+
+        inline const T *get_data() const noexcept {
+            return output.data();
+        }
+
+        inline size_t size() const noexcept {
+            return symbols;
+        }
+
+        inline size_t get_period() const noexcept {
+            return period;
+        }
+
+        void clear() noexcept {
+            std::fill(last_data.begin(), last_data.end(), 0);
+            std::fill(output.begin(), output.end(), std::numeric_limits<T>::quiet_NaN());
+            count = 0;
+        }
+    };
+
+    /** \brief Банк модифицированных скользящих средних
+     */
+    template <class T>
+    class IndicatorBank<MMA<T>> : public IndicatorBank<EMA<T>> {
+    public:
+
+        IndicatorBank() {};
+
+        IndicatorBank(const size_t s, const size_t p) :
+            IndicatorBank<EMA<T>>(s, p, 1.0/(T)p) {
+        }
+    };
+
+    /** \brief Банк стандартных отклонений
+     *
+     * Сумма квадратов отклонений считается по окну за O(периода),
+     * как и в StdDev, но сразу для всех символов
+     */
+    template <class T>
+    class IndicatorBank<StdDev<T>> {
+    private:
+        std::vector<T> ring;    /**< Кольцевой буфер [слот][символ] */
+        std::vector<T> last_data;
+        std::vector<T> mean;
+        std::vector<T> sum;
+        std::vector<T> output;
+        size_t symbols = 0;
+        size_t period = 0;
+        size_t pos = 0;
+        size_t count = 0;
+
+        inline void set_nan() noexcept {
+            std::fill(output.begin(), output.end(), std::numeric_limits<T>::quiet_NaN());
+        }
+
+        /** \brief Посчитать отклонение по окну
+         * \param slot    Слот самого старого значения окна
+         * \param last    Самое новое значение окна
+         */
+        void calc(size_t slot, const T *last) noexcept {
+            std::fill(sum.begin(), sum.end(), 0);
+            for (size_t j = 1; j < period; ++j) {
+                simd::lane_sq_dev(sum.data(), ring.data() + slot * symbols, mean.data(), symbols);
+                if (++slot == period) slot = 0;
+            }
+            simd::lane_sq_dev(sum.data(), last, mean.data(), symbols);
+            for (size_t i = 0; i < symbols; ++i) {
+                const T s = sum[i] / (T)(period - 1);
+                output[i] = s > 0 ? std::sqrt(s) : 0;
+            }
+        }
+
+    public:
+
+        IndicatorBank() {};
+
+        /** \brief Конструктор банка
+         * \param s     Количество символов
+         * \param p     Период
+         */
+        IndicatorBank(const size_t s, const size_t p) :
+            ring(s * p), last_data(s, 0), mean(s), sum(s),
+            output(s, std::numeric_limits<T>::quiet_NaN()),
+            symbols(s), period(p) {
+        }
+
+        int update_all(const T *in) noexcept {
+            if (period == 0) {
+                set_nan();
+                return common::NO_INIT;
+            }
+            T *slot = ring.data() + pos * symbols;
+            if (++pos == period) pos = 0;
+            if (count < period) {
+                ++count;
+                std::copy(in, in + symbols, slot);
+                simd::lane_add(last_data.data(), in, symbols);
+                set_nan();
+                return common::INDICATOR_NOT_READY_TO_WORK;
+            }
+            simd::lane_sma_update(last_data.data(), slot, in, mean.data(), symbols, (T)period);
+            calc(pos, in);
+            return common::OK;
+        }
+
+        int test_all(const T *in) noexcept {
+            if (period == 0 || count < period) {
+                set_nan();
+                return period == 0 ? common::NO_INIT : common::INDICATOR_NOT_READY_TO_WORK;
+            }
+            simd::lane_sma_test(last_data.data(), ring.data() + pos * symbols, in, mean.data(), symbols, (T)period);
+            calc(pos + 1 == period ? 0 : pos + 1, in);
+            return common::OK;
+        }
+
+        inline T get(const size_t symbol) const noexcept {
+            return output[symbol];
+        }
+
+        inline const T *get_data() const noexcept {
+            return output.data();
+        }
+
+        inline size_t size() const noexcept {
+            return symbols;
+        }
+
+        inline size_t get_period() const noexcept {
+            return period;
+        }
+
+        void clear() noexcept {
+            std::fill(last_data.begin(), last_data.end(), 0);
+            set_nan();
+            pos = count = 0;
+        }
+    };
+
+    /** \brief Банк истинных диапазонов
+     */
+    template <class T>
+    class IndicatorBank<TrueRange<T>> {
+    private:
+        std::vector<T> last_data;
+        std::vector<T> output;
+        size_t symbols = 0;
+        bool is_last = false;
+        bool is_output = false;
+
+    public:
+
+        IndicatorBank() {};
+
+        /** \brief Конструктор банка
+         *
+         * Второй параметр (период) не используется и оставлен для единообразия с другими банками
+         * \param s     Количество символов
+         */
+        IndicatorBank(const size_t s, const size_t = 0) :
+            last_data(s, std::numeric_limits<T>::quiet_NaN()),
+            output(s, std::numeric_limits<T>::quiet_NaN()), symbols(s) {
+        }
+
+        /** \brief Обновить состояние всех символов по барам
+         * \param high  Массив максимумов баров
+         * \param low   Массив минимумов баров
+         * \param close Массив цен закрытия баров
+         * \return Вернет 0 в случае успеха, иначе см. ErrorType
+         */
+        int update_all(const T *high, const T *low, const T *close) noexcept {
+            simd::lane_true_range(high, low, close, output.data(), symbols);
+            is_output = true;
+            return common::OK;
+        }
+
+        int update_all(const T *in) noexcept {
+            if (!is_last) {
+                std::copy(in, in + symbols, last_data.begin());
+                is_last = true;
+                return common::NO_INIT;
+            }
+            simd::lane_abs_diff(in, last_data.data(), output.data(), symbols);
+            std::copy(in, in + symbols, last_data.begin());
+            is_output = true;
+            return common::OK;
+        }
+
+        int test_all(const T *high, const T *low, const T *close) noexcept {
+            return update_all(high, low, close);
+        }
+
+        int test_all(const T *in) noexcept {
+            if (!is_last) return common::NO_INIT;
+            simd::lane_abs_diff(in, last_data.data(), output.data(), symbols);
+            is_output = true;
+            return common::OK;
+        }
+
+        /** \brief Проверить, есть ли значения на выходе
+         */
+        inline bool is_ready() const noexcept {
+            return is_output;
+        }
+
+        inline T get(const size_t symbol) const noexcept {
+            return output[symbol];
+        }
+
+        inline const T *get_data() const noexcept {
+            return output.data();
+        }
+
+        inline size_t size() const noexcept {
+            return symbols;
+        }
+
+        void clear() noexcept {
+            std::fill(last_data.begin(), last_data.end(), std::numeric_limits<T>::quiet_NaN());
+            std::fill(output.begin(), output.end(), std::numeric_limits<T>::quiet_NaN());
+            is_last = is_output = false;
+        }
+    };
+
+    /** \brief Банк индексов относительной силы
+     */
+    template <class T, class MA_TYPE>
+    class IndicatorBank<RSI<T, MA_TYPE>> {
+    private:
+        IndicatorBank<MA_TYPE> iU;
+        IndicatorBank<MA_TYPE> iD;
+        std::vector<T> prev;
+        std::vector<T> u;
+        std::vector<T> d;
+        std::vector<T> output;
+        size_t symbols = 0;
+        bool is_update = false;
+
+        inline void set_nan() noexcept {
+            std::fill(output.begin(), output.end(), std::numeric_limits<T>::quiet_NaN());
+        }
+
+    public:
+
+        IndicatorBank() {};
+
+        /** \brief Конструктор банка
+         * \param s     Количество символов
+         * \param p     Период
+         */
+        IndicatorBank(const size_t s, const size_t p) :
+            iU(s, p), iD(s, p), prev(s, 0), u(s, 0), d(s, 0),
+            output(s, std::numeric_limits<T>::quiet_NaN()), symbols(s) {
+        }
+
+        int update_all(const T *in) noexcept {
+            if (!is_update) {
+                std::copy(in, in + symbols, prev.begin());
+                set_nan();
+                is_update = true;
+                return common::INDICATOR_NOT_READY_TO_WORK;
+            }
+            simd::lane_rsi_split(in, prev.data(), u.data(), d.data(), symbols);
+            std::copy(in, in + symbols, prev.begin());
+            const int erru = iU.update_all(u.data());
+            const int errd = iD.update_all(d.data());
+            if (erru != common::OK || errd != common::OK) {
+                set_nan();
+                return common::INDICATOR_NOT_READY_TO_WORK;
+            }
+            simd::lane_rsi(iU.get_data(), iD.get_data(), output.data(), symbols);
+            return common::OK;
+        }
+
+        int test_all(const T *in) noexcept {
+            if (!is_update) {
+                set_nan();
+                return common::INDICATOR_NOT_READY_TO_WORK;
+            }
+            simd::lane_rsi_split(in, prev.data(), u.data(), d.data(), symbols);
+            const int erru = iU.test_all(u.data());
+            const int errd = iD.test_all(d.data());
+            if (erru != common::OK || errd != common::OK) {
+                set_nan();
+                return common::INDICATOR_NOT_READY_TO_WORK;
+            }
+            simd::lane_rsi(iU.get_data(), iD.get_data(), output.data(), symbols);
+            return common::OK;
+        }
+
+        inline T get(const size_t symbol) const noexcept {
+            return output[symbol];
+        }
+
+        inline const T *get_data() const noexcept {
+            return output.data();
+        }
+
+        inline size_t size() const noexcept {
+            return symbols;
+        }
+
+        void clear() noexcept {
+            set_nan();
+            is_update = false;
+            iU.clear();
+            iD.clear();
+        }
+    };
+
+    /** \brief Банк средних истинных диапазонов
+     */
+    template <class T, class MA_TYPE>
+    class IndicatorBank<ATR<T, MA_TYPE>> {
+    private:
+        IndicatorBank<MA_TYPE> ma;
+        IndicatorBank<TrueRange<T>> tr;
+        std::vector<T> output;
+        size_t symbols = 0;
+
+        inline int set_output(const int err) noexcept {
+            if (err != common::OK) return common::NO_INIT;
+            std::copy(ma.get_data(), ma.get_data() + symbols, output.begin());
+            return common::OK;
+        }
+
+    public:
+
+        IndicatorBank() {};
+
+        /** \brief Конструктор банка
+         * \param s     Количество символов
+         * \param p     Период
+         */
+        IndicatorBank(const size_t s, const size_t p) :
+            ma(s, p), tr(s), output(s, std::numeric_limits<T>::quiet_NaN()), symbols(s) {
+        }
+
+        /** \brief Обновить состояние всех символов по барам
+         * \param high  Массив максимумов баров
+         * \param low   Массив минимумов баров
+         * \param close Массив цен закрытия баров
+         * \return Вернет 0 в случае успеха, иначе см. ErrorType
+         */
+        int update_all(const T *high, const T *low, const T *close) noexcept {
+            tr.update_all(high, low, close);
+            return set_output(ma.update_all(tr.get_data()));
+        }
+
+        int update_all(const T *in) noexcept {
+            tr.update_all(in);
+            if (!tr.is_ready()) return common::NO_INIT;
+            return set_output(ma.update_all(tr.get_data()));
+        }
+
+        int test_all(const T *high, const T *low, const T *close) noexcept {
+            tr.test_all(high, low, close);
+            return set_output(ma.test_all(tr.get_data()));
+        }
+
+        int test_all(const T *in) noexcept {
+            tr.test_all(in);
+            if (!tr.is_ready()) return common::NO_INIT;
+            return set_output(ma.test_all(tr.get_data()));
+        }
+
+        inline T get(const size_t symbol) const noexcept {
+            return output[symbol];
+        }
+
+        inline const T *get_data() const noexcept {
+            return output.data();
+        }
+
+        inline size_t size() const noexcept {
+            return symbols;
+        }
+
+        void clear() noexcept {
+            std::fill(output.begin(), output.end(), std::numeric_limits<T>::quiet_NaN());
+            tr.clear();
+            ma.clear();
+        }
+    };
+
+}; // xtechnical
+
+#endif // XTECHNICAL_INDICATOR_BANK_HPP_INCLUDED
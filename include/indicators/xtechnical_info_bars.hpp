@@ -0,0 +1,480 @@
+#ifndef XTECHNICAL_INFO_BARS_HPP_INCLUDED
+#define XTECHNICAL_INFO_BARS_HPP_INCLUDED
+
+#include "../xtechnical_common.hpp"
+
+namespace xtechnical {
+
+    /** \brief Бар, сформированный по активности рынка
+     *
+     * Цены хранятся в пунктах (целых числах), перевод в цену через pips_size
+     */
+    class InfoBar {
+    public:
+        int64_t open = 0;
+        int64_t high = 0;
+        int64_t low = 0;
+        int64_t close = 0;
+        uint64_t volume = 0;            /**< Объем бара */
+        uint64_t ticks = 0;             /**< Количество тиков бара */
+        uint64_t timestamp = 0;         /**< Метка времени первого тика */
+        uint64_t close_timestamp = 0;   /**< Метка времени последнего тика */
+        double pips_size = 0;
+
+        inline double get_open_price() const noexcept {
+            return (double)open * pips_size;
+        }
+
+        inline double get_high_price() const noexcept {
+            return (double)high * pips_size;
+        }
+
+        inline double get_low_price() const noexcept {
+            return (double)low * pips_size;
+        }
+
+        inline double get_close_price() const noexcept {
+            return (double)close * pips_size;
+        }
+    };
+
+    /** \brief Кольцевой буфер баров, предоставляемый пользователем
+     *
+     * Память выделяется один раз в конструкторе. Формирователи баров
+     * только записывают бары в буфер, при переполнении старые бары затираются.
+     * По get_total() можно узнать, сколько баров записано за все время.
+     */
+    class InfoBarRing {
+    private:
+        std::vector<InfoBar> bars;
+        size_t pos = 0;
+        uint64_t total = 0;
+
+    public:
+
+        InfoBarRing() {};
+
+        /** \brief Конструктор кольцевого буфера баров
+         * \param capacity  Емкость буфера
+         */
+        InfoBarRing(const size_t capacity) : bars(capacity) {};
+
+        inline void push(const InfoBar &bar) noexcept {
+            if (bars.empty()) return;
+            bars[pos] = bar;
+            if (++pos == bars.size()) pos = 0;
+            ++total;
+        }
+
+        /** \brief Количество баров в буфере
+         */
+        inline size_t size() const noexcept {
+            return total < bars.size() ? (size_t)total : bars.size();
+        }
+
+        inline size_t capacity() const noexcept {
+            return bars.size();
+        }
+
+        /** \brief Количество баров, записанных за все время
+         */
+        inline uint64_t get_total() const noexcept {
+            return total;
+        }
+
+        /** \brief Получить бар по индексу
+         * \param index Индекс бара, 0 - самый старый бар в буфере
+         * \return Бар
+         */
+        inline const InfoBar &operator[](const size_t index) const noexcept {
+            const size_t n = size();
+            size_t i = pos + bars.size() - n + index;
+            if (i >= bars.size()) i -= bars.size();
+            return bars[i];
+        }
+
+        /** \brief Получить бар с конца
+         * \param offset    Смещение, 0 - последний записанный бар
+         * \return Бар
+         */
+        inline const InfoBar &back(const size_t offset = 0) const noexcept {
+            return (*this)[size() - 1 - offset];
+        }
+
+        inline void clear() noexcept {
+            pos = 0;
+            total = 0;
+        }
+    };
+
+    /** \brief Общая часть формирователей баров по активности
+     *
+     * Переводит цену в пункты и накапливает текущий бар.
+     * Закрытые бары записываются в InfoBarRing, память не выделяется.
+     */
+    template<class T>
+    class InfoBarCore {
+    protected:
+        InfoBarRing *ring = nullptr;
+        InfoBar bar;
+        double pips_size = 0;
+        double pips_scale = 0;
+        bool is_bar = false;
+
+        inline int64_t to_pips(const T price) const noexcept {
+            const double value = (double)price * pips_scale;
+            return value >= 0 ? (int64_t)(value + 0.5d) : -(int64_t)(0.5d - value);
+        }
+
+        inline void add(const int64_t price, const uint64_t timestamp, const uint64_t volume) noexcept {
+            if (!is_bar) {
+                bar.open = bar.high = bar.low = bar.close = price;
+                bar.volume = volume;
+                bar.ticks = 1;
+                bar.timestamp = bar.close_timestamp = timestamp;
+                is_bar = true;
+                return;
+            }
+            if (price > bar.high) bar.high = price;
+            else if (price < bar.low) bar.low = price;
+            bar.close = price;
+            bar.volume += volume;
+            ++bar.ticks;
+            bar.close_timestamp = timestamp;
+        }
+
+        inline void close_bar() noexcept {
+            ring->push(bar);
+            is_bar = false;
+        }
+
+    public:
+
+        InfoBarCore() {};
+
+        /** \brief Конструктор
+         * \param ps    Размер пункта, например 0.00001
+         * \param r     Кольцевой буфер для закрытых баров
+         */
+        InfoBarCore(const double ps, InfoBarRing &r) :
+            ring(&r), pips_size(ps), pips_scale(ps > 0 ? 1.0d / ps : 0.0d) {
+            bar.pips_size = ps;
+        }
+
+        /** \brief Получить несформированный бар
+         */
+        inline const InfoBar &get_bar() const noexcept {
+            return bar;
+        }
+
+        /** \brief Есть ли несформированный бар
+         */
+        inline bool is_unformed_bar() const noexcept {
+            return is_bar;
+        }
+
+        inline double get_pips_size() const noexcept {
+            return pips_size;
+        }
+    };
+
+    /** \brief Тиковые бары
+     *
+     * Бар закрывается после заданного количества тиков
+     */
+    template<class T>
+    class TickBarShaper : public InfoBarCore<T> {
+    private:
+        uint64_t ticks = 0;
+
+    public:
+
+        TickBarShaper() {};
+
+        /** \brief Конструктор
+         * \param t     Количество тиков в баре
+         * \param ps    Размер пункта
+         * \param r     Кольцевой буфер для закрытых баров
+         */
+        TickBarShaper(const uint64_t t, const double ps, InfoBarRing &r) :
+            InfoBarCore<T>(ps, r), ticks(t) {};
+
+        /** \brief Обновить состояние
+         * \param price     Цена
+         * \param timestamp Метка времени
+         * \param volume    Объем тика
+         * \return Количество закрытых баров
+         */
+        inline size_t update(const T price, const uint64_t timestamp, const uint64_t volume = 1) noexcept {
+            if (ticks == 0) return 0;
+            this->add(this->to_pips(price), timestamp, volume);
+            if (this->bar.ticks < ticks) return 0;
+            this->close_bar();
+            return 1;
+        }
+
+        inline void clear() noexcept {
+            this->is_bar = false;
+        }
+    };
+
+    /** \brief Бары объема
+     *
+     * Бар закрывается, когда накопленный объем достигает порога
+     */
+    template<class T>
+    class VolumeBarShaper : public InfoBarCore<T> {
+    private:
+        uint64_t threshold = 0;
+
+    public:
+
+        VolumeBarShaper() {};
+
+        /** \brief Конструктор
+         * \param v     Объем бара
+         * \param ps    Размер пункта
+         * \param r     Кольцевой буфер для закрытых баров
+         */
+        VolumeBarShaper(const uint64_t v, const double ps, InfoBarRing &r) :
+            InfoBarCore<T>(ps, r), threshold(v) {};
+
+        /** \brief Обновить состояние
+         * \param price     Цена
+         * \param timestamp Метка времени
+         * \param volume    Объем тика
+         * \return Количество закрытых баров
+         */
+        inline size_t update(const T price, const uint64_t timestamp, const uint64_t volume = 1) noexcept {
+            if (threshold == 0) return 0;
+            this->add(this->to_pips(price), timestamp, volume);
+            if (this->bar.volume < threshold) return 0;
+            this->close_bar();
+            return 1;
+        }
+
+        inline void clear() noexcept {
+            this->is_bar = false;
+        }
+    };
+
+    /** \brief Бары диапазона
+     *
+     * Бар закрывается, когда разница максимума и минимума достигает
+     * заданного числа пунктов, следующий тик открывает новый бар
+     */
+    template<class T>
+    class RangeBarShaper : public InfoBarCore<T> {
+    private:
+        int64_t range = 0;
+
+    public:
+
+        RangeBarShaper() {};
+
+        /** \brief Конструктор
+         * \param rp    Диапазон бара в пунктах
+         * \param ps    Размер пункта
+         * \param r     Кольцевой буфер для закрытых баров
+         */
+        RangeBarShaper(const int64_t rp, const double ps, InfoBarRing &r) :
+            InfoBarCore<T>(ps, r), range(rp) {};
+
+        /** \brief Обновить состояние
+         * \param price     Цена
+         * \param timestamp Метка времени
+         * \param volume    Объем тика
+         * \return Количество закрытых баров
+         */
+        inline size_t update(const T price, const uint64_t timestamp, const uint64_t volume = 1) noexcept {
+            if (range <= 0) return 0;
+            this->add(this->to_pips(price), timestamp, volume);
+            if ((this->bar.high - this->bar.low) < range) return 0;
+            this->close_bar();
+            return 1;
+        }
+
+        inline void clear() noexcept {
+            this->is_bar = false;
+        }
+    };
+
+    /** \brief Бары ренко
+     *
+     * Кирпич закрывается, когда цена уходит от закрытия прошлого кирпича
+     * на размер кирпича. Если за один тик пройдено несколько кирпичей,
+     * все они записываются в буфер, объем и тики достаются первому из них.
+     * Все вычисления выполняются в пунктах.
+     */
+    template<class T>
+    class RenkoBarShaper : public InfoBarCore<T> {
+    private:
+        int64_t brick = 0;
+        int64_t last_close = 0;
+        bool is_once = false;
+
+    public:
+
+        RenkoBarShaper() {};
+
+        /** \brief Конструктор
+         * \param b     Размер кирпича в пунктах
+         * \param ps    Размер пункта
+         * \param r     Кольцевой буфер для закрытых баров
+         */
+        RenkoBarShaper(const int64_t b, const double ps, InfoBarRing &r) :
+            InfoBarCore<T>(ps, r), brick(b) {};
+
+        /** \brief Обновить состояние
+         * \param price     Цена
+         * \param timestamp Метка времени
+         * \param volume    Объем тика
+         * \return Количество закрытых кирпичей
+         */
+        size_t update(const T price, const uint64_t timestamp, const uint64_t volume = 1) noexcept {
+            if (brick <= 0) return 0;
+            const int64_t p = this->to_pips(price);
+            if (!is_once) {
+                // первый кирпич начинается с ближайшей снизу границы
+                last_close = (p >= 0 ? p : (p - brick + 1)) / brick * brick;
+                is_once = true;
+            }
+            this->add(p, timestamp, volume);
+            InfoBar &bar = this->bar;
+            size_t n = 0;
+            while (p >= last_close + brick || p <= last_close - brick) {
+                const int64_t close = p > last_close ? (last_close + brick) : (last_close - brick);
+                bar.open = last_close;
+                bar.close = close;
+                if (n == 0) {
+                    bar.high = std::max(bar.high, std::max(last_close, close));
+                    bar.low = std::min(bar.low, std::min(last_close, close));
+                } else {
+                    bar.high = std::max(last_close, close);
+                    bar.low = std::min(last_close, close);
+                    bar.volume = 0;
+                    bar.ticks = 0;
+                    bar.timestamp = timestamp;
+                }
+                this->ring->push(bar);
+                last_close = close;
+                ++n;
+            }
+            if (n > 0) {
+                // остаток движения переходит в следующий кирпич
+                bar.open = last_close;
+                bar.high = std::max(last_close, p);
+                bar.low = std::min(last_close, p);
+                bar.close = p;
+                bar.volume = 0;
+                bar.ticks = 0;
+                bar.timestamp = timestamp;
+            }
+            return n;
+        }
+
+        /** \brief Получить закрытие последнего кирпича в пунктах
+         */
+        inline int64_t get_last_close() const noexcept {
+            return last_close;
+        }
+
+        inline void clear() noexcept {
+            this->is_bar = false;
+            is_once = false;
+        }
+    };
+
+    /** \brief Бары дисбаланса тиков
+     *
+     * Знак тика b равен знаку изменения цены (при неизменной цене берется
+     * прошлый знак). Бар закрывается, когда |сумма b| достигает
+     * E[T] * max(|E[b]|, min_imbalance), где E[T] - экспоненциальное среднее
+     * длины бара в тиках, E[b] - экспоненциальное среднее знака тика.
+     * E[T] ограничено диапазоном [t / 4, t * 4] от начальной длины бара t,
+     * иначе при |E[b]| около нуля порог вырождается до одного тика.
+     */
+    template<class T>
+    class TickImbalanceBarShaper : public InfoBarCore<T> {
+    private:
+        double expected_ticks = 0;
+        double expected_imbalance = 0;
+        double initial_ticks = 0;
+        double alpha_bar = 0;
+        double alpha_tick = 0;
+        double min_imbalance = 0;
+        int64_t imbalance = 0;
+        int64_t last_price = 0;
+        int last_sign = 0;
+        bool is_once = false;
+
+    public:
+
+        TickImbalanceBarShaper() {};
+
+        /** \brief Конструктор
+         * \param t     Начальная ожидаемая длина бара в тиках
+         * \param ps    Размер пункта
+         * \param r     Кольцевой буфер для закрытых баров
+         * \param ab    Коэффициент сглаживания длины бара
+         * \param mi    Минимальный ожидаемый дисбаланс
+         */
+        TickImbalanceBarShaper(
+                const uint64_t t,
+                const double ps,
+                InfoBarRing &r,
+                const double ab = 0.1,
+                const double mi = 0.05) :
+            InfoBarCore<T>(ps, r),
+            expected_ticks(t),
+            initial_ticks(t),
+            alpha_bar(ab),
+            alpha_tick(2.0d / ((double)t + 1.0d)),
+            min_imbalance(mi) {};
+
+        /** \brief Обновить состояние
+         * \param price     Цена
+         * \param timestamp Метка времени
+         * \param volume    Объем тика
+         * \return Количество закрытых баров
+         */
+        size_t update(const T price, const uint64_t timestamp, const uint64_t volume = 1) noexcept {
+            if (initial_ticks <= 0) return 0;
+            const int64_t p = this->to_pips(price);
+            if (is_once) {
+                if (p > last_price) last_sign = 1;
+                else if (p < last_price) last_sign = -1;
+            }
+            last_price = p;
+            is_once = true;
+            this->add(p, timestamp, volume);
+            imbalance += last_sign;
+            expected_imbalance += alpha_tick * ((double)last_sign - expected_imbalance);
+            const double threshold = expected_ticks * std::max(std::abs(expected_imbalance), min_imbalance);
+            if ((double)std::abs(imbalance) < threshold) return 0;
+            expected_ticks += alpha_bar * ((double)this->bar.ticks - expected_ticks);
+            expected_ticks = std::min(std::max(expected_ticks, initial_ticks / 4.0d), initial_ticks * 4.0d);
+            imbalance = 0;
+            this->close_bar();
+            return 1;
+        }
+
+        /** \brief Текущий порог дисбаланса
+         */
+        inline double get_threshold() const noexcept {
+            return expected_ticks * std::max(std::abs(expected_imbalance), min_imbalance);
+        }
+
+        inline void clear() noexcept {
+            this->is_bar = false;
+            expected_ticks = initial_ticks;
+            expected_imbalance = 0;
+            imbalance = 0;
+            last_sign = 0;
+            is_once = false;
+        }
+    };
+
+}; // xtechnical
+
+#endif // XTECHNICAL_INFO_BARS_HPP_INCLUDED
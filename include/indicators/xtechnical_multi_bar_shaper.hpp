@@ -0,0 +1,228 @@
+#ifndef XTECHNICAL_MULTI_BAR_SHAPER_HPP_INCLUDED
+#define XTECHNICAL_MULTI_BAR_SHAPER_HPP_INCLUDED
+
+#include "../xtechnical_common.hpp"
+
+namespace xtechnical {
+
+    /** \brief Формирователь баров сразу для нескольких таймфреймов
+     *
+     * Каждый таймфрейм ведет себя как отдельный BarShaperV1 с теми же флагами,
+     * но тики обрабатываются один раз. Тики внутри одного бара самого младшего
+     * таймфрейма копятся в общем "хвосте" (high, low, close) и переносятся
+     * во все таймфреймы только при смене младшего бара, поэтому стоимость
+     * обработки тика не зависит от числа таймфреймов.
+     * Периоды всех таймфреймов должны быть кратны самому младшему периоду.
+     */
+    template<class T>
+    class MultiBarShaper {
+    public:
+
+        /** \brief Данные бара
+         */
+        class Bar {
+        public:
+            T open = 0, high = 0, low = 0, close = 0;
+            uint64_t timestamp = 0;
+        };
+
+    private:
+
+        /** \brief Состояние одного таймфрейма, аналогичное BarShaperV1
+         */
+        class Level {
+        public:
+            Bar bar;
+            uint64_t period = 0;
+            uint64_t last_bar = 0;
+            bool is_once = false;
+        };
+
+        std::vector<Level> levels;
+        uint64_t finest_period = 0;
+        uint64_t segment = 0;       /**< Номер текущего бара младшего таймфрейма */
+        bool is_segment = false;
+
+        T tail_high = 0;
+        T tail_low = 0;
+        T tail_close = 0;
+        bool is_tail = false;       /**< Есть тики, не перенесенные в таймфреймы */
+
+        bool is_open_equal_prev_close = false;
+        bool is_use_bar_stop_time = false;
+        bool is_fill = false;
+        bool is_valid = false;
+
+        inline uint64_t get_bar_time(const Level &level, const uint64_t b) const noexcept {
+            return is_use_bar_stop_time ? (b * level.period + level.period) : (b * level.period);
+        }
+
+        /** \brief Обработать тик в таймфрейме так же, как BarShaperV1::update
+         */
+        void update_level(const size_t index, const T input, const uint64_t timestamp) {
+            Level &level = levels[index];
+            Bar &bar = level.bar;
+            const uint64_t current_bar = timestamp / level.period;
+            if (level.last_bar == 0) {
+                level.last_bar = current_bar;
+                return;
+            }
+            if (current_bar > level.last_bar) {
+                if (level.is_once) {
+                    bar.timestamp = get_bar_time(level, level.last_bar);
+                    if (on_close_bar != nullptr) on_close_bar(index, bar);
+                    if (is_fill) {
+                        for (uint64_t b = (level.last_bar + 1); b < current_bar; ++b) {
+                            bar.open = bar.low = bar.high = bar.close;
+                            bar.timestamp = get_bar_time(level, b);
+                            if (on_close_bar != nullptr) on_close_bar(index, bar);
+                        }
+                    }
+                }
+                if (is_open_equal_prev_close) {
+                    if (bar.close != 0) {
+                        bar.open = bar.close;
+                        level.is_once = true;
+                    }
+                } else {
+                    bar.open = input;
+                    level.is_once = true;
+                }
+                bar.high = input;
+                bar.low = input;
+                bar.close = input;
+                level.last_bar = current_bar;
+            } else
+            if (current_bar == level.last_bar) {
+                if (level.is_once) {
+                    bar.high = std::max(input, bar.high);
+                    bar.low = std::min(input, bar.low);
+                    bar.close = input;
+                    if (on_unformed_bar != nullptr) {
+                        bar.timestamp = get_bar_time(level, level.last_bar);
+                        on_unformed_bar(index, bar);
+                    }
+                } else {
+                    bar.close = input;
+                }
+            }
+        }
+
+        /** \brief Перенести накопленный хвост тиков во все таймфреймы
+         */
+        void flush_tail() noexcept {
+            if (!is_tail) return;
+            for (auto &level : levels) {
+                if (level.last_bar == 0) continue;
+                if (level.is_once) {
+                    level.bar.high = std::max(tail_high, level.bar.high);
+                    level.bar.low = std::min(tail_low, level.bar.low);
+                }
+                level.bar.close = tail_close;
+            }
+            is_tail = false;
+        }
+
+    public:
+
+        MultiBarShaper() {};
+
+        /** \brief Инициализировать формирователь баров
+         * \param p     Периоды таймфреймов, кратные самому младшему периоду
+         * \param oepc  Флаг, включает эквивалетность цены открытия цене закрытия предыдущего бара
+         * \param ubst  Флаг, включает использование последней метки времени бара вместо начала бара, как времени бара
+         * \param uf    Флаг, включает заполнение пропущенных баров
+         */
+        MultiBarShaper(
+                const std::vector<uint64_t> &p,
+                const bool oepc = false,
+                const bool ubst = false,
+                const bool uf = false) :
+                is_open_equal_prev_close(oepc),
+                is_use_bar_stop_time(ubst),
+                is_fill(uf) {
+            if (p.empty()) return;
+            finest_period = *std::min_element(p.begin(), p.end());
+            if (finest_period == 0) return;
+            levels.resize(p.size());
+            for (size_t i = 0; i < p.size(); ++i) {
+                if ((p[i] % finest_period) != 0) return;
+                levels[i].period = p[i];
+            }
+            is_valid = true;
+        }
+
+        std::function<void(const size_t index, const Bar &bar)> on_close_bar;               /**< Функция обратного вызова в момент закрытия бара таймфрейма index */
+        std::function<void(const size_t index, const Bar &bar)> on_unformed_bar = nullptr;  /**< Функция обратного вызова для несформированного бара таймфрейма index */
+
+        /** \brief Обновить состояние индикатора
+         * \param input     Текущая цена
+         * \param timestamp Метка времени
+         * \return Вернет 0 в случае успеха, иначе см. ErrorType
+         */
+        int update(const T input, const uint64_t timestamp) {
+            if (!is_valid) return common::NO_INIT;
+            const uint64_t current = timestamp / finest_period;
+            if (is_segment && current == segment) {
+                // тик внутри текущего бара младшего таймфрейма
+                if (is_tail) {
+                    tail_high = std::max(input, tail_high);
+                    tail_low = std::min(input, tail_low);
+                } else {
+                    tail_high = tail_low = input;
+                    is_tail = true;
+                }
+                tail_close = input;
+                if (on_unformed_bar != nullptr) {
+                    for (size_t i = 0; i < levels.size(); ++i) {
+                        const Level &level = levels[i];
+                        if (level.last_bar == 0 || !level.is_once) continue;
+                        Bar bar = level.bar;
+                        bar.high = std::max(tail_high, bar.high);
+                        bar.low = std::min(tail_low, bar.low);
+                        bar.close = tail_close;
+                        bar.timestamp = get_bar_time(level, level.last_bar);
+                        on_unformed_bar(i, bar);
+                    }
+                }
+                return common::OK;
+            }
+            flush_tail();
+            if (!is_segment || current > segment) {
+                segment = current;
+                is_segment = true;
+            }
+            for (size_t i = 0; i < levels.size(); ++i) {
+                update_level(i, input, timestamp);
+            }
+            return common::OK;
+        }
+
+        /** \brief Получить число таймфреймов
+         */
+        inline size_t size() const noexcept {
+            return levels.size();
+        }
+
+        /** \brief Получить период таймфрейма
+         * \param index Индекс таймфрейма
+         */
+        inline uint64_t get_period(const size_t index) const noexcept {
+            return levels[index].period;
+        }
+
+        /** \brief Очистить данные индикатора
+         */
+        void clear() noexcept {
+            for (auto &level : levels) {
+                level.bar = Bar();
+                level.last_bar = 0;
+                level.is_once = false;
+            }
+            is_segment = false;
+            is_tail = false;
+        }
+    };
+};
+
+#endif // XTECHNICAL_MULTI_BAR_SHAPER_HPP_INCLUDED
@@ -2,25 +2,223 @@
 #define XTECHNICAL_PERIOD_STATS_HPP_INCLUDED
 
 #include "../xtechnical_common.hpp"
+#include <unordered_map>
 
 namespace xtechnical {
 
     /** \brief Статистика за период
+     *
+     * Значения хранятся в кольцевом буфере, упорядоченном по времени.
+     * Экстремумы ведутся монотонными очередями, центр масс - текущей суммой,
+     * значение с максимальным весом - хеш-таблицей счетчиков и списками
+     * значений для каждого счетчика. Последнее значение хранится отдельно,
+     * пока не придет значение с большим временем, поэтому повторное
+     * добавление с тем же временем просто заменяет его.
+     * Добавление со временем меньше последнего пересобирает структуры за O(n).
      */
     template<class T>
     class PeriodStatsV1 {
     private:
-        // время / значение
-        std::map<uint64_t, T> data;
+
+        /** \brief Значение в окне
+         */
+        class Item {
+        public:
+            uint64_t time = 0;
+            uint64_t seq = 0;   /**< Порядковый номер добавления в окно */
+            T value = 0;
+        };
+
+        /** \brief Растущий кольцевой буфер значений, упорядоченных по времени
+         */
+        class TimeRing {
+        private:
+            std::vector<Item> buffer;
+            size_t head = 0;
+            size_t count = 0;
+
+        public:
+
+            inline size_t size() const noexcept {
+                return count;
+            }
+
+            inline bool empty() const noexcept {
+                return count == 0;
+            }
+
+            inline const Item &front() const noexcept {
+                return buffer[head];
+            }
+
+            inline const Item &operator[](const size_t index) const noexcept {
+                return buffer[(head + index) & (buffer.size() - 1)];
+            }
+
+            void push_back(const Item &item) {
+                if (count == buffer.size()) {
+                    std::vector<Item> temp(buffer.empty() ? 16 : buffer.size() * 2);
+                    for (size_t i = 0; i < count; ++i) temp[i] = (*this)[i];
+                    buffer.swap(temp);
+                    head = 0;
+                }
+                buffer[(head + count) & (buffer.size() - 1)] = item;
+                ++count;
+            }
+
+            inline void pop_front() noexcept {
+                head = (head + 1) & (buffer.size() - 1);
+                --count;
+            }
+
+            inline void clear() noexcept {
+                head = count = 0;
+            }
+        };
+
+        /** \brief Счетчик значения, узел списка значений с одинаковым счетчиком
+         */
+        class Counter {
+        public:
+            T value = 0;
+            size_t count = 0;
+            uint64_t last_seq = 0;  /**< Номер последнего появления значения */
+            size_t prev = NONE;
+            size_t next = NONE;
+        };
+
+        static const size_t NONE = std::numeric_limits<size_t>::max();
+
+        TimeRing ring;                          /**< Значения окна, кроме последнего */
+        Item last_item;                         /**< Последнее значение */
+        bool is_last_item = false;
+        uint64_t seq = 0;
+
+        std::deque<Item> max_queue;
+        std::deque<Item> min_queue;
+        T sum = 0;
+
+        std::unordered_map<T, size_t> counter_index;
+        std::vector<Counter> counters;
+        std::vector<size_t> free_counters;
+        std::vector<size_t> count_heads;        /**< Начала списков значений с одинаковым счетчиком */
+        size_t max_count = 0;
+
         uint64_t start_time = 0;
         uint64_t last_time = 0;
         uint64_t life_time = 0;
 
-        inline void remove(const uint64_t time, const uint64_t lifetime) noexcept {
+        inline void unlink(const size_t index) noexcept {
+            Counter &c = counters[index];
+            if (c.prev != NONE) counters[c.prev].next = c.next;
+            else count_heads[c.count] = c.next;
+            if (c.next != NONE) counters[c.next].prev = c.prev;
+        }
+
+        inline void link(const size_t index) {
+            Counter &c = counters[index];
+            if (count_heads.size() <= c.count) count_heads.resize(c.count + 1, NONE);
+            c.prev = NONE;
+            c.next = count_heads[c.count];
+            if (c.next != NONE) counters[c.next].prev = index;
+            count_heads[c.count] = index;
+        }
+
+        void commit(const Item &item) {
+            ring.push_back(item);
+            while (!max_queue.empty() && max_queue.back().value <= item.value) max_queue.pop_back();
+            max_queue.push_back(item);
+            while (!min_queue.empty() && min_queue.back().value >= item.value) min_queue.pop_back();
+            min_queue.push_back(item);
+            sum += item.value;
+
+            auto it = counter_index.find(item.value);
+            size_t index = 0;
+            if (it == counter_index.end()) {
+                if (free_counters.empty()) {
+                    index = counters.size();
+                    counters.push_back(Counter());
+                } else {
+                    index = free_counters.back();
+                    free_counters.pop_back();
+                }
+                counters[index] = Counter();
+                counters[index].value = item.value;
+                counter_index[item.value] = index;
+            } else {
+                index = it->second;
+                unlink(index);
+            }
+            Counter &c = counters[index];
+            ++c.count;
+            c.last_seq = item.seq;
+            link(index);
+            if (c.count > max_count) max_count = c.count;
+        }
+
+        void expire() {
+            const Item &item = ring.front();
+            if (max_queue.front().seq == item.seq) max_queue.pop_front();
+            if (min_queue.front().seq == item.seq) min_queue.pop_front();
+            sum -= item.value;
+
+            const size_t index = counter_index[item.value];
+            unlink(index);
+            if (--counters[index].count == 0) {
+                counter_index.erase(item.value);
+                free_counters.push_back(index);
+            } else {
+                link(index);
+            }
+            if (count_heads[max_count] == NONE) --max_count;
+            ring.pop_front();
+        }
+
+        void reset() noexcept {
+            ring.clear();
+            max_queue.clear();
+            min_queue.clear();
+            sum = 0;
+            counter_index.clear();
+            counters.clear();
+            free_counters.clear();
+            count_heads.clear();
+            max_count = 0;
+            is_last_item = false;
+        }
+
+        /** \brief Вставить значение со временем меньше последнего
+         */
+        void insert_past(const T value, const uint64_t time) {
+            std::vector<Item> items;
+            items.reserve(ring.size() + 2);
+            for (size_t i = 0; i < ring.size(); ++i) items.push_back(ring[i]);
+            items.push_back(last_item);
+            Item item;
+            item.time = time;
+            item.value = value;
+            auto it = std::lower_bound(items.begin(), items.end(), item,
+                [](const Item &a, const Item &b) {
+                    return a.time < b.time;
+                });
+            if (it != items.end() && it->time == time) it->value = value;
+            else items.insert(it, item);
+            reset();
+            for (size_t i = 0; i + 1 < items.size(); ++i) {
+                items[i].seq = seq++;
+                commit(items[i]);
+            }
+            last_item = items.back();
+            last_item.seq = seq++;
+            is_last_item = true;
+        }
+
+        inline void remove(const uint64_t time, const uint64_t lifetime) {
             // удаляем все что меньше нашей метки времени
             const uint64_t end_life_time = time - lifetime; // время последних данных
-            auto it = data.upper_bound(end_life_time);
-            if (it != data.end()) data.erase(data.begin(), it);
+            // как и раньше, ничего не удаляем, если устарели все данные
+            if (last_item.time <= end_life_time) return;
+            while (!ring.empty() && ring.front().time <= end_life_time) expire();
         }
 
     public:
@@ -39,7 +237,18 @@ namespace xtechnical {
          * \param time      Время значения
          */
         inline void add(const int value, const uint64_t time) noexcept {
-            data[time] = value;
+            if (!is_last_item || time > last_item.time) {
+                if (is_last_item) commit(last_item);
+                last_item.time = time;
+                last_item.value = value;
+                last_item.seq = seq++;
+                is_last_item = true;
+            } else
+            if (time == last_item.time) {
+                last_item.value = value;
+            } else {
+                insert_past(value, time);
+            }
             // удаляем устаревшие данные
             remove(time, life_time);
             last_time = time;
@@ -49,54 +258,51 @@ namespace xtechnical {
         /** \brief Проверить наличие данных
          */
         inline bool empty() noexcept {
-            return data.empty();
+            return !is_last_item;
         }
 
         /** \brief Получить максимальное значение
          */
         inline T get_max_value() noexcept {
-            T max_values = std::numeric_limits<T>::lowest();
-            for (auto &item : data) {
-                max_values = std::max(max_values, item.second);
-            }
-            return max_values;
+            if (!is_last_item) return std::numeric_limits<T>::lowest();
+            if (max_queue.empty()) return last_item.value;
+            return std::max(max_queue.front().value, last_item.value);
         }
 
         /** \brief Получить минимальное
          */
         inline T get_min_value() noexcept {
-            T min_value = std::numeric_limits<T>::max();
-            for (auto &item : data) {
-                min_value = std::min(min_value, item.second);
-            }
-            return min_value;
+            if (!is_last_item) return std::numeric_limits<T>::max();
+            if (min_queue.empty()) return last_item.value;
+            return std::min(min_queue.front().value, last_item.value);
         }
 
         /** \brief Получить значение с максимальным весом
+         *
+         * Из значений с одинаковым весом выбирается то, что встречалось последним.
+         * Если последнее значение не набрало максимального веса, просматривается
+         * список значений с максимальным весом, поэтому стоимость вызова
+         * O(числа значений с максимальным весом). Упорядочить эти списки по
+         * времени появления дешевле не получается: при устаревании записи
+         * значение переходит в список с меньшим весом на произвольное место.
          */
         inline T get_max_weight() noexcept {
-            std::multiset<T> counter;
-            int max_counter = 0;
-            T value = 0;
-            for (auto &item : data) {
-                counter.insert(item.second);
-                const int c = counter.count(item.second);
-                if (c >= max_counter) {
-                    max_counter = c;
-                    value = item.second;
-                }
+            if (!is_last_item) return 0;
+            auto it = counter_index.find(last_item.value);
+            const size_t last_count = (it == counter_index.end() ? 0 : counters[it->second].count) + 1;
+            if (last_count >= max_count) return last_item.value;
+            size_t best = count_heads[max_count];
+            for (size_t index = counters[best].next; index != NONE; index = counters[index].next) {
+                if (counters[index].last_seq > counters[best].last_seq) best = index;
             }
-            return value;
+            return counters[best].value;
         }
 
         /** \brief Получить центр масс
          */
         inline T get_center_mass() noexcept {
-            T sum = 0;
-            for (auto &item : data) {
-                sum += item.second;
-            }
-            return sum / data.size();
+            if (!is_last_item) return sum / ring.size();
+            return (sum + last_item.value) / (ring.size() + 1);
         }
 
         /** \brief Проверить заполненность данными
@@ -108,34 +314,139 @@ namespace xtechnical {
         }
 
         inline void clear() noexcept {
-            data.clear();
+            reset();
             start_time = 0;
         }
     };
 
+    template<class T>
+    const size_t PeriodStatsV1<T>::NONE;
+
     /** \brief Статистика за период
+     *
+     * Для каждого значения ведутся счетчики побед и поражений, которые
+     * уменьшаются по мере устаревания записей. Записи хранятся в очереди,
+     * упорядоченной по времени, поэтому удаление устаревших данных стоит
+     * O(числа удаленных записей), а calc*() лишь переносят счетчики в Stats.
+     * Как и раньше, устаревшие записи значения удаляются только тогда,
+     * когда у значения есть более новая запись.
      */
     class PeriodStatsV2 {
     private:
-        // значение / время / win / loss
-        std::map<int, std::map<uint64_t, std::pair<int, int>>> data;
+
+        /** \brief Устаревшая запись, ожидающая удаления
+         */
+        class Entry {
+        public:
+            uint64_t time = 0;
+            int win = 0;
+            int loss = 0;
+        };
+
+        /** \brief Счетчики значения
+         */
+        class Counter {
+        public:
+            uint32_t wins = 0;
+            uint32_t losses = 0;
+            uint64_t newest_time = 0;   /**< Время самой новой записи значения */
+            std::vector<Entry> stale;   /**< Устаревшие записи, у которых еще нет более новой записи */
+            bool is_pending = false;    /**< Значение есть в pending_counters */
+        };
+
+        typedef std::map<int, Counter> CounterMap;
+
+        /** \brief Запись в очереди времени
+         */
+        class Item {
+        public:
+            uint64_t time = 0;
+            CounterMap::iterator counter;
+            int win = 0;
+            int loss = 0;
+        };
+
+        CounterMap counters;
+        std::deque<Item> items;             /**< Записи, упорядоченные по времени */
+        std::vector<Counter*> pending_counters; /**< Значения с устаревшими записями новее границы времени */
+        size_t stale_counters = 0;          /**< Число значений с устаревшими записями */
+        uint64_t last_end_life_time = std::numeric_limits<uint64_t>::max();
+        uint32_t total_wins = 0;
+        uint32_t total_losses = 0;
         uint64_t start_time = 0;
         uint64_t last_time = 0;
         uint64_t life_time = 0;
 
-        inline void remove(const uint64_t time, const uint64_t lifetime) noexcept {
+        inline void drop(Counter &c, const int win, const int loss) noexcept {
+            c.wins -= win;
+            c.losses -= loss;
+            total_wins -= win;
+            total_losses -= loss;
+        }
+
+        /** \brief Удалить устаревшие записи значения, если у него есть более новая запись
+         * \return Вернет true, если у значения остались записи для проверки при следующем удалении
+         */
+        bool drop_stale(Counter &c, const uint64_t end_life_time) noexcept {
+            if (c.stale.empty()) return false;
+            if (c.newest_time <= end_life_time) return false;
+            size_t n = 0;
+            for (size_t i = 0; i < c.stale.size(); ++i) {
+                if (c.stale[i].time <= end_life_time) drop(c, c.stale[i].win, c.stale[i].loss);
+                else c.stale[n++] = c.stale[i];
+            }
+            c.stale.resize(n);
+            if (n == 0) {
+                --stale_counters;
+                return false;
+            }
+            return true;
+        }
+
+        inline void remove(const uint64_t time, const uint64_t lifetime, Counter *current) noexcept {
             // удаляем все что меньше нашей метки времени
             const uint64_t end_life_time = time - lifetime; // время последних данных
-            for (auto &item : data) {
-                auto it = item.second.upper_bound(end_life_time);
-                if (it != item.second.end()) item.second.erase(item.second.begin(), it);
+            while (!items.empty() && items.front().time <= end_life_time) {
+                const Item &item = items.front();
+                Counter &c = item.counter->second;
+                if (c.newest_time > end_life_time) {
+                    drop(c, item.win, item.loss);
+                } else {
+                    // у значения нет более новых записей, откладываем удаление
+                    if (c.stale.empty()) ++stale_counters;
+                    Entry entry;
+                    entry.time = item.time;
+                    entry.win = item.win;
+                    entry.loss = item.loss;
+                    c.stale.push_back(entry);
+                }
+                items.pop_front();
             }
-            // удаляем пустые данные
-            auto it = data.begin();
-            while(it != data.end()) {
-                if (it->second.empty()) it = data.erase(it);
-                else it++;
+            if (stale_counters != 0) {
+                if (end_life_time < last_end_life_time) {
+                    // граница времени сдвинулась назад, проверяем все значения
+                    for (Counter *c : pending_counters) c->is_pending = false;
+                    pending_counters.clear();
+                    for (auto &item : counters) {
+                        if (!drop_stale(item.second, end_life_time)) continue;
+                        item.second.is_pending = true;
+                        pending_counters.push_back(&item.second);
+                    }
+                } else {
+                    size_t n = 0;
+                    for (size_t i = 0; i < pending_counters.size(); ++i) {
+                        Counter *c = pending_counters[i];
+                        if (drop_stale(*c, end_life_time)) pending_counters[n++] = c;
+                        else c->is_pending = false;
+                    }
+                    pending_counters.resize(n);
+                    if (current && !current->is_pending && drop_stale(*current, end_life_time)) {
+                        current->is_pending = true;
+                        pending_counters.push_back(current);
+                    }
+                }
             }
+            last_end_life_time = end_life_time;
         }
 
     public:
@@ -155,27 +466,33 @@ namespace xtechnical {
          * \param result    Результат прогноза (1 - удачный, -1 - неудачный)
          */
         inline void add(const int value, const uint64_t time, const int result) noexcept {
-            // добавляем статистику
-            auto it = data.find(value);
-            if (it == data.end()) {
-                // статистики по значению нету, добавляем
-                if (result > 0) data[value][time] = std::pair<int, int>(result, 0);
-                else if (result < 0) data[value][time] = std::pair<int, int>(0, -result);
-            } else {
-                // если значение есть, ищем время
-                auto it2 = it->second.find(time);
-                if (it2 == it->second.end()) {
-                    // если время не найдено, добавляем
-                    if (result > 0) data[value][time] = std::pair<int, int>(result, 0);
-                    else if (result < 0) data[value][time] = std::pair<int, int>(0, -result);
+            Counter *current = nullptr;
+            if (result != 0) {
+                // добавляем статистику
+                Item item;
+                item.time = time;
+                item.counter = counters.insert(std::make_pair(value, Counter())).first;
+                if (result > 0) item.win = result;
+                else item.loss = -result;
+                Counter &c = item.counter->second;
+                c.wins += item.win;
+                c.losses += item.loss;
+                c.newest_time = std::max(c.newest_time, time);
+                total_wins += item.win;
+                total_losses += item.loss;
+                if (items.empty() || items.back().time <= time) {
+                    items.push_back(item);
                 } else {
-                    // если время найдено, учитываем статистику
-                    if (result > 0) it2->second.first += result;
-                    else if (result < 0) it2->second.second += -result;
+                    auto it = std::upper_bound(items.begin(), items.end(), time,
+                        [](const uint64_t t, const Item &a) {
+                            return t < a.time;
+                        });
+                    items.insert(it, item);
                 }
+                current = &c;
             }
             // удаляем устаревшие данные
-            remove(time, life_time);
+            remove(time, life_time, current);
             last_time = time;
             if (start_time == 0) start_time = time;
         }
@@ -183,17 +500,14 @@ namespace xtechnical {
         /** \brief Проверить наличие данных
          */
         inline bool empty() noexcept {
-            return !data.empty();
+            return !counters.empty();
         }
 
         /** \brief Получить максимальное значение
          */
         inline int get_max_value() noexcept {
-            int max_values = std::numeric_limits<int>::min();
-            for (auto &item : data) {
-                max_values = std::max(max_values, item.first);
-            }
-            return max_values;
+            if (counters.empty()) return std::numeric_limits<int>::min();
+            return counters.rbegin()->first;
         }
 
         /** \brief Класс для хранения статистики
@@ -209,109 +523,130 @@ namespace xtechnical {
             uint32_t    total_wins = 0;
             uint32_t    total_losses = 0;
             double      total_winrate = 0;
-        };
 
-        inline Stats calc() noexcept {
-            Stats stats;
-            for (auto &item : data) {
-                stats.values.push_back(item.first);
-                uint32_t wins = 0;
-                uint32_t losses = 0;
-                for (auto &item2 : item.second) {
-                    wins += item2.second.first;
-                    losses += item2.second.second;
-                }
+            inline void clear() noexcept {
+                values.clear();
+                wins.clear();
+                losses.clear();
+                deals.clear();
+                winrates.clear();
+                total_deals = total_wins = total_losses = 0;
+                total_winrate = 0;
+            }
 
-                stats.wins.push_back(wins);
-                stats.losses.push_back(losses);
-                const uint32_t d = wins + losses;
-                stats.deals.push_back(d);
-                const double w = d == 0 ? 0 : (double)wins / (double)d;
-                stats.winrates.push_back(w);
-                stats.total_wins += wins;
-                stats.total_losses += losses;
+            inline void push_back(const int value, const uint32_t w, const uint32_t l) {
+                values.push_back(value);
+                wins.push_back(w);
+                losses.push_back(l);
+                const uint32_t d = w + l;
+                deals.push_back(d);
+                winrates.push_back(d == 0 ? 0 : (double)w / (double)d);
+            }
+
+            inline void set_totals(const uint32_t w, const uint32_t l) noexcept {
+                total_wins = w;
+                total_losses = l;
+                total_deals = total_wins + total_losses;
+                total_winrate = total_deals == 0 ? 0 : (double)total_wins / (double)total_deals;
             }
-            stats.total_deals = stats.total_wins + stats.total_losses;
-            stats.total_winrate = stats.total_deals == 0 ? 0 : (double)stats.total_wins / (double)stats.total_deals;
-            return std::move(stats);
         };
 
-        inline Stats calc_norm(const uint32_t threshold_deals) noexcept {
+        /** \brief Перебрать счетчики значений без построения Stats
+         * \param f Функция вида f(value, wins, losses), вызывается по возрастанию значения
+         */
+        template<class F>
+        inline void for_each(F f) const {
+            for (auto &item : counters) {
+                f(item.first, item.second.wins, item.second.losses);
+            }
+        }
+
+        inline uint32_t get_total_wins() const noexcept {
+            return total_wins;
+        }
+
+        inline uint32_t get_total_losses() const noexcept {
+            return total_losses;
+        }
+
+        /** \brief Получить статистику по каждому значению
+         * \param stats Статистика, память массивов используется повторно
+         */
+        inline void calc(Stats &stats) {
+            stats.clear();
+            for (auto &item : counters) {
+                stats.push_back(item.first, item.second.wins, item.second.losses);
+            }
+            stats.set_totals(total_wins, total_losses);
+        }
+
+        inline Stats calc() noexcept {
             Stats stats;
+            calc(stats);
+            return stats;
+        };
+
+        /** \brief Получить статистику по группам значений, в каждой группе не меньше threshold_deals сделок
+         * \param threshold_deals   Минимальное число сделок в группе
+         * \param stats             Статистика, память массивов используется повторно
+         */
+        inline void calc_norm(const uint32_t threshold_deals, Stats &stats) {
+            stats.clear();
             int start_value = 0;
             uint32_t wins = 0;
             uint32_t losses = 0;
             bool is_init_element = false;
-            for (auto &item : data) {
-
+            for (auto &item : counters) {
                 if (!is_init_element) {
                     is_init_element = true;
                     start_value = item.first;
                 }
-
-                for (auto &item2 : item.second) {
-                    wins += item2.second.first;
-                    losses += item2.second.second;
-                    stats.total_wins += item2.second.first;
-                    stats.total_losses += item2.second.second;
-                }
-
+                wins += item.second.wins;
+                losses += item.second.losses;
                 const uint32_t d = wins + losses;
                 if (d >= threshold_deals) {
-                    const double w = d == 0 ? 0 : (double)wins / (double)d;
-                    stats.values.push_back(start_value);
-                    stats.wins.push_back(wins);
-                    stats.losses.push_back(losses);
-                    stats.deals.push_back(d);
-                    stats.winrates.push_back(w);
+                    stats.push_back(start_value, wins, losses);
                     is_init_element = false;
                     wins = 0;
                     losses = 0;
                 }
             }
-            if (is_init_element) {
-                const uint32_t d = wins + losses;
-                const double w = d == 0 ? 0 : (double)wins / (double)d;
-                stats.values.push_back(start_value);
-                stats.wins.push_back(wins);
-                stats.losses.push_back(losses);
-                stats.deals.push_back(d);
-                stats.winrates.push_back(w);
-            }
-            stats.total_deals = stats.total_wins + stats.total_losses;
-            stats.total_winrate = stats.total_deals == 0 ? 0 : (double)stats.total_wins / (double)stats.total_deals;
-            return std::move(stats);
-        };
+            if (is_init_element) stats.push_back(start_value, wins, losses);
+            stats.set_totals(total_wins, total_losses);
+        }
 
-        inline Stats calc_norm_up(const uint32_t threshold_deals) noexcept {
+        inline Stats calc_norm(const uint32_t threshold_deals) noexcept {
             Stats stats;
-            int start_value = 0;
+            calc_norm(threshold_deals, stats);
+            return stats;
+        };
+
+        /** \brief Получить статистику для значений не меньше начала каждой группы
+         *
+         * Группы формируются так же, как в calc_norm, но статистика группы
+         * включает все значения, начиная с первого значения группы
+         * \param threshold_deals   Минимальное число сделок в группе
+         * \param stats             Статистика, память массивов используется повторно
+         */
+        inline void calc_norm_up(const uint32_t threshold_deals, Stats &stats) {
+            stats.clear();
             uint32_t wins = 0;
             uint32_t losses = 0;
+            uint32_t prefix_wins = 0;
+            uint32_t prefix_losses = 0;
             bool is_init_element = false;
-            for (auto &item : data) {
-
+            for (auto &item : counters) {
                 if (!is_init_element) {
                     is_init_element = true;
-                    start_value = item.first;
-                    stats.values.push_back(start_value);
-                    stats.wins.push_back(0);
-                    stats.losses.push_back(0);
-                    stats.deals.push_back(0);
-                    stats.winrates.push_back(0);
+                    // временно храним сумму до начала группы
+                    stats.values.push_back(item.first);
+                    stats.wins.push_back(prefix_wins);
+                    stats.losses.push_back(prefix_losses);
                 }
-
-                for (auto &item2 : item.second) {
-                    wins += item2.second.first;
-                    losses += item2.second.second;
-                    stats.total_wins += item2.second.first;
-                    stats.total_losses += item2.second.second;
-                    for (size_t i = 0; i < stats.values.size(); ++i) {
-                        stats.wins[i] += item2.second.first;
-                        stats.losses[i] += item2.second.second;
-                    }
-                }
-
+                wins += item.second.wins;
+                losses += item.second.losses;
+                prefix_wins += item.second.wins;
+                prefix_losses += item.second.losses;
                 const uint32_t d = wins + losses;
                 if (d >= threshold_deals) {
                     wins = 0;
@@ -319,13 +654,22 @@ namespace xtechnical {
                     is_init_element = false;
                 }
             }
-            for (size_t i = 0; i < stats.values.size(); ++i) {
+            const size_t size = stats.values.size();
+            stats.deals.resize(size);
+            stats.winrates.resize(size);
+            for (size_t i = 0; i < size; ++i) {
+                stats.wins[i] = prefix_wins - stats.wins[i];
+                stats.losses[i] = prefix_losses - stats.losses[i];
                 stats.deals[i] = stats.wins[i] + stats.losses[i];
                 stats.winrates[i] = stats.deals[i] == 0 ? 0 : (double)stats.wins[i] / (double)stats.deals[i];
             }
-            stats.total_deals = stats.total_wins + stats.total_losses;
-            stats.total_winrate = stats.total_deals == 0 ? 0 : (double)stats.total_wins / (double)stats.total_deals;
-            return std::move(stats);
+            stats.set_totals(total_wins, total_losses);
+        }
+
+        inline Stats calc_norm_up(const uint32_t threshold_deals) noexcept {
+            Stats stats;
+            calc_norm_up(threshold_deals, stats);
+            return stats;
         };
 
         /** \brief Проверить заполненность данными
@@ -337,7 +681,12 @@ namespace xtechnical {
         }
 
         inline void clear() noexcept {
-            data.clear();
+            counters.clear();
+            items.clear();
+            pending_counters.clear();
+            stale_counters = 0;
+            last_end_life_time = std::numeric_limits<uint64_t>::max();
+            total_wins = total_losses = 0;
             start_time = 0;
         }
     };
@@ -0,0 +1,453 @@
+#ifndef XTECHNICAL_PROFILE_INDEX_HPP_INCLUDED
+#define XTECHNICAL_PROFILE_INDEX_HPP_INCLUDED
+
+#include "../xtechnical_common.hpp"
+#include "../math/xtechnical_simd.hpp"
+#include "xtechnical_cluster_shaper.hpp"
+
+namespace xtechnical {
+
+	/** \brief Индекс поиска похожих профилей кластеров
+	 *
+	 * Профили (нормированные массивы кластеров) приводятся к одной длине
+	 * линейной интерполяцией и хранятся в непрерывной памяти блоками
+	 * по BLOCK векторов, блок хранится по столбцам. Поиск k ближайших
+	 * соседей перебирает блоки векторными ядрами simd::block_sq_dist
+	 * и simd::block_dot.
+	 *
+	 * После вызова build_ivf доступен приближенный поиск search_ivf:
+	 * векторы разбиваются k-средними на списки, и просматриваются только
+	 * списки с nprobe ближайшими центрами. Векторы при этом переносятся
+	 * в списки, общий набор освобождается, поэтому каждый вектор хранится
+	 * один раз, а точный поиск search перебирает все списки.
+	 * \tparam T	Тип хранения координат (float или double)
+	 */
+	template<class T = float>
+	class ProfileIndex {
+	public:
+
+		/// Мера сходства профилей
+		enum MetricType {
+			EUCLIDEAN = 0,	/**< 1 / (1 + евклидово расстояние), как ClusterShaper::get_euclidean_distance */
+			COSINE = 1,		/**< Косинусное сходство, как ClusterShaper::get_cosine_similarity */
+		};
+
+		static const size_t BLOCK = 64;	/**< Количество векторов в блоке */
+
+		/** \brief Результат поиска
+		 */
+		class Result {
+		public:
+			size_t id = 0;			/**< Номер профиля в порядке добавления */
+			double similarity = 0;	/**< Сходство с запросом */
+		};
+
+	private:
+
+		/** \brief Набор векторов, хранящийся блоками по столбцам
+		 */
+		class List {
+		public:
+			std::vector<T> data;
+			std::vector<double> norms;
+			std::vector<size_t> ids;
+			size_t count = 0;
+
+			void add(const T *vec, const double norm, const size_t id, const size_t dim) {
+				if ((count % BLOCK) == 0) data.resize(data.size() + dim * BLOCK, T(0));
+				T *block = data.data() + (count / BLOCK) * dim * BLOCK;
+				const size_t lane = count % BLOCK;
+				for (size_t d = 0; d < dim; ++d) {
+					block[d * BLOCK + lane] = vec[d];
+				}
+				norms.push_back(norm);
+				ids.push_back(id);
+				++count;
+			}
+
+			void get(const size_t index, T *out, const size_t dim) const {
+				const T *block = data.data() + (index / BLOCK) * dim * BLOCK;
+				const size_t lane = index % BLOCK;
+				for (size_t d = 0; d < dim; ++d) {
+					out[d] = block[d * BLOCK + lane];
+				}
+			}
+
+			void clear() {
+				data.clear();
+				norms.clear();
+				ids.clear();
+				count = 0;
+			}
+		};
+
+		/** \brief Положение вектора в списке приближенного поиска
+		 */
+		class Location {
+		public:
+			size_t list = 0;
+			size_t index = 0;
+
+			Location() {};
+
+			Location(const size_t l, const size_t i) : list(l), index(i) {};
+		};
+
+		/** \brief Кандидат в k ближайших, меньший score лучше
+		 */
+		class Item {
+		public:
+			double score;
+			size_t id;
+
+			Item(const double s, const size_t i) : score(s), id(i) {};
+
+			inline bool operator < (const Item &other) const noexcept {
+				return score < other.score || (score == other.score && id < other.id);
+			}
+		};
+
+		List all;						/**< Все векторы до вызова build_ivf */
+		List centers;
+		std::vector<List> lists;		/**< Списки приближенного поиска, после build_ivf хранят все векторы */
+		std::vector<Location> locations;/**< Положение векторов в списках по номеру профиля */
+		size_t count = 0;				/**< Количество профилей */
+		size_t dim = 0;
+		MetricType metric = EUCLIDEAN;
+		std::vector<double> buffer;
+		std::vector<T> vec;
+
+		static inline double calc_norm(const T *x, const size_t n) noexcept {
+			double s = 0;
+			for (size_t i = 0; i < n; ++i) s += (double)x[i] * (double)x[i];
+			return std::sqrt(s);
+		}
+
+		/** \brief Найти k лучших векторов набора
+		 * \param list		Набор векторов
+		 * \param query		Запрос
+		 * \param norm		Норма запроса
+		 * \param k			Количество результатов
+		 * \param heap		Куча кандидатов, наихудший в начале
+		 */
+		void scan(
+				const List &list,
+				const T *query,
+				const double norm,
+				const size_t k,
+				std::vector<Item> &heap) const {
+			double scores[BLOCK];
+			const size_t blocks = (list.count + BLOCK - 1) / BLOCK;
+			for (size_t b = 0; b < blocks; ++b) {
+				const T *block = list.data.data() + b * dim * BLOCK;
+				if (metric == EUCLIDEAN) simd::block_sq_dist(block, query, dim, BLOCK, scores);
+				else simd::block_dot(block, query, dim, BLOCK, scores);
+				const size_t offset = b * BLOCK;
+				const size_t width = std::min(BLOCK, list.count - offset);
+				for (size_t i = 0; i < width; ++i) {
+					double score = scores[i];
+					if (metric == COSINE) {
+						const double denom = list.norms[offset + i] * norm;
+						score = denom > 0 ? -score / denom : 0.0d;
+					}
+					if (heap.size() < k) {
+						heap.push_back(Item(score, list.ids[offset + i]));
+						std::push_heap(heap.begin(), heap.end());
+					} else
+					if (Item(score, list.ids[offset + i]) < heap.front()) {
+						std::pop_heap(heap.begin(), heap.end());
+						heap.back() = Item(score, list.ids[offset + i]);
+						std::push_heap(heap.begin(), heap.end());
+					}
+				}
+			}
+		}
+
+		inline double to_similarity(const double score) const noexcept {
+			return metric == EUCLIDEAN ? 1.0d / (1.0d + std::sqrt(std::max(score, 0.0d))) : -score;
+		}
+
+		void make_results(std::vector<Item> &heap, std::vector<Result> &results) const {
+			std::sort_heap(heap.begin(), heap.end());
+			results.resize(heap.size());
+			for (size_t i = 0; i < heap.size(); ++i) {
+				results[i].id = heap[i].id;
+				results[i].similarity = to_similarity(heap[i].score);
+			}
+		}
+
+		inline size_t find_center(const T *x, const double norm) const {
+			std::vector<Item> heap;
+			heap.reserve(1);
+			scan(centers, x, norm, 1, heap);
+			return heap.front().id;
+		}
+
+		/** \brief Скопировать вектор и получить его норму
+		 */
+		double get_vector(const size_t id, T *out) const {
+			if (lists.empty()) {
+				all.get(id, out, dim);
+				return all.norms[id];
+			}
+			const Location &location = locations[id];
+			const List &list = lists[location.list];
+			list.get(location.index, out, dim);
+			return list.norms[location.index];
+		}
+
+		/** \brief Добавить вектор в список ближайшего центра
+		 */
+		void add_to_list(
+				std::vector<List> &target,
+				std::vector<Location> &target_locations,
+				const T *x,
+				const double norm,
+				const size_t id) {
+			const size_t c = find_center(x, norm);
+			if (target_locations.size() <= id) target_locations.resize(id + 1);
+			target_locations[id] = Location(c, target[c].count);
+			target[c].add(x, norm, id, dim);
+		}
+
+		void prepare_query(const std::vector<double> &profile, std::vector<T> &query, double &norm) const {
+			query.resize(dim);
+			resample(profile.data(), profile.size(), query.data(), dim);
+			norm = calc_norm(query.data(), dim);
+		}
+
+	public:
+
+		ProfileIndex() {};
+
+		/** \brief Конструктор индекса профилей
+		 * \param d		Длина профиля после передискретизации
+		 * \param m		Мера сходства
+		 */
+		ProfileIndex(const size_t d, const MetricType m = EUCLIDEAN) :
+			dim(d), metric(m), vec(d) {
+		}
+
+		/** \brief Привести массив к заданной длине линейной интерполяцией
+		 * \param values	Исходный массив
+		 * \param length	Длина исходного массива
+		 * \param out		Выходной массив
+		 * \param n			Длина выходного массива
+		 */
+		static void resample(const double *values, const size_t length, T *out, const size_t n) noexcept {
+			if (n == 0) return;
+			if (length == 0) {
+				std::fill(out, out + n, T(0));
+				return;
+			}
+			if (length == 1 || n == 1) {
+				std::fill(out, out + n, (T)values[0]);
+				return;
+			}
+			const double step = (double)(length - 1) / (double)(n - 1);
+			for (size_t i = 0; i < n; ++i) {
+				const double x = (double)i * step;
+				const size_t j = std::min((size_t)x, length - 2);
+				const double w = x - (double)j;
+				out[i] = (T)(values[j] + (values[j + 1] - values[j]) * w);
+			}
+		}
+
+		/** \brief Добавить профиль
+		 * \param profile	Профиль произвольной длины
+		 * \return Номер профиля
+		 */
+		size_t add(const std::vector<double> &profile) {
+			resample(profile.data(), profile.size(), vec.data(), dim);
+			const double norm = calc_norm(vec.data(), dim);
+			const size_t id = count++;
+			if (lists.empty()) all.add(vec.data(), norm, id, dim);
+			else add_to_list(lists, locations, vec.data(), norm, id);
+			return id;
+		}
+
+		/** \brief Добавить нормированный профиль кластера
+		 * \param cluster	Кластер
+		 * \return Номер профиля
+		 */
+		size_t add(const ClusterShaperBase::Cluster &cluster) {
+			cluster.get_normalized_array(buffer);
+			return add(buffer);
+		}
+
+		/** \brief Найти k наиболее похожих профилей полным перебором
+		 * \param profile	Профиль запроса произвольной длины
+		 * \param k			Количество результатов
+		 * \param results	Результаты, отсортированные по убыванию сходства
+		 * \return Вернет 0 в случае успеха, иначе см. ErrorType
+		 */
+		int search(const std::vector<double> &profile, const size_t k, std::vector<Result> &results) const {
+			results.clear();
+			if (dim == 0) return common::NO_INIT;
+			if (count == 0 || k == 0) return common::OK;
+			std::vector<T> query;
+			double norm = 0;
+			prepare_query(profile, query, norm);
+			std::vector<Item> heap;
+			heap.reserve(k);
+			if (lists.empty()) {
+				scan(all, query.data(), norm, k, heap);
+			} else {
+				for (const List &list : lists) scan(list, query.data(), norm, k, heap);
+			}
+			make_results(heap, results);
+			return common::OK;
+		}
+
+		int search(const ClusterShaperBase::Cluster &cluster, const size_t k, std::vector<Result> &results) const {
+			return search(cluster.get_normalized_array(), k, results);
+		}
+
+		/** \brief Построить списки для приближенного поиска
+		 *
+		 * Центры ищутся k-средними по выборке не более max_train профилей,
+		 * затем все профили распределяются по спискам ближайших центров.
+		 * Профили, добавленные позже, сразу попадают в свои списки.
+		 * Векторы переносятся из общего набора в списки, при повторном
+		 * вызове - из старых списков в новые, на время переноса память
+		 * под векторы занята дважды.
+		 * \param nlist			Количество списков
+		 * \param iterations	Количество итераций k-средних
+		 * \param max_train		Размер обучающей выборки (0 - 64 профиля на список)
+		 * \return Вернет 0 в случае успеха, иначе см. ErrorType
+		 */
+		int build_ivf(const size_t nlist, const size_t iterations = 10, size_t max_train = 0) {
+			if (dim == 0 || nlist == 0) return common::INVALID_PARAMETER;
+			if (count < nlist) return common::INDICATOR_NOT_READY_TO_WORK;
+			if (max_train == 0) max_train = nlist * 64;
+			const size_t train = std::min(std::max(max_train, nlist), count);
+
+			/* обучающая выборка и начальные центры берутся равномерно по индексу */
+			std::vector<T> samples(train * dim);
+			for (size_t i = 0; i < train; ++i) {
+				get_vector(i * count / train, samples.data() + i * dim);
+			}
+			std::vector<T> values(nlist * dim);
+			for (size_t c = 0; c < nlist; ++c) {
+				std::copy(
+					samples.begin() + (c * train / nlist) * dim,
+					samples.begin() + (c * train / nlist + 1) * dim,
+					values.begin() + c * dim);
+			}
+
+			std::vector<double> sums(nlist * dim);
+			std::vector<size_t> counts(nlist);
+			for (size_t it = 0; it < iterations; ++it) {
+				centers.clear();
+				for (size_t c = 0; c < nlist; ++c) {
+					centers.add(values.data() + c * dim, calc_norm(values.data() + c * dim, dim), c, dim);
+				}
+				std::fill(sums.begin(), sums.end(), 0.0d);
+				std::fill(counts.begin(), counts.end(), 0);
+				for (size_t i = 0; i < train; ++i) {
+					const T *x = samples.data() + i * dim;
+					const size_t c = find_center(x, calc_norm(x, dim));
+					for (size_t d = 0; d < dim; ++d) sums[c * dim + d] += x[d];
+					++counts[c];
+				}
+				for (size_t c = 0; c < nlist; ++c) {
+					if (counts[c] == 0) continue;
+					for (size_t d = 0; d < dim; ++d) {
+						values[c * dim + d] = (T)(sums[c * dim + d] / (double)counts[c]);
+					}
+				}
+			}
+			centers.clear();
+			for (size_t c = 0; c < nlist; ++c) {
+				centers.add(values.data() + c * dim, calc_norm(values.data() + c * dim, dim), c, dim);
+			}
+
+			/* перенос из общего набора или старых списков в новые */
+			std::vector<List> new_lists(nlist);
+			std::vector<Location> new_locations(count);
+			for (size_t i = 0; i < count; ++i) {
+				const double norm = get_vector(i, vec.data());
+				add_to_list(new_lists, new_locations, vec.data(), norm, i);
+			}
+			lists.swap(new_lists);
+			locations.swap(new_locations);
+			all = List();
+			return common::OK;
+		}
+
+		/** \brief Найти k похожих профилей приближенно
+		 *
+		 * До вызова build_ivf выполняется полный перебор
+		 * \param profile	Профиль запроса произвольной длины
+		 * \param k			Количество результатов
+		 * \param results	Результаты, отсортированные по убыванию сходства
+		 * \param nprobe	Количество просматриваемых списков
+		 * \return Вернет 0 в случае успеха, иначе см. ErrorType
+		 */
+		int search_ivf(
+				const std::vector<double> &profile,
+				const size_t k,
+				std::vector<Result> &results,
+				const size_t nprobe = 8) const {
+			if (lists.empty()) return search(profile, k, results);
+			results.clear();
+			if (k == 0) return common::OK;
+			std::vector<T> query;
+			double norm = 0;
+			prepare_query(profile, query, norm);
+			std::vector<Item> probes;
+			probes.reserve(nprobe);
+			scan(centers, query.data(), norm, std::max(nprobe, (size_t)1), probes);
+			std::vector<Item> heap;
+			heap.reserve(k);
+			for (const Item &probe : probes) {
+				scan(lists[probe.id], query.data(), norm, k, heap);
+			}
+			make_results(heap, results);
+			return common::OK;
+		}
+
+		/** \brief Получить профиль после передискретизации
+		 * \param id	Номер профиля
+		 * \param out	Профиль длиной get_dimension()
+		 */
+		void get(const size_t id, std::vector<T> &out) const {
+			out.resize(dim);
+			get_vector(id, out.data());
+		}
+
+		/** \brief Количество профилей
+		 */
+		inline size_t size() const noexcept {
+			return count;
+		}
+
+		/** \brief Длина профиля после передискретизации
+		 */
+		inline size_t get_dimension() const noexcept {
+			return dim;
+		}
+
+		/** \brief Количество списков приближенного поиска
+		 */
+		inline size_t get_lists() const noexcept {
+			return lists.size();
+		}
+
+		/** \brief Очистить индекс
+		 */
+		void clear() {
+			all.clear();
+			centers.clear();
+			lists.clear();
+			locations.clear();
+			count = 0;
+		}
+	};
+
+	template<class T>
+	const size_t ProfileIndex<T>::BLOCK;
+
+}; // xtechnical
+
+#endif // XTECHNICAL_PROFILE_INDEX_HPP_INCLUDED
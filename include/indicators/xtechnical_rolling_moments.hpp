@@ -0,0 +1,351 @@
+#ifndef XTECHNICAL_ROLLING_MOMENTS_HPP_INCLUDED
+#define XTECHNICAL_ROLLING_MOMENTS_HPP_INCLUDED
+
+#include "../xtechnical_common.hpp"
+
+namespace xtechnical {
+
+    /** \brief Скользящие степенные суммы до 4 порядка
+     *
+     * Суммы считаются относительно сдвига (среднего на момент последней
+     * пересинхронизации), чтобы уменьшить потерю точности. Раз в resync_period
+     * обновлений суммы пересчитываются по кольцевому буферу заново,
+     * поэтому стоимость update и test в среднем O(1).
+     */
+    template <typename T>
+    class RollingPowerSums {
+    private:
+        std::vector<T> buffer;
+        size_t period = 0;
+        size_t pos = 0;
+        size_t count = 0;
+        size_t resync_period = 0;
+        size_t resync_counter = 0;
+        double shift = 0;
+        double s1 = 0, s2 = 0, s3 = 0, s4 = 0;
+
+        inline void add(const double x, const double sign, double &a1, double &a2, double &a3, double &a4) const noexcept {
+            const double d = x - shift;
+            const double d2 = d * d;
+            a1 += sign * d;
+            a2 += sign * d2;
+            a3 += sign * d2 * d;
+            a4 += sign * d2 * d2;
+        }
+
+        void resync() noexcept {
+            shift += s1 / (double)count;
+            s1 = s2 = s3 = s4 = 0;
+            for (size_t i = 0; i < count; ++i) {
+                add(buffer[i], 1.0, s1, s2, s3, s4);
+            }
+            resync_counter = 0;
+        }
+
+    public:
+
+        /** \brief Центральные моменты окна
+         */
+        class Moments {
+        public:
+            size_t n = 0;
+            double m2 = 0;  /**< Второй центральный момент (деленный на n) */
+            double m3 = 0;  /**< Третий центральный момент (деленный на n) */
+            double m4 = 0;  /**< Четвертый центральный момент (деленный на n) */
+        };
+
+        RollingPowerSums() {};
+
+        /** \brief Конструктор
+         * \param p     Период
+         * \param rp    Период пересинхронизации сумм (0 - равен периоду)
+         */
+        RollingPowerSums(const size_t p, const size_t rp = 0) :
+                buffer(p), period(p), resync_period(rp == 0 ? p : rp) {
+        }
+
+        /** \brief Обновить суммы
+         * \param in    Новое значение
+         */
+        inline void update(const T in) noexcept {
+            if (count == 0 && resync_counter == 0) shift = in;
+            if (count == period) {
+                add(buffer[pos], -1.0, s1, s2, s3, s4);
+            } else {
+                ++count;
+            }
+            buffer[pos] = in;
+            if (++pos == period) pos = 0;
+            add(in, 1.0, s1, s2, s3, s4);
+            if (++resync_counter >= resync_period) resync();
+        }
+
+        /** \brief Получить моменты окна после гипотетического добавления значения
+         *
+         * Состояние не меняется
+         * \param in    Значение
+         * \return Моменты окна
+         */
+        inline Moments test(const T in) const noexcept {
+            double a1 = s1, a2 = s2, a3 = s3, a4 = s4;
+            size_t n = count;
+            if (count == period) add(buffer[pos], -1.0, a1, a2, a3, a4);
+            else ++n;
+            add(in, 1.0, a1, a2, a3, a4);
+            return calc(n, a1, a2, a3, a4);
+        }
+
+        /** \brief Получить моменты окна
+         */
+        inline Moments get() const noexcept {
+            return calc(count, s1, s2, s3, s4);
+        }
+
+        static inline Moments calc(const size_t n, const double a1, const double a2, const double a3, const double a4) noexcept {
+            Moments moments;
+            moments.n = n;
+            if (n == 0) return moments;
+            const double nd = (double)n;
+            const double m = a1 / nd;
+            const double e2 = a2 / nd;
+            const double e3 = a3 / nd;
+            const double e4 = a4 / nd;
+            const double mm = m * m;
+            moments.m2 = std::max(0.0, e2 - mm);
+            moments.m3 = e3 - 3.0 * m * e2 + 2.0 * mm * m;
+            moments.m4 = std::max(0.0, e4 - 4.0 * m * e3 + 6.0 * mm * e2 - 3.0 * mm * mm);
+            return moments;
+        }
+
+        inline size_t size() const noexcept {
+            return count;
+        }
+
+        inline bool full() const noexcept {
+            return period != 0 && count == period;
+        }
+
+        inline void clear() noexcept {
+            pos = count = resync_counter = 0;
+            shift = s1 = s2 = s3 = s4 = 0;
+        }
+    };
+
+    /** \brief Скользящий коэффициент асимметрии
+     *
+     * Значение совпадает с Moments::get_skewness из xtechnical_statistics.hpp:
+     * g1 = m3 / m2^(3/2)
+     */
+    template <typename T>
+    class RollingSkewness {
+    private:
+        RollingPowerSums<T> sums;
+        T output_value = std::numeric_limits<T>::quiet_NaN();
+        size_t period = 0;
+
+        static inline T calc(const typename RollingPowerSums<T>::Moments &m) noexcept {
+            if (m.m2 <= 0) return 0;
+            return (T)(m.m3 / std::pow(m.m2, 1.5));
+        }
+
+    public:
+        RollingSkewness() {};
+
+        /** \brief Конструктор скользящего коэффициента асимметрии
+         * \param p     Период
+         * \param rp    Период пересинхронизации сумм (0 - равен периоду)
+         */
+        RollingSkewness(const size_t p, const size_t rp = 0) :
+            sums(p, rp), period(p) {
+        }
+
+        /** \brief Обновить состояние индикатора
+         * \param in    Сигнал на входе
+         * \return Вернет 0 в случае успеха, иначе см. ErrorType
+         */
+        int update(const T in) noexcept {
+            if(period == 0) {
+                output_value = std::numeric_limits<T>::quiet_NaN();
+                return common::NO_INIT;
+            }
+            sums.update(in);
+            if(!sums.full()) {
+                output_value = std::numeric_limits<T>::quiet_NaN();
+                return common::INDICATOR_NOT_READY_TO_WORK;
+            }
+            output_value = calc(sums.get());
+            return common::OK;
+        }
+
+        /** \brief Обновить состояние индикатора
+         * \param in    Сигнал на входе
+         * \param out   Сигнал на выходе
+         * \return Вернет 0 в случае успеха, иначе см. ErrorType
+         */
+        int update(const T in, T &out) noexcept {
+            const int err = update(in);
+            out = output_value;
+            return err;
+        }
+
+        /** \brief Протестировать индикатор
+         *
+         * Данная функция отличается от update тем,
+         * что не влияет на внутреннее состояние индикатора
+         * \param in    Сигнал на входе
+         * \return Вернет 0 в случае успеха, иначе см. ErrorType
+         */
+        int test(const T in) noexcept {
+            if(period == 0) {
+                output_value = std::numeric_limits<T>::quiet_NaN();
+                return common::NO_INIT;
+            }
+            const typename RollingPowerSums<T>::Moments m = sums.test(in);
+            if(m.n < period) {
+                output_value = std::numeric_limits<T>::quiet_NaN();
+                return common::INDICATOR_NOT_READY_TO_WORK;
+            }
+            output_value = calc(m);
+            return common::OK;
+        }
+
+        /** \brief Протестировать индикатор
+         *
+         * Данная функция отличается от update тем,
+         * что не влияет на внутреннее состояние индикатора
+         * \param in    Сигнал на входе
+         * \param out   Сигнал на выходе
+         * \return Вернет 0 в случае успеха, иначе см. ErrorType
+         */
+        int test(const T in, T &out) noexcept {
+            const int err = test(in);
+            out = output_value;
+            return err;
+        }
+
+        /** \brief Получить значение индикатора
+         * \return Значение индикатора
+         */
+        inline T get() const noexcept {
+            return output_value;
+        }
+
+        /** \brief Очистить данные индикатора
+         */
+        inline void clear() noexcept {
+            sums.clear();
+            output_value = std::numeric_limits<T>::quiet_NaN();
+        }
+    };
+
+    /** \brief Скользящий коэффициент эксцесса
+     *
+     * Значение совпадает с calc_excess из xtechnical_statistics.hpp:
+     * четвертый момент делится на квадрат выборочной дисперсии, затем вычитается 3
+     */
+    template <typename T>
+    class RollingKurtosis {
+    private:
+        RollingPowerSums<T> sums;
+        T output_value = std::numeric_limits<T>::quiet_NaN();
+        size_t period = 0;
+
+        static inline T calc(const typename RollingPowerSums<T>::Moments &m) noexcept {
+            if (m.m2 <= 0 || m.n < 2) return 0;
+            const double var = m.m2 * (double)m.n / (double)(m.n - 1);
+            return (T)(m.m4 / (var * var) - 3.0);
+        }
+
+    public:
+        RollingKurtosis() {};
+
+        /** \brief Конструктор скользящего коэффициента эксцесса
+         * \param p     Период
+         * \param rp    Период пересинхронизации сумм (0 - равен периоду)
+         */
+        RollingKurtosis(const size_t p, const size_t rp = 0) :
+            sums(p, rp), period(p) {
+        }
+
+        /** \brief Обновить состояние индикатора
+         * \param in    Сигнал на входе
+         * \return Вернет 0 в случае успеха, иначе см. ErrorType
+         */
+        int update(const T in) noexcept {
+            if(period == 0) {
+                output_value = std::numeric_limits<T>::quiet_NaN();
+                return common::NO_INIT;
+            }
+            sums.update(in);
+            if(!sums.full()) {
+                output_value = std::numeric_limits<T>::quiet_NaN();
+                return common::INDICATOR_NOT_READY_TO_WORK;
+            }
+            output_value = calc(sums.get());
+            return common::OK;
+        }
+
+        /** \brief Обновить состояние индикатора
+         * \param in    Сигнал на входе
+         * \param out   Сигнал на выходе
+         * \return Вернет 0 в случае успеха, иначе см. ErrorType
+         */
+        int update(const T in, T &out) noexcept {
+            const int err = update(in);
+            out = output_value;
+            return err;
+        }
+
+        /** \brief Протестировать индикатор
+         *
+         * Данная функция отличается от update тем,
+         * что не влияет на внутреннее состояние индикатора
+         * \param in    Сигнал на входе
+         * \return Вернет 0 в случае успеха, иначе см. ErrorType
+         */
+        int test(const T in) noexcept {
+            if(period == 0) {
+                output_value = std::numeric_limits<T>::quiet_NaN();
+                return common::NO_INIT;
+            }
+            const typename RollingPowerSums<T>::Moments m = sums.test(in);
+            if(m.n < period) {
+                output_value = std::numeric_limits<T>::quiet_NaN();
+                return common::INDICATOR_NOT_READY_TO_WORK;
+            }
+            output_value = calc(m);
+            return common::OK;
+        }
+
+        /** \brief Протестировать индикатор
+         *
+         * Данная функция отличается от update тем,
+         * что не влияет на внутреннее состояние индикатора
+         * \param in    Сигнал на входе
+         * \param out   Сигнал на выходе
+         * \return Вернет 0 в случае успеха, иначе см. ErrorType
+         */
+        int test(const T in, T &out) noexcept {
+            const int err = test(in);
+            out = output_value;
+            return err;
+        }
+
+        /** \brief Получить значение индикатора
+         * \return Значение индикатора
+         */
+        inline T get() const noexcept {
+            return output_value;
+        }
+
+        /** \brief Очистить данные индикатора
+         */
+        inline void clear() noexcept {
+            sums.clear();
+            output_value = std::numeric_limits<T>::quiet_NaN();
+        }
+    };
+
+}; // xtechnical
+
+#endif // XTECHNICAL_ROLLING_MOMENTS_HPP_INCLUDED
@@ -0,0 +1,323 @@
+#ifndef XTECHNICAL_ROLLING_VOLUME_PROFILE_HPP_INCLUDED
+#define XTECHNICAL_ROLLING_VOLUME_PROFILE_HPP_INCLUDED
+
+#include "../xtechnical_common.hpp"
+#include "xtechnical_cluster_shaper.hpp"
+
+namespace xtechnical {
+
+	/** \brief Скользящий профиль объема по последним N кластерам
+	 *
+	 * Гистограмма нового кластера добавляется к профилю, а гистограмма
+	 * вышедшего из окна кластера вычитается, поэтому обновление стоит
+	 * O(диапазона кластера). Префиксные суммы, точка контроля (POC)
+	 * и узлы объема пересчитываются лениво за O(диапазона профиля) при первом
+	 * запросе после обновления, границы зоны стоимости ищутся
+	 * двоичным поиском по префиксным суммам.
+	 *
+	 * Класс можно использовать как приемник BasicClusterShaper
+	 */
+	class RollingVolumeProfile {
+	private:
+
+		/** \brief Гистограмма кластера в окне
+		 */
+		class Entry {
+		public:
+			std::vector<int> volumes;
+			int low = 0;
+		};
+
+		std::vector<Entry> entries;
+		size_t period = 0;
+		size_t pos = 0;
+		size_t count = 0;
+
+		std::vector<int64_t> volumes;
+		int origin = 0;		/**< Уровень цены, соответствующий volumes[0] */
+		int low = 0;		/**< Минимальный уровень с ненулевым объемом */
+		int high = 0;		/**< Максимальный уровень с ненулевым объемом */
+		int64_t total_volume = 0;
+		double pips_size = 0;
+		double value_area = 0.7;
+
+		mutable std::vector<int64_t> prefix;	/**< prefix[i] - объем уровней от low до low + i - 1 */
+		mutable int poc = 0;
+		mutable int64_t poc_volume = 0;
+		mutable bool is_dirty = true;
+
+		inline bool is_inside(const int tick) const noexcept {
+			return tick >= origin && (int64_t)tick < ((int64_t)origin + (int64_t)volumes.size());
+		}
+
+		void grow(const int l, const int h) {
+			const size_t length = (size_t)((int64_t)h - (int64_t)l + 1);
+			const size_t capacity = std::max(std::max(volumes.size() * 2, length * 2), (size_t)64);
+			std::vector<int64_t> temp(capacity, 0);
+			const int new_origin = l - (int)((capacity - length) / 2);
+			if (total_volume > 0) {
+				std::copy(
+					volumes.begin() + (low - origin),
+					volumes.begin() + (high - origin + 1),
+					temp.begin() + (low - new_origin));
+			}
+			volumes.swap(temp);
+			origin = new_origin;
+		}
+
+		void add(const int *values, const size_t length, const int l) {
+			if (length == 0) return;
+			const int h = l + (int)length - 1;
+			if (total_volume == 0) {
+				if (!is_inside(l) || !is_inside(h)) grow(l, h);
+				low = l;
+				high = h;
+			} else {
+				if (!is_inside(l) || !is_inside(h)) grow(std::min(l, low), std::max(h, high));
+				low = std::min(l, low);
+				high = std::max(h, high);
+			}
+			int64_t *dst = volumes.data() + (l - origin);
+			for (size_t i = 0; i < length; ++i) {
+				dst[i] += values[i];
+				total_volume += values[i];
+			}
+		}
+
+		void sub(const Entry &entry) {
+			const size_t length = entry.volumes.size();
+			if (length == 0) return;
+			int64_t *dst = volumes.data() + (entry.low - origin);
+			for (size_t i = 0; i < length; ++i) {
+				dst[i] -= entry.volumes[i];
+				total_volume -= entry.volumes[i];
+			}
+			if (total_volume == 0) return;
+			while (volumes[low - origin] == 0) ++low;
+			while (volumes[high - origin] == 0) --high;
+		}
+
+		void rebuild() const {
+			if (!is_dirty) return;
+			is_dirty = false;
+			poc = low;
+			poc_volume = 0;
+			if (total_volume == 0) {
+				prefix.assign(1, 0);
+				return;
+			}
+			const size_t length = (size_t)(high - low + 1);
+			const int64_t *values = volumes.data() + (low - origin);
+			prefix.resize(length + 1);
+			prefix[0] = 0;
+			for (size_t i = 0; i < length; ++i) {
+				prefix[i + 1] = prefix[i] + values[i];
+				if (values[i] > poc_volume) {
+					poc_volume = values[i];
+					poc = low + (int)i;
+				}
+			}
+		}
+
+		inline int64_t get_level_volume(const int tick) const noexcept {
+			if (total_volume == 0 || tick < low || tick > high) return 0;
+			return volumes[tick - origin];
+		}
+
+		template<class CMP>
+		void get_nodes(std::vector<double> &prices, const double ratio, CMP cmp) const {
+			prices.clear();
+			rebuild();
+			if (total_volume == 0) return;
+			const double threshold = ratio * (double)poc_volume;
+			for (int tick = low; tick <= high; ++tick) {
+				const int64_t value = volumes[tick - origin];
+				const int64_t prev = get_level_volume(tick - 1);
+				const int64_t next = get_level_volume(tick + 1);
+				if (cmp(value, prev, next, threshold)) prices.push_back((double)tick * pips_size);
+			}
+		}
+
+	public:
+
+		RollingVolumeProfile() {};
+
+		/** \brief Конструктор скользящего профиля объема
+		 * \param p		Количество кластеров в окне
+		 * \param va	Доля объема в зоне стоимости
+		 */
+		RollingVolumeProfile(const size_t p, const double va = 0.7) :
+			entries(p), period(p), value_area(va) {
+		}
+
+		/** \brief Добавить закрытый кластер
+		 * \param cluster	Кластер
+		 * \return Вернет 0 в случае успеха, иначе см. ErrorType
+		 */
+		int update(const ClusterShaperBase::Cluster &cluster) {
+			if (period == 0) return common::NO_INIT;
+			Entry &entry = entries[pos];
+			if (count == period) sub(entry);
+			else ++count;
+			const int *values = cluster.distribution.data();
+			const size_t length = cluster.distribution.size();
+			entry.volumes.assign(values, values + length);
+			entry.low = cluster.distribution.get_low();
+			add(values, length, entry.low);
+			pips_size = cluster.pips_size;
+			if (++pos == period) pos = 0;
+			is_dirty = true;
+			if (count < period) return common::INDICATOR_NOT_READY_TO_WORK;
+			return common::OK;
+		}
+
+		inline void on_close_bar(const ClusterShaperBase::Cluster &cluster) {
+			update(cluster);
+		}
+
+		inline void on_unformed_bar(const ClusterShaperBase::Cluster &) {};
+
+		/** \brief Количество кластеров в окне
+		 */
+		inline size_t size() const noexcept {
+			return count;
+		}
+
+		inline bool full() const noexcept {
+			return period != 0 && count == period;
+		}
+
+		/** \brief Суммарный объем профиля
+		 */
+		inline int64_t get_volume() const noexcept {
+			return total_volume;
+		}
+
+		/** \brief Суммарный объем уровней цены от low_tick до high_tick включительно
+		 * \param low_tick	Нижний уровень
+		 * \param high_tick	Верхний уровень
+		 * \return Объем
+		 */
+		int64_t get_volume(int low_tick, int high_tick) const {
+			rebuild();
+			if (total_volume == 0) return 0;
+			low_tick = std::max(low_tick, low);
+			high_tick = std::min(high_tick, high);
+			if (low_tick > high_tick) return 0;
+			return prefix[high_tick - low + 1] - prefix[low_tick - low];
+		}
+
+		/** \brief Минимальный уровень цены профиля
+		 */
+		inline int get_low() const noexcept {
+			return low;
+		}
+
+		/** \brief Максимальный уровень цены профиля
+		 */
+		inline int get_high() const noexcept {
+			return high;
+		}
+
+		/** \brief Уровень цены с максимальным объемом (точка контроля)
+		 */
+		inline int get_poc() const {
+			rebuild();
+			return poc;
+		}
+
+		inline double get_poc_price() const {
+			return (double)get_poc() * pips_size;
+		}
+
+		/** \brief Объем точки контроля
+		 */
+		inline int64_t get_poc_volume() const {
+			rebuild();
+			return poc_volume;
+		}
+
+		/** \brief Получить зону стоимости
+		 *
+		 * Зона отсекает по (1 - va) / 2 объема снизу и сверху профиля
+		 * \param val_tick	Нижняя граница зоны
+		 * \param vah_tick	Верхняя граница зоны
+		 * \return Вернет 0 в случае успеха, иначе см. ErrorType
+		 */
+		int get_value_area(int &val_tick, int &vah_tick) const {
+			rebuild();
+			if (total_volume == 0) return common::INDICATOR_NOT_READY_TO_WORK;
+			const double cut = (double)total_volume * (1.0d - value_area) / 2.0d;
+			const double upper = (double)total_volume - cut;
+			auto it_low = std::upper_bound(prefix.begin() + 1, prefix.end(), cut,
+				[](const double value, const int64_t item) {
+					return value < (double)item;
+				});
+			auto it_high = std::lower_bound(prefix.begin() + 1, prefix.end(), upper,
+				[](const int64_t item, const double value) {
+					return (double)item < value;
+				});
+			if (it_high == prefix.end()) --it_high;
+			val_tick = low + (int)(it_low - (prefix.begin() + 1));
+			vah_tick = low + (int)(it_high - (prefix.begin() + 1));
+			return common::OK;
+		}
+
+		int get_value_area_price(double &val, double &vah) const {
+			int val_tick = 0, vah_tick = 0;
+			const int err = get_value_area(val_tick, vah_tick);
+			val = (double)val_tick * pips_size;
+			vah = (double)vah_tick * pips_size;
+			return err;
+		}
+
+		/** \brief Получить узлы высокого объема
+		 *
+		 * Локальные максимумы профиля с объемом не меньше ratio от объема точки контроля
+		 * \param prices	Цены узлов
+		 * \param ratio		Доля объема точки контроля
+		 */
+		void get_high_volume_nodes(std::vector<double> &prices, const double ratio = 0.7) const {
+			get_nodes(prices, ratio, [](const int64_t value, const int64_t prev, const int64_t next, const double threshold) {
+				return value > prev && value >= next && (double)value >= threshold;
+			});
+		}
+
+		/** \brief Получить узлы низкого объема
+		 *
+		 * Локальные минимумы внутри профиля с объемом не больше ratio от объема точки контроля
+		 * \param prices	Цены узлов
+		 * \param ratio		Доля объема точки контроля
+		 */
+		void get_low_volume_nodes(std::vector<double> &prices, const double ratio = 0.3) const {
+			get_nodes(prices, ratio, [](const int64_t value, const int64_t prev, const int64_t next, const double threshold) {
+				return value < prev && value <= next && (double)value <= threshold;
+			});
+		}
+
+		/** \brief Получить объемы уровней от get_low() до get_high()
+		 * \param out	Массив объемов
+		 */
+		void get_array(std::vector<double> &out) const {
+			if (total_volume == 0) {
+				out.clear();
+				return;
+			}
+			const int64_t *values = volumes.data() + (low - origin);
+			out.assign(values, values + (high - low + 1));
+		}
+
+		/** \brief Очистить данные индикатора
+		 */
+		void clear() noexcept {
+			std::fill(volumes.begin(), volumes.end(), 0);
+			for (auto &entry : entries) entry.volumes.clear();
+			pos = count = 0;
+			total_volume = 0;
+			is_dirty = true;
+		}
+	};
+
+}; // xtechnical
+
+#endif // XTECHNICAL_ROLLING_VOLUME_PROFILE_HPP_INCLUDED
@@ -2,6 +2,7 @@
 #define XTECHNICAL_SMA_HPP_INCLUDED
 
 #include "../xtechnical_common.hpp"
+#include "../xtechnical_circular_buffer.hpp"
 
 namespace xtechnical {
 
@@ -108,6 +109,90 @@ namespace xtechnical {
         }
     };
 
+    /** \brief Простая скользящая средняя с периодом, заданным на этапе компиляции
+     *
+     * Аналог SMA на fixed_delay_buffer, не выделяет память в куче.
+     * Результат совпадает с SMA побитно
+     */
+    template <typename T, size_t N>
+    class FixedSMA {
+    private:
+        T last_data = 0;
+        fixed_delay_buffer<T, (N > 0 ? N : 1)> buffer;
+        T output_value = std::numeric_limits<T>::quiet_NaN();
+    public:
+
+        FixedSMA() {};
+
+        /** \brief Конструктор для совместимости с SMA
+         * \param p     Период, должен совпадать с параметром шаблона N
+         */
+        explicit FixedSMA(const size_t p) {
+            assert(p == N);
+            (void)p;
+        };
+
+        /** \brief Обновить состояние индикатора
+         * \param in сигнал на входе
+         * \return вернет 0 в случае успеха, иначе см. ErrorType
+         */
+        int update(const T in) noexcept {
+            if(N == 0) {
+                output_value = std::numeric_limits<T>::quiet_NaN();
+                return common::NO_INIT;
+            }
+            if(!buffer.ready()) {
+                last_data += in;
+                buffer.push(in);
+                output_value = std::numeric_limits<T>::quiet_NaN();
+                return common::INDICATOR_NOT_READY_TO_WORK;
+            }
+            last_data = last_data + (in - buffer.lag());
+            buffer.push(in);
+            output_value = last_data/(T)N;
+            return common::OK;
+        }
+
+        int update(const T in, T &out) noexcept {
+            const int err = update(in);
+            out = output_value;
+            return err;
+        }
+
+        /** \brief Протестировать индикатор
+         * \param in сигнал на входе
+         * \return вернет 0 в случае успеха, иначе см. ErrorType
+         */
+        int test(const T in) noexcept {
+            if(N == 0) {
+                output_value = std::numeric_limits<T>::quiet_NaN();
+                return common::NO_INIT;
+            }
+            if(!buffer.ready()) {
+                output_value = std::numeric_limits<T>::quiet_NaN();
+                return common::INDICATOR_NOT_READY_TO_WORK;
+            }
+            output_value = (last_data + (in - buffer.lag()))/(T)N;
+            return common::OK;
+        }
+
+        int test(const T in, T &out) noexcept {
+            const int err = test(in);
+            out = output_value;
+            return err;
+        }
+
+        inline T get() const noexcept {
+            return output_value;
+        }
+
+        inline void clear() noexcept {
+            buffer.clear();
+            output_value = std::numeric_limits<T>::quiet_NaN();
+            last_data = 0;
+        }
+    };
+
 }; // xtechnical
 
 #endif // XTECHNICAL_SMA_HPP_INCLUDED
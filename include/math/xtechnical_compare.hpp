@@ -10,7 +10,7 @@ namespace xtechnical {
      */
     template<class T>
     bool combined_tolerance_compare(const T x, const T y) {
-        double maxXYOne = std::max( { 1.0, std::fabs(x) , std::fabs(y) } ) ;
+        double maxXYOne = std::max( { 1.0, (double)std::fabs(x) , (double)std::fabs(y) } ) ;
         return std::fabs(x - y) <= std::numeric_limits<T>::epsilon() * maxXYOne;
     }
 }
@@ -0,0 +1,1976 @@
+#ifndef XTECHNICAL_SIMD_HPP_INCLUDED
+#define XTECHNICAL_SIMD_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <type_traits>
+
+/* Векторные ядра собираются только для GCC/Clang на x86.
+ * Набор инструкций выбирается во время выполнения, поэтому
+ * библиотеку не нужно собирать с -mavx2 или -mavx512f.
+ * Определите XTECHNICAL_NO_SIMD, чтобы оставить только скалярные ядра.
+ */
+#if !defined(XTECHNICAL_NO_SIMD) && \
+    (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+#define XTECHNICAL_SIMD_X86 1
+#include <immintrin.h>
+#define XTECHNICAL_TARGET_SSE2      __attribute__((target("sse2")))
+#define XTECHNICAL_TARGET_AVX2      __attribute__((target("avx2")))
+#define XTECHNICAL_TARGET_AVX512    __attribute__((target("avx512f")))
+/* AVX-512F содержит FMA, и GCC по умолчанию сливает умножение со сложением.
+ * Ядрам банков индикаторов нужен тот же результат, что и у скалярного кода.
+ */
+#if defined(__clang__)
+#define XTECHNICAL_NO_FP_CONTRACT
+#else
+#define XTECHNICAL_NO_FP_CONTRACT   __attribute__((optimize("fp-contract=off")))
+#endif
+#else
+#define XTECHNICAL_SIMD_X86 0
+#endif
+
+namespace xtechnical {
+    namespace simd {
+
+        /// Набор инструкций, используемый ядрами
+        enum class InstructionSet {
+            SCALAR = 0, ///< Скалярные циклы
+            SSE2 = 1,   ///< 128 бит
+            AVX2 = 2,   ///< 256 бит
+            AVX512 = 3, ///< 512 бит (AVX-512F)
+        };
+
+        /** \brief Признак непрерывного массива float/double
+         *
+         * Для таких контейнеров функции статистики, нормализации и корреляции
+         * передают данные в векторные ядра. Для остальных контейнеров
+         * используются исходные шаблонные циклы.
+         */
+        template<class C>
+        struct contiguous_array {
+            static const bool value = false;
+            typedef double value_type;
+            static inline const value_type *data(const C &) noexcept {return nullptr;}
+            static inline value_type *data(C &) noexcept {return nullptr;}
+        };
+
+        template<class T>
+        struct contiguous_array_base {
+            static const bool value = true;
+            typedef T value_type;
+            template<class C>
+            static inline const value_type *data(const C &c) noexcept {return c.data();}
+            template<class C>
+            static inline value_type *data(C &c) noexcept {return c.data();}
+        };
+
+        template<class A>
+        struct contiguous_array<std::vector<double, A>> : public contiguous_array_base<double> {};
+
+        template<class A>
+        struct contiguous_array<std::vector<float, A>> : public contiguous_array_base<float> {};
+
+        template<size_t N>
+        struct contiguous_array<std::array<double, N>> : public contiguous_array_base<double> {};
+
+        template<size_t N>
+        struct contiguous_array<std::array<float, N>> : public contiguous_array_base<float> {};
+
+        /** \brief Таблица ядер для одного типа данных
+         *
+         * Все накопления выполняются в double независимо от типа данных.
+         */
+        template<class T>
+        class Kernels {
+        public:
+            double (*sum)(const T *x, const size_t n);
+            double (*sum_sq)(const T *x, const size_t n);
+            double (*dot)(const T *x, const T *y, const size_t n);
+            double (*sum_sq_dev)(const T *x, const size_t n, const double mean);
+            void (*central_moments)(const T *x, const size_t n, const double mean, double &m2, double &m3, double &m4);
+            void (*min_max)(const T *x, const size_t n, T &min_value, T &max_value);
+            void (*cross_moments)(const T *x, const T *y, const size_t n, const double xm, const double ym, double &sxy, double &sxx, double &syy);
+            void (*normalize_min_max)(const T *in, T *out, const size_t n, const double min_value, const double ampl, const bool is_signed);
+            void (*normalize_zscore)(const T *in, T *out, const size_t n, const double mean, const double dix, const double t);
+            void (*log)(const T *in, T *out, const size_t n);
+            void (*block_sq_dist)(const T *block, const T *query, const size_t dim, const size_t width, double *out);
+            void (*block_dot)(const T *block, const T *query, const size_t dim, const size_t width, double *out);
+            void (*fractals)(const T *high, const T *low, const size_t n, uint64_t *up, uint64_t *dn);
+            void (*lane_add)(T *acc, const T *x, const size_t n);
+            void (*lane_sma_update)(T *sum, T *ring, const T *in, T *out, const size_t n, const T period);
+            void (*lane_sma_test)(const T *sum, const T *ring, const T *in, T *out, const size_t n, const T period);
+            void (*lane_ema_update)(T *last, const T *in, T *out, const size_t n, const T a);
+            void (*lane_ema_test)(const T *last, const T *in, T *out, const size_t n, const T a);
+            void (*lane_ema_alpha)(T *last, const T *a, const T in, T *out, const size_t n);
+            void (*lane_sq_dev)(T *acc, const T *x, const T *mean, const size_t n);
+            void (*lane_true_range)(const T *high, const T *low, const T *close, T *out, const size_t n);
+            void (*lane_abs_diff)(const T *in, const T *last, T *out, const size_t n);
+            void (*lane_rsi_split)(const T *in, const T *prev, T *u, T *d, const size_t n);
+            void (*lane_rsi)(const T *u, const T *d, T *out, const size_t n);
+        };
+
+        namespace scalar {
+
+            template<class T>
+            double sum(const T *x, const size_t n) {
+                double s = 0;
+                for (size_t i = 0; i < n; ++i) s += x[i];
+                return s;
+            }
+
+            template<class T>
+            double sum_sq(const T *x, const size_t n) {
+                double s = 0;
+                for (size_t i = 0; i < n; ++i) s += (double)x[i] * (double)x[i];
+                return s;
+            }
+
+            template<class T>
+            double dot(const T *x, const T *y, const size_t n) {
+                double s = 0;
+                for (size_t i = 0; i < n; ++i) s += (double)x[i] * (double)y[i];
+                return s;
+            }
+
+            template<class T>
+            double sum_sq_dev(const T *x, const size_t n, const double mean) {
+                double s = 0;
+                for (size_t i = 0; i < n; ++i) {
+                    const double d = x[i] - mean;
+                    s += d * d;
+                }
+                return s;
+            }
+
+            template<class T>
+            void central_moments(const T *x, const size_t n, const double mean, double &m2, double &m3, double &m4) {
+                double s2 = 0, s3 = 0, s4 = 0;
+                for (size_t i = 0; i < n; ++i) {
+                    const double d = x[i] - mean;
+                    const double d2 = d * d;
+                    s2 += d2;
+                    s3 += d2 * d;
+                    s4 += d2 * d2;
+                }
+                m2 = s2;
+                m3 = s3;
+                m4 = s4;
+            }
+
+            template<class T>
+            void min_max(const T *x, const size_t n, T &min_value, T &max_value) {
+                if (n == 0) return;
+                T mn = x[0], mx = x[0];
+                for (size_t i = 1; i < n; ++i) {
+                    mn = std::min(mn, x[i]);
+                    mx = std::max(mx, x[i]);
+                }
+                min_value = mn;
+                max_value = mx;
+            }
+
+            template<class T>
+            void cross_moments(const T *x, const T *y, const size_t n, const double xm, const double ym, double &sxy, double &sxx, double &syy) {
+                double s = 0, sx = 0, sy = 0;
+                for (size_t i = 0; i < n; ++i) {
+                    const double dx = x[i] - xm;
+                    const double dy = y[i] - ym;
+                    s += dx * dy;
+                    sx += dx * dx;
+                    sy += dy * dy;
+                }
+                sxy = s;
+                sxx = sx;
+                syy = sy;
+            }
+
+            template<class T>
+            void normalize_min_max(const T *in, T *out, const size_t n, const double min_value, const double ampl, const bool is_signed) {
+                if (is_signed) {
+                    for (size_t i = 0; i < n; ++i) out[i] = 2.0 * ((in[i] - min_value) / ampl) - 1.0;
+                } else {
+                    for (size_t i = 0; i < n; ++i) out[i] = (in[i] - min_value) / ampl;
+                }
+            }
+
+            template<class T>
+            void normalize_zscore(const T *in, T *out, const size_t n, const double mean, const double dix, const double t) {
+                for (size_t i = 0; i < n; ++i) {
+                    double v = dix != 0 ? (in[i] - mean) / dix : 0.0;
+                    if (v > t) v = t;
+                    if (v < -t) v = -t;
+                    out[i] = v;
+                }
+            }
+
+            template<class T>
+            void log(const T *in, T *out, const size_t n) {
+                for (size_t i = 0; i < n; ++i) out[i] = std::log(in[i]);
+            }
+
+            template<class T>
+            void block_sq_dist_tail(const T *block, const T *query, const size_t dim, const size_t width, const size_t stride, double *out) {
+                for (size_t i = 0; i < width; ++i) {
+                    double s = 0;
+                    for (size_t d = 0; d < dim; ++d) {
+                        const double diff = block[d * stride + i] - (double)query[d];
+                        s += diff * diff;
+                    }
+                    out[i] = s;
+                }
+            }
+
+            template<class T>
+            void block_dot_tail(const T *block, const T *query, const size_t dim, const size_t width, const size_t stride, double *out) {
+                for (size_t i = 0; i < width; ++i) {
+                    double s = 0;
+                    for (size_t d = 0; d < dim; ++d) {
+                        s += (double)block[d * stride + i] * (double)query[d];
+                    }
+                    out[i] = s;
+                }
+            }
+
+            template<class T>
+            void block_sq_dist(const T *block, const T *query, const size_t dim, const size_t width, double *out) {
+                block_sq_dist_tail(block, query, dim, width, width, out);
+            }
+
+            template<class T>
+            void block_dot(const T *block, const T *query, const size_t dim, const size_t width, double *out) {
+                block_dot_tail(block, query, dim, width, width, out);
+            }
+
+            /** \brief Проверить верхний фрактал Билла Вильямса на 9 барах
+             * \param v   Значения от самого старого v[0] до самого нового v[8], вершина в v[6]
+             */
+            template<class T>
+            inline bool is_fractal_up(const T *v) noexcept {
+                const T c = v[6];
+                if (!(c > v[7] && c > v[8])) return false;
+                return
+                    (c > v[4] && c > v[5]) ||
+                    (c > v[3] && c > v[4] && c == v[5]) ||
+                    (c > v[2] && c > v[3] && c == v[4] && c >= v[5]) ||
+                    (c > v[1] && c > v[2] && c == v[3] && c == v[4] && c >= v[5]) ||
+                    (c > v[0] && c > v[1] && c == v[2] && c >= v[3] && c == v[4] && c >= v[5]);
+            }
+
+            /** \brief Проверить нижний фрактал Билла Вильямса на 9 барах
+             * \param v   Значения от самого старого v[0] до самого нового v[8], вершина в v[6]
+             */
+            template<class T>
+            inline bool is_fractal_dn(const T *v) noexcept {
+                const T c = v[6];
+                if (!(c < v[7] && c < v[8])) return false;
+                return
+                    (c < v[4] && c < v[5]) ||
+                    (c < v[3] && c < v[4] && c == v[5]) ||
+                    (c < v[2] && c < v[3] && c == v[4] && c <= v[5]) ||
+                    (c < v[1] && c < v[2] && c == v[3] && c == v[4] && c <= v[5]) ||
+                    (c < v[0] && c < v[1] && c == v[2] && c <= v[3] && c == v[4] && c <= v[5]);
+            }
+
+            /** \brief Записать маску из width бит в битовый массив с позиции pos
+             */
+            inline void set_bits(uint64_t *bits, const size_t pos, const uint64_t mask, const size_t width) noexcept {
+                if (mask == 0) return;
+                const size_t shift = pos & 63;
+                bits[pos >> 6] |= mask << shift;
+                if (shift + width > 64) bits[(pos >> 6) + 1] |= mask >> (64 - shift);
+            }
+
+            template<class T>
+            void fractals_tail(const T *high, const T *low, const size_t start, const size_t n, uint64_t *up, uint64_t *dn) {
+                for (size_t j = start; j < n; ++j) {
+                    if (is_fractal_up(high + j - 8)) up[j >> 6] |= (uint64_t)1 << (j & 63);
+                    if (is_fractal_dn(low + j - 8)) dn[j >> 6] |= (uint64_t)1 << (j & 63);
+                }
+            }
+
+            template<class T>
+            void fractals(const T *high, const T *low, const size_t n, uint64_t *up, uint64_t *dn) {
+                std::fill(up, up + (n + 63) / 64, 0);
+                std::fill(dn, dn + (n + 63) / 64, 0);
+                fractals_tail(high, low, 8, n, up, dn);
+            }
+
+            /* Ядра банков индикаторов. Каждый элемент массива - отдельный символ,
+             * операции выполняются в типе T в том же порядке, что и в индикаторах,
+             * поэтому результат совпадает с отдельными экземплярами побитно.
+             */
+
+            template<class T>
+            void lane_add(T *acc, const T *x, const size_t n) {
+                for (size_t i = 0; i < n; ++i) acc[i] = acc[i] + x[i];
+            }
+
+            template<class T>
+            void lane_sma_update(T *sum, T *ring, const T *in, T *out, const size_t n, const T period) {
+                for (size_t i = 0; i < n; ++i) {
+                    const T old = ring[i];
+                    ring[i] = in[i];
+                    sum[i] = sum[i] + (in[i] - old);
+                    out[i] = sum[i] / period;
+                }
+            }
+
+            template<class T>
+            void lane_sma_test(const T *sum, const T *ring, const T *in, T *out, const size_t n, const T period) {
+                for (size_t i = 0; i < n; ++i) {
+                    out[i] = (sum[i] + (in[i] - ring[i])) / period;
+                }
+            }
+
+            template<class T>
+            void lane_ema_update(T *last, const T *in, T *out, const size_t n, const T a) {
+                for (size_t i = 0; i < n; ++i) {
+                    last[i] = a * in[i] + (1.0 - a) * last[i];
+                    out[i] = last[i];
+                }
+            }
+
+            template<class T>
+            void lane_ema_test(const T *last, const T *in, T *out, const size_t n, const T a) {
+                for (size_t i = 0; i < n; ++i) {
+                    out[i] = a * in[i] + (1.0 - a) * last[i];
+                }
+            }
+
+            template<class T>
+            void lane_ema_alpha(T *last, const T *a, const T in, T *out, const size_t n) {
+                for (size_t i = 0; i < n; ++i) {
+                    last[i] = a[i] * in + (1.0 - a[i]) * last[i];
+                    out[i] = last[i];
+                }
+            }
+
+            template<class T>
+            void lane_sq_dev(T *acc, const T *x, const T *mean, const size_t n) {
+                for (size_t i = 0; i < n; ++i) {
+                    const T diff = x[i] - mean[i];
+                    acc[i] += diff * diff;
+                }
+            }
+
+            template<class T>
+            void lane_true_range(const T *high, const T *low, const T *close, T *out, const size_t n) {
+                for (size_t i = 0; i < n; ++i) {
+                    out[i] = std::max(std::max(high[i] - low[i], high[i] - close[i]), close[i] - low[i]);
+                }
+            }
+
+            template<class T>
+            void lane_abs_diff(const T *in, const T *last, T *out, const size_t n) {
+                for (size_t i = 0; i < n; ++i) out[i] = std::abs(in[i] - last[i]);
+            }
+
+            template<class T>
+            void lane_rsi_split(const T *in, const T *prev, T *u, T *d, const size_t n) {
+                for (size_t i = 0; i < n; ++i) {
+                    u[i] = prev[i] < in[i] ? in[i] - prev[i] : 0;
+                    d[i] = prev[i] > in[i] ? prev[i] - in[i] : 0;
+                }
+            }
+
+            template<class T>
+            void lane_rsi(const T *u, const T *d, T *out, const size_t n) {
+                for (size_t i = 0; i < n; ++i) {
+                    if (d[i] == 0) {
+                        out[i] = 100.0;
+                    } else {
+                        const T rs = u[i] / d[i];
+                        out[i] = 100.0 - (100.0 / (1.0 + rs));
+                    }
+                }
+            }
+        }; // scalar
+
+#if XTECHNICAL_SIMD_X86
+        namespace sse2 {
+
+            XTECHNICAL_TARGET_SSE2 inline __m128d load(const double *p) {
+                return _mm_loadu_pd(p);
+            }
+
+            XTECHNICAL_TARGET_SSE2 inline __m128d load(const float *p) {
+                return _mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64((const __m128i*)p)));
+            }
+
+            XTECHNICAL_TARGET_SSE2 inline void store(double *p, const __m128d v) {
+                _mm_storeu_pd(p, v);
+            }
+
+            XTECHNICAL_TARGET_SSE2 inline void store(float *p, const __m128d v) {
+                _mm_storel_epi64((__m128i*)p, _mm_castps_si128(_mm_cvtpd_ps(v)));
+            }
+
+            XTECHNICAL_TARGET_SSE2 inline double hsum(const __m128d v) {
+                return _mm_cvtsd_f64(_mm_add_sd(v, _mm_unpackhi_pd(v, v)));
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_SSE2 double sum(const T *x, const size_t n) {
+                __m128d a0 = _mm_setzero_pd(), a1 = _mm_setzero_pd();
+                size_t i = 0;
+                for (; i + 4 <= n; i += 4) {
+                    a0 = _mm_add_pd(a0, load(x + i));
+                    a1 = _mm_add_pd(a1, load(x + i + 2));
+                }
+                double s = hsum(_mm_add_pd(a0, a1));
+                for (; i < n; ++i) s += x[i];
+                return s;
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_SSE2 double sum_sq(const T *x, const size_t n) {
+                __m128d a0 = _mm_setzero_pd(), a1 = _mm_setzero_pd();
+                size_t i = 0;
+                for (; i + 4 <= n; i += 4) {
+                    const __m128d v0 = load(x + i);
+                    const __m128d v1 = load(x + i + 2);
+                    a0 = _mm_add_pd(a0, _mm_mul_pd(v0, v0));
+                    a1 = _mm_add_pd(a1, _mm_mul_pd(v1, v1));
+                }
+                double s = hsum(_mm_add_pd(a0, a1));
+                for (; i < n; ++i) s += (double)x[i] * (double)x[i];
+                return s;
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_SSE2 double dot(const T *x, const T *y, const size_t n) {
+                __m128d a0 = _mm_setzero_pd(), a1 = _mm_setzero_pd();
+                size_t i = 0;
+                for (; i + 4 <= n; i += 4) {
+                    a0 = _mm_add_pd(a0, _mm_mul_pd(load(x + i), load(y + i)));
+                    a1 = _mm_add_pd(a1, _mm_mul_pd(load(x + i + 2), load(y + i + 2)));
+                }
+                double s = hsum(_mm_add_pd(a0, a1));
+                for (; i < n; ++i) s += (double)x[i] * (double)y[i];
+                return s;
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_SSE2 double sum_sq_dev(const T *x, const size_t n, const double mean) {
+                const __m128d m = _mm_set1_pd(mean);
+                __m128d a0 = _mm_setzero_pd(), a1 = _mm_setzero_pd();
+                size_t i = 0;
+                for (; i + 4 <= n; i += 4) {
+                    const __m128d d0 = _mm_sub_pd(load(x + i), m);
+                    const __m128d d1 = _mm_sub_pd(load(x + i + 2), m);
+                    a0 = _mm_add_pd(a0, _mm_mul_pd(d0, d0));
+                    a1 = _mm_add_pd(a1, _mm_mul_pd(d1, d1));
+                }
+                double s = hsum(_mm_add_pd(a0, a1));
+                for (; i < n; ++i) {
+                    const double d = x[i] - mean;
+                    s += d * d;
+                }
+                return s;
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_SSE2 void central_moments(const T *x, const size_t n, const double mean, double &m2, double &m3, double &m4) {
+                const __m128d m = _mm_set1_pd(mean);
+                __m128d a2 = _mm_setzero_pd(), a3 = _mm_setzero_pd(), a4 = _mm_setzero_pd();
+                size_t i = 0;
+                for (; i + 2 <= n; i += 2) {
+                    const __m128d d = _mm_sub_pd(load(x + i), m);
+                    const __m128d d2 = _mm_mul_pd(d, d);
+                    a2 = _mm_add_pd(a2, d2);
+                    a3 = _mm_add_pd(a3, _mm_mul_pd(d2, d));
+                    a4 = _mm_add_pd(a4, _mm_mul_pd(d2, d2));
+                }
+                double s2 = hsum(a2), s3 = hsum(a3), s4 = hsum(a4);
+                for (; i < n; ++i) {
+                    const double d = x[i] - mean;
+                    const double d2 = d * d;
+                    s2 += d2;
+                    s3 += d2 * d;
+                    s4 += d2 * d2;
+                }
+                m2 = s2;
+                m3 = s3;
+                m4 = s4;
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_SSE2 void min_max(const T *x, const size_t n, T &min_value, T &max_value) {
+                if (n < 2) {
+                    scalar::min_max(x, n, min_value, max_value);
+                    return;
+                }
+                __m128d mn = load(x), mx = mn;
+                size_t i = 2;
+                for (; i + 2 <= n; i += 2) {
+                    const __m128d v = load(x + i);
+                    mn = _mm_min_pd(mn, v);
+                    mx = _mm_max_pd(mx, v);
+                }
+                double tmn[2], tmx[2];
+                _mm_storeu_pd(tmn, mn);
+                _mm_storeu_pd(tmx, mx);
+                double rmn = std::min(tmn[0], tmn[1]);
+                double rmx = std::max(tmx[0], tmx[1]);
+                for (; i < n; ++i) {
+                    rmn = std::min(rmn, (double)x[i]);
+                    rmx = std::max(rmx, (double)x[i]);
+                }
+                min_value = (T)rmn;
+                max_value = (T)rmx;
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_SSE2 void cross_moments(const T *x, const T *y, const size_t n, const double xm, const double ym, double &sxy, double &sxx, double &syy) {
+                const __m128d vxm = _mm_set1_pd(xm);
+                const __m128d vym = _mm_set1_pd(ym);
+                __m128d axy = _mm_setzero_pd(), axx = _mm_setzero_pd(), ayy = _mm_setzero_pd();
+                size_t i = 0;
+                for (; i + 2 <= n; i += 2) {
+                    const __m128d dx = _mm_sub_pd(load(x + i), vxm);
+                    const __m128d dy = _mm_sub_pd(load(y + i), vym);
+                    axy = _mm_add_pd(axy, _mm_mul_pd(dx, dy));
+                    axx = _mm_add_pd(axx, _mm_mul_pd(dx, dx));
+                    ayy = _mm_add_pd(ayy, _mm_mul_pd(dy, dy));
+                }
+                double s = hsum(axy), sx = hsum(axx), sy = hsum(ayy);
+                for (; i < n; ++i) {
+                    const double dx = x[i] - xm;
+                    const double dy = y[i] - ym;
+                    s += dx * dy;
+                    sx += dx * dx;
+                    sy += dy * dy;
+                }
+                sxy = s;
+                sxx = sx;
+                syy = sy;
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_SSE2 void normalize_min_max(const T *in, T *out, const size_t n, const double min_value, const double ampl, const bool is_signed) {
+                const __m128d vmin = _mm_set1_pd(min_value);
+                const __m128d vampl = _mm_set1_pd(ampl);
+                const __m128d k = _mm_set1_pd(is_signed ? 2.0 : 1.0);
+                const __m128d c = _mm_set1_pd(is_signed ? 1.0 : 0.0);
+                size_t i = 0;
+                for (; i + 2 <= n; i += 2) {
+                    const __m128d v = _mm_div_pd(_mm_sub_pd(load(in + i), vmin), vampl);
+                    store(out + i, _mm_sub_pd(_mm_mul_pd(k, v), c));
+                }
+                scalar::normalize_min_max(in + i, out + i, n - i, min_value, ampl, is_signed);
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_SSE2 void normalize_zscore(const T *in, T *out, const size_t n, const double mean, const double dix, const double t) {
+                if (dix == 0) {
+                    std::fill(out, out + n, T(0));
+                    return;
+                }
+                const __m128d vm = _mm_set1_pd(mean);
+                const __m128d vd = _mm_set1_pd(dix);
+                const __m128d vt = _mm_set1_pd(t);
+                const __m128d vnt = _mm_set1_pd(-t);
+                size_t i = 0;
+                for (; i + 2 <= n; i += 2) {
+                    const __m128d v = _mm_div_pd(_mm_sub_pd(load(in + i), vm), vd);
+                    store(out + i, _mm_max_pd(_mm_min_pd(v, vt), vnt));
+                }
+                scalar::normalize_zscore(in + i, out + i, n - i, mean, dix, t);
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_SSE2 void block_sq_dist(const T *block, const T *query, const size_t dim, const size_t width, double *out) {
+                size_t i = 0;
+                for (; i + 8 <= width; i += 8) {
+                    __m128d a0 = _mm_setzero_pd(), a1 = _mm_setzero_pd(), a2 = _mm_setzero_pd(), a3 = _mm_setzero_pd();
+                    for (size_t d = 0; d < dim; ++d) {
+                        const __m128d q = _mm_set1_pd(query[d]);
+                        const T *column = block + d * width + i;
+                        const __m128d d0 = _mm_sub_pd(load(column), q);
+                        const __m128d d1 = _mm_sub_pd(load(column + 2), q);
+                        const __m128d d2 = _mm_sub_pd(load(column + 4), q);
+                        const __m128d d3 = _mm_sub_pd(load(column + 6), q);
+                        a0 = _mm_add_pd(a0, _mm_mul_pd(d0, d0));
+                        a1 = _mm_add_pd(a1, _mm_mul_pd(d1, d1));
+                        a2 = _mm_add_pd(a2, _mm_mul_pd(d2, d2));
+                        a3 = _mm_add_pd(a3, _mm_mul_pd(d3, d3));
+                    }
+                    store(out + i, a0);
+                    store(out + i + 2, a1);
+                    store(out + i + 4, a2);
+                    store(out + i + 6, a3);
+                }
+                if (i < width) scalar::block_sq_dist_tail(block + i, query, dim, width - i, width, out + i);
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_SSE2 void block_dot(const T *block, const T *query, const size_t dim, const size_t width, double *out) {
+                size_t i = 0;
+                for (; i + 8 <= width; i += 8) {
+                    __m128d a0 = _mm_setzero_pd(), a1 = _mm_setzero_pd(), a2 = _mm_setzero_pd(), a3 = _mm_setzero_pd();
+                    for (size_t d = 0; d < dim; ++d) {
+                        const __m128d q = _mm_set1_pd(query[d]);
+                        const T *column = block + d * width + i;
+                        a0 = _mm_add_pd(a0, _mm_mul_pd(load(column), q));
+                        a1 = _mm_add_pd(a1, _mm_mul_pd(load(column + 2), q));
+                        a2 = _mm_add_pd(a2, _mm_mul_pd(load(column + 4), q));
+                        a3 = _mm_add_pd(a3, _mm_mul_pd(load(column + 6), q));
+                    }
+                    store(out + i, a0);
+                    store(out + i + 2, a1);
+                    store(out + i + 4, a2);
+                    store(out + i + 6, a3);
+                }
+                if (i < width) scalar::block_dot_tail(block + i, query, dim, width - i, width, out + i);
+            }
+
+            /** \brief Маска фрактала для двух соседних позиций, v - окно первой позиции
+             */
+            template<bool IS_UP, class T>
+            XTECHNICAL_TARGET_SSE2 inline int fractal_mask(const T *v) {
+                const __m128d c = load(v + 6);
+                __m128d g[6], ge[6], e[6];
+                const __m128d g7 = IS_UP ? _mm_cmpgt_pd(c, load(v + 7)) : _mm_cmplt_pd(c, load(v + 7));
+                const __m128d g8 = IS_UP ? _mm_cmpgt_pd(c, load(v + 8)) : _mm_cmplt_pd(c, load(v + 8));
+                const __m128d right = _mm_and_pd(g7, g8);
+                // вершина должна быть выше двух следующих баров, обычно это отсекает все позиции
+                if (_mm_movemask_pd(right) == 0) return 0;
+                for (size_t k = 0; k < 6; ++k) {
+                    const __m128d x = load(v + k);
+                    g[k] = IS_UP ? _mm_cmpgt_pd(c, x) : _mm_cmplt_pd(c, x);
+                    ge[k] = IS_UP ? _mm_cmpge_pd(c, x) : _mm_cmple_pd(c, x);
+                    e[k] = _mm_cmpeq_pd(c, x);
+                }
+                const __m128d p5 = _mm_and_pd(g[4], g[5]);
+                const __m128d p6 = _mm_and_pd(_mm_and_pd(g[3], g[4]), e[5]);
+                const __m128d p7 = _mm_and_pd(_mm_and_pd(g[2], g[3]), _mm_and_pd(e[4], ge[5]));
+                const __m128d p8 = _mm_and_pd(_mm_and_pd(_mm_and_pd(g[1], g[2]), _mm_and_pd(e[3], e[4])), ge[5]);
+                const __m128d p9 = _mm_and_pd(_mm_and_pd(_mm_and_pd(g[0], g[1]), _mm_and_pd(e[2], ge[3])), _mm_and_pd(e[4], ge[5]));
+                const __m128d any = _mm_or_pd(_mm_or_pd(_mm_or_pd(p5, p6), _mm_or_pd(p7, p8)), p9);
+                return _mm_movemask_pd(_mm_and_pd(right, any));
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_SSE2 void fractals(const T *high, const T *low, const size_t n, uint64_t *up, uint64_t *dn) {
+                std::fill(up, up + (n + 63) / 64, 0);
+                std::fill(dn, dn + (n + 63) / 64, 0);
+                size_t j = 8;
+                for (; j + 2 <= n; j += 2) {
+                    scalar::set_bits(up, j, (uint64_t)fractal_mask<true>(high + j - 8), 2);
+                    scalar::set_bits(dn, j, (uint64_t)fractal_mask<false>(low + j - 8), 2);
+                }
+                scalar::fractals_tail(high, low, j, n, up, dn);
+            }
+
+            /* fit округляет промежуточный результат до точности T,
+             * чтобы float давал тот же результат, что и скалярный код
+             */
+            XTECHNICAL_TARGET_SSE2 inline __m128d fit(const double *, const __m128d v) {
+                return v;
+            }
+
+            XTECHNICAL_TARGET_SSE2 inline __m128d fit(const float *, const __m128d v) {
+                return _mm_cvtps_pd(_mm_cvtpd_ps(v));
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_SSE2 XTECHNICAL_NO_FP_CONTRACT void lane_add(T *acc, const T *x, const size_t n) {
+                size_t i = 0;
+                for (; i + 2 <= n; i += 2) store(acc + i, _mm_add_pd(load(acc + i), load(x + i)));
+                scalar::lane_add(acc + i, x + i, n - i);
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_SSE2 XTECHNICAL_NO_FP_CONTRACT void lane_sma_update(T *sum, T *ring, const T *in, T *out, const size_t n, const T period) {
+                const __m128d p = _mm_set1_pd((double)period);
+                size_t i = 0;
+                for (; i + 2 <= n; i += 2) {
+                    const __m128d v = load(in + i);
+                    const __m128d s = fit(in, _mm_add_pd(load(sum + i), fit(in, _mm_sub_pd(v, load(ring + i)))));
+                    store(ring + i, v);
+                    store(sum + i, s);
+                    store(out + i, _mm_div_pd(s, p));
+                }
+                scalar::lane_sma_update(sum + i, ring + i, in + i, out + i, n - i, period);
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_SSE2 XTECHNICAL_NO_FP_CONTRACT void lane_sma_test(const T *sum, const T *ring, const T *in, T *out, const size_t n, const T period) {
+                const __m128d p = _mm_set1_pd((double)period);
+                size_t i = 0;
+                for (; i + 2 <= n; i += 2) {
+                    const __m128d s = fit(in, _mm_add_pd(load(sum + i), fit(in, _mm_sub_pd(load(in + i), load(ring + i)))));
+                    store(out + i, _mm_div_pd(s, p));
+                }
+                scalar::lane_sma_test(sum + i, ring + i, in + i, out + i, n - i, period);
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_SSE2 XTECHNICAL_NO_FP_CONTRACT void lane_ema_update(T *last, const T *in, T *out, const size_t n, const T a) {
+                const __m128d va = _mm_set1_pd((double)a);
+                const __m128d vb = _mm_set1_pd(1.0 - a);
+                size_t i = 0;
+                for (; i + 2 <= n; i += 2) {
+                    const __m128d v = fit(in, _mm_add_pd(fit(in, _mm_mul_pd(va, load(in + i))), _mm_mul_pd(vb, load(last + i))));
+                    store(last + i, v);
+                    store(out + i, v);
+                }
+                scalar::lane_ema_update(last + i, in + i, out + i, n - i, a);
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_SSE2 XTECHNICAL_NO_FP_CONTRACT void lane_ema_test(const T *last, const T *in, T *out, const size_t n, const T a) {
+                const __m128d va = _mm_set1_pd((double)a);
+                const __m128d vb = _mm_set1_pd(1.0 - a);
+                size_t i = 0;
+                for (; i + 2 <= n; i += 2) {
+                    store(out + i, _mm_add_pd(fit(in, _mm_mul_pd(va, load(in + i))), _mm_mul_pd(vb, load(last + i))));
+                }
+                scalar::lane_ema_test(last + i, in + i, out + i, n - i, a);
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_SSE2 XTECHNICAL_NO_FP_CONTRACT void lane_ema_alpha(T *last, const T *a, const T in, T *out, const size_t n) {
+                const __m128d one = _mm_set1_pd(1.0);
+                const __m128d vin = _mm_set1_pd((double)in);
+                size_t i = 0;
+                for (; i + 2 <= n; i += 2) {
+                    const __m128d va = load(a + i);
+                    const __m128d v = _mm_add_pd(fit(a, _mm_mul_pd(va, vin)), _mm_mul_pd(_mm_sub_pd(one, va), load(last + i)));
+                    store(last + i, v);
+                    store(out + i, v);
+                }
+                scalar::lane_ema_alpha(last + i, a + i, in, out + i, n - i);
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_SSE2 XTECHNICAL_NO_FP_CONTRACT void lane_sq_dev(T *acc, const T *x, const T *mean, const size_t n) {
+                size_t i = 0;
+                for (; i + 2 <= n; i += 2) {
+                    const __m128d d = fit(x, _mm_sub_pd(load(x + i), load(mean + i)));
+                    store(acc + i, _mm_add_pd(load(acc + i), fit(x, _mm_mul_pd(d, d))));
+                }
+                scalar::lane_sq_dev(acc + i, x + i, mean + i, n - i);
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_SSE2 XTECHNICAL_NO_FP_CONTRACT void lane_true_range(const T *high, const T *low, const T *close, T *out, const size_t n) {
+                size_t i = 0;
+                for (; i + 2 <= n; i += 2) {
+                    const __m128d h = load(high + i), l = load(low + i), c = load(close + i);
+                    const __m128d hl = fit(high, _mm_sub_pd(h, l));
+                    const __m128d hc = fit(high, _mm_sub_pd(h, c));
+                    const __m128d cl = fit(high, _mm_sub_pd(c, l));
+                    // std::max(a, b) возвращает a при равенстве, как и _mm_max_pd(b, a)
+                    store(out + i, _mm_max_pd(cl, _mm_max_pd(hc, hl)));
+                }
+                scalar::lane_true_range(high + i, low + i, close + i, out + i, n - i);
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_SSE2 XTECHNICAL_NO_FP_CONTRACT void lane_abs_diff(const T *in, const T *last, T *out, const size_t n) {
+                const __m128d sign = _mm_set1_pd(-0.0);
+                size_t i = 0;
+                for (; i + 2 <= n; i += 2) {
+                    store(out + i, _mm_andnot_pd(sign, _mm_sub_pd(load(in + i), load(last + i))));
+                }
+                scalar::lane_abs_diff(in + i, last + i, out + i, n - i);
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_SSE2 XTECHNICAL_NO_FP_CONTRACT void lane_rsi_split(const T *in, const T *prev, T *u, T *d, const size_t n) {
+                size_t i = 0;
+                for (; i + 2 <= n; i += 2) {
+                    const __m128d v = load(in + i), p = load(prev + i);
+                    store(u + i, _mm_and_pd(_mm_cmplt_pd(p, v), _mm_sub_pd(v, p)));
+                    store(d + i, _mm_and_pd(_mm_cmpgt_pd(p, v), _mm_sub_pd(p, v)));
+                }
+                scalar::lane_rsi_split(in + i, prev + i, u + i, d + i, n - i);
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_SSE2 XTECHNICAL_NO_FP_CONTRACT void lane_rsi(const T *u, const T *d, T *out, const size_t n) {
+                const __m128d one = _mm_set1_pd(1.0), hundred = _mm_set1_pd(100.0);
+                size_t i = 0;
+                for (; i + 2 <= n; i += 2) {
+                    const __m128d vd = load(d + i);
+                    const __m128d rs = fit(u, _mm_div_pd(load(u + i), vd));
+                    const __m128d r = _mm_sub_pd(hundred, _mm_div_pd(hundred, _mm_add_pd(one, rs)));
+                    const __m128d zero = _mm_cmpeq_pd(vd, _mm_setzero_pd());
+                    store(out + i, _mm_or_pd(_mm_and_pd(zero, hundred), _mm_andnot_pd(zero, r)));
+                }
+                scalar::lane_rsi(u + i, d + i, out + i, n - i);
+            }
+        }; // sse2
+
+        namespace avx2 {
+
+            XTECHNICAL_TARGET_AVX2 inline __m256d load(const double *p) {
+                return _mm256_loadu_pd(p);
+            }
+
+            XTECHNICAL_TARGET_AVX2 inline __m256d load(const float *p) {
+                return _mm256_cvtps_pd(_mm_loadu_ps(p));
+            }
+
+            XTECHNICAL_TARGET_AVX2 inline void store(double *p, const __m256d v) {
+                _mm256_storeu_pd(p, v);
+            }
+
+            XTECHNICAL_TARGET_AVX2 inline void store(float *p, const __m256d v) {
+                _mm_storeu_ps(p, _mm256_cvtpd_ps(v));
+            }
+
+            XTECHNICAL_TARGET_AVX2 inline double hsum(const __m256d v) {
+                const __m128d s = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+                return _mm_cvtsd_f64(_mm_add_sd(s, _mm_unpackhi_pd(s, s)));
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_AVX2 double sum(const T *x, const size_t n) {
+                __m256d a0 = _mm256_setzero_pd(), a1 = _mm256_setzero_pd();
+                size_t i = 0;
+                for (; i + 8 <= n; i += 8) {
+                    a0 = _mm256_add_pd(a0, load(x + i));
+                    a1 = _mm256_add_pd(a1, load(x + i + 4));
+                }
+                double s = hsum(_mm256_add_pd(a0, a1));
+                for (; i < n; ++i) s += x[i];
+                return s;
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_AVX2 double sum_sq(const T *x, const size_t n) {
+                __m256d a0 = _mm256_setzero_pd(), a1 = _mm256_setzero_pd();
+                size_t i = 0;
+                for (; i + 8 <= n; i += 8) {
+                    const __m256d v0 = load(x + i);
+                    const __m256d v1 = load(x + i + 4);
+                    a0 = _mm256_add_pd(a0, _mm256_mul_pd(v0, v0));
+                    a1 = _mm256_add_pd(a1, _mm256_mul_pd(v1, v1));
+                }
+                double s = hsum(_mm256_add_pd(a0, a1));
+                for (; i < n; ++i) s += (double)x[i] * (double)x[i];
+                return s;
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_AVX2 double dot(const T *x, const T *y, const size_t n) {
+                __m256d a0 = _mm256_setzero_pd(), a1 = _mm256_setzero_pd();
+                size_t i = 0;
+                for (; i + 8 <= n; i += 8) {
+                    a0 = _mm256_add_pd(a0, _mm256_mul_pd(load(x + i), load(y + i)));
+                    a1 = _mm256_add_pd(a1, _mm256_mul_pd(load(x + i + 4), load(y + i + 4)));
+                }
+                double s = hsum(_mm256_add_pd(a0, a1));
+                for (; i < n; ++i) s += (double)x[i] * (double)y[i];
+                return s;
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_AVX2 double sum_sq_dev(const T *x, const size_t n, const double mean) {
+                const __m256d m = _mm256_set1_pd(mean);
+                __m256d a0 = _mm256_setzero_pd(), a1 = _mm256_setzero_pd();
+                size_t i = 0;
+                for (; i + 8 <= n; i += 8) {
+                    const __m256d d0 = _mm256_sub_pd(load(x + i), m);
+                    const __m256d d1 = _mm256_sub_pd(load(x + i + 4), m);
+                    a0 = _mm256_add_pd(a0, _mm256_mul_pd(d0, d0));
+                    a1 = _mm256_add_pd(a1, _mm256_mul_pd(d1, d1));
+                }
+                double s = hsum(_mm256_add_pd(a0, a1));
+                for (; i < n; ++i) {
+                    const double d = x[i] - mean;
+                    s += d * d;
+                }
+                return s;
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_AVX2 void central_moments(const T *x, const size_t n, const double mean, double &m2, double &m3, double &m4) {
+                const __m256d m = _mm256_set1_pd(mean);
+                __m256d a2 = _mm256_setzero_pd(), a3 = _mm256_setzero_pd(), a4 = _mm256_setzero_pd();
+                size_t i = 0;
+                for (; i + 4 <= n; i += 4) {
+                    const __m256d d = _mm256_sub_pd(load(x + i), m);
+                    const __m256d d2 = _mm256_mul_pd(d, d);
+                    a2 = _mm256_add_pd(a2, d2);
+                    a3 = _mm256_add_pd(a3, _mm256_mul_pd(d2, d));
+                    a4 = _mm256_add_pd(a4, _mm256_mul_pd(d2, d2));
+                }
+                double s2 = hsum(a2), s3 = hsum(a3), s4 = hsum(a4);
+                for (; i < n; ++i) {
+                    const double d = x[i] - mean;
+                    const double d2 = d * d;
+                    s2 += d2;
+                    s3 += d2 * d;
+                    s4 += d2 * d2;
+                }
+                m2 = s2;
+                m3 = s3;
+                m4 = s4;
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_AVX2 void min_max(const T *x, const size_t n, T &min_value, T &max_value) {
+                if (n < 4) {
+                    scalar::min_max(x, n, min_value, max_value);
+                    return;
+                }
+                __m256d mn = load(x), mx = mn;
+                size_t i = 4;
+                for (; i + 4 <= n; i += 4) {
+                    const __m256d v = load(x + i);
+                    mn = _mm256_min_pd(mn, v);
+                    mx = _mm256_max_pd(mx, v);
+                }
+                double tmn[4], tmx[4];
+                _mm256_storeu_pd(tmn, mn);
+                _mm256_storeu_pd(tmx, mx);
+                double rmn = std::min(std::min(tmn[0], tmn[1]), std::min(tmn[2], tmn[3]));
+                double rmx = std::max(std::max(tmx[0], tmx[1]), std::max(tmx[2], tmx[3]));
+                for (; i < n; ++i) {
+                    rmn = std::min(rmn, (double)x[i]);
+                    rmx = std::max(rmx, (double)x[i]);
+                }
+                min_value = (T)rmn;
+                max_value = (T)rmx;
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_AVX2 void cross_moments(const T *x, const T *y, const size_t n, const double xm, const double ym, double &sxy, double &sxx, double &syy) {
+                const __m256d vxm = _mm256_set1_pd(xm);
+                const __m256d vym = _mm256_set1_pd(ym);
+                __m256d axy = _mm256_setzero_pd(), axx = _mm256_setzero_pd(), ayy = _mm256_setzero_pd();
+                size_t i = 0;
+                for (; i + 4 <= n; i += 4) {
+                    const __m256d dx = _mm256_sub_pd(load(x + i), vxm);
+                    const __m256d dy = _mm256_sub_pd(load(y + i), vym);
+                    axy = _mm256_add_pd(axy, _mm256_mul_pd(dx, dy));
+                    axx = _mm256_add_pd(axx, _mm256_mul_pd(dx, dx));
+                    ayy = _mm256_add_pd(ayy, _mm256_mul_pd(dy, dy));
+                }
+                double s = hsum(axy), sx = hsum(axx), sy = hsum(ayy);
+                for (; i < n; ++i) {
+                    const double dx = x[i] - xm;
+                    const double dy = y[i] - ym;
+                    s += dx * dy;
+                    sx += dx * dx;
+                    sy += dy * dy;
+                }
+                sxy = s;
+                sxx = sx;
+                syy = sy;
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_AVX2 void normalize_min_max(const T *in, T *out, const size_t n, const double min_value, const double ampl, const bool is_signed) {
+                const __m256d vmin = _mm256_set1_pd(min_value);
+                const __m256d vampl = _mm256_set1_pd(ampl);
+                const __m256d k = _mm256_set1_pd(is_signed ? 2.0 : 1.0);
+                const __m256d c = _mm256_set1_pd(is_signed ? 1.0 : 0.0);
+                size_t i = 0;
+                for (; i + 4 <= n; i += 4) {
+                    const __m256d v = _mm256_div_pd(_mm256_sub_pd(load(in + i), vmin), vampl);
+                    store(out + i, _mm256_sub_pd(_mm256_mul_pd(k, v), c));
+                }
+                scalar::normalize_min_max(in + i, out + i, n - i, min_value, ampl, is_signed);
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_AVX2 void normalize_zscore(const T *in, T *out, const size_t n, const double mean, const double dix, const double t) {
+                if (dix == 0) {
+                    std::fill(out, out + n, T(0));
+                    return;
+                }
+                const __m256d vm = _mm256_set1_pd(mean);
+                const __m256d vd = _mm256_set1_pd(dix);
+                const __m256d vt = _mm256_set1_pd(t);
+                const __m256d vnt = _mm256_set1_pd(-t);
+                size_t i = 0;
+                for (; i + 4 <= n; i += 4) {
+                    const __m256d v = _mm256_div_pd(_mm256_sub_pd(load(in + i), vm), vd);
+                    store(out + i, _mm256_max_pd(_mm256_min_pd(v, vt), vnt));
+                }
+                scalar::normalize_zscore(in + i, out + i, n - i, mean, dix, t);
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_AVX2 void block_sq_dist(const T *block, const T *query, const size_t dim, const size_t width, double *out) {
+                size_t i = 0;
+                for (; i + 16 <= width; i += 16) {
+                    __m256d a0 = _mm256_setzero_pd(), a1 = _mm256_setzero_pd(), a2 = _mm256_setzero_pd(), a3 = _mm256_setzero_pd();
+                    for (size_t d = 0; d < dim; ++d) {
+                        const __m256d q = _mm256_set1_pd(query[d]);
+                        const T *column = block + d * width + i;
+                        const __m256d d0 = _mm256_sub_pd(load(column), q);
+                        const __m256d d1 = _mm256_sub_pd(load(column + 4), q);
+                        const __m256d d2 = _mm256_sub_pd(load(column + 8), q);
+                        const __m256d d3 = _mm256_sub_pd(load(column + 12), q);
+                        a0 = _mm256_add_pd(a0, _mm256_mul_pd(d0, d0));
+                        a1 = _mm256_add_pd(a1, _mm256_mul_pd(d1, d1));
+                        a2 = _mm256_add_pd(a2, _mm256_mul_pd(d2, d2));
+                        a3 = _mm256_add_pd(a3, _mm256_mul_pd(d3, d3));
+                    }
+                    store(out + i, a0);
+                    store(out + i + 4, a1);
+                    store(out + i + 8, a2);
+                    store(out + i + 12, a3);
+                }
+                if (i < width) scalar::block_sq_dist_tail(block + i, query, dim, width - i, width, out + i);
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_AVX2 void block_dot(const T *block, const T *query, const size_t dim, const size_t width, double *out) {
+                size_t i = 0;
+                for (; i + 16 <= width; i += 16) {
+                    __m256d a0 = _mm256_setzero_pd(), a1 = _mm256_setzero_pd(), a2 = _mm256_setzero_pd(), a3 = _mm256_setzero_pd();
+                    for (size_t d = 0; d < dim; ++d) {
+                        const __m256d q = _mm256_set1_pd(query[d]);
+                        const T *column = block + d * width + i;
+                        a0 = _mm256_add_pd(a0, _mm256_mul_pd(load(column), q));
+                        a1 = _mm256_add_pd(a1, _mm256_mul_pd(load(column + 4), q));
+                        a2 = _mm256_add_pd(a2, _mm256_mul_pd(load(column + 8), q));
+                        a3 = _mm256_add_pd(a3, _mm256_mul_pd(load(column + 12), q));
+                    }
+                    store(out + i, a0);
+                    store(out + i + 4, a1);
+                    store(out + i + 8, a2);
+                    store(out + i + 12, a3);
+                }
+                if (i < width) scalar::block_dot_tail(block + i, query, dim, width - i, width, out + i);
+            }
+
+            /** \brief Маска фрактала для четырех соседних позиций, v - окно первой позиции
+             */
+            template<int GT, int GE, class T>
+            XTECHNICAL_TARGET_AVX2 inline int fractal_mask(const T *v) {
+                const __m256d c = load(v + 6);
+                __m256d g[6], ge[6], e[6];
+                const __m256d right = _mm256_and_pd(_mm256_cmp_pd(c, load(v + 7), GT), _mm256_cmp_pd(c, load(v + 8), GT));
+                if (_mm256_movemask_pd(right) == 0) return 0;
+                for (size_t k = 0; k < 6; ++k) {
+                    const __m256d x = load(v + k);
+                    g[k] = _mm256_cmp_pd(c, x, GT);
+                    ge[k] = _mm256_cmp_pd(c, x, GE);
+                    e[k] = _mm256_cmp_pd(c, x, _CMP_EQ_OQ);
+                }
+                const __m256d p5 = _mm256_and_pd(g[4], g[5]);
+                const __m256d p6 = _mm256_and_pd(_mm256_and_pd(g[3], g[4]), e[5]);
+                const __m256d p7 = _mm256_and_pd(_mm256_and_pd(g[2], g[3]), _mm256_and_pd(e[4], ge[5]));
+                const __m256d p8 = _mm256_and_pd(_mm256_and_pd(_mm256_and_pd(g[1], g[2]), _mm256_and_pd(e[3], e[4])), ge[5]);
+                const __m256d p9 = _mm256_and_pd(_mm256_and_pd(_mm256_and_pd(g[0], g[1]), _mm256_and_pd(e[2], ge[3])), _mm256_and_pd(e[4], ge[5]));
+                const __m256d any = _mm256_or_pd(_mm256_or_pd(_mm256_or_pd(p5, p6), _mm256_or_pd(p7, p8)), p9);
+                return _mm256_movemask_pd(_mm256_and_pd(right, any));
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_AVX2 void fractals(const T *high, const T *low, const size_t n, uint64_t *up, uint64_t *dn) {
+                std::fill(up, up + (n + 63) / 64, 0);
+                std::fill(dn, dn + (n + 63) / 64, 0);
+                size_t j = 8;
+                for (; j + 4 <= n; j += 4) {
+                    scalar::set_bits(up, j, (uint64_t)fractal_mask<_CMP_GT_OQ, _CMP_GE_OQ>(high + j - 8), 4);
+                    scalar::set_bits(dn, j, (uint64_t)fractal_mask<_CMP_LT_OQ, _CMP_LE_OQ>(low + j - 8), 4);
+                }
+                scalar::fractals_tail(high, low, j, n, up, dn);
+            }
+
+            /* fit округляет промежуточный результат до точности T,
+             * чтобы float давал тот же результат, что и скалярный код
+             */
+            XTECHNICAL_TARGET_AVX2 inline __m256d fit(const double *, const __m256d v) {
+                return v;
+            }
+
+            XTECHNICAL_TARGET_AVX2 inline __m256d fit(const float *, const __m256d v) {
+                return _mm256_cvtps_pd(_mm256_cvtpd_ps(v));
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_AVX2 XTECHNICAL_NO_FP_CONTRACT void lane_add(T *acc, const T *x, const size_t n) {
+                size_t i = 0;
+                for (; i + 4 <= n; i += 4) store(acc + i, _mm256_add_pd(load(acc + i), load(x + i)));
+                scalar::lane_add(acc + i, x + i, n - i);
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_AVX2 XTECHNICAL_NO_FP_CONTRACT void lane_sma_update(T *sum, T *ring, const T *in, T *out, const size_t n, const T period) {
+                const __m256d p = _mm256_set1_pd((double)period);
+                size_t i = 0;
+                for (; i + 4 <= n; i += 4) {
+                    const __m256d v = load(in + i);
+                    const __m256d s = fit(in, _mm256_add_pd(load(sum + i), fit(in, _mm256_sub_pd(v, load(ring + i)))));
+                    store(ring + i, v);
+                    store(sum + i, s);
+                    store(out + i, _mm256_div_pd(s, p));
+                }
+                scalar::lane_sma_update(sum + i, ring + i, in + i, out + i, n - i, period);
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_AVX2 XTECHNICAL_NO_FP_CONTRACT void lane_sma_test(const T *sum, const T *ring, const T *in, T *out, const size_t n, const T period) {
+                const __m256d p = _mm256_set1_pd((double)period);
+                size_t i = 0;
+                for (; i + 4 <= n; i += 4) {
+                    const __m256d s = fit(in, _mm256_add_pd(load(sum + i), fit(in, _mm256_sub_pd(load(in + i), load(ring + i)))));
+                    store(out + i, _mm256_div_pd(s, p));
+                }
+                scalar::lane_sma_test(sum + i, ring + i, in + i, out + i, n - i, period);
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_AVX2 XTECHNICAL_NO_FP_CONTRACT void lane_ema_update(T *last, const T *in, T *out, const size_t n, const T a) {
+                const __m256d va = _mm256_set1_pd((double)a);
+                const __m256d vb = _mm256_set1_pd(1.0 - a);
+                size_t i = 0;
+                for (; i + 4 <= n; i += 4) {
+                    const __m256d v = fit(in, _mm256_add_pd(fit(in, _mm256_mul_pd(va, load(in + i))), _mm256_mul_pd(vb, load(last + i))));
+                    store(last + i, v);
+                    store(out + i, v);
+                }
+                scalar::lane_ema_update(last + i, in + i, out + i, n - i, a);
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_AVX2 XTECHNICAL_NO_FP_CONTRACT void lane_ema_test(const T *last, const T *in, T *out, const size_t n, const T a) {
+                const __m256d va = _mm256_set1_pd((double)a);
+                const __m256d vb = _mm256_set1_pd(1.0 - a);
+                size_t i = 0;
+                for (; i + 4 <= n; i += 4) {
+                    store(out + i, _mm256_add_pd(fit(in, _mm256_mul_pd(va, load(in + i))), _mm256_mul_pd(vb, load(last + i))));
+                }
+                scalar::lane_ema_test(last + i, in + i, out + i, n - i, a);
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_AVX2 XTECHNICAL_NO_FP_CONTRACT void lane_ema_alpha(T *last, const T *a, const T in, T *out, const size_t n) {
+                const __m256d one = _mm256_set1_pd(1.0);
+                const __m256d vin = _mm256_set1_pd((double)in);
+                size_t i = 0;
+                for (; i + 4 <= n; i += 4) {
+                    const __m256d va = load(a + i);
+                    const __m256d v = _mm256_add_pd(fit(a, _mm256_mul_pd(va, vin)), _mm256_mul_pd(_mm256_sub_pd(one, va), load(last + i)));
+                    store(last + i, v);
+                    store(out + i, v);
+                }
+                scalar::lane_ema_alpha(last + i, a + i, in, out + i, n - i);
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_AVX2 XTECHNICAL_NO_FP_CONTRACT void lane_sq_dev(T *acc, const T *x, const T *mean, const size_t n) {
+                size_t i = 0;
+                for (; i + 4 <= n; i += 4) {
+                    const __m256d d = fit(x, _mm256_sub_pd(load(x + i), load(mean + i)));
+                    store(acc + i, _mm256_add_pd(load(acc + i), fit(x, _mm256_mul_pd(d, d))));
+                }
+                scalar::lane_sq_dev(acc + i, x + i, mean + i, n - i);
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_AVX2 XTECHNICAL_NO_FP_CONTRACT void lane_true_range(const T *high, const T *low, const T *close, T *out, const size_t n) {
+                size_t i = 0;
+                for (; i + 4 <= n; i += 4) {
+                    const __m256d h = load(high + i), l = load(low + i), c = load(close + i);
+                    const __m256d hl = fit(high, _mm256_sub_pd(h, l));
+                    const __m256d hc = fit(high, _mm256_sub_pd(h, c));
+                    const __m256d cl = fit(high, _mm256_sub_pd(c, l));
+                    // std::max(a, b) возвращает a при равенстве, как и _mm256_max_pd(b, a)
+                    store(out + i, _mm256_max_pd(cl, _mm256_max_pd(hc, hl)));
+                }
+                scalar::lane_true_range(high + i, low + i, close + i, out + i, n - i);
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_AVX2 XTECHNICAL_NO_FP_CONTRACT void lane_abs_diff(const T *in, const T *last, T *out, const size_t n) {
+                const __m256d sign = _mm256_set1_pd(-0.0);
+                size_t i = 0;
+                for (; i + 4 <= n; i += 4) {
+                    store(out + i, _mm256_andnot_pd(sign, _mm256_sub_pd(load(in + i), load(last + i))));
+                }
+                scalar::lane_abs_diff(in + i, last + i, out + i, n - i);
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_AVX2 XTECHNICAL_NO_FP_CONTRACT void lane_rsi_split(const T *in, const T *prev, T *u, T *d, const size_t n) {
+                size_t i = 0;
+                for (; i + 4 <= n; i += 4) {
+                    const __m256d v = load(in + i), p = load(prev + i);
+                    store(u + i, _mm256_and_pd(_mm256_cmp_pd(p, v, _CMP_LT_OQ), _mm256_sub_pd(v, p)));
+                    store(d + i, _mm256_and_pd(_mm256_cmp_pd(p, v, _CMP_GT_OQ), _mm256_sub_pd(p, v)));
+                }
+                scalar::lane_rsi_split(in + i, prev + i, u + i, d + i, n - i);
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_AVX2 XTECHNICAL_NO_FP_CONTRACT void lane_rsi(const T *u, const T *d, T *out, const size_t n) {
+                const __m256d one = _mm256_set1_pd(1.0), hundred = _mm256_set1_pd(100.0);
+                size_t i = 0;
+                for (; i + 4 <= n; i += 4) {
+                    const __m256d vd = load(d + i);
+                    const __m256d rs = fit(u, _mm256_div_pd(load(u + i), vd));
+                    const __m256d r = _mm256_sub_pd(hundred, _mm256_div_pd(hundred, _mm256_add_pd(one, rs)));
+                    const __m256d zero = _mm256_cmp_pd(vd, _mm256_setzero_pd(), _CMP_EQ_OQ);
+                    store(out + i, _mm256_blendv_pd(r, hundred, zero));
+                }
+                scalar::lane_rsi(u + i, d + i, out + i, n - i);
+            }
+        }; // avx2
+
+        /* maskz-варианты intrinsic-функций используются, чтобы GCC без -mavx512f
+         * не выдавал ложных предупреждений -Wmaybe-uninitialized
+         */
+        namespace avx512 {
+
+            XTECHNICAL_TARGET_AVX512 inline __m512d load(const double *p) {
+                return _mm512_loadu_pd(p);
+            }
+
+            XTECHNICAL_TARGET_AVX512 inline __m512d load(const float *p) {
+                return _mm512_maskz_cvtps_pd((__mmask8)0xFF, _mm256_loadu_ps(p));
+            }
+
+            XTECHNICAL_TARGET_AVX512 inline void store(double *p, const __m512d v) {
+                _mm512_storeu_pd(p, v);
+            }
+
+            XTECHNICAL_TARGET_AVX512 inline void store(float *p, const __m512d v) {
+                _mm256_storeu_ps(p, _mm512_maskz_cvtpd_ps((__mmask8)0xFF, v));
+            }
+
+            XTECHNICAL_TARGET_AVX512 inline double hsum(const __m512d v) {
+                double t[8];
+                _mm512_storeu_pd(t, v);
+                return ((t[0] + t[1]) + (t[2] + t[3])) + ((t[4] + t[5]) + (t[6] + t[7]));
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_AVX512 double sum(const T *x, const size_t n) {
+                __m512d a0 = _mm512_setzero_pd(), a1 = _mm512_setzero_pd();
+                size_t i = 0;
+                for (; i + 16 <= n; i += 16) {
+                    a0 = _mm512_add_pd(a0, load(x + i));
+                    a1 = _mm512_add_pd(a1, load(x + i + 8));
+                }
+                double s = hsum(_mm512_add_pd(a0, a1));
+                for (; i < n; ++i) s += x[i];
+                return s;
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_AVX512 double sum_sq(const T *x, const size_t n) {
+                __m512d a0 = _mm512_setzero_pd(), a1 = _mm512_setzero_pd();
+                size_t i = 0;
+                for (; i + 16 <= n; i += 16) {
+                    const __m512d v0 = load(x + i);
+                    const __m512d v1 = load(x + i + 8);
+                    a0 = _mm512_add_pd(a0, _mm512_mul_pd(v0, v0));
+                    a1 = _mm512_add_pd(a1, _mm512_mul_pd(v1, v1));
+                }
+                double s = hsum(_mm512_add_pd(a0, a1));
+                for (; i < n; ++i) s += (double)x[i] * (double)x[i];
+                return s;
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_AVX512 double dot(const T *x, const T *y, const size_t n) {
+                __m512d a0 = _mm512_setzero_pd(), a1 = _mm512_setzero_pd();
+                size_t i = 0;
+                for (; i + 16 <= n; i += 16) {
+                    a0 = _mm512_add_pd(a0, _mm512_mul_pd(load(x + i), load(y + i)));
+                    a1 = _mm512_add_pd(a1, _mm512_mul_pd(load(x + i + 8), load(y + i + 8)));
+                }
+                double s = hsum(_mm512_add_pd(a0, a1));
+                for (; i < n; ++i) s += (double)x[i] * (double)y[i];
+                return s;
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_AVX512 double sum_sq_dev(const T *x, const size_t n, const double mean) {
+                const __m512d m = _mm512_set1_pd(mean);
+                __m512d a0 = _mm512_setzero_pd(), a1 = _mm512_setzero_pd();
+                size_t i = 0;
+                for (; i + 16 <= n; i += 16) {
+                    const __m512d d0 = _mm512_sub_pd(load(x + i), m);
+                    const __m512d d1 = _mm512_sub_pd(load(x + i + 8), m);
+                    a0 = _mm512_add_pd(a0, _mm512_mul_pd(d0, d0));
+                    a1 = _mm512_add_pd(a1, _mm512_mul_pd(d1, d1));
+                }
+                double s = hsum(_mm512_add_pd(a0, a1));
+                for (; i < n; ++i) {
+                    const double d = x[i] - mean;
+                    s += d * d;
+                }
+                return s;
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_AVX512 void central_moments(const T *x, const size_t n, const double mean, double &m2, double &m3, double &m4) {
+                const __m512d m = _mm512_set1_pd(mean);
+                __m512d a2 = _mm512_setzero_pd(), a3 = _mm512_setzero_pd(), a4 = _mm512_setzero_pd();
+                size_t i = 0;
+                for (; i + 8 <= n; i += 8) {
+                    const __m512d d = _mm512_sub_pd(load(x + i), m);
+                    const __m512d d2 = _mm512_mul_pd(d, d);
+                    a2 = _mm512_add_pd(a2, d2);
+                    a3 = _mm512_add_pd(a3, _mm512_mul_pd(d2, d));
+                    a4 = _mm512_add_pd(a4, _mm512_mul_pd(d2, d2));
+                }
+                double s2 = hsum(a2), s3 = hsum(a3), s4 = hsum(a4);
+                for (; i < n; ++i) {
+                    const double d = x[i] - mean;
+                    const double d2 = d * d;
+                    s2 += d2;
+                    s3 += d2 * d;
+                    s4 += d2 * d2;
+                }
+                m2 = s2;
+                m3 = s3;
+                m4 = s4;
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_AVX512 void min_max(const T *x, const size_t n, T &min_value, T &max_value) {
+                if (n < 8) {
+                    scalar::min_max(x, n, min_value, max_value);
+                    return;
+                }
+                __m512d mn = load(x), mx = mn;
+                size_t i = 8;
+                for (; i + 8 <= n; i += 8) {
+                    const __m512d v = load(x + i);
+                    mn = _mm512_maskz_min_pd((__mmask8)0xFF, mn, v);
+                    mx = _mm512_maskz_max_pd((__mmask8)0xFF, mx, v);
+                }
+                double tmn[8], tmx[8];
+                _mm512_storeu_pd(tmn, mn);
+                _mm512_storeu_pd(tmx, mx);
+                double rmn = tmn[0], rmx = tmx[0];
+                for (size_t j = 1; j < 8; ++j) {
+                    rmn = std::min(rmn, tmn[j]);
+                    rmx = std::max(rmx, tmx[j]);
+                }
+                for (; i < n; ++i) {
+                    rmn = std::min(rmn, (double)x[i]);
+                    rmx = std::max(rmx, (double)x[i]);
+                }
+                min_value = (T)rmn;
+                max_value = (T)rmx;
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_AVX512 void cross_moments(const T *x, const T *y, const size_t n, const double xm, const double ym, double &sxy, double &sxx, double &syy) {
+                const __m512d vxm = _mm512_set1_pd(xm);
+                const __m512d vym = _mm512_set1_pd(ym);
+                __m512d axy = _mm512_setzero_pd(), axx = _mm512_setzero_pd(), ayy = _mm512_setzero_pd();
+                size_t i = 0;
+                for (; i + 8 <= n; i += 8) {
+                    const __m512d dx = _mm512_sub_pd(load(x + i), vxm);
+                    const __m512d dy = _mm512_sub_pd(load(y + i), vym);
+                    axy = _mm512_add_pd(axy, _mm512_mul_pd(dx, dy));
+                    axx = _mm512_add_pd(axx, _mm512_mul_pd(dx, dx));
+                    ayy = _mm512_add_pd(ayy, _mm512_mul_pd(dy, dy));
+                }
+                double s = hsum(axy), sx = hsum(axx), sy = hsum(ayy);
+                for (; i < n; ++i) {
+                    const double dx = x[i] - xm;
+                    const double dy = y[i] - ym;
+                    s += dx * dy;
+                    sx += dx * dx;
+                    sy += dy * dy;
+                }
+                sxy = s;
+                sxx = sx;
+                syy = sy;
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_AVX512 void normalize_min_max(const T *in, T *out, const size_t n, const double min_value, const double ampl, const bool is_signed) {
+                const __m512d vmin = _mm512_set1_pd(min_value);
+                const __m512d vampl = _mm512_set1_pd(ampl);
+                const __m512d k = _mm512_set1_pd(is_signed ? 2.0 : 1.0);
+                const __m512d c = _mm512_set1_pd(is_signed ? 1.0 : 0.0);
+                size_t i = 0;
+                for (; i + 8 <= n; i += 8) {
+                    const __m512d v = _mm512_div_pd(_mm512_sub_pd(load(in + i), vmin), vampl);
+                    store(out + i, _mm512_sub_pd(_mm512_mul_pd(k, v), c));
+                }
+                scalar::normalize_min_max(in + i, out + i, n - i, min_value, ampl, is_signed);
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_AVX512 void normalize_zscore(const T *in, T *out, const size_t n, const double mean, const double dix, const double t) {
+                if (dix == 0) {
+                    std::fill(out, out + n, T(0));
+                    return;
+                }
+                const __m512d vm = _mm512_set1_pd(mean);
+                const __m512d vd = _mm512_set1_pd(dix);
+                const __m512d vt = _mm512_set1_pd(t);
+                const __m512d vnt = _mm512_set1_pd(-t);
+                size_t i = 0;
+                for (; i + 8 <= n; i += 8) {
+                    const __m512d v = _mm512_div_pd(_mm512_sub_pd(load(in + i), vm), vd);
+                    store(out + i, _mm512_maskz_max_pd((__mmask8)0xFF, _mm512_maskz_min_pd((__mmask8)0xFF, v, vt), vnt));
+                }
+                scalar::normalize_zscore(in + i, out + i, n - i, mean, dix, t);
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_AVX512 void block_sq_dist(const T *block, const T *query, const size_t dim, const size_t width, double *out) {
+                size_t i = 0;
+                for (; i + 32 <= width; i += 32) {
+                    __m512d a0 = _mm512_setzero_pd(), a1 = _mm512_setzero_pd(), a2 = _mm512_setzero_pd(), a3 = _mm512_setzero_pd();
+                    for (size_t d = 0; d < dim; ++d) {
+                        const __m512d q = _mm512_set1_pd(query[d]);
+                        const T *column = block + d * width + i;
+                        const __m512d d0 = _mm512_sub_pd(load(column), q);
+                        const __m512d d1 = _mm512_sub_pd(load(column + 8), q);
+                        const __m512d d2 = _mm512_sub_pd(load(column + 16), q);
+                        const __m512d d3 = _mm512_sub_pd(load(column + 24), q);
+                        a0 = _mm512_add_pd(a0, _mm512_mul_pd(d0, d0));
+                        a1 = _mm512_add_pd(a1, _mm512_mul_pd(d1, d1));
+                        a2 = _mm512_add_pd(a2, _mm512_mul_pd(d2, d2));
+                        a3 = _mm512_add_pd(a3, _mm512_mul_pd(d3, d3));
+                    }
+                    store(out + i, a0);
+                    store(out + i + 8, a1);
+                    store(out + i + 16, a2);
+                    store(out + i + 24, a3);
+                }
+                if (i < width) scalar::block_sq_dist_tail(block + i, query, dim, width - i, width, out + i);
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_AVX512 void block_dot(const T *block, const T *query, const size_t dim, const size_t width, double *out) {
+                size_t i = 0;
+                for (; i + 32 <= width; i += 32) {
+                    __m512d a0 = _mm512_setzero_pd(), a1 = _mm512_setzero_pd(), a2 = _mm512_setzero_pd(), a3 = _mm512_setzero_pd();
+                    for (size_t d = 0; d < dim; ++d) {
+                        const __m512d q = _mm512_set1_pd(query[d]);
+                        const T *column = block + d * width + i;
+                        a0 = _mm512_add_pd(a0, _mm512_mul_pd(load(column), q));
+                        a1 = _mm512_add_pd(a1, _mm512_mul_pd(load(column + 8), q));
+                        a2 = _mm512_add_pd(a2, _mm512_mul_pd(load(column + 16), q));
+                        a3 = _mm512_add_pd(a3, _mm512_mul_pd(load(column + 24), q));
+                    }
+                    store(out + i, a0);
+                    store(out + i + 8, a1);
+                    store(out + i + 16, a2);
+                    store(out + i + 24, a3);
+                }
+                if (i < width) scalar::block_dot_tail(block + i, query, dim, width - i, width, out + i);
+            }
+
+            /** \brief Маска фрактала для восьми соседних позиций, v - окно первой позиции
+             */
+            template<int GT, int GE, class T>
+            XTECHNICAL_TARGET_AVX512 inline unsigned fractal_mask(const T *v) {
+                const __m512d c = load(v + 6);
+                const unsigned right = _mm512_cmp_pd_mask(c, load(v + 7), GT) & _mm512_cmp_pd_mask(c, load(v + 8), GT);
+                if (right == 0) return 0;
+                unsigned g[6], ge[6], e[6];
+                for (size_t k = 0; k < 6; ++k) {
+                    const __m512d x = load(v + k);
+                    g[k] = _mm512_cmp_pd_mask(c, x, GT);
+                    ge[k] = _mm512_cmp_pd_mask(c, x, GE);
+                    e[k] = _mm512_cmp_pd_mask(c, x, _CMP_EQ_OQ);
+                }
+                const unsigned any =
+                    (g[4] & g[5]) |
+                    (g[3] & g[4] & e[5]) |
+                    (g[2] & g[3] & e[4] & ge[5]) |
+                    (g[1] & g[2] & e[3] & e[4] & ge[5]) |
+                    (g[0] & g[1] & e[2] & ge[3] & e[4] & ge[5]);
+                return right & any;
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_AVX512 void fractals(const T *high, const T *low, const size_t n, uint64_t *up, uint64_t *dn) {
+                std::fill(up, up + (n + 63) / 64, 0);
+                std::fill(dn, dn + (n + 63) / 64, 0);
+                size_t j = 8;
+                for (; j + 8 <= n; j += 8) {
+                    scalar::set_bits(up, j, (uint64_t)fractal_mask<_CMP_GT_OQ, _CMP_GE_OQ>(high + j - 8), 8);
+                    scalar::set_bits(dn, j, (uint64_t)fractal_mask<_CMP_LT_OQ, _CMP_LE_OQ>(low + j - 8), 8);
+                }
+                scalar::fractals_tail(high, low, j, n, up, dn);
+            }
+
+            /* fit округляет промежуточный результат до точности T,
+             * чтобы float давал тот же результат, что и скалярный код
+             */
+            XTECHNICAL_TARGET_AVX512 inline __m512d fit(const double *, const __m512d v) {
+                return v;
+            }
+
+            XTECHNICAL_TARGET_AVX512 inline __m512d fit(const float *, const __m512d v) {
+                return _mm512_cvtps_pd(_mm512_cvtpd_ps(v));
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_AVX512 XTECHNICAL_NO_FP_CONTRACT void lane_add(T *acc, const T *x, const size_t n) {
+                size_t i = 0;
+                for (; i + 8 <= n; i += 8) store(acc + i, _mm512_add_pd(load(acc + i), load(x + i)));
+                scalar::lane_add(acc + i, x + i, n - i);
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_AVX512 XTECHNICAL_NO_FP_CONTRACT void lane_sma_update(T *sum, T *ring, const T *in, T *out, const size_t n, const T period) {
+                const __m512d p = _mm512_set1_pd((double)period);
+                size_t i = 0;
+                for (; i + 8 <= n; i += 8) {
+                    const __m512d v = load(in + i);
+                    const __m512d s = fit(in, _mm512_add_pd(load(sum + i), fit(in, _mm512_sub_pd(v, load(ring + i)))));
+                    store(ring + i, v);
+                    store(sum + i, s);
+                    store(out + i, _mm512_div_pd(s, p));
+                }
+                scalar::lane_sma_update(sum + i, ring + i, in + i, out + i, n - i, period);
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_AVX512 XTECHNICAL_NO_FP_CONTRACT void lane_sma_test(const T *sum, const T *ring, const T *in, T *out, const size_t n, const T period) {
+                const __m512d p = _mm512_set1_pd((double)period);
+                size_t i = 0;
+                for (; i + 8 <= n; i += 8) {
+                    const __m512d s = fit(in, _mm512_add_pd(load(sum + i), fit(in, _mm512_sub_pd(load(in + i), load(ring + i)))));
+                    store(out + i, _mm512_div_pd(s, p));
+                }
+                scalar::lane_sma_test(sum + i, ring + i, in + i, out + i, n - i, period);
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_AVX512 XTECHNICAL_NO_FP_CONTRACT void lane_ema_update(T *last, const T *in, T *out, const size_t n, const T a) {
+                const __m512d va = _mm512_set1_pd((double)a);
+                const __m512d vb = _mm512_set1_pd(1.0 - a);
+                size_t i = 0;
+                for (; i + 8 <= n; i += 8) {
+                    const __m512d v = fit(in, _mm512_add_pd(fit(in, _mm512_mul_pd(va, load(in + i))), _mm512_mul_pd(vb, load(last + i))));
+                    store(last + i, v);
+                    store(out + i, v);
+                }
+                scalar::lane_ema_update(last + i, in + i, out + i, n - i, a);
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_AVX512 XTECHNICAL_NO_FP_CONTRACT void lane_ema_test(const T *last, const T *in, T *out, const size_t n, const T a) {
+                const __m512d va = _mm512_set1_pd((double)a);
+                const __m512d vb = _mm512_set1_pd(1.0 - a);
+                size_t i = 0;
+                for (; i + 8 <= n; i += 8) {
+                    store(out + i, _mm512_add_pd(fit(in, _mm512_mul_pd(va, load(in + i))), _mm512_mul_pd(vb, load(last + i))));
+                }
+                scalar::lane_ema_test(last + i, in + i, out + i, n - i, a);
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_AVX512 XTECHNICAL_NO_FP_CONTRACT void lane_ema_alpha(T *last, const T *a, const T in, T *out, const size_t n) {
+                const __m512d one = _mm512_set1_pd(1.0);
+                const __m512d vin = _mm512_set1_pd((double)in);
+                size_t i = 0;
+                for (; i + 8 <= n; i += 8) {
+                    const __m512d va = load(a + i);
+                    const __m512d v = _mm512_add_pd(fit(a, _mm512_mul_pd(va, vin)), _mm512_mul_pd(_mm512_sub_pd(one, va), load(last + i)));
+                    store(last + i, v);
+                    store(out + i, v);
+                }
+                scalar::lane_ema_alpha(last + i, a + i, in, out + i, n - i);
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_AVX512 XTECHNICAL_NO_FP_CONTRACT void lane_sq_dev(T *acc, const T *x, const T *mean, const size_t n) {
+                size_t i = 0;
+                for (; i + 8 <= n; i += 8) {
+                    const __m512d d = fit(x, _mm512_sub_pd(load(x + i), load(mean + i)));
+                    store(acc + i, _mm512_add_pd(load(acc + i), fit(x, _mm512_mul_pd(d, d))));
+                }
+                scalar::lane_sq_dev(acc + i, x + i, mean + i, n - i);
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_AVX512 XTECHNICAL_NO_FP_CONTRACT void lane_true_range(const T *high, const T *low, const T *close, T *out, const size_t n) {
+                size_t i = 0;
+                for (; i + 8 <= n; i += 8) {
+                    const __m512d h = load(high + i), l = load(low + i), c = load(close + i);
+                    const __m512d hl = fit(high, _mm512_sub_pd(h, l));
+                    const __m512d hc = fit(high, _mm512_sub_pd(h, c));
+                    const __m512d cl = fit(high, _mm512_sub_pd(c, l));
+                    // std::max(a, b) возвращает a при равенстве, как и _mm512_max_pd(b, a)
+                    store(out + i, _mm512_max_pd(cl, _mm512_max_pd(hc, hl)));
+                }
+                scalar::lane_true_range(high + i, low + i, close + i, out + i, n - i);
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_AVX512 XTECHNICAL_NO_FP_CONTRACT void lane_abs_diff(const T *in, const T *last, T *out, const size_t n) {
+                size_t i = 0;
+                for (; i + 8 <= n; i += 8) {
+                    store(out + i, _mm512_abs_pd(_mm512_sub_pd(load(in + i), load(last + i))));
+                }
+                scalar::lane_abs_diff(in + i, last + i, out + i, n - i);
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_AVX512 XTECHNICAL_NO_FP_CONTRACT void lane_rsi_split(const T *in, const T *prev, T *u, T *d, const size_t n) {
+                size_t i = 0;
+                for (; i + 8 <= n; i += 8) {
+                    const __m512d v = load(in + i), p = load(prev + i);
+                    store(u + i, _mm512_maskz_sub_pd(_mm512_cmp_pd_mask(p, v, _CMP_LT_OQ), v, p));
+                    store(d + i, _mm512_maskz_sub_pd(_mm512_cmp_pd_mask(p, v, _CMP_GT_OQ), p, v));
+                }
+                scalar::lane_rsi_split(in + i, prev + i, u + i, d + i, n - i);
+            }
+
+            template<class T>
+            XTECHNICAL_TARGET_AVX512 XTECHNICAL_NO_FP_CONTRACT void lane_rsi(const T *u, const T *d, T *out, const size_t n) {
+                const __m512d one = _mm512_set1_pd(1.0), hundred = _mm512_set1_pd(100.0);
+                size_t i = 0;
+                for (; i + 8 <= n; i += 8) {
+                    const __m512d vd = load(d + i);
+                    const __m512d rs = fit(u, _mm512_div_pd(load(u + i), vd));
+                    const __m512d r = _mm512_sub_pd(hundred, _mm512_div_pd(hundred, _mm512_add_pd(one, rs)));
+                    const __mmask8 zero = _mm512_cmp_pd_mask(vd, _mm512_setzero_pd(), _CMP_EQ_OQ);
+                    store(out + i, _mm512_mask_blend_pd(zero, r, hundred));
+                }
+                scalar::lane_rsi(u + i, d + i, out + i, n - i);
+            }
+        }; // avx512
+#endif
+
+        /** \brief Определить лучший набор инструкций, доступный процессору
+         * \return Набор инструкций
+         */
+        inline InstructionSet detect_instruction_set() noexcept {
+#if XTECHNICAL_SIMD_X86
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx512f")) return InstructionSet::AVX512;
+            if (__builtin_cpu_supports("avx2")) return InstructionSet::AVX2;
+            if (__builtin_cpu_supports("sse2")) return InstructionSet::SSE2;
+#endif
+            return InstructionSet::SCALAR;
+        }
+
+        /** \brief Заполнить таблицу ядер для указанного набора инструкций
+         * \param kernels   Таблица ядер
+         * \param set       Набор инструкций
+         */
+        template<class T>
+        void fill_kernels(Kernels<T> &kernels, const InstructionSet set) noexcept {
+            kernels.sum = scalar::sum<T>;
+            kernels.sum_sq = scalar::sum_sq<T>;
+            kernels.dot = scalar::dot<T>;
+            kernels.sum_sq_dev = scalar::sum_sq_dev<T>;
+            kernels.central_moments = scalar::central_moments<T>;
+            kernels.min_max = scalar::min_max<T>;
+            kernels.cross_moments = scalar::cross_moments<T>;
+            kernels.normalize_min_max = scalar::normalize_min_max<T>;
+            kernels.normalize_zscore = scalar::normalize_zscore<T>;
+            // векторного логарифма в libm нет, поэтому log всегда скалярный
+            kernels.log = scalar::log<T>;
+            kernels.block_sq_dist = scalar::block_sq_dist<T>;
+            kernels.block_dot = scalar::block_dot<T>;
+            kernels.fractals = scalar::fractals<T>;
+            kernels.lane_add = scalar::lane_add<T>;
+            kernels.lane_sma_update = scalar::lane_sma_update<T>;
+            kernels.lane_sma_test = scalar::lane_sma_test<T>;
+            kernels.lane_ema_update = scalar::lane_ema_update<T>;
+            kernels.lane_ema_test = scalar::lane_ema_test<T>;
+            kernels.lane_ema_alpha = scalar::lane_ema_alpha<T>;
+            kernels.lane_sq_dev = scalar::lane_sq_dev<T>;
+            kernels.lane_true_range = scalar::lane_true_range<T>;
+            kernels.lane_abs_diff = scalar::lane_abs_diff<T>;
+            kernels.lane_rsi_split = scalar::lane_rsi_split<T>;
+            kernels.lane_rsi = scalar::lane_rsi<T>;
+#if XTECHNICAL_SIMD_X86
+            switch (set) {
+            case InstructionSet::AVX512:
+                kernels.sum = avx512::sum<T>;
+                kernels.sum_sq = avx512::sum_sq<T>;
+                kernels.dot = avx512::dot<T>;
+                kernels.sum_sq_dev = avx512::sum_sq_dev<T>;
+                kernels.central_moments = avx512::central_moments<T>;
+                kernels.min_max = avx512::min_max<T>;
+                kernels.cross_moments = avx512::cross_moments<T>;
+                kernels.normalize_min_max = avx512::normalize_min_max<T>;
+                kernels.normalize_zscore = avx512::normalize_zscore<T>;
+                kernels.block_sq_dist = avx512::block_sq_dist<T>;
+                kernels.block_dot = avx512::block_dot<T>;
+                kernels.fractals = avx512::fractals<T>;
+                kernels.lane_add = avx512::lane_add<T>;
+                kernels.lane_sma_update = avx512::lane_sma_update<T>;
+                kernels.lane_sma_test = avx512::lane_sma_test<T>;
+                kernels.lane_ema_update = avx512::lane_ema_update<T>;
+                kernels.lane_ema_test = avx512::lane_ema_test<T>;
+                kernels.lane_ema_alpha = avx512::lane_ema_alpha<T>;
+                kernels.lane_sq_dev = avx512::lane_sq_dev<T>;
+                kernels.lane_true_range = avx512::lane_true_range<T>;
+                kernels.lane_abs_diff = avx512::lane_abs_diff<T>;
+                kernels.lane_rsi_split = avx512::lane_rsi_split<T>;
+                kernels.lane_rsi = avx512::lane_rsi<T>;
+                break;
+            case InstructionSet::AVX2:
+                kernels.sum = avx2::sum<T>;
+                kernels.sum_sq = avx2::sum_sq<T>;
+                kernels.dot = avx2::dot<T>;
+                kernels.sum_sq_dev = avx2::sum_sq_dev<T>;
+                kernels.central_moments = avx2::central_moments<T>;
+                kernels.min_max = avx2::min_max<T>;
+                kernels.cross_moments = avx2::cross_moments<T>;
+                kernels.normalize_min_max = avx2::normalize_min_max<T>;
+                kernels.normalize_zscore = avx2::normalize_zscore<T>;
+                kernels.block_sq_dist = avx2::block_sq_dist<T>;
+                kernels.block_dot = avx2::block_dot<T>;
+                kernels.fractals = avx2::fractals<T>;
+                kernels.lane_add = avx2::lane_add<T>;
+                kernels.lane_sma_update = avx2::lane_sma_update<T>;
+                kernels.lane_sma_test = avx2::lane_sma_test<T>;
+                kernels.lane_ema_update = avx2::lane_ema_update<T>;
+                kernels.lane_ema_test = avx2::lane_ema_test<T>;
+                kernels.lane_ema_alpha = avx2::lane_ema_alpha<T>;
+                kernels.lane_sq_dev = avx2::lane_sq_dev<T>;
+                kernels.lane_true_range = avx2::lane_true_range<T>;
+                kernels.lane_abs_diff = avx2::lane_abs_diff<T>;
+                kernels.lane_rsi_split = avx2::lane_rsi_split<T>;
+                kernels.lane_rsi = avx2::lane_rsi<T>;
+                break;
+            case InstructionSet::SSE2:
+                kernels.sum = sse2::sum<T>;
+                kernels.sum_sq = sse2::sum_sq<T>;
+                kernels.dot = sse2::dot<T>;
+                kernels.sum_sq_dev = sse2::sum_sq_dev<T>;
+                kernels.central_moments = sse2::central_moments<T>;
+                kernels.min_max = sse2::min_max<T>;
+                kernels.cross_moments = sse2::cross_moments<T>;
+                kernels.normalize_min_max = sse2::normalize_min_max<T>;
+                kernels.normalize_zscore = sse2::normalize_zscore<T>;
+                kernels.block_sq_dist = sse2::block_sq_dist<T>;
+                kernels.block_dot = sse2::block_dot<T>;
+                kernels.fractals = sse2::fractals<T>;
+                kernels.lane_add = sse2::lane_add<T>;
+                kernels.lane_sma_update = sse2::lane_sma_update<T>;
+                kernels.lane_sma_test = sse2::lane_sma_test<T>;
+                kernels.lane_ema_update = sse2::lane_ema_update<T>;
+                kernels.lane_ema_test = sse2::lane_ema_test<T>;
+                kernels.lane_ema_alpha = sse2::lane_ema_alpha<T>;
+                kernels.lane_sq_dev = sse2::lane_sq_dev<T>;
+                kernels.lane_true_range = sse2::lane_true_range<T>;
+                kernels.lane_abs_diff = sse2::lane_abs_diff<T>;
+                kernels.lane_rsi_split = sse2::lane_rsi_split<T>;
+                kernels.lane_rsi = sse2::lane_rsi<T>;
+                break;
+            default:
+                break;
+            };
+#else
+            (void)set;
+#endif
+        }
+
+        /** \brief Получить таблицу ядер
+         *
+         * Таблица заполняется один раз при первом обращении
+         * по результату detect_instruction_set().
+         * \return Таблица ядер для типа T
+         */
+        template<class T>
+        Kernels<T> &get_kernels() noexcept {
+            static Kernels<T> kernels = [] {
+                Kernels<T> k;
+                fill_kernels(k, detect_instruction_set());
+                return k;
+            }();
+            return kernels;
+        }
+
+        /** \brief Получить текущий набор инструкций
+         */
+        inline InstructionSet &current_instruction_set() noexcept {
+            static InstructionSet set = detect_instruction_set();
+            return set;
+        }
+
+        /** \brief Принудительно выбрать набор инструкций
+         *
+         * Нужен для сравнения ядер между собой. Набор выше доступного
+         * процессору выбирать нельзя. Метод не потокобезопасен,
+         * вызывать его нужно до начала расчетов.
+         * \param set   Набор инструкций
+         * \return Вернет true, если набор инструкций установлен
+         */
+        inline bool set_instruction_set(const InstructionSet set) noexcept {
+            if ((int)set > (int)detect_instruction_set()) return false;
+            fill_kernels(get_kernels<double>(), set);
+            fill_kernels(get_kernels<float>(), set);
+            current_instruction_set() = set;
+            return true;
+        }
+
+        /** \brief Получить набор инструкций, используемый ядрами
+         */
+        inline InstructionSet get_instruction_set() noexcept {
+            return current_instruction_set();
+        }
+
+        template<class T>
+        inline double sum(const T *x, const size_t n) noexcept {
+            return get_kernels<T>().sum(x, n);
+        }
+
+        template<class T>
+        inline double sum_sq(const T *x, const size_t n) noexcept {
+            return get_kernels<T>().sum_sq(x, n);
+        }
+
+        template<class T>
+        inline double dot(const T *x, const T *y, const size_t n) noexcept {
+            return get_kernels<T>().dot(x, y, n);
+        }
+
+        template<class T>
+        inline double sum_sq_dev(const T *x, const size_t n, const double mean) noexcept {
+            return get_kernels<T>().sum_sq_dev(x, n, mean);
+        }
+
+        template<class T>
+        inline void central_moments(const T *x, const size_t n, const double mean, double &m2, double &m3, double &m4) noexcept {
+            get_kernels<T>().central_moments(x, n, mean, m2, m3, m4);
+        }
+
+        template<class T>
+        inline void min_max(const T *x, const size_t n, T &min_value, T &max_value) noexcept {
+            get_kernels<T>().min_max(x, n, min_value, max_value);
+        }
+
+        template<class T>
+        inline void cross_moments(const T *x, const T *y, const size_t n, const double xm, const double ym, double &sxy, double &sxx, double &syy) noexcept {
+            get_kernels<T>().cross_moments(x, y, n, xm, ym, sxy, sxx, syy);
+        }
+
+        template<class T>
+        inline void normalize_min_max(const T *in, T *out, const size_t n, const double min_value, const double ampl, const bool is_signed) noexcept {
+            get_kernels<T>().normalize_min_max(in, out, n, min_value, ampl, is_signed);
+        }
+
+        template<class T>
+        inline void normalize_zscore(const T *in, T *out, const size_t n, const double mean, const double dix, const double t) noexcept {
+            get_kernels<T>().normalize_zscore(in, out, n, mean, dix, t);
+        }
+
+        template<class T>
+        inline void log(const T *in, T *out, const size_t n) noexcept {
+            get_kernels<T>().log(in, out, n);
+        }
+
+        /** \brief Квадраты евклидовых расстояний от запроса до блока векторов
+         *
+         * Блок хранится по столбцам: координата d вектора i лежит в block[d * width + i]
+         * \param block   Блок векторов
+         * \param query   Вектор запроса длиной dim
+         * \param dim     Размерность векторов
+         * \param width   Количество векторов в блоке
+         * \param out     Расстояния, массив длиной width
+         */
+        template<class T>
+        inline void block_sq_dist(const T *block, const T *query, const size_t dim, const size_t width, double *out) noexcept {
+            get_kernels<T>().block_sq_dist(block, query, dim, width, out);
+        }
+
+        /** \brief Скалярные произведения запроса и векторов блока
+         *
+         * Блок хранится так же, как в block_sq_dist
+         */
+        template<class T>
+        inline void block_dot(const T *block, const T *query, const size_t dim, const size_t width, double *out) noexcept {
+            get_kernels<T>().block_dot(block, query, dim, width, out);
+        }
+
+        /** \brief Найти фракталы Билла Вильямса в массивах баров
+         *
+         * Бит j массива up (dn) устанавливается, если после бара j
+         * образовался верхний (нижний) фрактал с вершиной на баре j - 2,
+         * то есть BasicFractals::update для бара j вызвал бы on_up (on_dn).
+         * \param high    Максимальные значения баров
+         * \param low     Минимальные значения баров
+         * \param n       Количество баров
+         * \param up      Битовый массив верхних фракталов длиной (n + 63) / 64
+         * \param dn      Битовый массив нижних фракталов длиной (n + 63) / 64
+         */
+        template<class T>
+        inline void fractals(const T *high, const T *low, const size_t n, uint64_t *up, uint64_t *dn) noexcept {
+            get_kernels<T>().fractals(high, low, n, up, dn);
+        }
+
+        /* Вертикальные ядра банков индикаторов (см. IndicatorBank).
+         * Элемент i каждого массива относится к символу i.
+         */
+
+        template<class T>
+        inline void lane_add(T *acc, const T *x, const size_t n) noexcept {
+            get_kernels<T>().lane_add(acc, x, n);
+        }
+
+        template<class T>
+        inline void lane_sma_update(T *sum, T *ring, const T *in, T *out, const size_t n, const T period) noexcept {
+            get_kernels<T>().lane_sma_update(sum, ring, in, out, n, period);
+        }
+
+        template<class T>
+        inline void lane_sma_test(const T *sum, const T *ring, const T *in, T *out, const size_t n, const T period) noexcept {
+            get_kernels<T>().lane_sma_test(sum, ring, in, out, n, period);
+        }
+
+        template<class T>
+        inline void lane_ema_update(T *last, const T *in, T *out, const size_t n, const T a) noexcept {
+            get_kernels<T>().lane_ema_update(last, in, out, n, a);
+        }
+
+        template<class T>
+        inline void lane_ema_test(const T *last, const T *in, T *out, const size_t n, const T a) noexcept {
+            get_kernels<T>().lane_ema_test(last, in, out, n, a);
+        }
+
+        /** \brief Шаг EMA с разными коэффициентами сглаживания
+         *
+         * Все элементы получают одно значение in, а элемент i
+         * сглаживается с коэффициентом a[i]
+         */
+        template<class T>
+        inline void lane_ema_alpha(T *last, const T *a, const T in, T *out, const size_t n) noexcept {
+            get_kernels<T>().lane_ema_alpha(last, a, in, out, n);
+        }
+
+        template<class T>
+        inline void lane_sq_dev(T *acc, const T *x, const T *mean, const size_t n) noexcept {
+            get_kernels<T>().lane_sq_dev(acc, x, mean, n);
+        }
+
+        template<class T>
+        inline void lane_true_range(const T *high, const T *low, const T *close, T *out, const size_t n) noexcept {
+            get_kernels<T>().lane_true_range(high, low, close, out, n);
+        }
+
+        template<class T>
+        inline void lane_abs_diff(const T *in, const T *last, T *out, const size_t n) noexcept {
+            get_kernels<T>().lane_abs_diff(in, last, out, n);
+        }
+
+        template<class T>
+        inline void lane_rsi_split(const T *in, const T *prev, T *u, T *d, const size_t n) noexcept {
+            get_kernels<T>().lane_rsi_split(in, prev, u, d, n);
+        }
+
+        template<class T>
+        inline void lane_rsi(const T *u, const T *d, T *out, const size_t n) noexcept {
+            get_kernels<T>().lane_rsi(u, d, out, n);
+        }
+
+    }; // simd
+}; // xtechnical
+
+#endif // XTECHNICAL_SIMD_HPP_INCLUDED
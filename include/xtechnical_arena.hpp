@@ -0,0 +1,223 @@
+#ifndef XTECHNICAL_ARENA_HPP_INCLUDED
+#define XTECHNICAL_ARENA_HPP_INCLUDED
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <type_traits>
+
+namespace xtechnical {
+
+    /** \brief Арена для данных индикаторов
+     *
+     * Память выделяется последовательно из крупных блоков и не освобождается
+     * поштучно, поэтому индикаторы, пересоздаваемые в цикле, увеличивают
+     * арену до вызова clear. Буферы индикаторов одной стратегии или символа
+     * лежат рядом в памяти, а их создание не требует отдельного обращения
+     * к куче для каждого буфера.
+     * Метод clear освобождает память всех объектов арены сразу
+     * и позволяет переиспользовать блоки, но не сбрасывает сами индикаторы:
+     * до вызова clear все они должны быть уничтожены.
+     * Арена должна существовать дольше всех индикаторов, созданных в ней.
+     *
+     * Арена используется только по запросу: через аллокатор ArenaAllocator,
+     * например в arena_circular_buffer. Буферы индикаторов всегда берут
+     * память из кучи.
+     */
+    class Arena {
+    private:
+
+        class Block {
+        public:
+            std::unique_ptr<char[]> data;
+            size_t size = 0;
+        };
+
+        std::vector<Block> blocks;
+        size_t block_size = 0;
+        size_t index = 0;       /**< Индекс текущего блока */
+        size_t offset = 0;      /**< Смещение в текущем блоке */
+        size_t used = 0;        /**< Выделено байт с момента последнего сброса */
+
+        static inline size_t align_up(const size_t value, const size_t alignment) noexcept {
+            return (value + alignment - 1) & ~(alignment - 1);
+        }
+
+        /** \brief Попробовать разместить данные в блоке
+         */
+        inline void *place(Block &block, const size_t size, const size_t alignment) noexcept {
+            const uintptr_t base = reinterpret_cast<uintptr_t>(block.data.get());
+            const size_t start = align_up(base + offset, alignment) - base;
+            if (start + size > block.size) return nullptr;
+            offset = start + size;
+            return block.data.get() + start;
+        }
+
+    public:
+
+        /** \brief Конструктор арены
+         * \param bs    Размер блока в байтах
+         */
+        Arena(const size_t bs = 64 * 1024) : block_size(std::max(bs, (size_t)64)) {};
+
+        Arena(const Arena &) = delete;
+        Arena &operator=(const Arena &) = delete;
+
+        /** \brief Выделить память
+         * \param size      Размер в байтах
+         * \param alignment Выравнивание, степень двойки
+         * \return Указатель на память
+         */
+        void *allocate(const size_t size, const size_t alignment = alignof(std::max_align_t)) {
+            used += size;
+            while (index < blocks.size()) {
+                void *ptr = place(blocks[index], size, alignment);
+                if (ptr != nullptr) return ptr;
+                ++index;
+                offset = 0;
+            }
+            Block block;
+            block.size = std::max(block_size, size + alignment);
+            block.data.reset(new char[block.size]);
+            blocks.push_back(std::move(block));
+            index = blocks.size() - 1;
+            offset = 0;
+            return place(blocks.back(), size, alignment);
+        }
+
+        /** \brief Сбросить арену
+         *
+         * Все индикаторы, созданные в арене, должны быть уничтожены
+         * или больше не использоваться. Блоки памяти сохраняются
+         * для повторного использования.
+         */
+        inline void clear() noexcept {
+            index = 0;
+            offset = 0;
+            used = 0;
+        }
+
+        /** \brief Освободить все блоки памяти
+         */
+        inline void release() noexcept {
+            blocks.clear();
+            clear();
+        }
+
+        /** \brief Получить число выделенных байт с момента последнего сброса
+         */
+        inline size_t size() const noexcept {
+            return used;
+        }
+
+        /** \brief Получить объем памяти, занимаемый блоками арены
+         */
+        inline size_t memory_usage() const noexcept {
+            size_t sum = sizeof(*this);
+            for (const auto &block : blocks) sum += block.size;
+            return sum;
+        }
+
+        /** \brief Проверить, принадлежит ли указатель арене
+         */
+        inline bool contains(const void *ptr) const noexcept {
+            const char *p = static_cast<const char*>(ptr);
+            for (const auto &block : blocks) {
+                if (p >= block.data.get() && p < block.data.get() + block.size) return true;
+            }
+            return false;
+        }
+
+        /** \brief Арена текущего контекста создания индикаторов
+         * \return Ссылка на указатель арены текущего потока или nullptr
+         */
+        static inline Arena *&current() noexcept {
+            static thread_local Arena *arena = nullptr;
+            return arena;
+        }
+    };
+
+    /** \brief Контекст создания индикаторов в арене
+     *
+     * Пока объект существует, аллокаторы ArenaAllocator, созданные в этом потоке
+     * без явного указания арены, берут память из указанной арены.
+     * Контексты можно вкладывать.
+     *
+     * Пример:
+     * \code
+     * xtechnical::Arena arena;
+     * std::vector<xtechnical::arena_circular_buffer<double>> windows;
+     * {
+     *     xtechnical::ArenaScope scope(arena);
+     *     for (size_t p = 2; p < 100; ++p) windows.emplace_back(p);
+     * }
+     * \endcode
+     */
+    class ArenaScope {
+    private:
+        Arena *prev;
+    public:
+
+        explicit ArenaScope(Arena &arena) noexcept : prev(Arena::current()) {
+            Arena::current() = &arena;
+        }
+
+        ~ArenaScope() {
+            Arena::current() = prev;
+        }
+
+        ArenaScope(const ArenaScope &) = delete;
+        ArenaScope &operator=(const ArenaScope &) = delete;
+    };
+
+    /** \brief Аллокатор, берущий память из арены контекста создания
+     *
+     * Арена запоминается при создании аллокатора. Если контекста нет,
+     * память выделяется из кучи, как у std::allocator.
+     * Копия контейнера получает арену текущего контекста.
+     */
+    template<class T>
+    class ArenaAllocator {
+    public:
+        typedef T value_type;
+        typedef std::true_type propagate_on_container_move_assignment;
+        typedef std::true_type propagate_on_container_swap;
+
+        Arena *arena;
+
+        ArenaAllocator() noexcept : arena(Arena::current()) {};
+
+        explicit ArenaAllocator(Arena *a) noexcept : arena(a) {};
+
+        template<class U>
+        ArenaAllocator(const ArenaAllocator<U> &other) noexcept : arena(other.arena) {};
+
+        inline T *allocate(const size_t n) {
+            if (arena == nullptr) return static_cast<T*>(::operator new(n * sizeof(T)));
+            return static_cast<T*>(arena->allocate(n * sizeof(T), std::max(alignof(T), alignof(std::max_align_t))));
+        }
+
+        inline void deallocate(T *ptr, const size_t) noexcept {
+            if (arena == nullptr) ::operator delete(ptr);
+        }
+
+        inline ArenaAllocator select_on_container_copy_construction() const noexcept {
+            return ArenaAllocator();
+        }
+    };
+
+    template<class T, class U>
+    inline bool operator==(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) noexcept {
+        return a.arena == b.arena;
+    }
+
+    template<class T, class U>
+    inline bool operator!=(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) noexcept {
+        return a.arena != b.arena;
+    }
+
+}; // xtechnical
+
+#endif // XTECHNICAL_ARENA_HPP_INCLUDED
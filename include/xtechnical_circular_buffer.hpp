@@ -2,109 +2,297 @@
 #define XTECHNICAL_CIRCULAR_BUFFER_HPP_INCLUDED
 
 #include <vector>
+#include <array>
+#include <algorithm>
+#include <iterator>
+#include <cstdint>
+#include <type_traits>
+#include "math/xtechnical_simd.hpp"
+#include "xtechnical_arena.hpp"
 
 namespace xtechnical {
-    /** \brief Класс циклического буфера
+    /** \brief Окно циклического буфера без копирования
+     *
+     * Окно представлено не более чем двумя непрерывными участками памяти:
+     * first содержит более старые элементы, second - более новые.
+     * Представление не владеет данными и действительно до следующего
+     * изменения буфера. Суммы, скалярное произведение и экстремумы
+     * для float и double считаются векторными ядрами xtechnical::simd,
+     * накопление выполняется в double.
      */
     template<class T>
+    class circular_buffer_view {
+    private:
+
+        typedef std::integral_constant<bool,
+            std::is_same<T, double>::value ||
+            std::is_same<T, float>::value> is_simd;
+
+        /** \brief Найти непрерывный участок, начинающийся с элемента index
+         */
+        inline const T *locate(const size_t index, size_t &length) const noexcept {
+            if (index < first_size) {
+                length = first_size - index;
+                return first + index;
+            }
+            length = second_size - (index - first_size);
+            return second + (index - first_size);
+        }
+
+        static inline double part_sum(const T *x, const size_t n, std::true_type) noexcept {
+            return simd::sum(x, n);
+        }
+
+        static inline double part_sum(const T *x, const size_t n, std::false_type) noexcept {
+            double s = 0;
+            for (size_t i = 0; i < n; ++i) s += x[i];
+            return s;
+        }
+
+        static inline double part_sum_sq(const T *x, const size_t n, std::true_type) noexcept {
+            return simd::sum_sq(x, n);
+        }
+
+        static inline double part_sum_sq(const T *x, const size_t n, std::false_type) noexcept {
+            double s = 0;
+            for (size_t i = 0; i < n; ++i) s += (double)x[i] * (double)x[i];
+            return s;
+        }
+
+        static inline double part_sum_sq_dev(const T *x, const size_t n, const double mean, std::true_type) noexcept {
+            return simd::sum_sq_dev(x, n, mean);
+        }
+
+        static inline double part_sum_sq_dev(const T *x, const size_t n, const double mean, std::false_type) noexcept {
+            double s = 0;
+            for (size_t i = 0; i < n; ++i) {
+                const double d = x[i] - mean;
+                s += d * d;
+            }
+            return s;
+        }
+
+        static inline double part_dot(const T *x, const T *y, const size_t n, std::true_type) noexcept {
+            return simd::dot(x, y, n);
+        }
+
+        static inline double part_dot(const T *x, const T *y, const size_t n, std::false_type) noexcept {
+            double s = 0;
+            for (size_t i = 0; i < n; ++i) s += (double)x[i] * (double)y[i];
+            return s;
+        }
+
+        static inline void part_min_max(const T *x, const size_t n, T &min_value, T &max_value, std::true_type) noexcept {
+            simd::min_max(x, n, min_value, max_value);
+        }
+
+        static inline void part_min_max(const T *x, const size_t n, T &min_value, T &max_value, std::false_type) noexcept {
+            T mn = x[0], mx = x[0];
+            for (size_t i = 1; i < n; ++i) {
+                mn = std::min(mn, x[i]);
+                mx = std::max(mx, x[i]);
+            }
+            min_value = mn;
+            max_value = mx;
+        }
+
+    public:
+
+        const T *first = nullptr;   /**< Начало участка со старыми элементами */
+        size_t first_size = 0;      /**< Длина первого участка */
+        const T *second = nullptr;  /**< Начало участка с новыми элементами */
+        size_t second_size = 0;     /**< Длина второго участка */
+
+        circular_buffer_view() {};
+
+        circular_buffer_view(const T *f, const size_t fs, const T *s, const size_t ss) :
+            first(f), first_size(fs), second(s), second_size(ss) {};
+
+        inline size_t size() const noexcept {
+            return first_size + second_size;
+        }
+
+        inline bool empty() const noexcept {
+            return size() == 0;
+        }
+
+        inline const T &operator[](const size_t index) const noexcept {
+            return index < first_size ? first[index] : second[index - first_size];
+        }
+
+        /** \brief Вызвать функцию для каждого элемента окна, от старого к новому
+         * \param f    Функция вида f(const T &value)
+         */
+        template<class F>
+        inline void for_each(F f) const {
+            for (size_t i = 0; i < first_size; ++i) f(first[i]);
+            for (size_t i = 0; i < second_size; ++i) f(second[i]);
+        }
+
+        /** \brief Сумма элементов окна
+         */
+        inline double sum() const noexcept {
+            return part_sum(first, first_size, is_simd()) + part_sum(second, second_size, is_simd());
+        }
+
+        /** \brief Сумма квадратов элементов окна
+         */
+        inline double sum_sq() const noexcept {
+            return part_sum_sq(first, first_size, is_simd()) + part_sum_sq(second, second_size, is_simd());
+        }
+
+        /** \brief Сумма квадратов отклонений элементов окна от mean
+         */
+        inline double sum_sq_dev(const double mean) const noexcept {
+            return
+                part_sum_sq_dev(first, first_size, mean, is_simd()) +
+                part_sum_sq_dev(second, second_size, mean, is_simd());
+        }
+
+        /** \brief Скалярное произведение двух окон
+         *
+         * Участки окон могут делиться в разных местах,
+         * поэтому произведение считается не более чем по трем кускам
+         * \param other    Второе окно
+         * \return Сумма произведений по длине меньшего окна
+         */
+        double dot(const circular_buffer_view &other) const noexcept {
+            const size_t n = std::min(size(), other.size());
+            double s = 0;
+            size_t index = 0;
+            while (index < n) {
+                size_t x_length = 0, y_length = 0;
+                const T *x = locate(index, x_length);
+                const T *y = other.locate(index, y_length);
+                const size_t length = std::min(std::min(x_length, y_length), n - index);
+                s += part_dot(x, y, length, is_simd());
+                index += length;
+            }
+            return s;
+        }
+
+        /** \brief Найти минимум и максимум окна
+         * \param min_value    Минимальное значение
+         * \param max_value    Максимальное значение
+         * \return Вернет false, если окно пустое
+         */
+        bool min_max(T &min_value, T &max_value) const noexcept {
+            if (first_size == 0 && second_size == 0) return false;
+            if (first_size == 0) {
+                part_min_max(second, second_size, min_value, max_value, is_simd());
+                return true;
+            }
+            part_min_max(first, first_size, min_value, max_value, is_simd());
+            if (second_size == 0) return true;
+            T mn = min_value, mx = max_value;
+            part_min_max(second, second_size, mn, mx, is_simd());
+            min_value = std::min(min_value, mn);
+            max_value = std::max(max_value, mx);
+            return true;
+        }
+
+        inline T min() const noexcept {
+            T mn = 0, mx = 0;
+            min_max(mn, mx);
+            return mn;
+        }
+
+        inline T max() const noexcept {
+            T mn = 0, mx = 0;
+            min_max(mn, mx);
+            return mx;
+        }
+    };
+
+    /** \brief Класс циклического буфера
+     *
+     * Буфер хранит ровно столько элементов, сколько задано в конструкторе,
+     * без округления до степени двойки. Переход через границу массива
+     * выполняется сравнением и вычитанием без ветвлений. Метод test не
+     * использует отдельный буфер: тестовое значение пишется в ячейку,
+     * которую займет следующий update, а смещение и число элементов
+     * в режиме теста вычисляются на лету.
+     *
+     * Память берется через аллокатор A, по умолчанию std::allocator.
+     * Чтобы разместить буфер в арене, используйте arena_circular_buffer.
+     */
+    template<class T, class A = std::allocator<T>>
     class circular_buffer {
     private:
-	
-        std::vector<T> buffer;      /**< Основной буфер */
-        std::vector<T> buffer_test; /**< Буфер для теста */
-        uint32_t buffer_size;       /**< Размер буфера */
-        uint32_t buffer_size_div2;  /**< Индекс середины массива */
-        uint32_t buffer_offset;     /**< Смещение в буфере для размера массива не кратного степени двойки */
-        uint32_t count;             /**< Количество элементов в буфере */
-        uint32_t count_test;        /**< Количество элементов в буфере для теста */
-        uint32_t offset;            /**< Смещение в буфере */
-        uint32_t offset_test;
-        uint32_t mask;              /**< Маска */
-        bool is_power_of_two;       /**< Флаг степени двойки */
+
+        std::vector<T, A> buffer;   /**< Основной буфер */
+        size_t buffer_size;         /**< Размер буфера */
+        size_t buffer_size_div2;    /**< Индекс середины массива */
+        size_t offset;              /**< Смещение в буфере */
+        uint64_t count;             /**< Количество элементов в буфере */
         bool is_test;               /**< Флаг теста */
 
-        inline const uint32_t cpl2(uint32_t x) const {
-            x = x - 1;
-            x = x | (x >> 1);
-            x = x | (x >> 2);
-            x = x | (x >> 4);
-            x = x | (x >> 8);
-            x = x | (x >> 16);
-            return x + 1;
+        /** \brief Перенести индекс из диапазона [0, 2 * buffer_size) в [0, buffer_size)
+         */
+        inline size_t wrap(const size_t index) const noexcept {
+            return index - (index >= buffer_size ? buffer_size : 0);
+        }
+
+        inline size_t get_offset() const noexcept {
+            return is_test ? wrap(offset + 1) : offset;
         }
 
-        inline const bool check_power_of_two(const uint32_t value) const {
-            return value && !(value & (value - 1));
+        inline uint64_t get_count() const noexcept {
+            return is_test ? std::min(count + 1, (uint64_t)buffer_size) : count;
         }
-		
+
     public:
-	
+
         typedef T value_t;
 
         /** \brief Конструктор циклического буфера
          */
         circular_buffer() :
-            buffer_size(0), buffer_size_div2(0), buffer_offset(0),
-            count(0), count_test(0), offset(0), offset_test(0), mask(0),
-            is_power_of_two(false), is_test(false) {};
+            buffer_size(0), buffer_size_div2(0),
+            offset(0), count(0), is_test(false) {};
 
         /** \brief Конструктор циклического буфера
          * \param user_size Размер циклического буфера
+         * \param alloc     Аллокатор
          */
-        circular_buffer(const size_t user_size) :
-                buffer_size(user_size), buffer_size_div2(0), buffer_offset(0),
-                count(0), count_test(0), offset(0), offset_test(0),
-                is_power_of_two(false), is_test(false) {
-            if(check_power_of_two(user_size)) {
-                buffer.resize(buffer_size);
-                buffer_test.resize(buffer_size);
-                mask = user_size - 1;
-                is_power_of_two = true;
-            } else {
-                const size_t new_size = cpl2(buffer_size);
-                buffer.resize(new_size);
-                buffer_test.resize(new_size);
-                mask = new_size - 1;
-                buffer_offset = buffer_size - new_size;
-                is_power_of_two = false;
-            }
-            buffer_size_div2 = buffer_size / 2;
+        circular_buffer(const size_t user_size, const A &alloc = A()) :
+                buffer(user_size, T(), alloc), buffer_size(user_size),
+                buffer_size_div2(user_size / 2),
+                offset(0), count(0), is_test(false) {
         };
 
         /** \brief Добавить значение в циклический буфер
          * \param value Значение
          */
         inline void push_back(const T value) {
-            buffer[offset++] = value;
-            if(offset > count) count = offset;
-            offset &= mask;
+            buffer[offset] = value;
+            offset = wrap(offset + 1);
+            if(count < buffer_size) ++count;
         }
 
         /** \brief Получить размер циклического буфера
          * \return Размер циклического буфера. Может быть меньше максимального, если буфер еще не заполнился.
          */
         inline size_t size() const {
-            return is_test ? std::min((size_t)count_test, (size_t)buffer_size) : std::min((size_t)count, (size_t)buffer_size);
+            return (size_t)get_count();
         }
 
         /** \brief Проверить, если циклическй буфер пуст
          * \return Вернет true, если циклическй буфер пуст
          */
         inline bool empty() const {
-            return is_test ? (count_test == 0) : (count == 0);
+            return get_count() == 0;
         }
 
         /** \brief Проверить, если циклическй буфер полн
          * \return Вернет true, если циклическй буфер полн
          */
         inline bool full() const {
-            if(is_test) return (count_test >= buffer_size);
-            return (count >= buffer_size);
+            return get_count() >= buffer_size;
         }
 
         void fill(const T value) {
-            if(is_test) std::fill(buffer_test.begin(), buffer_test.end(), value);
-            else std::fill(buffer.begin(), buffer.end(), value);
+            std::fill(buffer.begin(), buffer.end(), value);
         }
 
         /** \brief Обновить состояние циклического буфера
@@ -121,134 +309,83 @@ namespace xtechnical {
          * \param value Новое значение
          * \return Вернет true, если циклическй буфер полн
          */
-        inline bool test(const double value) {
-            if(!is_test) {
-                is_test = true;
-                buffer_test = buffer;
-                offset_test = offset;
-                count_test = count;
-                buffer_test[offset_test++] = value;
-                if(offset_test > count_test) count_test = offset_test;
-                offset_test &= mask;
-            } else {
-                buffer_test[(offset_test - 1) & mask] = value;
-            }
+        inline bool test(const T value) {
+            is_test = true;
+            buffer[offset] = value;
             return full();
         }
 
         /** \brief Получить значение циклического буфера по индексу
-         * \param index Индекс
+         * \param index Индекс, меньше размера буфера
          * \return Значение циклического буфера
          */
-        inline T &get(const uint32_t index) {
-            if(is_test) return buffer_test[(offset_test + (is_power_of_two ? index : (index - buffer_offset))) & mask];
-            return buffer[(offset + (is_power_of_two ? index : (index - buffer_offset))) & mask];
+        inline T &get(const size_t index) {
+            return buffer[wrap(get_offset() + index)];
         }
 
         /** \brief Получить значение циклического буфера по индексу
-         * \param index Индекс
+         * \param index Индекс, меньше размера буфера
          * \return Значение циклического буфера
          */
         T& operator[](std::size_t index) {
-            if(is_test) return buffer_test[(offset_test + (is_power_of_two ? index : (index - buffer_offset))) & mask];
-            return buffer[(offset + (is_power_of_two ? index : (index - buffer_offset))) & mask];
+            return buffer[wrap(get_offset() + index)];
         }
 
         /** \brief Получить значение циклического буфера по индексу
-         * \param index Индекс
+         * \param index Индекс, меньше размера буфера
          * \return Значение циклического буфера
          */
         const T& operator[](std::size_t index) const {
-            if(is_test) return buffer_test[(offset_test + (is_power_of_two ? index : (index - buffer_offset))) & mask];
-            return buffer[(offset + (is_power_of_two ? index : (index - buffer_offset))) & mask];
+            return buffer[wrap(get_offset() + index)];
         }
 
         /** \brief Доступ к первому элементу
          * \return Возвращает ссылку на первый элемент циклического буфера
          */
         inline T &front() {
-            if(is_test) return buffer_test[(offset_test - (is_power_of_two ? 0 : buffer_offset)) & mask];
-            return buffer[(offset - (is_power_of_two ? 0 : buffer_offset)) & mask];
+            return buffer[get_offset()];
         }
 
         /** \brief Доступ к первому элементу
          * \return Возвращает ссылку на первый элемент циклического буфера
          */
         inline const T &front() const {
-            if(is_test) return buffer_test[(offset_test - (is_power_of_two ? 0 : buffer_offset)) & mask];
-            return buffer[(offset - (is_power_of_two ? 0 : buffer_offset)) & mask];
+            return buffer[get_offset()];
         }
 
         /** \brief Доступ к последнему элементу
          * \return Возвращает ссылку на первый элемент циклического буфера
          */
         inline T &back() {
-            if(is_test) return buffer_test[(offset_test - 1) & mask];
-            return buffer[(offset - 1) & mask];
+            return buffer[wrap(get_offset() + buffer_size - 1)];
         }
 
         /** \brief Доступ к последнему элементу
          * \return Возвращает ссылку на первый элемент циклического буфера
          */
         inline const T &back() const {
-            if(is_test) return buffer_test[(offset_test - 1) & mask];
-            return buffer[(offset - 1) & mask];
+            return buffer[wrap(get_offset() + buffer_size - 1)];
         }
 
         /** \brief Доступ к среднему элементу
          * \return Возвращает ссылку на первый элемент циклического буфера
          */
         inline T &middle() {
-            if(is_test) {
-                if(full()) return buffer_test[(offset_test + (is_power_of_two ? buffer_size_div2 : buffer_size_div2 - buffer_offset)) & mask];
-                else return buffer_test[(offset_test + (is_power_of_two ? (count_test/2) : (count_test/2) - buffer_offset)) & mask];
-            }
-            if(full()) return buffer[(offset + (is_power_of_two ? buffer_size_div2 : buffer_size_div2 - buffer_offset)) & mask];
-            else return buffer[(offset + (is_power_of_two ? (count/2) : (count/2) - buffer_offset)) & mask];
+            return (*this)[full() ? buffer_size_div2 : (size_t)(get_count() / 2)];
         }
 
         /** \brief Доступ к среднему элементу
          * \return Возвращает ссылку на первый элемент циклического буфера
          */
         inline const T &middle() const {
-            if(is_test) {
-                if(full()) return buffer_test[(offset_test + (is_power_of_two ? buffer_size_div2 : buffer_size_div2 - buffer_offset)) & mask];
-                return buffer_test[(offset_test + (is_power_of_two ? (count_test/2) : (count_test/2) - buffer_offset)) & mask];
-            }
-            if(full()) return buffer[(offset + (is_power_of_two ? buffer_size_div2 : buffer_size_div2 - buffer_offset)) & mask];
-            return buffer[(offset + (is_power_of_two ? (count/2) : (count/2) - buffer_offset)) & mask];
+            return (*this)[full() ? buffer_size_div2 : (size_t)(get_count() / 2)];
         }
 
         /** \brief Получить сумму
          * \return Возвращает сумму элементов циклического буфера
          */
         inline const T sum() const {
-            T temp = 0;
-            if(is_test) {
-                if(is_power_of_two) {
-                    for(uint32_t index = 0; index < buffer_size; ++index) {
-                        temp += buffer_test[(offset_test + index) & mask];
-                    }
-                    return temp;
-                } else {
-                    for(uint32_t index = 0; index < buffer_size; ++index) {
-                        temp += buffer_test[(offset_test + (index - buffer_offset)) & mask];
-                    }
-                    return temp;
-                }
-            } else {
-                if(is_power_of_two) {
-                    for(uint32_t index = 0; index < buffer_size; ++index) {
-                        temp += buffer[(offset + index) & mask];
-                    }
-                    return temp;
-                } else {
-                    for(uint32_t index = 0; index < buffer_size; ++index) {
-                        temp += buffer[(offset + (index - buffer_offset)) & mask];
-                    }
-                    return temp;
-                }
-            }
+            return sum(0, buffer_size);
         }
 
         /** \brief Получить сумму
@@ -256,33 +393,19 @@ namespace xtechnical {
          * \param stop_index Конечный индекс
          * \return Возвращает сумму элементов циклического буфера
          */
-        inline const T sum(const uint32_t start_index, const uint32_t stop_index) const {
+        inline const T sum(const size_t start_index, const size_t stop_index) const {
             T temp = 0;
-            if(is_test) {
-                if(is_power_of_two) {
-                    for(uint32_t index = start_index; index < stop_index; ++index) {
-                        temp += buffer_test[(offset_test + index) & mask];
-                    }
-                    return temp;
-                } else {
-                    for(uint32_t index = start_index; index < stop_index; ++index) {
-                        temp += buffer_test[(offset_test + (index - buffer_offset)) & mask];
-                    }
-                    return temp;
-                }
-            } else {
-                if(is_power_of_two) {
-                    for(uint32_t index = start_index; index < stop_index; ++index) {
-                        temp += buffer[(offset + index) & mask];
-                    }
-                    return temp;
-                } else {
-                    for(uint32_t index = start_index; index < stop_index; ++index) {
-                        temp += buffer[(offset + (index - buffer_offset)) & mask];
-                    }
-                    return temp;
-                }
+            if(start_index >= stop_index) return temp;
+            const size_t start_pos = wrap(get_offset() + start_index);
+            const size_t length = stop_index - start_index;
+            const size_t head = std::min(length, buffer_size - start_pos);
+            for(size_t index = 0; index < head; ++index) {
+                temp += buffer[start_pos + index];
             }
+            for(size_t index = 0; index < (length - head); ++index) {
+                temp += buffer[index];
+            }
+            return temp;
         }
 
         /** \brief Получить среднее значение
@@ -292,60 +415,316 @@ namespace xtechnical {
             return sum() / (T)buffer_size;
         }
 
+        /** \brief Получить окно буфера без копирования
+         *
+         * Окно содержит те же элементы и в том же порядке, что и to_vector()
+         * \return Окно из не более чем двух непрерывных участков
+         */
+        inline circular_buffer_view<T> view() const noexcept {
+            return view(0, buffer_size);
+        }
+
+        /** \brief Получить часть окна буфера без копирования
+         * \param start_index Начальный индекс
+         * \param stop_index Конечный индекс, не больше размера буфера
+         * \return Окно элементов с индексами от start_index до stop_index - 1
+         */
+        inline circular_buffer_view<T> view(const size_t start_index, const size_t stop_index) const noexcept {
+            if(start_index >= stop_index) return circular_buffer_view<T>();
+            const size_t start_pos = wrap(get_offset() + start_index);
+            const size_t length = stop_index - start_index;
+            const size_t head = std::min(length, buffer_size - start_pos);
+            return circular_buffer_view<T>(buffer.data() + start_pos, head, buffer.data(), length - head);
+        }
+
         /** \brief Преобразовать к вектору
          * \return Вектор
          */
         std::vector<T> to_vector() {
             std::vector<T> temp;
             temp.reserve(buffer_size);
-            const uint32_t max_index = buffer_size - 1;
-            if(is_test) {
-                uint32_t start_index = 0;
-                uint32_t stop_index = 0;
-                if(is_power_of_two) {
-                    start_index = (offset_test) & mask;
-                    stop_index = (offset_test + max_index) & mask;
-                } else {
-                    start_index = (offset_test - buffer_offset) & mask;
-                    stop_index = (offset_test + (max_index - buffer_offset)) & mask;
-                }
-                if(start_index > stop_index) {
-                    std::copy(buffer_test.begin() + start_index, buffer_test.end(), std::back_inserter(temp));
-                    std::copy(buffer_test.begin(), buffer_test.begin() + stop_index + 1, std::back_inserter(temp));
-                } else {
-                    std::copy(buffer_test.begin() + start_index, buffer_test.begin() + stop_index + 1, std::back_inserter(temp));
-                }
-            } else {
-                uint32_t start_index = 0;
-                uint32_t stop_index = 0;
-                if(is_power_of_two) {
-                    start_index = offset & mask;
-                    stop_index = (offset + max_index) & mask;
-                } else {
-                    start_index = (offset- buffer_offset) & mask;
-                    stop_index = (offset + (max_index - buffer_offset)) & mask;
-                }
-                if(start_index > stop_index) {
-                    std::copy(buffer.begin() + start_index, buffer.end(), std::back_inserter(temp));
-                    std::copy(buffer.begin(), buffer.begin() + stop_index + 1, std::back_inserter(temp));
-                } else {
-                    std::copy(buffer.begin() + start_index, buffer.begin() + stop_index + 1, std::back_inserter(temp));
-                }
-            }
-            return std::move(temp);
+            const size_t start_index = get_offset();
+            std::copy(buffer.begin() + start_index, buffer.end(), std::back_inserter(temp));
+            std::copy(buffer.begin(), buffer.begin() + start_index, std::back_inserter(temp));
+            return temp;
+        }
+
+        /** \brief Получить объем памяти, занимаемый буфером
+         * \return Размер объекта и его данных в байтах
+         */
+        inline size_t memory_usage() const noexcept {
+            return sizeof(*this) + buffer.capacity() * sizeof(T);
         }
 
         /** \brief Очистить данные циклического буфера
          */
         inline void clear() {
             count = 0;
-            count_test = 0;
             offset = 0;
-            offset_test = 0;
             is_test = false;
             //fill(0);
         }
     };
+
+    /** \brief Циклический буфер в арене
+     *
+     * Буфер, созданный внутри ArenaScope, берет память из арены контекста,
+     * иначе арену можно передать явно: arena_circular_buffer<T>(n, ArenaAllocator<T>(&arena)).
+     * Буфер хранит указатель на арену и не должен ее пережить.
+     */
+    template<class T>
+    using arena_circular_buffer = circular_buffer<T, ArenaAllocator<T>>;
+
+    /** \brief Циклический буфер с размером, заданным на этапе компиляции
+     *
+     * Повторяет поведение circular_buffer, но хранит данные в std::array,
+     * размер которого округлен до степени двойки, поэтому маска и смещение
+     * индексов - константы. Метод test не копирует буфер: тестовое значение
+     * пишется в ячейку, которую займет следующий update.
+     */
+    template<class T, size_t N>
+    class fixed_circular_buffer {
+    private:
+
+        static constexpr size_t cpl2(const size_t x, const size_t p = 1) {
+            return p >= x ? p : cpl2(x, p * 2);
+        }
+
+        static constexpr size_t CAPACITY = cpl2(N);
+        static constexpr size_t MASK = CAPACITY - 1;
+        static constexpr size_t SHIFT = CAPACITY - N;   /**< Смещение индекса первого элемента окна */
+
+        static_assert(N > 0, "fixed_circular_buffer size must be greater than zero");
+
+        std::array<T, CAPACITY> buffer;
+        size_t offset = 0;
+        size_t count = 0;
+        bool is_test = false;
+
+        inline size_t get_offset() const noexcept {
+            return is_test ? ((offset + 1) & MASK) : offset;
+        }
+
+        inline size_t get_count() const noexcept {
+            return is_test ? std::min(count + 1, N) : count;
+        }
+
+    public:
+
+        typedef T value_t;
+
+        fixed_circular_buffer() {
+            buffer.fill(0);
+        }
+
+        /** \brief Добавить значение в циклический буфер
+         * \param value Значение
+         */
+        inline void push_back(const T value) noexcept {
+            buffer[offset] = value;
+            offset = (offset + 1) & MASK;
+            if (count < N) ++count;
+        }
+
+        /** \brief Получить размер циклического буфера
+         * \return Размер циклического буфера. Может быть меньше максимального, если буфер еще не заполнился.
+         */
+        inline size_t size() const noexcept {
+            return get_count();
+        }
+
+        inline bool empty() const noexcept {
+            return get_count() == 0;
+        }
+
+        inline bool full() const noexcept {
+            return get_count() >= N;
+        }
+
+        void fill(const T value) noexcept {
+            buffer.fill(value);
+        }
+
+        /** \brief Обновить состояние циклического буфера
+         * \param value Новое значение
+         * \return Вернет true, если циклическй буфер полн
+         */
+        inline bool update(const T value) noexcept {
+            is_test = false;
+            push_back(value);
+            return full();
+        }
+
+        /** \brief Протестировать состояние циклического буфера
+         * \param value Новое значение
+         * \return Вернет true, если циклическй буфер полн
+         */
+        inline bool test(const T value) noexcept {
+            is_test = true;
+            buffer[offset] = value;
+            return full();
+        }
+
+        inline T &operator[](const size_t index) noexcept {
+            return buffer[(get_offset() + index + SHIFT) & MASK];
+        }
+
+        inline const T &operator[](const size_t index) const noexcept {
+            return buffer[(get_offset() + index + SHIFT) & MASK];
+        }
+
+        inline T &get(const size_t index) noexcept {
+            return (*this)[index];
+        }
+
+        inline T &front() noexcept {
+            return buffer[(get_offset() + SHIFT) & MASK];
+        }
+
+        inline const T &front() const noexcept {
+            return buffer[(get_offset() + SHIFT) & MASK];
+        }
+
+        inline T &back() noexcept {
+            return buffer[(get_offset() - 1) & MASK];
+        }
+
+        inline const T &back() const noexcept {
+            return buffer[(get_offset() - 1) & MASK];
+        }
+
+        inline const T &middle() const noexcept {
+            return (*this)[full() ? (N / 2) : (get_count() / 2)];
+        }
+
+        /** \brief Получить сумму
+         * \return Возвращает сумму элементов циклического буфера
+         */
+        inline const T sum() const noexcept {
+            return sum(0, N);
+        }
+
+        /** \brief Получить сумму
+         * \param start_index Начальный индекс
+         * \param stop_index Конечный индекс
+         * \return Возвращает сумму элементов циклического буфера
+         */
+        inline const T sum(const size_t start_index, const size_t stop_index) const noexcept {
+            T temp = 0;
+            const size_t start = get_offset() + SHIFT;
+            for (size_t index = start_index; index < stop_index; ++index) {
+                temp += buffer[(start + index) & MASK];
+            }
+            return temp;
+        }
+
+        inline const T mean() const noexcept {
+            return sum() / (T)N;
+        }
+
+        /** \brief Получить окно буфера без копирования
+         * \return Окно из не более чем двух непрерывных участков
+         */
+        inline circular_buffer_view<T> view() const noexcept {
+            const size_t start_pos = (get_offset() + SHIFT) & MASK;
+            const size_t head = std::min(N, CAPACITY - start_pos);
+            return circular_buffer_view<T>(buffer.data() + start_pos, head, buffer.data(), N - head);
+        }
+
+        std::vector<T> to_vector() const {
+            std::vector<T> temp(N);
+            for (size_t i = 0; i < N; ++i) temp[i] = (*this)[i];
+            return temp;
+        }
+
+        /** \brief Получить объем памяти, занимаемый буфером
+         * \return Размер объекта в байтах
+         */
+        inline size_t memory_usage() const noexcept {
+            return sizeof(*this);
+        }
+
+        /** \brief Очистить данные циклического буфера
+         */
+        inline void clear() noexcept {
+            offset = 0;
+            count = 0;
+            is_test = false;
+        }
+    };
+
+    template<class T, size_t N>
+    constexpr size_t fixed_circular_buffer<T, N>::CAPACITY;
+
+    template<class T, size_t N>
+    constexpr size_t fixed_circular_buffer<T, N>::MASK;
+
+    template<class T, size_t N>
+    constexpr size_t fixed_circular_buffer<T, N>::SHIFT;
+
+    /** \brief Буфер задержки с размером, заданным на этапе компиляции
+     *
+     * Хранит последние N значений и отдает значение, добавленное N обновлений назад.
+     * В отличие от fixed_circular_buffer не имеет состояния test,
+     * поэтому чтение задержанного значения не требует ветвлений.
+     * Используется индикаторами с периодом, заданным на этапе компиляции.
+     */
+    template<class T, size_t N>
+    class fixed_delay_buffer {
+    private:
+
+        static constexpr size_t cpl2(const size_t x, const size_t p = 1) {
+            return p >= x ? p : cpl2(x, p * 2);
+        }
+
+        static constexpr size_t CAPACITY = cpl2(N);
+        static constexpr size_t MASK = CAPACITY - 1;
+
+        static_assert(N > 0, "fixed_delay_buffer size must be greater than zero");
+
+        std::array<T, CAPACITY> buffer;
+        size_t offset = 0;
+        size_t count = 0;
+
+    public:
+
+        fixed_delay_buffer() {
+            buffer.fill(0);
+        }
+
+        /** \brief Проверить, накоплено ли N значений
+         */
+        inline bool ready() const noexcept {
+            return count >= N;
+        }
+
+        /** \brief Получить значение, добавленное N обновлений назад
+         * \return Задержанное значение, имеет смысл только если ready() вернет true
+         */
+        inline const T &lag() const noexcept {
+            return buffer[(offset - N) & MASK];
+        }
+
+        /** \brief Добавить значение
+         * \param value Значение
+         */
+        inline void push(const T value) noexcept {
+            buffer[offset] = value;
+            offset = (offset + 1) & MASK;
+            if (count < N) ++count;
+        }
+
+        inline void clear() noexcept {
+            offset = 0;
+            count = 0;
+        }
+    };
+
+    template<class T, size_t N>
+    constexpr size_t fixed_delay_buffer<T, N>::CAPACITY;
+
+    template<class T, size_t N>
+    constexpr size_t fixed_delay_buffer<T, N>::MASK;
 };
 
 #endif // XTECHNICAL_CIRCULAR_BUFFER_HPP_INCLUDED
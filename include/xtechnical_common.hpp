@@ -34,6 +34,7 @@
 #include <functional>
 #include <numeric>
 #include <cmath>
+#include <cassert>
 
 namespace xtechnical {
     namespace common {
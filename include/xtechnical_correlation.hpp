@@ -25,6 +25,7 @@
 #define XTECHNICAL_CORRELATION_HPP_INCLUDED
 
 #include "xtechnical_common.hpp"
+#include "math/xtechnical_simd.hpp"
 
 #include <vector>
 #include <algorithm>
@@ -48,6 +49,21 @@ namespace xtechnical {
             if(x.size() != y.size() || x.size() == 0) {
                 return common::INVALID_PARAMETER;
             }
+            typedef simd::contiguous_array<std::vector<T1>> x_array_t;
+            if(x_array_t::value && std::is_same<T1, T2>::value) {
+                const typename x_array_t::value_type *px = x_array_t::data(x);
+                const typename x_array_t::value_type *py = (const typename x_array_t::value_type*)y.data();
+                const size_t size = x.size();
+                const double xm = simd::sum(px, size) / (double)size;
+                const double ym = simd::sum(py, size) / (double)size;
+                double sum = 0, sumx2 = 0, sumy2 = 0;
+                simd::cross_moments(px, py, size, xm, ym, sum, sumx2, sumy2);
+                if(sumx2 == 0 || sumy2 == 0) {
+                    return common::INVALID_PARAMETER;
+                }
+                rxy = sum / std::sqrt(sumx2 * sumy2);
+                return common::OK;
+            }
             T1 xm = std::accumulate(x.begin(), x.end(), T1(0));
             T2 ym = std::accumulate(y.begin(), y.end(), T2(0));
             xm /= (T1)x.size();
@@ -46,7 +46,13 @@
 #include "indicators/xtechnical_super_trend.hpp"
 #include "indicators/xtechnical_body_filter.hpp"
 #include "indicators/xtechnical_period_stats.hpp"
+#include "indicators/xtechnical_rolling_moments.hpp"
+#include "indicators/xtechnical_multi_bar_shaper.hpp"
+#include "indicators/xtechnical_rolling_volume_profile.hpp"
+#include "indicators/xtechnical_profile_index.hpp"
+#include "indicators/xtechnical_info_bars.hpp"
 #include "indicators/ssa.hpp"
+#include "indicators/xtechnical_indicator_bank.hpp"
 
 #include <vector>
 #include <deque>
@@ -1387,6 +1393,79 @@ namespace xtechnical {
         }
     };
 
+    /** \brief Скользящая сумма с периодом, заданным на этапе компиляции
+     */
+    template <typename T, size_t N>
+    class FixedSUM {
+    private:
+        T last_data = 0;
+        fixed_delay_buffer<T, (N > 0 ? N : 1)> buffer;
+        T output_value = std::numeric_limits<T>::quiet_NaN();
+    public:
+
+        FixedSUM() {};
+
+        /** \brief Конструктор для совместимости с SUM
+         * \param user_period период, должен совпадать с параметром шаблона N
+         */
+        explicit FixedSUM(const size_t user_period) {
+            assert(user_period == N);
+            (void)user_period;
+        };
+
+        int update(const T in) noexcept {
+            if(N == 0) {
+                output_value = std::numeric_limits<T>::quiet_NaN();
+                return common::NO_INIT;
+            }
+            if(!buffer.ready()) {
+                last_data += in;
+                buffer.push(in);
+                output_value = std::numeric_limits<T>::quiet_NaN();
+                return common::INDICATOR_NOT_READY_TO_WORK;
+            }
+            last_data = last_data + (in - buffer.lag());
+            buffer.push(in);
+            output_value = last_data;
+            return common::OK;
+        }
+
+        int update(const T in, T &out) noexcept {
+            const int err = update(in);
+            out = output_value;
+            return err;
+        }
+
+        int test(const T in) noexcept {
+            if(N == 0) {
+                output_value = std::numeric_limits<T>::quiet_NaN();
+                return common::NO_INIT;
+            }
+            if(!buffer.ready()) {
+                output_value = std::numeric_limits<T>::quiet_NaN();
+                return common::INDICATOR_NOT_READY_TO_WORK;
+            }
+            output_value = (last_data + (in - buffer.lag()));
+            return common::OK;
+        }
+
+        int test(const T in, T &out) noexcept {
+            const int err = test(in);
+            out = output_value;
+            return err;
+        }
+
+        inline T get() const noexcept {
+            return output_value;
+        }
+
+        inline void clear() noexcept {
+            buffer.clear();
+            output_value = std::numeric_limits<T>::quiet_NaN();
+            last_data = 0;
+        }
+    };
+
     /** \brief Взвешенное скользящее среднее
      */
     template <typename T>
@@ -1617,6 +1696,82 @@ namespace xtechnical {
         }
     };
 
+    /** \brief Экспоненциально взвешенное скользящее среднее с периодом, заданным на этапе компиляции
+     *
+     * В отличие от EMA не хранит первые N значений, а накапливает их сумму
+     * в том же порядке, поэтому результат совпадает с EMA
+     */
+    template <class T, size_t N>
+    class FixedEMA {
+    private:
+        T sum = 0;
+        T last_data_ = 0;
+        T a = 2.0/(T)(N + 1.0d);
+        size_t count = 0;
+        T output_value = std::numeric_limits<T>::quiet_NaN();
+    public:
+
+        FixedEMA() {};
+
+        /** \brief Конструктор для совместимости с EMA
+         * \param period период, должен совпадать с параметром шаблона N
+         */
+        explicit FixedEMA(const size_t period) {
+            assert(period == N);
+            (void)period;
+        };
+
+        int update(const T in) noexcept {
+            if(N == 0) {
+                output_value = in;
+                return common::NO_INIT;
+            }
+            if(count < N) {
+                sum += in;
+                if(++count == N) last_data_ = sum / (T)N;
+            } else {
+                last_data_ = a * in + (1.0 - a) * last_data_;
+                output_value = last_data_;
+                return common::OK;
+            }
+            return common::INDICATOR_NOT_READY_TO_WORK;
+        }
+
+        int update(const T in, T &out) noexcept {
+            const int err = update(in);
+            out = output_value;
+            return err;
+        }
+
+        int test(const T &in) noexcept {
+            if(N == 0) {
+                output_value = in;
+                return common::NO_INIT;
+            }
+            if(count == N) {
+                output_value = a * in + (1.0 - a) * last_data_;
+                return common::OK;
+            }
+            return common::INDICATOR_NOT_READY_TO_WORK;
+        }
+
+        int test(const T &in, T &out) noexcept {
+            const int err = test(in);
+            out = output_value;
+            return err;
+        }
+
+        inline T get() const noexcept {
+            return output_value;
+        }
+
+        inline void clear() noexcept {
+            sum = 0;
+            count = 0;
+            output_value = std::numeric_limits<T>::quiet_NaN();
+        }
+    };
+
     /** \brief Модифицированное скользящее среднее
      */
     template <class T>
@@ -1663,22 +1818,13 @@ namespace xtechnical {
             price_buffer.update(input);
             weight_buffer.update(weight);
             if (!weight_buffer.full()) return common::INDICATOR_NOT_READY_TO_WORK;
-            std::vector<T> price_data(price_buffer.to_vector());
-            std::vector<T> weight_data(weight_buffer.to_vector());
-            T sum = 0;
-            T sum_weight = 0;
-            for(size_t i = 0; i < price_data.size(); ++i) {
-                sum += price_data[i] * weight_data[i];
-                sum_weight += weight_data[i];
-            }
+            const circular_buffer_view<T> price_data(price_buffer.view());
+            const circular_buffer_view<T> weight_data(weight_buffer.view());
+            const T sum_weight = weight_data.sum();
             if(sum_weight == 0) {
-                sum = 0;
-                for(size_t i = 0; i < price_data.size(); ++i) {
-                    sum += price_data[i];
-                }
-                output_value = sum / (T)period;
+                output_value = (T)price_data.sum() / (T)period;
             } else {
-                output_value = sum / (sum_weight);
+                output_value = (T)price_data.dot(weight_data) / sum_weight;
             }
             return common::OK;
         }
@@ -1708,22 +1854,13 @@ namespace xtechnical {
             price_buffer.test(input);
             weight_buffer.test(weight);
             if (!weight_buffer.full()) return common::INDICATOR_NOT_READY_TO_WORK;
-            std::vector<T> price_data(price_buffer.to_vector());
-            std::vector<T> weight_data(weight_buffer.to_vector());
-            T sum = 0;
-            T sum_weight = 0;
-            for(size_t i = 0; i < price_data.size(); ++i) {
-                sum += price_data[i] * weight_data[i];
-                sum_weight += weight_data[i];
-            }
+            const circular_buffer_view<T> price_data(price_buffer.view());
+            const circular_buffer_view<T> weight_data(weight_buffer.view());
+            const T sum_weight = weight_data.sum();
             if(sum_weight == 0) {
-                sum = 0;
-                for(size_t i = 0; i < price_data.size(); ++i) {
-                    sum += price_data[i];
-                }
-                output_value = sum / (T)period;
+                output_value = (T)price_data.sum() / (T)period;
             } else {
-                output_value = sum / (sum_weight);
+                output_value = (T)price_data.dot(weight_data) / sum_weight;
             }
             return common::OK;
         }
@@ -1879,11 +2016,11 @@ namespace xtechnical {
             const T diff = percent_diff.get();
             if (!mode_offset) buffer.update(diff);
             if (buffer.full()) {
-                std::vector<T> temp(buffer.to_vector());
+                const circular_buffer_view<T> temp(buffer.view());
                 T counter = 0;
-                for (size_t i = 0; i < temp.size(); ++i) {
-                    if (temp[i] <= diff) counter += 1;
-                }
+                temp.for_each([&](const T value) {
+                    if (value <= diff) counter += 1;
+                });
                 if (mode_offset) buffer.update(diff);
                 if (temp.size() == 0) output_value = 0;
                 else output_value = (counter / (T)temp.size()) * 100;
@@ -1916,11 +2053,11 @@ namespace xtechnical {
             const T diff = percent_diff.get();
             if (!mode_offset) buffer.test(diff);
             if (buffer.full()) {
-                std::vector<T> temp(buffer.to_vector());
+                const circular_buffer_view<T> temp(buffer.view());
                 T counter = 0;
-                for (size_t i = 0; i < temp.size(); ++i) {
-                    if (temp[i] <= diff) counter += 1;
-                }
+                temp.for_each([&](const T value) {
+                    if (value <= diff) counter += 1;
+                });
                 if (mode_offset) buffer.test(diff);
                 if (temp.size() == 0) output_value = 0;
                 else output_value = (counter / (T)temp.size()) * 100;
@@ -2117,11 +2254,12 @@ namespace xtechnical {
             ma.update(in);
             if (!buffer.full()) return common::INDICATOR_NOT_READY_TO_WORK;
             if (std::isnan(ma.get())) return common::INDICATOR_NOT_READY_TO_WORK;
-            std::vector<T> temp(buffer.to_vector());
+            const circular_buffer_view<T> temp(buffer.view());
+            const T mean = ma.get();
             T sum = 0;
-            for (size_t  i = 0; i < temp.size(); ++i) {
-                sum += std::abs(temp[i] - ma.get());
-            }
+            temp.for_each([&](const T value) {
+                sum += std::abs(value - mean);
+            });
             output_value = sum / (T)temp.size();
             return common::OK;
         }
@@ -2137,11 +2275,12 @@ namespace xtechnical {
             ma.test(in);
             if (!buffer.full()) return common::INDICATOR_NOT_READY_TO_WORK;
             if (std::isnan(ma.get())) return common::INDICATOR_NOT_READY_TO_WORK;
-            const std::vector<T> temp(buffer.to_vector());
+            const circular_buffer_view<T> temp(buffer.view());
+            const T mean = ma.get();
             T sum = 0;
-            for (size_t  i = 0; i < temp.size(); ++i) {
-                sum += std::abs(temp[i] - ma.get());
-            }
+            temp.for_each([&](const T value) {
+                sum += std::abs(value - mean);
+            });
             output_value = sum / (T)temp.size();
             return common::OK;
         }
@@ -2318,13 +2457,8 @@ namespace xtechnical {
             buffer.update(delay_line.get());
             ma.update(delay_line.get());
             if(buffer.full() && !std::isnan(ma.get())) {
-                std::vector<T> data = buffer.to_vector();
                 output_ml = ma.get();
-                T sum = 0;
-                for (size_t i = 0; i < period; ++i) {
-                    const T diff = (data[i] - output_ml);
-                    sum += diff * diff;
-                }
+                const T sum = buffer.view().sum_sq_dev(output_ml);
                 output_std_dev = std::sqrt(sum / (T)(period - 1));
                 const T std_dev_offset = output_std_dev * deviations;
                 output_tl = std_dev_offset + output_ml;
@@ -2389,13 +2523,8 @@ namespace xtechnical {
             buffer.test(delay_line.get());
             ma.test(delay_line.get());
             if(buffer.full() && !std::isnan(ma.get())) {
-                std::vector<T> data = buffer.to_vector();
                 output_ml = ma.get();
-                T sum = 0;
-                for (size_t i = 0; i < period; ++i) {
-                    const T diff = (data[i] - output_ml);
-                    sum += diff * diff;
-                }
+                const T sum = buffer.view().sum_sq_dev(output_ml);
                 output_std_dev = std::sqrt(sum / (T)(period - 1));
                 const T std_dev_offset = output_std_dev * deviations;
                 output_tl = std_dev_offset + output_ml;
@@ -3710,8 +3839,8 @@ namespace xtechnical {
 	template<class T>
 	class MaBBandsYxf {
 	private:
-		OsMa<T> iOsMa;
-		DelayLine<T> iDelayLineOsMa;
+		OsMa<T, FixedEMA<T, 5>, FixedEMA<T, 9>> iOsMa;
+		FixedDelayLine<T, 1> iDelayLineOsMa;
 		SMA<T> iSmaHigh;
 		SMA<T> iSmaLow;
 		DelayLine<T> iDelayLineHigh;
@@ -3732,7 +3861,7 @@ namespace xtechnical {
                 const size_t os_period = 3,
                 const double symbol_point = 0.00001,
                 const size_t symbol_dist = 20) :
-            iOsMa(5, 9, os_period), iDelayLineOsMa(1),
+            iOsMa(5, 9, os_period),
             iSmaHigh(ma_period), iSmaLow(ma_period),
             iDelayLineHigh(move_shift), iDelayLineLow(move_shift),
             iWmaHigh(4), iWmaLow(4),
@@ -4009,11 +4138,7 @@ namespace xtechnical {
 
             buffer.update(std::abs(tdf));
             if(buffer.full()) {
-                T h = 0;
-                std::vector<T> data = buffer.to_vector();
-                for (size_t i = 0; i < data.size(); ++i) {
-                    if (h < data[i]) h = data[i];
-                }
+                const T h = std::max((T)0, buffer.view().max());
                 output = (h > 0.0) ? (tdf / h) : 0.0;
                 return common::OK;
             };
@@ -4070,11 +4195,7 @@ namespace xtechnical {
 
             buffer.test(std::abs(tdf));
             if(buffer.full()) {
-                T h = 0;
-                std::vector<T> data = buffer.to_vector();
-                for (size_t i = 0; i < data.size(); ++i) {
-                    if (h < data[i]) h = data[i];
-                }
+                const T h = std::max((T)0, buffer.view().max());
                 output = (h > 0.0) ? (tdf / h) : 0.0;
                 return common::OK;
             };
@@ -4435,10 +4556,10 @@ namespace xtechnical {
         }
     };
 
-    /** \brief Формирователь баров для усредненной цены
+    /** \brief Данные бара формирователя баров
      */
     template<class T>
-    class BarShaperV1 {
+    class BarShaperBase {
     public:
 
         /** \brief Данные бара
@@ -4448,6 +4569,28 @@ namespace xtechnical {
             T open = 0, high = 0, low = 0, close = 0;
             uint64_t timestamp = 0;
         };
+    };
+
+    /** \brief Пустой приемник баров
+     *
+     * Приемник для BasicBarShaper должен иметь методы on_close_bar и on_unformed_bar,
+     * от этого класса можно наследоваться, чтобы не писать ненужный метод
+     */
+    template<class T>
+    class BarShaperSink {
+    public:
+        inline void on_close_bar(const typename BarShaperBase<T>::Bar &) {};
+        inline void on_unformed_bar(const typename BarShaperBase<T>::Bar &) {};
+    };
+
+    /** \brief Формирователь баров для усредненной цены со статическим приемником баров
+     *
+     * Методы приемника вызываются напрямую и могут быть встроены компилятором
+     */
+    template<class T, class SINK = BarShaperSink<T>>
+    class BasicBarShaper : public BarShaperBase<T> {
+    public:
+        typedef typename BarShaperBase<T>::Bar Bar;
 
     private:
         Bar bar;
@@ -4461,28 +4604,44 @@ namespace xtechnical {
 
     public:
 
-        BarShaperV1() {};
+        SINK sink;  /**< Приемник баров */
+
+        BasicBarShaper() {};
 
         /** \brief Инициализировать формирователь баров
          * \param p     Период
          * \param oepc  Флаг, включает эквивалетность цены открытия цене закрытия предыдущего бара
          * \param ubst  Флаг, включает использование последней метки времени бара вместо начала бара, как времени бара
          * \param uf    Флаг, включает заполнение пропущенных баров
-         */
-        BarShaperV1(const uint64_t p, const bool oepc = false, const bool ubst = false, const bool uf = false) :
+         * \param s     Приемник баров
+         */
+        BasicBarShaper(
+                const uint64_t p,
+                const bool oepc = false,
+                const bool ubst = false,
+                const bool uf = false,
+                const SINK &s = SINK()) :
             period(p),
             is_open_equal_prev_close(oepc),
             is_use_bar_stop_time(ubst),
-            is_fill(uf)  {};
-
-        std::function<void(const Bar &bar)> on_close_bar;               /**< Функция обратного вызова в момент закрытия бара */
-        std::function<void(const Bar &bar)> on_unformed_bar = nullptr;  /**< Функция обратного вызова для несформированного бара */
+            is_fill(uf),
+            sink(s) {};
 
         /** \brief Обновить состояние индикатора
          * \param input     Текущая цена
          * \param timestamp Метка времени
          */
-        void update(const T input, const uint64_t timestamp) {
+        inline void update(const T input, const uint64_t timestamp) {
+            update(input, timestamp, sink);
+        }
+
+        /** \brief Обновить состояние индикатора с указанным приемником баров
+         * \param input     Текущая цена
+         * \param timestamp Метка времени
+         * \param s         Приемник баров
+         */
+        template<class S>
+        void update(const T input, const uint64_t timestamp, S &s) {
             if (period == 0) return;
             if (last_bar == 0) {
                 last_bar = timestamp / period;
@@ -4493,13 +4652,13 @@ namespace xtechnical {
                 if (is_once) {
                     bar.timestamp = is_use_bar_stop_time ?
                         (last_bar * period + period) : (last_bar * period);
-                    on_close_bar(bar);
+                    s.on_close_bar(bar);
                     if (is_fill) {
                         for (uint64_t b = (last_bar + 1); b < current_bar; ++b) {
                             bar.open = bar.low = bar.high = bar.close;
                             bar.timestamp = is_use_bar_stop_time ?
                                 (b * period + period) : (b * period);
-                            on_close_bar(bar);
+                            s.on_close_bar(bar);
                         }
                     }
                 }
@@ -4522,11 +4681,9 @@ namespace xtechnical {
                     bar.high = std::max(input, bar.high);
                     bar.low = std::min(input, bar.low);
                     bar.close = input;
-                    if (on_unformed_bar != nullptr) {
-                        bar.timestamp = is_use_bar_stop_time ?
-                            (last_bar * period + period) : (last_bar * period);
-                        on_unformed_bar(bar);
-                    }
+                    bar.timestamp = is_use_bar_stop_time ?
+                        (last_bar * period + period) : (last_bar * period);
+                    s.on_unformed_bar(bar);
                 } else {
                     bar.close = input;
                 }
@@ -4534,11 +4691,67 @@ namespace xtechnical {
         }
     };
 
+    /** \brief Формирователь баров для усредненной цены
+     *
+     * Версия с функциями обратного вызова std::function поверх BasicBarShaper
+     */
+    template<class T>
+    class BarShaperV1 : public BarShaperBase<T> {
+    public:
+        typedef typename BarShaperBase<T>::Bar Bar;
 
-    /** \brief График ренко
+    private:
+        BasicBarShaper<T> shaper;
+
+        class FunctionSink {
+        public:
+            const std::function<void(const Bar &bar)> &close_bar;
+            const std::function<void(const Bar &bar)> &unformed_bar;
+
+            FunctionSink(
+                const std::function<void(const Bar &bar)> &c,
+                const std::function<void(const Bar &bar)> &u) :
+                close_bar(c), unformed_bar(u) {};
+
+            inline void on_close_bar(const Bar &bar) {
+                close_bar(bar);
+            }
+
+            inline void on_unformed_bar(const Bar &bar) {
+                if (unformed_bar != nullptr) unformed_bar(bar);
+            }
+        };
+
+    public:
+
+        BarShaperV1() {};
+
+        /** \brief Инициализировать формирователь баров
+         * \param p     Период
+         * \param oepc  Флаг, включает эквивалетность цены открытия цене закрытия предыдущего бара
+         * \param ubst  Флаг, включает использование последней метки времени бара вместо начала бара, как времени бара
+         * \param uf    Флаг, включает заполнение пропущенных баров
+         */
+        BarShaperV1(const uint64_t p, const bool oepc = false, const bool ubst = false, const bool uf = false) :
+            shaper(p, oepc, ubst, uf) {};
+
+        std::function<void(const Bar &bar)> on_close_bar;               /**< Функция обратного вызова в момент закрытия бара */
+        std::function<void(const Bar &bar)> on_unformed_bar = nullptr;  /**< Функция обратного вызова для несформированного бара */
+
+        /** \brief Обновить состояние индикатора
+         * \param input     Текущая цена
+         * \param timestamp Метка времени
+         */
+        void update(const T input, const uint64_t timestamp) {
+            FunctionSink sink(on_close_bar, on_unformed_bar);
+            shaper.update(input, timestamp, sink);
+        }
+    };
+
+    /** \brief Данные бара графика ренко
      */
     template<class T>
-    class RenkoChart {
+    class RenkoChartBase {
     public:
 
         /** \brief Данные бара
@@ -4548,6 +4761,16 @@ namespace xtechnical {
             T close = 0;
             uint64_t timestamp = 0;
         };
+    };
+
+    /** \brief График ренко со статическим приемником баров
+     *
+     * Приемник должен иметь метод on_close_bar(const Bar &bar)
+     */
+    template<class T, class SINK>
+    class BasicRenkoChart : public RenkoChartBase<T> {
+    public:
+        typedef typename RenkoChartBase<T>::Bar Bar;
 
     private:
         uint64_t digits = 0;
@@ -4558,19 +4781,9 @@ namespace xtechnical {
         std::array<double, 9> digits_to_value = {0.0, 0.1, 0.01, 0.001, 0.0001, 0.00001, 0.000001, 0.0000001, 0.00000001};
 
         bool is_once = false;
-    public:
-
-        std::function<void(const Bar &bar)> on_close_bar;               /**< Функция обратного вызова в момент закрытия бара */
-
-        RenkoChart() {};
-
-        /** \brief Инициализировать график ренко
-         * \param d Количество разрядов
-         * \param s Шаг графика
-         */
-        RenkoChart(const uint64_t d, const uint64_t s) : digits(d), step(s) {};
 
-        void update(const T input, const uint64_t timestamp) {
+        template<class S>
+        void process(const T input, const bool is_timestamp, const uint64_t timestamp, S &s) {
             if (digits == 0) return;
             const int64_t level = (int64_t)(input / (digits_to_value[digits] * (double)step));
             if (last_level == 0) {
@@ -4583,51 +4796,93 @@ namespace xtechnical {
                     is_once = true;
                     return;
                 }
+                if (is_timestamp) bar.timestamp = timestamp;
                 if (last_level > level) {
-                    bar.timestamp = timestamp;
                     for (int64_t l = last_level + 1; l <= level; ++l) {
                         bar.close = (double)l * digits_to_value[digits] * (double)step;
-                        on_close_bar(bar);
+                        s.on_close_bar(bar);
                     }
                 } else
                 if (last_level < level) {
-                    bar.timestamp = timestamp;
                     for (int64_t l = last_level - 1; l >= level; --l) {
                         bar.close = (double)l * digits_to_value[digits] * (double)step;
-                        on_close_bar(bar);
+                        s.on_close_bar(bar);
                     }
                 }
                 last_level = level;
             }
         }
 
-        void update(const T input) {
-            if (digits == 0) return;
-            const int64_t level = (int64_t)(input / (digits_to_value[digits] * (double)step));
-            if (last_level == 0) {
-                last_level = level;
-                return;
-            }
-            if (last_level != level) {
-                if (!is_once) {
-                    last_level = level;
-                    is_once = true;
-                    return;
-                }
-                if (last_level > level) {
-                    for (int64_t l = last_level + 1; l <= level; ++l) {
-                        bar.close = (double)l * digits_to_value[digits] * (double)step;
-                        on_close_bar(bar);
-                    }
-                } else
-                if (last_level < level) {
-                    for (int64_t l = last_level - 1; l >= level; --l) {
-                        bar.close = (double)l * digits_to_value[digits] * (double)step;
-                        on_close_bar(bar);
-                    }
-                }
-                last_level = level;
+    public:
+
+        SINK sink;  /**< Приемник баров */
+
+        BasicRenkoChart() {};
+
+        /** \brief Инициализировать график ренко
+         * \param d Количество разрядов
+         * \param s Шаг графика
+         * \param k Приемник баров
+         */
+        BasicRenkoChart(const uint64_t d, const uint64_t s, const SINK &k = SINK()) :
+            digits(d), step(s), sink(k) {};
+
+        inline void update(const T input, const uint64_t timestamp) {
+            process(input, true, timestamp, sink);
+        }
+
+        inline void update(const T input) {
+            process(input, false, 0, sink);
+        }
+
+        template<class S>
+        inline void update(const T input, const uint64_t timestamp, S &s) {
+            process(input, true, timestamp, s);
+        }
+    };
+
+    /** \brief График ренко
+     *
+     * Версия с функцией обратного вызова std::function поверх BasicRenkoChart
+     */
+    template<class T>
+    class RenkoChart : public RenkoChartBase<T> {
+    public:
+        typedef typename RenkoChartBase<T>::Bar Bar;
+
+    private:
+
+        class FunctionSink {
+        public:
+            const std::function<void(const Bar &bar)> *close_bar = nullptr;
+
+            inline void on_close_bar(const Bar &bar) {
+                (*close_bar)(bar);
             }
+        };
+
+        BasicRenkoChart<T, FunctionSink> chart;
+
+    public:
+
+        std::function<void(const Bar &bar)> on_close_bar;               /**< Функция обратного вызова в момент закрытия бара */
+
+        RenkoChart() {};
+
+        /** \brief Инициализировать график ренко
+         * \param d Количество разрядов
+         * \param s Шаг графика
+         */
+        RenkoChart(const uint64_t d, const uint64_t s) : chart(d, s) {};
+
+        void update(const T input, const uint64_t timestamp) {
+            chart.sink.close_bar = &on_close_bar;
+            chart.update(input, timestamp);
+        }
+
+        void update(const T input) {
+            chart.sink.close_bar = &on_close_bar;
+            chart.update(input);
         }
     };
 
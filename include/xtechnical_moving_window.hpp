@@ -498,7 +498,9 @@ namespace xtechnical {
         /** \brief Получить массив средних значений
          * и стандартного отклонения буфера
          *
-         * Минимальный период равен 2
+         * Минимальный период равен 2. Для расчета по всему ряду
+         * сразу для набора периодов см. sweep::calculate_sma
+         * и sweep::calculate_std_dev
          * \param average_data массив средних значений
          * \param std_data массив стандартного отклонения
          * \param min_period минимальный период
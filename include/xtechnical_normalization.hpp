@@ -25,6 +25,7 @@
 #define XTECHNICAL_NORMALIZATION_HPP_INCLUDED
 
 #include "xtechnical_common.hpp"
+#include "math/xtechnical_simd.hpp"
 
 #include <vector>
 #include <algorithm>
@@ -45,6 +46,24 @@ namespace xtechnical {
             size_t input_size = in.size();
             size_t output_size = out.size();
             if(input_size == 0 || output_size != input_size) return common::INVALID_PARAMETER;
+            typedef simd::contiguous_array<T1> in_array_t;
+            typedef simd::contiguous_array<T2> out_array_t;
+            if(in_array_t::value) {
+                typename in_array_t::value_type min_data = 0, max_data = 0;
+                simd::min_max(in_array_t::data(in), input_size, min_data, max_data);
+                const double ampl = max_data - min_data;
+                if(ampl == 0) {
+                    std::fill(out.begin(), out.end(),0);
+                } else
+                if(std::is_same<typename in_array_t::value_type, typename out_array_t::value_type>::value && out_array_t::value) {
+                    simd::normalize_min_max(in_array_t::data(in), (typename in_array_t::value_type*)out_array_t::data(out), input_size, min_data, ampl, type != 0);
+                } else {
+                    for(size_t i = 0; i < input_size; i++) {
+                        out[i] = type == 0 ? (double)(in[i] - min_data) / ampl : 2.0 * ((double)(in[i] - min_data) / ampl) - 1.0;
+                    }
+                }
+                return common::OK;
+            }
             auto it_max_data = std::max_element(in.begin(), in.end());
             auto it_min_data = std::min_element(in.begin(), in.end());
             auto max_data = in[0];
@@ -77,6 +96,27 @@ namespace xtechnical {
             size_t input_size = in.size();
             size_t output_size = out.size();
             if(input_size == 0 || output_size != input_size) return common::INVALID_PARAMETER;
+            using NumType = typename T1::value_type;
+            typedef simd::contiguous_array<T1> in_array_t;
+            typedef simd::contiguous_array<T2> out_array_t;
+            if(in_array_t::value) {
+                typename in_array_t::value_type min_data = 0, max_data = 0;
+                simd::min_max(in_array_t::data(in), input_size, min_data, max_data);
+                min_data = std::min((typename in_array_t::value_type)min_value, min_data);
+                max_data = std::max((typename in_array_t::value_type)max_value, max_data);
+                const double ampl = max_data - min_data;
+                if(ampl == 0) {
+                    std::fill(out.begin(), out.end(),0);
+                } else
+                if(std::is_same<typename in_array_t::value_type, typename out_array_t::value_type>::value && out_array_t::value) {
+                    simd::normalize_min_max(in_array_t::data(in), (typename in_array_t::value_type*)out_array_t::data(out), input_size, min_data, ampl, type != 0);
+                } else {
+                    for(size_t i = 0; i < input_size; i++) {
+                        out[i] = type == 0 ? (double)(in[i] - min_data) / ampl : 2.0 * ((double)(in[i] - min_data) / ampl) - 1.0;
+                    }
+                }
+                return common::OK;
+            }
             auto it_max_data = std::max_element(in.begin(), in.end());
             auto it_min_data = std::min_element(in.begin(), in.end());
             auto max_data = in[0];
@@ -85,7 +125,6 @@ namespace xtechnical {
                 max_data = *it_max_data;
                 min_data = *it_min_data;
             }
-            using NumType = typename T1::value_type;
             min_data = (NumType)std::min((NumType)min_value, (NumType)min_data);
             max_data = (NumType)std::max((NumType)max_value, (NumType)max_data);
             auto ampl = max_data - min_data;
@@ -112,9 +151,21 @@ namespace xtechnical {
             size_t output_size = out.size();
             if(input_size == 0 || output_size != input_size) return common::INVALID_PARAMETER;
             using NumType = typename T1::value_type;
+            typedef simd::contiguous_array<T1> in_array_t;
+            typedef simd::contiguous_array<T2> out_array_t;
+            if(in_array_t::value &&
+               out_array_t::value &&
+               std::is_same<typename in_array_t::value_type, typename out_array_t::value_type>::value) {
+                const typename in_array_t::value_type *x = in_array_t::data(in);
+                const double mean = simd::sum(x, input_size) / (double)input_size;
+                const double diff = simd::sum_sq_dev(x, input_size, mean);
+                const double std_dev = diff > 0 ? std::sqrt(diff / (double)(input_size - 1)) : 0.0;
+                simd::normalize_zscore(x, (typename in_array_t::value_type*)out_array_t::data(out), input_size, mean, d * std_dev, t);
+                return common::OK;
+            }
             auto mean = std::accumulate(in.begin(), in.end(), NumType(0));
             mean /= (NumType)input_size;
-            auto diff = 0;
+            NumType diff = 0;
             for(size_t k = 0; k < input_size; ++k) {
                 diff += ((in[k] - mean) * (in[k] - mean));
             }
@@ -182,6 +233,14 @@ namespace xtechnical {
             size_t input_size = in.size();
             size_t output_size = out.size();
             if(input_size == 0 || output_size != input_size) return common::INVALID_PARAMETER;
+            typedef simd::contiguous_array<T1> in_array_t;
+            typedef simd::contiguous_array<T2> out_array_t;
+            if(in_array_t::value &&
+               out_array_t::value &&
+               std::is_same<typename in_array_t::value_type, typename out_array_t::value_type>::value) {
+                simd::log(in_array_t::data(in), (typename in_array_t::value_type*)out_array_t::data(out), input_size);
+                return common::OK;
+            }
             for(size_t i = 0; i < input_size; i++) {
                 out[i] = std::log(in[i]);
             }
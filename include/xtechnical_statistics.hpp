@@ -1,9 +1,14 @@
 #ifndef XTECHNICAL_STATISTICS_HPP_INCLUDED
 #define XTECHNICAL_STATISTICS_HPP_INCLUDED
 
+#include "math/xtechnical_simd.hpp"
+
 #include <vector>
 #include <cmath>
 #include <algorithm>
+#include <future>
+#include <cstdint>
+#include <type_traits>
 
 namespace xtechnical_statistics {
 
@@ -15,6 +20,10 @@ namespace xtechnical_statistics {
     T1 calc_root_mean_square(const T2 &array_data) {
         const size_t size = array_data.size();
         if(size == 0) return (T1)0;
+        typedef xtechnical::simd::contiguous_array<T2> array_t;
+        if(array_t::value) {
+            return (T1)std::sqrt(xtechnical::simd::sum_sq(array_t::data(array_data), size) / (double)size);
+        }
         T1 sum = 0;
         for(size_t i = 0; i < size; ++i) {
             T1 temp = array_data[i] * array_data[i];
@@ -32,6 +41,10 @@ namespace xtechnical_statistics {
     T1 calc_mean_value(const T2 &array_data) {
         const size_t size = array_data.size();
         if(size == 0) return (T1)0;
+        typedef xtechnical::simd::contiguous_array<T2> array_t;
+        if(array_t::value) {
+            return (T1)(xtechnical::simd::sum(array_t::data(array_data), size) / (double)size);
+        }
         T1 sum = 0;
         for(size_t i = 0; i < size; ++i) {
             sum += array_data[i];
@@ -90,6 +103,11 @@ namespace xtechnical_statistics {
         const size_t size = array_data.size();
 		if(size < 2) return (T1)0;
         T1 mean = calc_mean_value<T1>(array_data);
+        typedef xtechnical::simd::contiguous_array<T2> array_t;
+        if(array_t::value) {
+            const double sum = xtechnical::simd::sum_sq_dev(array_t::data(array_data), size, mean);
+            return (T1)std::sqrt(sum / (double)(size - 1));
+        }
         T1 sum = 0;
         for(size_t i = 0; i < size; ++i) {
             T1 diff = array_data[i] - mean;
@@ -109,6 +127,11 @@ namespace xtechnical_statistics {
         const size_t size = array_data.size();
 		if(size == 0) return (T1)0;
         T1 mean = calc_mean_value<T1>(array_data);
+        typedef xtechnical::simd::contiguous_array<T2> array_t;
+        if(array_t::value) {
+            const double sum = xtechnical::simd::sum_sq_dev(array_t::data(array_data), size, mean);
+            return (T1)std::sqrt(sum / (double)size);
+        }
         T1 sum = 0;
         for(size_t i = 0; i < size; ++i) {
             T1 diff = array_data[i] - mean;
@@ -169,11 +192,18 @@ namespace xtechnical_statistics {
         T1 mean = calc_mean_value<T1>(array_data);
         const size_t size = array_data.size();
         if(size < 2) return (T1)0;
+        typedef xtechnical::simd::contiguous_array<T2> array_t;
         T1 sum = 0;
-        for(size_t i = 0; i < size; ++i) {
-            T1 diff = array_data[i] - mean;
-            diff = diff*diff*diff;
-            sum += diff;
+        if(array_t::value) {
+            double m2 = 0, m3 = 0, m4 = 0;
+            xtechnical::simd::central_moments(array_t::data(array_data), size, mean, m2, m3, m4);
+            sum = (T1)m3;
+        } else {
+            for(size_t i = 0; i < size; ++i) {
+                T1 diff = array_data[i] - mean;
+                diff = diff*diff*diff;
+                sum += diff;
+            }
         }
         size_t new_size = size - 1;
         new_size = new_size * new_size * new_size;
@@ -219,11 +249,16 @@ namespace xtechnical_statistics {
         size_t size = array_data.size();
         if(size < 2) return (T1)0;
         T1 mean = calc_mean_value<T1>(array_data);
+        typedef xtechnical::simd::contiguous_array<T2> array_t;
         T1 sum = 0;
-        for(size_t i = 0; i < size; ++i) {
-            T1 diff = array_data[i] - mean;
-            diff*=diff;
-            sum += diff;
+        if(array_t::value) {
+            sum = (T1)xtechnical::simd::sum_sq_dev(array_t::data(array_data), size, mean);
+        } else {
+            for(size_t i = 0; i < size; ++i) {
+                T1 diff = array_data[i] - mean;
+                diff*=diff;
+                sum += diff;
+            }
         }
         sum /= (T1)(size - 1);
         return std::sqrt(sum)/mean;
@@ -246,11 +281,16 @@ namespace xtechnical_statistics {
         const size_t size = array_data.size();
         if(size < 2) return (T1)0;
         T1 mean = calc_mean_value<T1>(array_data);
+        typedef xtechnical::simd::contiguous_array<T2> array_t;
         T1 sum = 0;
-        for(size_t i = 0; i < size; ++i) {
-            T1 diff = array_data[i] - mean;
-            diff*=diff;
-            sum += diff;
+        if(array_t::value) {
+            sum = (T1)xtechnical::simd::sum_sq_dev(array_t::data(array_data), size, mean);
+        } else {
+            for(size_t i = 0; i < size; ++i) {
+                T1 diff = array_data[i] - mean;
+                diff*=diff;
+                sum += diff;
+            }
         }
         sum /= (T1)(size - 1);
         return mean/std::sqrt(sum);
@@ -271,11 +311,19 @@ namespace xtechnical_statistics {
         T1 mean = calc_mean_value<T1>(array_data);
         T1 u4 = 0;
         T1 std_dev = 0;
-        for(size_t i = 0; i < size; ++i) {
-            T1 diff = array_data[i] - mean;
-            diff *= diff;
-            std_dev += diff;
-            u4 += diff * diff;
+        typedef xtechnical::simd::contiguous_array<T2> array_t;
+        if(array_t::value) {
+            double m2 = 0, m3 = 0, m4 = 0;
+            xtechnical::simd::central_moments(array_t::data(array_data), size, mean, m2, m3, m4);
+            std_dev = (T1)m2;
+            u4 = (T1)m4;
+        } else {
+            for(size_t i = 0; i < size; ++i) {
+                T1 diff = array_data[i] - mean;
+                diff *= diff;
+                std_dev += diff;
+                u4 += diff * diff;
+            }
         }
         u4 /= (T1)size;
         std_dev /= (T1)(size - 1);
@@ -285,6 +333,214 @@ namespace xtechnical_statistics {
         return u4/std_dev - 3.0;
     }
 
+    /** \brief Накопитель моментов распределения
+     *
+     * Считает среднее, дисперсию, асимметрию и эксцесс за один проход
+     * (обновления Уэлфорда/Пебая). Два накопителя можно объединить методом merge,
+     * результат совпадает с расчетом по объединенному массиву. Это позволяет
+     * обрабатывать большой массив частями в нескольких потоках.
+     */
+    template<class T>
+    class Moments {
+    private:
+        uint64_t n = 0;
+        double mean = 0;
+        double m2 = 0;
+        double m3 = 0;
+        double m4 = 0;
+
+    public:
+
+        Moments() {};
+
+        /** \brief Добавить значение
+         * \param value    Значение
+         */
+        inline void update(const T value) noexcept {
+            const double n1 = (double)n;
+            ++n;
+            const double nd = (double)n;
+            const double delta = (double)value - mean;
+            const double delta_n = delta / nd;
+            const double delta_n2 = delta_n * delta_n;
+            const double term1 = delta * delta_n * n1;
+            mean += delta_n;
+            m4 += term1 * delta_n2 * (nd * nd - 3.0 * nd + 3.0) + 6.0 * delta_n2 * m2 - 4.0 * delta_n * m3;
+            m3 += term1 * delta_n * (nd - 2.0) - 3.0 * delta_n * m2;
+            m2 += term1;
+        }
+
+        /** \brief Добавить массив значений
+         * \param array_data   Массив с данными
+         */
+        template<class T2, typename std::enable_if<!std::is_arithmetic<T2>::value, int>::type = 0>
+        inline void update(const T2 &array_data) noexcept {
+            const size_t size = array_data.size();
+            for(size_t i = 0; i < size; ++i) {
+                update(array_data[i]);
+            }
+        }
+
+        /** \brief Добавить часть массива
+         * \param array_data   Массив с данными
+         * \param start_index  Начальный индекс
+         * \param stop_index   Конечный индекс (не включается)
+         */
+        template<class T2, typename std::enable_if<!std::is_arithmetic<T2>::value, int>::type = 0>
+        inline void update(const T2 &array_data, const size_t start_index, const size_t stop_index) noexcept {
+            for(size_t i = start_index; i < stop_index; ++i) {
+                update(array_data[i]);
+            }
+        }
+
+        /** \brief Объединить с другим накопителем
+         * \param other    Накопитель, посчитанный по другой части данных
+         */
+        void merge(const Moments<T> &other) noexcept {
+            if (other.n == 0) return;
+            if (n == 0) {
+                *this = other;
+                return;
+            }
+            const double na = (double)n;
+            const double nb = (double)other.n;
+            const double nx = na + nb;
+            const double delta = other.mean - mean;
+            const double delta2 = delta * delta;
+            const double delta3 = delta2 * delta;
+            const double delta4 = delta2 * delta2;
+
+            const double new_m4 = m4 + other.m4 +
+                delta4 * na * nb * (na * na - na * nb + nb * nb) / (nx * nx * nx) +
+                6.0 * delta2 * (na * na * other.m2 + nb * nb * m2) / (nx * nx) +
+                4.0 * delta * (na * other.m3 - nb * m3) / nx;
+            const double new_m3 = m3 + other.m3 +
+                delta3 * na * nb * (na - nb) / (nx * nx) +
+                3.0 * delta * (na * other.m2 - nb * m2) / nx;
+            const double new_m2 = m2 + other.m2 + delta2 * na * nb / nx;
+
+            mean += delta * nb / nx;
+            m2 = new_m2;
+            m3 = new_m3;
+            m4 = new_m4;
+            n += other.n;
+        }
+
+        /** \brief Получить количество значений
+         */
+        inline uint64_t get_count() const noexcept {
+            return n;
+        }
+
+        /** \brief Получить среднее значение
+         */
+        inline T get_mean() const noexcept {
+            return (T)mean;
+        }
+
+        /** \brief Получить стандартное отклонение выборки
+         */
+        inline T get_std_dev_sample() const noexcept {
+            if (n < 2) return (T)0;
+            return (T)std::sqrt(m2 / (double)(n - 1));
+        }
+
+        /** \brief Получить стандартное отклонение популяции
+         */
+        inline T get_std_dev_population() const noexcept {
+            if (n == 0) return (T)0;
+            return (T)std::sqrt(m2 / (double)n);
+        }
+
+        /** \brief Получить коэффициент асимметрии
+         *
+         * В отличие от calc_skewness, значение нормировано на дисперсию:
+         * g1 = sqrt(n) * M3 / M2^(3/2)
+         */
+        inline T get_skewness() const noexcept {
+            if (n < 2 || m2 == 0) return (T)0;
+            return (T)(std::sqrt((double)n) * m3 / std::pow(m2, 1.5));
+        }
+
+        /** \brief Получить коэффициент эксцесса
+         *
+         * Формула совпадает с calc_excess
+         */
+        inline T get_excess() const noexcept {
+            if (n < 2 || m2 == 0) return (T)0;
+            const double u4 = m4 / (double)n;
+            const double var = m2 / (double)(n - 1);
+            return (T)(u4 / (var * var) - 3.0);
+        }
+
+        /** \brief Получить коэффициент вариации
+         *
+         * Формула совпадает с calc_coefficient_variance
+         */
+        inline T get_coefficient_variance() const noexcept {
+            if (n < 2) return (T)0;
+            return (T)(std::sqrt(m2 / (double)(n - 1)) / mean);
+        }
+
+        /** \brief Получить отношение сигнал / шум
+         *
+         * Формула совпадает с calc_signal_to_noise_ratio
+         */
+        inline T get_signal_to_noise_ratio() const noexcept {
+            if (n < 2) return (T)0;
+            return (T)(mean / std::sqrt(m2 / (double)(n - 1)));
+        }
+
+        /** \brief Получить стандартную ошибку
+         */
+        inline T get_standard_error() const noexcept {
+            if (n == 0) return (T)0;
+            return (T)(get_std_dev_sample() / std::sqrt((double)n));
+        }
+
+        /** \brief Очистить данные
+         */
+        inline void clear() noexcept {
+            n = 0;
+            mean = m2 = m3 = m4 = 0;
+        }
+    };
+
+    /** \brief Посчитать моменты распределения за один проход
+     *
+     * Массив делится на части, каждая часть обрабатывается в своем потоке,
+     * затем результаты объединяются через Moments::merge.
+     * \param array_data   Массив с данными
+     * \param num_threads  Количество потоков
+     * \return Накопитель моментов
+     */
+    template<class T1, class T2>
+    Moments<T1> calc_moments(const T2 &array_data, const size_t num_threads = 1) {
+        const size_t size = array_data.size();
+        Moments<T1> moments;
+        if (num_threads <= 1 || size < num_threads) {
+            moments.update(array_data);
+            return moments;
+        }
+        const size_t chunk = size / num_threads;
+        std::vector<std::future<Moments<T1>>> futures;
+        futures.reserve(num_threads - 1);
+        for (size_t t = 1; t < num_threads; ++t) {
+            const size_t start_index = t * chunk;
+            const size_t stop_index = t == (num_threads - 1) ? size : (start_index + chunk);
+            futures.push_back(std::async(std::launch::async, [&array_data, start_index, stop_index]() {
+                Moments<T1> part;
+                part.update(array_data, start_index, stop_index);
+                return part;
+            }));
+        }
+        moments.update(array_data, 0, chunk);
+        for (auto &f : futures) {
+            moments.merge(f.get());
+        }
+        return moments;
+    }
+
 
     template<class T1, class T2>
     T1 calc_laplace(T2 t) {
@@ -308,20 +564,174 @@ namespace xtechnical_statistics {
         return result;
     }
 
+    /** \brief Функция распределения стандартного нормального закона
+     * \param x Аргумент
+     * \return Вероятность P(X <= x)
+     */
+    template<class T1, class T2>
+    T1 calc_normal_cdf(const T2 x) {
+        constexpr double inv_sqrt2 = 0.70710678118654752440;
+        return (T1)(0.5 * std::erfc(-(double)x * inv_sqrt2));
+    }
+
+    /** \brief Непрерывная дробь для неполной бета-функции (метод Лентца)
+     */
+    inline double calc_incomplete_beta_cf(const double a, const double b, const double x) {
+        const size_t max_iter = 500;
+        const double eps = 1.0e-15;
+        const double fpmin = 1.0e-300;
+        const double qab = a + b;
+        const double qap = a + 1.0;
+        const double qam = a - 1.0;
+        double c = 1.0;
+        double d = 1.0 - qab * x / qap;
+        if(std::abs(d) < fpmin) d = fpmin;
+        d = 1.0 / d;
+        double h = d;
+        for(size_t m = 1; m <= max_iter; ++m) {
+            const double m2 = 2.0 * (double)m;
+            double aa = (double)m * (b - (double)m) * x / ((qam + m2) * (a + m2));
+            d = 1.0 + aa * d;
+            if(std::abs(d) < fpmin) d = fpmin;
+            c = 1.0 + aa / c;
+            if(std::abs(c) < fpmin) c = fpmin;
+            d = 1.0 / d;
+            h *= d * c;
+            aa = -(a + (double)m) * (qab + (double)m) * x / ((a + m2) * (qap + m2));
+            d = 1.0 + aa * d;
+            if(std::abs(d) < fpmin) d = fpmin;
+            c = 1.0 + aa / c;
+            if(std::abs(c) < fpmin) c = fpmin;
+            d = 1.0 / d;
+            const double del = d * c;
+            h *= del;
+            if(std::abs(del - 1.0) < eps) break;
+        }
+        return h;
+    }
+
+    /** \brief Регуляризованная неполная бета-функция I_x(a, b)
+     * \param a Параметр a > 0
+     * \param b Параметр b > 0
+     * \param x Аргумент от 0 до 1
+     * \return Значение I_x(a, b)
+     */
+    template<class T1>
+    T1 calc_incomplete_beta(const double a, const double b, const double x) {
+        if(x <= 0) return 0;
+        if(x >= 1) return 1;
+        const double bt = std::exp(
+            std::lgamma(a + b) - std::lgamma(a) - std::lgamma(b) +
+            a * std::log(x) + b * std::log1p(-x));
+        if(x < (a + 1.0) / (a + b + 2.0)) {
+            return (T1)(bt * calc_incomplete_beta_cf(a, b, x) / a);
+        }
+        return (T1)(1.0 - bt * calc_incomplete_beta_cf(b, a, 1.0 - x) / b);
+    }
+
+    /** \brief Функция биномиального распределения P(X <= k)
+     * \param k Количество успехов
+     * \param n Количество испытаний
+     * \param p Вероятность успеха в одном испытании
+     * \return Вероятность получить не более k успехов
+     */
+    template<class T1>
+    T1 calc_binomial_cdf(const int64_t k, const int64_t n, const double p) {
+        if(k < 0) return 0;
+        if(k >= n) return 1;
+        return calc_incomplete_beta<T1>((double)(n - k), (double)(k + 1), 1.0 - p);
+    }
+
     /** \brief Посчитать вероятность, с которой винрейт играемой стратегии выше заданного числа
      *
+     * Используется нормальное приближение. Интеграл функции Лапласа
+     * считается в замкнутом виде через erfc, поэтому precision не влияет
+     * на время расчета, а результат совпадает с интегрированием
+     * по шагу precision с точностью до ошибки этого интегрирования.
+     * Как и раньше, при отрицательном t вероятность равна 0.5,
+     * а для одной ставки - 0.
      * \param threshold_winrate Заданнывй винрейт
      * \param win_bet Количество удачных ставок
      * \param number_bet Количество ставок
+     * \param precision Шаг интегрирования, оставлен для совместимости
      * \return Вероятность
      */
     template<class T1, class T2>
     T1 calc_probability_winrate(const T1 threshold_winrate, const T2 win_bet, const T2 number_bet, double precision = 0.01) {
+        (void)precision;
         if(number_bet <= 0 || number_bet == 1) return 0;
         const double w = (double)win_bet/(double)number_bet;
         if(w == 1) return 1;
         const double t = (w - threshold_winrate) * std::sqrt(((double)number_bet / w) / (1.0 - w));
-        return calc_integral_laplace<T1>(t, precision) + 0.5;
+        if(!(t > 0)) return 0.5;
+        return calc_normal_cdf<T1>(t);
+    }
+
+    /** \brief Посчитать вероятность, с которой винрейт играемой стратегии выше заданного числа, без приближений
+     *
+     * При равномерном априорном распределении винрейт имеет бета-распределение
+     * Beta(win_bet + 1, number_bet - win_bet + 1). Его хвост P(p > threshold)
+     * равен вероятности получить не более win_bet успехов в number_bet + 1
+     * испытаниях с вероятностью успеха threshold_winrate.
+     * Для малого числа ставок результат заметно отличается
+     * от нормального приближения calc_probability_winrate.
+     * \param threshold_winrate Заданнывй винрейт
+     * \param win_bet Количество удачных ставок
+     * \param number_bet Количество ставок
+     * \return Вероятность
+     */
+    template<class T1, class T2>
+    T1 calc_probability_winrate_exact(const T1 threshold_winrate, const T2 win_bet, const T2 number_bet) {
+        if(number_bet <= 0) return 0;
+        return calc_binomial_cdf<T1>((int64_t)win_bet, (int64_t)number_bet + 1, (double)threshold_winrate);
+    }
+
+    /** \brief Посчитать вероятности для массива пар (удачные ставки, все ставки)
+     *
+     * Для каждой пары вызывается calc_probability_winrate
+     * \param threshold_winrate Заданнывй винрейт
+     * \param win_bet Массив количества удачных ставок
+     * \param number_bet Массив количества ставок
+     * \param probability Массив вероятностей (должен иметь тот же размер)
+     * \param precision Шаг интегрирования, оставлен для совместимости
+     * \return Вернет true в случае успеха
+     */
+    template<class T1, class T2, class T3>
+    bool calc_probability_winrate(
+            const T1 threshold_winrate,
+            const T2 &win_bet,
+            const T2 &number_bet,
+            T3 &probability,
+            double precision = 0.01) {
+        const size_t size = win_bet.size();
+        if(number_bet.size() != size || probability.size() != size) return false;
+        for(size_t i = 0; i < size; ++i) {
+            probability[i] = calc_probability_winrate<double>((double)threshold_winrate, win_bet[i], number_bet[i], precision);
+        }
+        return true;
+    }
+
+    /** \brief Посчитать вероятности без приближений для массива пар (удачные ставки, все ставки)
+     *
+     * Для каждой пары вызывается calc_probability_winrate_exact
+     * \param threshold_winrate Заданнывй винрейт
+     * \param win_bet Массив количества удачных ставок
+     * \param number_bet Массив количества ставок
+     * \param probability Массив вероятностей (должен иметь тот же размер)
+     * \return Вернет true в случае успеха
+     */
+    template<class T1, class T2, class T3>
+    bool calc_probability_winrate_exact(
+            const T1 threshold_winrate,
+            const T2 &win_bet,
+            const T2 &number_bet,
+            T3 &probability) {
+        const size_t size = win_bet.size();
+        if(number_bet.size() != size || probability.size() != size) return false;
+        for(size_t i = 0; i < size; ++i) {
+            probability[i] = calc_probability_winrate_exact<double>((double)threshold_winrate, win_bet[i], number_bet[i]);
+        }
+        return true;
     }
 };
 
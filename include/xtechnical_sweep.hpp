@@ -0,0 +1,327 @@
+#ifndef XTECHNICAL_SWEEP_HPP_INCLUDED
+#define XTECHNICAL_SWEEP_HPP_INCLUDED
+
+#include "xtechnical_common.hpp"
+#include "math/xtechnical_simd.hpp"
+
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <limits>
+#include <cmath>
+
+namespace xtechnical {
+
+    /** \brief Расчет индикатора сразу для набора периодов
+     *
+     * Функции проходят ряд один раз и заполняют матрицу [n x periods.size()]
+     * по строкам: значение для бара t и периода periods[k] лежит
+     * в output[t * periods.size() + k]. Пока индикатор с данным периодом
+     * не готов, в матрице стоит NaN, момент готовности совпадает
+     * с одноименными индикаторами библиотеки.
+     *
+     * SMA и SUM считаются скользящими суммами для каждого периода
+     * в том же порядке операций, что и индикаторы, и совпадают с ними побитно.
+     * Матрица меняет размер через resize, при повторных расчетах
+     * лучше передавать тот же массив, чтобы не выделять память заново.
+     * EMA и MMA считаются векторными ядрами по всем периодам сразу
+     * и совпадают с индикаторами побитно.
+     * StdDev, WMA и LRMA считаются по префиксным суммам в double, поэтому
+     * их время не зависит от периода, а результат отличается от индикаторов
+     * на ошибку округления: около 1e-11 относительной для double.
+     * Индикаторы с типом float накапливают суммы во float, и отличие от них
+     * доходит до 1e-3 относительной для StdDev и 1e-5 для WMA и LRMA,
+     * при этом значения матрицы точнее.
+     * Префиксные суммы строятся по участкам ряда относительно первого значения
+     * участка, чтобы не терять точность на длинных рядах.
+     */
+    namespace sweep {
+
+        /** \brief Получить список периодов
+         * \param min_period    Минимальный период
+         * \param max_period    Максимальный период
+         * \param step_period   Шаг периода
+         * \return Периоды от min_period до max_period с шагом step_period
+         */
+        inline std::vector<size_t> make_periods(
+                const size_t min_period,
+                const size_t max_period,
+                const size_t step_period = 1) {
+            std::vector<size_t> periods;
+            if (step_period == 0) return periods;
+            for (size_t p = min_period; p <= max_period; p += step_period) {
+                periods.push_back(p);
+            }
+            return periods;
+        }
+
+        namespace detail {
+
+            /** \brief Префиксные суммы участка ряда
+             *
+             * Индекс j отсчитывается от начала участка, значения сдвинуты на center
+             */
+            class PrefixSums {
+            public:
+                std::vector<double> sum;        /**< sum[j] - сумма первых j значений */
+                std::vector<double> sum_sq;     /**< Сумма квадратов */
+                std::vector<double> sum_index;  /**< Сумма значений, умноженных на индекс */
+                std::vector<double> values;     /**< Сдвинутые значения, нужны вместе с sum_sq */
+                double center = 0;
+
+                template<class T>
+                void calc(const T &input, const size_t start, const size_t stop, const double c, const bool is_sq, const bool is_index) {
+                    const size_t length = stop - start;
+                    center = c;
+                    sum.resize(length + 1);
+                    sum[0] = 0;
+                    for (size_t j = 0; j < length; ++j) {
+                        sum[j + 1] = sum[j] + ((double)input[start + j] - c);
+                    }
+                    if (is_sq) {
+                        sum_sq.resize(length + 1);
+                        values.resize(length);
+                        sum_sq[0] = 0;
+                        for (size_t j = 0; j < length; ++j) {
+                            const double y = (double)input[start + j] - c;
+                            values[j] = y;
+                            sum_sq[j + 1] = sum_sq[j] + y * y;
+                        }
+                    }
+                    if (is_index) {
+                        sum_index.resize(length + 1);
+                        sum_index[0] = 0;
+                        for (size_t j = 0; j < length; ++j) {
+                            sum_index[j + 1] = sum_index[j] + (double)j * ((double)input[start + j] - c);
+                        }
+                    }
+                }
+
+                /** \brief Сумма сдвинутых значений окна длиной p, заканчивающегося на j
+                 */
+                inline double get_sum(const size_t j, const size_t p) const noexcept {
+                    return sum[j + 1] - sum[j + 1 - p];
+                }
+
+                inline double get_sum_sq(const size_t j, const size_t p) const noexcept {
+                    return sum_sq[j + 1] - sum_sq[j + 1 - p];
+                }
+
+                /** \brief Сумма квадратов отклонений окна от mean, посчитанная напрямую
+                 */
+                inline double get_sum_sq_dev(const size_t j, const size_t p, const double mean) const noexcept {
+                    double s = 0;
+                    for (size_t i = j + 1 - p; i <= j; ++i) {
+                        const double diff = values[i] - mean;
+                        s += diff * diff;
+                    }
+                    return s;
+                }
+
+                /** \brief Взвешенная сумма сдвинутых значений окна с весами 1..p
+                 */
+                inline double get_weighted_sum(const size_t j, const size_t p) const noexcept {
+                    return (sum_index[j + 1] - sum_index[j + 1 - p]) -
+                        ((double)j - (double)p) * get_sum(j, p);
+                }
+            };
+
+            /** \brief Пройти ряд участками и вызвать func для каждого бара
+             *
+             * Участок содержит max_period значений перед первым баром,
+             * поэтому окно любого периода помещается в участок.
+             * Функция func возвращает значение индикатора или NaN
+             */
+            template<class T1, class T2, class F>
+            int calc_tiled(
+                    const T1 &input,
+                    const std::vector<size_t> &periods,
+                    T2 &output,
+                    const bool is_sq,
+                    const bool is_index,
+                    F func) {
+                typedef typename T2::value_type NumType;
+                const size_t n = input.size();
+                const size_t m = periods.size();
+                if (m == 0) return common::INVALID_PARAMETER;
+                if (std::find(periods.begin(), periods.end(), 0) != periods.end()) return common::INVALID_PARAMETER;
+                output.resize(n * m);
+                const size_t max_period = *std::max_element(periods.begin(), periods.end());
+                const size_t tile = std::max(max_period, (size_t)1024);
+                PrefixSums prefix;
+                for (size_t s = 0; s < n; s += tile) {
+                    const size_t e = std::min(n, s + tile);
+                    const size_t g = s >= max_period ? s - max_period : 0;
+                    prefix.calc(input, g, e, (double)input[s], is_sq, is_index);
+                    for (size_t t = s; t < e; ++t) {
+                        NumType *row = &output[t * m];
+                        const size_t j = t - g;
+                        for (size_t k = 0; k < m; ++k) {
+                            row[k] = (NumType)func(prefix, t, j, periods[k]);
+                        }
+                    }
+                }
+                return common::OK;
+            }
+
+            /** \brief Скользящие суммы для всех периодов
+             *
+             * Сумма обновляется так же, как у SUM и SMA: last = last + (in - old)
+             */
+            template<class T1, class T2>
+            int calc_running_sum(
+                    const T1 &input,
+                    const std::vector<size_t> &periods,
+                    T2 &output,
+                    const bool is_mean) {
+                typedef typename T2::value_type NumType;
+                const size_t n = input.size();
+                const size_t m = periods.size();
+                if (m == 0) return common::INVALID_PARAMETER;
+                if (std::find(periods.begin(), periods.end(), 0) != periods.end()) return common::INVALID_PARAMETER;
+                output.resize(n * m);
+                std::vector<NumType> sum(m, 0);
+                for (size_t t = 0; t < n; ++t) {
+                    const NumType in = (NumType)input[t];
+                    NumType *row = &output[t * m];
+                    for (size_t k = 0; k < m; ++k) {
+                        const size_t p = periods[k];
+                        if (t < p) {
+                            sum[k] += in;
+                            row[k] = std::numeric_limits<NumType>::quiet_NaN();
+                            continue;
+                        }
+                        sum[k] = sum[k] + (in - (NumType)input[t - p]);
+                        row[k] = is_mean ? sum[k] / (NumType)p : sum[k];
+                    }
+                }
+                return common::OK;
+            }
+
+            template<class T1, class T2>
+            int calc_ema(
+                    const T1 &input,
+                    const std::vector<size_t> &periods,
+                    T2 &output,
+                    const bool is_mma) {
+                typedef typename T2::value_type NumType;
+                const size_t n = input.size();
+                const size_t m = periods.size();
+                if (m == 0) return common::INVALID_PARAMETER;
+                if (std::find(periods.begin(), periods.end(), 0) != periods.end()) return common::INVALID_PARAMETER;
+                output.assign(n * m, std::numeric_limits<NumType>::quiet_NaN());
+
+                /* периоды упорядочены по возрастанию, тогда готовые
+                 * к расчету периоды всегда занимают начало массива
+                 */
+                std::vector<size_t> index(m);
+                std::iota(index.begin(), index.end(), 0);
+                std::stable_sort(index.begin(), index.end(), [&](const size_t a, const size_t b) {
+                    return periods[a] < periods[b];
+                });
+                std::vector<NumType> a(m), last(m, 0), row(m);
+                for (size_t k = 0; k < m; ++k) {
+                    const size_t p = periods[index[k]];
+                    a[k] = is_mma ? 1.0/(NumType)p : 2.0/(NumType)(p + 1.0d);
+                }
+
+                NumType sum = 0;
+                size_t ready = 0;   /**< Количество периодов, для которых получено начальное значение */
+                for (size_t t = 0; t < n; ++t) {
+                    const NumType in = (NumType)input[t];
+                    if (ready > 0) {
+                        simd::lane_ema_alpha(last.data(), a.data(), in, row.data(), ready);
+                        NumType *dst = &output[t * m];
+                        for (size_t k = 0; k < ready; ++k) dst[index[k]] = row[k];
+                    }
+                    sum += in;
+                    while (ready < m && periods[index[ready]] == t + 1) {
+                        last[ready] = sum / (NumType)periods[index[ready]];
+                        ++ready;
+                    }
+                }
+                return common::OK;
+            }
+
+        }; // detail
+
+        /** \brief Простые скользящие средние для набора периодов
+         * \param input     Ряд значений
+         * \param periods   Периоды
+         * \param output    Матрица [input.size() x periods.size()]
+         * \return Вернет 0 в случае успеха, иначе см. ErrorType
+         */
+        template<class T1, class T2>
+        int calculate_sma(const T1 &input, const std::vector<size_t> &periods, T2 &output) {
+            return detail::calc_running_sum(input, periods, output, true);
+        }
+
+        /** \brief Скользящие суммы для набора периодов
+         */
+        template<class T1, class T2>
+        int calculate_sum(const T1 &input, const std::vector<size_t> &periods, T2 &output) {
+            return detail::calc_running_sum(input, periods, output, false);
+        }
+
+        /** \brief Стандартные отклонения для набора периодов
+         */
+        template<class T1, class T2>
+        int calculate_std_dev(const T1 &input, const std::vector<size_t> &periods, T2 &output) {
+            return detail::calc_tiled(input, periods, output, true, false,
+                [](const detail::PrefixSums &prefix, const size_t t, const size_t j, const size_t p) -> double {
+                    if (t < p) return std::numeric_limits<double>::quiet_NaN();
+                    // как и у StdDev, при периоде 1 отклонение равно 0
+                    if (p == 1) return 0;
+                    const double sum = prefix.get_sum(j, p);
+                    const double sum_sq = prefix.get_sum_sq(j, p);
+                    double sum_sq_dev = sum_sq - sum * sum / (double)p;
+                    // при сильном сокращении разности окно пересчитывается напрямую
+                    if (sum_sq_dev < 1e-3 * sum_sq) sum_sq_dev = prefix.get_sum_sq_dev(j, p, sum / (double)p);
+                    sum_sq_dev /= (double)(p - 1);
+                    return sum_sq_dev > 0 ? std::sqrt(sum_sq_dev) : 0;
+                });
+        }
+
+        /** \brief Взвешенные скользящие средние для набора периодов
+         */
+        template<class T1, class T2>
+        int calculate_wma(const T1 &input, const std::vector<size_t> &periods, T2 &output) {
+            return detail::calc_tiled(input, periods, output, false, true,
+                [](const detail::PrefixSums &prefix, const size_t t, const size_t j, const size_t p) -> double {
+                    if (t + 1 < p) return std::numeric_limits<double>::quiet_NaN();
+                    return prefix.center + prefix.get_weighted_sum(j, p) * 2.0 / ((double)p * ((double)p + 1.0));
+                });
+        }
+
+        /** \brief Линейно-регрессионные скользящие средние для набора периодов
+         */
+        template<class T1, class T2>
+        int calculate_lrma(const T1 &input, const std::vector<size_t> &periods, T2 &output) {
+            return detail::calc_tiled(input, periods, output, false, true,
+                [](const detail::PrefixSums &prefix, const size_t t, const size_t j, const size_t p) -> double {
+                    // LRMA начинает обновлять WMA только после готовности SMA
+                    if (t + 1 < 2 * p) return std::numeric_limits<double>::quiet_NaN();
+                    const double wma = prefix.center + prefix.get_weighted_sum(j, p) * 2.0 / ((double)p * ((double)p + 1.0));
+                    const double sma = prefix.center + prefix.get_sum(j, p) / (double)p;
+                    return 3.0 * wma - 2.0 * sma;
+                });
+        }
+
+        /** \brief Экспоненциально взвешенные скользящие средние для набора периодов
+         */
+        template<class T1, class T2>
+        int calculate_ema(const T1 &input, const std::vector<size_t> &periods, T2 &output) {
+            return detail::calc_ema(input, periods, output, false);
+        }
+
+        /** \brief Модифицированные скользящие средние для набора периодов
+         */
+        template<class T1, class T2>
+        int calculate_mma(const T1 &input, const std::vector<size_t> &periods, T2 &output) {
+            return detail::calc_ema(input, periods, output, true);
+        }
+
+    }; // sweep
+}; // xtechnical
+
+#endif // XTECHNICAL_SWEEP_HPP_INCLUDED